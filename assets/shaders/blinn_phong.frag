@@ -1,33 +1,65 @@
 //include fog.glsl common.glsl commonFrag.glsl 
 
+// Each light is four texels of light_buffer, layout must match struct Light_Block_Entry in renderer.h
 struct Light
 {
 	vec3  position;
-	vec3  direction;
 	float outer_angle;
+	vec3  direction;
 	float inner_angle;
+	vec3  color;
 	float falloff;
 	float intensity;
-	vec3  color;
-	uint  pcf_enabled;
+	float radius;
 	int   type;
-	int   radius; 
-	float depth_bias;
 };
 
 const int LT_SPOT    = 0;
 const int LT_DIR     = 1;
 const int LT_POINT   = 2;
 
+// Layout must match struct Light_Block in renderer.h
+layout(std140) uniform Light_Block
+{
+	int   total_active_lights;
+	int   num_directional_lights;
+	float cluster_z_scale;
+	float cluster_z_bias;
+	vec2  cluster_tile_size;
+};
+
+uniform samplerBuffer  light_buffer;
+uniform usamplerBuffer light_clusters; // Offset into light_indices and light count for every cluster
+uniform usamplerBuffer light_indices;
+
 uniform sampler2D diffuse_texture;
-uniform Light lights[MAX_LIGHTS];
-uniform int total_active_lights;
+uniform mat4 view_mat;
 
 uniform float specular;
 uniform float diffuse;
 uniform float specular_strength;
 out vec4 frag_color;
 
+Light fetch_light(int index)
+{
+	vec4 texel0 = texelFetch(light_buffer, index * 4);
+	vec4 texel1 = texelFetch(light_buffer, index * 4 + 1);
+	vec4 texel2 = texelFetch(light_buffer, index * 4 + 2);
+	vec4 texel3 = texelFetch(light_buffer, index * 4 + 3);
+
+	Light light;
+	light.position    = texel0.xyz;
+	light.outer_angle = texel0.w;
+	light.direction   = texel1.xyz;
+	light.inner_angle = texel1.w;
+	light.color       = texel2.xyz;
+	light.falloff     = texel2.w;
+	light.intensity   = texel3.x;
+	light.radius      = texel3.y;
+	light.type        = floatBitsToInt(texel3.z);
+	return light;
+}
+
 vec3 calc_point_light(in Light light)
 {
 	vec3  diffuse_comp  = vec3(0.0);
@@ -112,14 +144,22 @@ void main()
 	vec4 albedo_color = diffuse_color * texture(diffuse_texture, vec2(uv.x * uv_scale.x, uv.y * uv_scale.y));
 	vec3 light_contribution = vec3(0.0, 0.0, 0.0);
 	
-	for(int i = 0; i < total_active_lights; i++)
+	for(int i = 0; i < num_directional_lights; i++)
+		light_contribution += calc_dir_light(fetch_light(i));
+
+	// Point and spot lights are only evaluated if they touch the cluster this fragment falls in
+	float view_depth = -(view_mat * vec4(vertex, 1.0)).z;
+	ivec3 cluster_coord = ivec3(ivec2(gl_FragCoord.xy / cluster_tile_size), int(floor(log(max(view_depth, 1e-4)) * cluster_z_scale + cluster_z_bias)));
+	cluster_coord = clamp(cluster_coord, ivec3(0), ivec3(LIGHT_CLUSTER_X - 1, LIGHT_CLUSTER_Y - 1, LIGHT_CLUSTER_Z - 1));
+	int   cluster       = cluster_coord.x + LIGHT_CLUSTER_X * (cluster_coord.y + LIGHT_CLUSTER_Y * cluster_coord.z);
+	uvec2 cluster_entry = texelFetch(light_clusters, cluster).xy;
+	for(uint i = 0u; i < cluster_entry.y; i++)
 	{
-		if(lights[i].type == LT_POINT)
-			light_contribution += calc_point_light(lights[i]);
-		else if(lights[i].type == LT_DIR)
-			light_contribution += calc_dir_light(lights[i]);
+		Light light = fetch_light(int(texelFetch(light_indices, int(cluster_entry.x + i)).x));
+		if(light.type == LT_POINT)
+			light_contribution += calc_point_light(light);
 		else
-			light_contribution += calc_spot_light(lights[i]);
+			light_contribution += calc_spot_light(light);
 	}
 	
 	frag_color = apply_fog((albedo_color * vec4(light_contribution + ambient_light, 1.0)));
@@ -3,6 +3,8 @@
 in vec3 vPosition;
 in vec3 vNormal;
 in vec2 vUV;
+in mat4 vModelMat;  // Per-instance, sourced from the renderer's instance buffer
+in mat3 vNormalMat; // Per-instance inverse transpose of vModelMat, computed on the cpu
 
 out vec2 uv;
 out vec3 normal;
@@ -11,23 +13,21 @@ out vec3 vertex;
 // out vec4 vertLightSpace;
 
 // Common uniforms
-uniform mat4 model_mat;
-uniform mat4 inv_model_mat;
 // uniform mat4 view_mat;
-uniform mat4 mvp;
+uniform mat4 view_proj_mat;
 uniform mat4 lightVPMat;
 
 vec4 transformPosition(vec3 position)
 {
-	return mvp * vec4(vPosition, 1.0);
+	return view_proj_mat * vModelMat * vec4(vPosition, 1.0);
 }
 
 void setOutputs()
 {
 	uv = vUV;
 	//Normal and vertex sent to the fragment shader should be in the same space!
-	normal = vec4(transpose(inv_model_mat) * vec4(vNormal, 0.0)).xyz;
-	vertex = vec4(model_mat * vec4(vPosition, 1.0)).xyz;
+	normal = vNormalMat * vNormal;
+	vertex = vec4(vModelMat * vec4(vPosition, 1.0)).xyz;
 	// vertCamSpace   = vec4(view_mat * vec4(vPosition, 1.0)).xyz;
-	// vertLightSpace = vec4((lightVPMat * model_mat) * vec4(vPosition, 1.0));
+	// vertLightSpace = vec4((lightVPMat * vModelMat) * vec4(vPosition, 1.0));
 }
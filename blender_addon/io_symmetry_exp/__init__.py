@@ -14,11 +14,50 @@ import struct
 from math import radians
 from bpy_extras.io_utils import ExportHelper
 
+GEOM_FILE_MAGIC   = 0x324D4753 # "SGM2", must match geometry.h
+GEOM_FILE_VERSION = 2
+
+def pack_normal(normal):
+    # Signed normalized 10_10_10_2, w is unused
+    packed = 0
+    for i in range(3):
+        component = int(round(max(-1.0, min(1.0, normal[i])) * 511.0))
+        packed |= (component & 0x3FF) << (10 * i)
+    return packed
+
+def write_symbres_v2(filepath, vertices, normals, uvs):
+    # Blender hands out one vertex per face corner, merge the ones that end up identical after quantization
+    vertex_data   = []
+    indices       = []
+    unique_lookup = {}
+    for i in range(len(vertices)):
+        packed = struct.pack('<fffIee', vertices[i][0], vertices[i][1], vertices[i][2], pack_normal(normals[i]), uvs[i][0], uvs[i][1])
+        index = unique_lookup.get(packed)
+        if index is None:
+            index = len(vertex_data)
+            unique_lookup[packed] = index
+            vertex_data.append(packed)
+        indices.append(index)
+
+    index_format = 'H' if len(vertex_data) <= 65536 else 'I'
+    index_size   = struct.calcsize(index_format)
+
+    print ("Num Vertices : %d, merged from %d" % (len(vertex_data), len(vertices)))
+    print ("Num Indices  : %d, %d bytes each" % (len(indices), index_size))
+
+    file = open(filepath, 'bw')
+    file.write(struct.pack('<IIIII', GEOM_FILE_MAGIC, GEOM_FILE_VERSION, len(vertex_data), len(indices), index_size))
+    file.write(b''.join(vertex_data))
+    file.write(struct.pack('<%d%s' % (len(indices), index_format), *indices))
+    file.close()
+
 class ExportSymmetry(bpy.types.Operator, ExportHelper):
     bl_idname       = "export_symmetry.symbres";
     bl_label        = "Symmetry Exporter";
     bl_options      = {'PRESET'};
     filename_ext    = ".symbres";
+
+    legacy_format: bpy.props.BoolProperty(name = "Legacy Format", description = "Write the old version 1 layout with separate float arrays instead of interleaved, quantized vertices", default = False);
     
     def execute(self, context):
         scene = context.scene
@@ -70,6 +109,11 @@ class ExportSymmetry(bpy.types.Operator, ExportHelper):
         activeObject.rotation_euler[1] = radians(-180)
         bpy.ops.object.transform_apply(location = True, scale = True, rotation = True)
         
+        if not self.legacy_format:
+            write_symbres_v2(self.filepath, vertices, normals, uvs)
+            print("Done!")
+            return {'FINISHED'};
+
         file = open(self.filepath, 'bw')
 
         # Header
@@ -175,6 +175,172 @@ solution "Symmetry"
 			postbuildcommands {"ln -fs " .. os.getcwd()  .. "/../assets " .. os.getcwd() .. "/" .. _ACTION .. "/debug"}
 			postbuildcommands {"ln -fs " .. os.getcwd()  .. "/../assets " .. os.getcwd() .. "/" .. _ACTION .. "/release"}
 
+	-------------------------
+	-- Texture Importer
+	-------------------------
+	project "Texture_Importer"
+		kind "ConsoleApp"
+		targetname "Texture_Importer"
+		language "C"
+		files { "../src/tools/texture_importer.c", "../src/game/image.c", "../src/game/image.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+
+		configuration "not windows"
+		    links {"m"}
+
+	-------------------------
+	-- Tests
+	-------------------------
+	-- Console apps that exit with a non zero status when a check fails, run them from the build directory
+	project "Job_System_Test"
+		kind "ConsoleApp"
+		targetname "Job_System_Test"
+		language "C"
+		files { "../src/tests/job_system_test.c", "../src/common/job_system.c", "../src/common/job_system.h", "../src/common/atomics.h", "../src/common/linmath.c", "../src/common/linmath.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h", "../src/game/bounding_volumes.c", "../src/game/bounding_volumes.h" }
+		includedirs {"../include/common"}
+
+		configuration "linux"
+		    includedirs {"../include/linux/sdl2/"}
+		    libdirs {"../lib/linux/sdl2/"}
+		    links {"SDL2", "m", "pthread"}
+
+		configuration "macosx"
+		    includedirs {"../include/mac/sdl2/"}
+		    libdirs {"../lib/mac/sdl2/"}
+		    links {"SDL2", "m", "pthread"}
+
+		configuration {"windows", "vs2019"}
+		    includedirs	{"../include/windows/sdl2/"}
+		    libdirs {"../lib/windows/sdl2/"}
+		    links {"SDL2"}
+
+	-- Same source built with and without SSE, see the top of linmath_test.c for how to run them
+	project "Linmath_Test_Scalar"
+		kind "ConsoleApp"
+		targetname "Linmath_Test_Scalar"
+		language "C"
+		files { "../src/tests/linmath_test.c", "../src/tests/test_utils.c", "../src/tests/test_utils.h", "../src/common/linmath.c", "../src/common/linmath.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+		defines {"LINMATH_NO_SSE"}
+
+		configuration "not windows"
+		    links {"m"}
+
+	project "Linmath_Test"
+		kind "ConsoleApp"
+		targetname "Linmath_Test"
+		language "C"
+		files { "../src/tests/linmath_test.c", "../src/tests/test_utils.c", "../src/tests/test_utils.h", "../src/common/linmath.c", "../src/common/linmath.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+
+		configuration "not windows"
+		    links {"m"}
+
+	project "Image_Test"
+		kind "ConsoleApp"
+		targetname "Image_Test"
+		language "C"
+		files { "../src/tests/image_test.c", "../src/tests/test_utils.c", "../src/tests/test_utils.h", "../src/game/image.c", "../src/game/image.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+
+		configuration "not windows"
+		    links {"m"}
+
+	project "Image_Bench"
+		kind "ConsoleApp"
+		targetname "Image_Bench"
+		language "C"
+		files { "../src/tests/image_test.c", "../src/tests/test_utils.c", "../src/tests/test_utils.h", "../src/game/image.c", "../src/game/image.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+		defines {"IMAGE_BENCH"}
+
+		configuration "not windows"
+		    links {"m"}
+
+	project "Frustum_Bench"
+		kind "ConsoleApp"
+		targetname "Frustum_Bench"
+		language "C"
+		files { "../src/tests/frustum_bench.c", "../src/tests/test_utils.c", "../src/tests/test_utils.h", "../src/game/bounding_volumes.c", "../src/game/bounding_volumes.h", "../src/common/linmath.c", "../src/common/linmath.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+
+		configuration "not windows"
+		    links {"m"}
+
+	project "Light_Cluster_Bench"
+		kind "ConsoleApp"
+		targetname "Light_Cluster_Bench"
+		language "C"
+		files { "../src/tests/light_cluster_bench.c", "../src/tests/test_utils.c", "../src/tests/test_utils.h", "../src/game/light_cluster.c", "../src/game/light_cluster.h", "../src/common/linmath.c", "../src/common/linmath.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+
+		configuration "not windows"
+		    links {"m"}
+
+	project "Event_Bench"
+		kind "ConsoleApp"
+		targetname "Event_Bench"
+		language "C"
+		files { "../src/tests/event_bench.c", "../src/tests/test_utils.c", "../src/tests/test_utils.h", "../src/game/event.c", "../src/game/event.h", "../src/game/entity_handle.h", "../src/common/array.c", "../src/common/array.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+
+		configuration "linux"
+		    includedirs {"../include/linux/sdl2/"}
+		    libdirs {"../lib/linux/sdl2/"}
+		    links {"SDL2", "m"}
+
+		configuration "macosx"
+		    includedirs {"../include/mac/sdl2/"}
+		    libdirs {"../lib/mac/sdl2/"}
+		    links {"SDL2", "m"}
+
+		configuration {"windows", "vs2019"}
+		    includedirs	{"../include/windows/sdl2/"}
+		    libdirs {"../lib/windows/sdl2/"}
+		    links {"SDL2"}
+
+	project "Hashmap_Bench"
+		kind "ConsoleApp"
+		targetname "Hashmap_Bench"
+		language "C"
+		files { "../src/tests/hashmap_bench.c", "../src/tests/test_utils.c", "../src/tests/test_utils.h", "../src/common/hashmap.c", "../src/common/hashmap.h", "../src/common/variant.c", "../src/common/variant.h", "../src/common/string_utils.c", "../src/common/string_utils.h", "../src/common/array.c", "../src/common/array.h", "../src/common/linmath.c", "../src/common/linmath.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+
+		configuration "not windows"
+		    links {"m"}
+
+	project "Parser_Test"
+		kind "ConsoleApp"
+		targetname "Parser_Test"
+		language "C"
+		files { "../src/tests/parser_test.c", "../src/tests/test_utils.c", "../src/tests/test_utils.h", "../src/common/parser.c", "../src/common/parser.h", "../src/common/hashmap.c", "../src/common/hashmap.h", "../src/common/variant.c", "../src/common/variant.h", "../src/common/string_utils.c", "../src/common/string_utils.h", "../src/common/array.c", "../src/common/array.h", "../src/common/linmath.c", "../src/common/linmath.h", "../src/common/log.c", "../src/common/log.h", "../src/common/memory_utils.c", "../src/common/memory_utils.h" }
+		includedirs {"../include/common"}
+
+		configuration "not windows"
+		    links {"m"}
+
+	project "Event_Queue_Test"
+		kind "ConsoleApp"
+		targetname "Event_Queue_Test"
+		language "C"
+		files { "../src/tests/event_queue_test.c", "../src/common/**.c", "../src/common/**.h", "../src/system/platform.c", "../src/system/config_vars.c", "../src/system/file_io.c", "../src/game/event.c", "../src/game/event.h", "../src/game/entity_handle.h" }
+		includedirs {"../include/common"}
+
+		configuration "linux"
+		    includedirs {"../include/linux/sdl2/"}
+		    libdirs {"../lib/linux/sdl2/"}
+		    links {"SDL2", "m", "pthread"}
+
+		configuration "macosx"
+		    includedirs {"../include/mac/sdl2/"}
+		    libdirs {"../lib/mac/sdl2/"}
+		    links {"SDL2", "m", "pthread"}
+
+		configuration {"windows", "vs2019"}
+		    includedirs	{"../include/windows/sdl2/"}
+		    libdirs {"../lib/windows/sdl2/"}
+		    links {"SDL2"}
+
 	newaction {
 	   trigger = "build_addon",
 	   description = "Build blender addon into zip file that can be loaded into blender, needs zip installed and available on PATH(Only works on bash/nix-style shell for now)",
@@ -27,7 +27,7 @@ static struct Array* array_get_ptr(void* array_data)
 void* array_new_(size_t object_size, int capacity)
 {
 	int initial_capacity    = capacity == 0 ? ARRAY_MIN_CAPACITY : capacity;
-	struct Array* new_array = memory_allocate(sizeof(*new_array) + (object_size * initial_capacity));
+	struct Array* new_array = memory_allocate_tagged(sizeof(*new_array) + (object_size * initial_capacity), MT_ARRAY);
 	new_array->object_size  = object_size;
 	new_array->length       = capacity;
 	new_array->capacity     = initial_capacity;
@@ -53,7 +53,7 @@ void* array_grow_(void** array)
 	if(++array_ptr->length > array_ptr->capacity)
 	{
 		array_ptr->capacity = array_ptr->capacity << 1; /* LShift by 1 means (number * number) */
-		char* new_data = memory_reallocate(array_ptr, sizeof(*array_ptr) + (array_ptr->object_size * array_ptr->capacity));
+		char* new_data = memory_reallocate_tagged(array_ptr, sizeof(*array_ptr) + (array_ptr->object_size * array_ptr->capacity), MT_ARRAY);
 		if(new_data)
 		{
 			array_ptr = (struct Array*)new_data;
@@ -77,7 +77,7 @@ int array_reset_(void** array, int length)
 	int new_capacity = length < ARRAY_MIN_CAPACITY ? ARRAY_MIN_CAPACITY : length;
 	int new_length = new_capacity;
 	array_free(*array);
-	array_ptr = memory_allocate_and_clear(1, sizeof(*array_ptr) + (new_capacity * object_size));
+	array_ptr = memory_allocate_and_clear_tagged(1, sizeof(*array_ptr) + (new_capacity * object_size), MT_ARRAY);
 	if(array_ptr)
 	{
 		array_ptr->length = new_length;
@@ -110,7 +110,7 @@ struct Array* array_reallocate(struct Array* array)
 	if((array->length << 2) < array->capacity && array->capacity > ARRAY_MIN_CAPACITY)
 	{
 		array->capacity = array->capacity >> 1;
-		array = memory_reallocate(array, sizeof(*array) + (array->object_size * array->capacity));
+		array = memory_reallocate_tagged(array, sizeof(*array) + (array->object_size * array->capacity), MT_ARRAY);
 		/* TODO: Maybe error handling here? */
 	}
 	return array;
@@ -181,7 +181,7 @@ void array_inc_cap_by_(void** array, int cap)
 	if(cap > 0)
 	{
 		array_ptr->capacity += cap;
-		char* new_data = memory_reallocate(array_ptr, sizeof(*array_ptr) + (array_ptr->object_size * array_ptr->capacity));
+		char* new_data = memory_reallocate_tagged(array_ptr, sizeof(*array_ptr) + (array_ptr->object_size * array_ptr->capacity), MT_ARRAY);
 		if(new_data)
 		{
 			array_ptr = (struct Array*)new_data;
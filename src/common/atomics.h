@@ -0,0 +1,96 @@
+#ifndef ATOMICS_H
+#define ATOMICS_H
+
+#include "num_types.h"
+
+#include <stddef.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+Small set of atomic operations for data shared with worker threads. Loads have acquire and
+stores have release semantics, read-modify-write operations are full barriers. relaxed_load
+is for values like statistics where ordering does not matter
+ */
+
+static inline uint32 atomic_uint32_load(volatile uint32* value)
+{
+#ifdef _MSC_VER
+	return *value; // Volatile accesses have acquire/release semantics on x86 and x64
+#else
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void atomic_uint32_store(volatile uint32* value, uint32 new_value)
+{
+#ifdef _MSC_VER
+	*value = new_value;
+#else
+	__atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline uint32 atomic_uint32_add(volatile uint32* value, uint32 amount) // Returns the new value
+{
+#ifdef _MSC_VER
+	return (uint32)_InterlockedExchangeAdd((volatile long*)value, (long)amount) + amount;
+#else
+	return __atomic_add_fetch(value, amount, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline uint32 atomic_uint32_exchange(volatile uint32* value, uint32 new_value) // Returns the previous value
+{
+#ifdef _MSC_VER
+	return (uint32)_InterlockedExchange((volatile long*)value, (long)new_value);
+#else
+	return __atomic_exchange_n(value, new_value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline bool atomic_uint32_compare_exchange(volatile uint32* value, uint32* expected, uint32 desired) // On failure expected is set to the current value
+{
+#ifdef _MSC_VER
+	uint32 previous = (uint32)_InterlockedCompareExchange((volatile long*)value, (long)desired, (long)*expected);
+	bool success = previous == *expected;
+	*expected = previous;
+	return success;
+#else
+	return __atomic_compare_exchange_n(value, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline size_t atomic_size_relaxed_load(volatile size_t* value)
+{
+#ifdef _MSC_VER
+	return *value;
+#else
+	return __atomic_load_n(value, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline size_t atomic_size_add(volatile size_t* value, size_t amount) // Returns the new value
+{
+#ifdef _MSC_VER
+	return (size_t)_InterlockedExchangeAdd64((volatile __int64*)value, (__int64)amount) + amount;
+#else
+	return __atomic_add_fetch(value, amount, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline bool atomic_size_compare_exchange(volatile size_t* value, size_t* expected, size_t desired)
+{
+#ifdef _MSC_VER
+	size_t previous = (size_t)_InterlockedCompareExchange64((volatile __int64*)value, (__int64)desired, (__int64)*expected);
+	bool success = previous == *expected;
+	*expected = previous;
+	return success;
+#else
+	return __atomic_compare_exchange_n(value, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+#endif
@@ -8,84 +8,142 @@
 #include <string.h>
 #include <assert.h>
 
+/* Open addressing with linear probing. A stored hash of 0 marks an empty slot, hashes
+   produced by hashmap_key_hash are never 0. Removal shifts the following entries of the
+   probe sequence back instead of leaving tombstones so lookups never have to skip over
+   dead slots */
 struct Hashmap_Entry
 {
+    uint32         hash;
     char           key[MAX_HASH_KEY_LEN];
     struct Variant value;
 };
 
 struct Hashmap
 {
-    struct Hashmap_Entry* buckets[HASH_MAP_NUM_BUCKETS];
-    int iter_bucket, iter_index;
+    struct Hashmap_Entry* entries;
+    int                   capacity; // Always a power of two
+    int                   count;
+    int                   iter_index;
 };
 
-static unsigned int          hashmap_generate_hash(const char* key);
+#define HASHMAP_MIN_CAPACITY  16
+#define HASHMAP_MAX_LOAD_NUM  3 // Grow once the map is more than 3/4 full
+#define HASHMAP_MAX_LOAD_DEN  4
+
 static struct Hashmap_Entry* hashmap_entry_new(struct Hashmap* hashmap, const char* key);
+static struct Hashmap_Entry* hashmap_entry_find(const struct Hashmap* hashmap, uint32 hash, const char* key);
+static bool                  hashmap_grow(struct Hashmap* hashmap);
+static void                  hashmap_value_read(const struct Hashmap* hashmap, const char* key, int variant_type, struct Variant* out_value);
 
-static struct Hashmap_Entry* hashmap_entry_new(struct Hashmap* hashmap, const char* key)
+uint32 hashmap_key_hash(const char* key)
 {
-	unsigned int index = hashmap_generate_hash(key);
-	struct Hashmap_Entry* new_entry = NULL;
-	for(int i = 0; i < array_len(hashmap->buckets[index]); i++) /* Look for duplicates and over-write if found */
-	{
-		if(strncmp(key, hashmap->buckets[index][i].key, MAX_HASH_KEY_LEN) == 0)
-		{
-			new_entry = &hashmap->buckets[index][i];
-			//if(new_entry->key) memory_free(new_entry->key);
-            memset(new_entry->key, '\0', MAX_HASH_KEY_LEN);
-			break;
-		}
-	}
-	if(!new_entry) new_entry = array_grow(hashmap->buckets[index], struct Hashmap_Entry);
-	//new_entry->key = str_new(key);
-    strncpy(new_entry->key, key, MAX_HASH_KEY_LEN);
-	new_entry->value.type = VT_NONE;
-    variant_free(&new_entry->value);
-    return new_entry;
+    // FNV-1a over the part of the key that fits in an entry
+    uint32 hash = 2166136261u;
+    for(int i = 0; i < MAX_HASH_KEY_LEN - 1 && key[i] != '\0'; i++)
+    {
+        hash ^= (uchar)key[i];
+        hash *= 16777619u;
+    }
+    return hash != 0 ? hash : 1;
 }
 
-unsigned int hashmap_generate_hash(const char* key)
+static struct Hashmap_Entry* hashmap_entry_find(const struct Hashmap* hashmap, uint32 hash, const char* key)
 {
-    unsigned int index      = 0;
-    const int    multiplier = 51;
-    for(int i = 0; i < (int)strlen(key); i++)
-	index = index * multiplier + key[i];
-    return index % HASH_MAP_NUM_BUCKETS;
+    uint32 mask = (uint32)hashmap->capacity - 1;
+    for(uint32 index = hash & mask; hashmap->entries[index].hash != 0; index = (index + 1) & mask)
+    {
+        struct Hashmap_Entry* entry = &hashmap->entries[index];
+        if(entry->hash == hash && strncmp(key, entry->key, MAX_HASH_KEY_LEN - 1) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+static bool hashmap_grow(struct Hashmap* hashmap)
+{
+    int new_capacity = hashmap->capacity * 2;
+    struct Hashmap_Entry* new_entries = memory_allocate_and_clear_tagged(1, sizeof(*new_entries) * new_capacity, MT_HASHMAP);
+    if(!new_entries)
+    {
+        log_error("hashmap:grow", "Failed to grow hashmap to %d entries", new_capacity);
+        return false;
+    }
+
+    // Stored hashes let existing entries be moved without touching their keys
+    uint32 mask = (uint32)new_capacity - 1;
+    for(int i = 0; i < hashmap->capacity; i++)
+    {
+        struct Hashmap_Entry* entry = &hashmap->entries[i];
+        if(entry->hash == 0) continue;
+
+        uint32 index = entry->hash & mask;
+        while(new_entries[index].hash != 0)
+            index = (index + 1) & mask;
+        memcpy(&new_entries[index], entry, sizeof(*entry));
+    }
+
+    memory_free(hashmap->entries);
+    hashmap->entries  = new_entries;
+    hashmap->capacity = new_capacity;
+    return true;
+}
+
+static struct Hashmap_Entry* hashmap_entry_new(struct Hashmap* hashmap, const char* key)
+{
+    uint32 hash = hashmap_key_hash(key);
+    struct Hashmap_Entry* new_entry = hashmap_entry_find(hashmap, hash, key); /* Over-write existing value if found */
+    if(new_entry)
+    {
+        variant_free(&new_entry->value);
+        return new_entry;
+    }
+
+    if((hashmap->count + 1) * HASHMAP_MAX_LOAD_DEN > hashmap->capacity * HASHMAP_MAX_LOAD_NUM)
+        hashmap_grow(hashmap);
+
+    uint32 mask  = (uint32)hashmap->capacity - 1;
+    uint32 index = hash & mask;
+    while(hashmap->entries[index].hash != 0)
+        index = (index + 1) & mask;
+
+    new_entry = &hashmap->entries[index];
+    new_entry->hash = hash;
+    strncpy(new_entry->key, key, MAX_HASH_KEY_LEN - 1);
+    new_entry->key[MAX_HASH_KEY_LEN - 1] = '\0';
+    new_entry->value.type = VT_NONE;
+    hashmap->count++;
+    return new_entry;
 }
 
 struct Hashmap* hashmap_create(void)
 {
-    struct Hashmap* hashmap = memory_allocate(sizeof(*hashmap));
+    struct Hashmap* hashmap = memory_allocate_tagged(sizeof(*hashmap), MT_HASHMAP);
     if(!hashmap)
 		return NULL;
 
-    for(int i = 0; i < HASH_MAP_NUM_BUCKETS; i++)
-		hashmap->buckets[i] = array_new(struct Hashmap_Entry);
-    hashmap->iter_bucket =  0;
-    hashmap->iter_index  = -1;
+    hashmap->entries = memory_allocate_and_clear_tagged(1, sizeof(*hashmap->entries) * HASHMAP_MIN_CAPACITY, MT_HASHMAP);
+    if(!hashmap->entries)
+    {
+        memory_free(hashmap);
+        return NULL;
+    }
+    hashmap->capacity   = HASHMAP_MIN_CAPACITY;
+    hashmap->count      = 0;
+    hashmap->iter_index = -1;
     return hashmap;
 }
 
 void hashmap_free(struct Hashmap* hashmap)
 {
 	if(!hashmap) return;
-	for(int i = 0; i < HASH_MAP_NUM_BUCKETS; i++)
+	for(int i = 0; i < hashmap->capacity; i++)
 	{
-		for(int j = 0; j < array_len(hashmap->buckets[i]); j++)
-		{
-			struct Hashmap_Entry* entry = &hashmap->buckets[i][j];
-			//if(entry->key)
-			//{
-			//	memory_free(entry->key);
-			//	entry->key = NULL;
-			//}
-            memset(entry->key, '\0', MAX_HASH_KEY_LEN);
+		struct Hashmap_Entry* entry = &hashmap->entries[i];
+		if(entry->hash != 0)
 			variant_free(&entry->value);
-		}
-		array_free(hashmap->buckets[i]);
-		hashmap->buckets[i] = NULL;
 	}
+	memory_free(hashmap->entries);
 	memory_free(hashmap);
 	hashmap = NULL;
 }
@@ -100,38 +158,38 @@ void hashmap_value_set(struct Hashmap* hashmap, const char* key, const struct Va
 struct Variant* hashmap_value_get(const struct Hashmap* hashmap, const char* key)
 {
     if(!hashmap || !key) return NULL;
-    struct Variant* value = NULL;
-    unsigned int index    = hashmap_generate_hash(key);
-    int key_len           = (int)strlen(key);
-    int compare_len       = key_len < MAX_HASH_KEY_LEN ? key_len : MAX_HASH_KEY_LEN;
-	for(int i = 0; i < array_len(hashmap->buckets[index]); i++)
-	{
-		// Check for the length of the key to avoid partial matches. We might be looking for 
-		// "Diffuse" and we'll get matched to "Diffuse_Color" if we're relying on the length
-		// of "Diffuse" only
-		if(strnlen(hashmap->buckets[index][i].key, MAX_HASH_KEY_LEN) == compare_len && strncmp(key, hashmap->buckets[index][i].key, compare_len) == 0)
-		{
-			value = &hashmap->buckets[index][i].value;
-			break;
-		}
-	}
-	return value;
+    return hashmap_value_get_hashed(hashmap, hashmap_key_hash(key), key);
+}
+
+struct Variant* hashmap_value_get_hashed(const struct Hashmap* hashmap, uint32 hash, const char* key)
+{
+    if(!hashmap || !key) return NULL;
+    struct Hashmap_Entry* entry = hashmap_entry_find(hashmap, hash, key);
+    return entry ? &entry->value : NULL;
 }
 
 void hashmap_value_remove(struct Hashmap* hashmap, const char* key)
 {
     if(!hashmap || !key) return;
-    unsigned int index = hashmap_generate_hash(key);
-	int index_to_remove = -1;
-	for(int i = 0; i < array_len(hashmap->buckets[index]); i++)
-	{
-		if(strncmp(key, hashmap->buckets[index][i].key, MAX_HASH_KEY_LEN) == 0)
-		{
-			index_to_remove = i;
-			break;
-		}
-	}
-	if(index_to_remove != -1) array_remove_at(hashmap->buckets[index], index_to_remove);
+    struct Hashmap_Entry* entry = hashmap_entry_find(hashmap, hashmap_key_hash(key), key);
+    if(!entry) return;
+
+    variant_free(&entry->value);
+
+    // Pull back any entry after the hole that would become unreachable from its home slot
+    uint32 mask = (uint32)hashmap->capacity - 1;
+    uint32 hole = (uint32)(entry - hashmap->entries);
+    for(uint32 index = (hole + 1) & mask; hashmap->entries[index].hash != 0; index = (index + 1) & mask)
+    {
+        uint32 home = hashmap->entries[index].hash & mask;
+        if(((index - home) & mask) >= ((index - hole) & mask))
+        {
+            memcpy(&hashmap->entries[hole], &hashmap->entries[index], sizeof(struct Hashmap_Entry));
+            hole = index;
+        }
+    }
+    memset(&hashmap->entries[hole], 0, sizeof(struct Hashmap_Entry));
+    hashmap->count--;
 }
 
 bool hashmap_value_exists(struct Hashmap * hashmap, const char * key)
@@ -238,65 +296,65 @@ void hashmap_ptr_set(struct Hashmap* hashmap, const char* key, void* value)
 
 float hashmap_float_get(const struct Hashmap* hashmap, const char* key)
 {
-    struct Variant* variant = hashmap_value_get(hashmap, key);
-    if(variant->type == VT_STR)	variant_from_str(variant, variant->val_str, VT_FLOAT);
-    return variant->val_float;
+    struct Variant value;
+    hashmap_value_read(hashmap, key, VT_FLOAT, &value);
+    return value.val_float;
 }
 
 int hashmap_int_get(const struct Hashmap* hashmap, const char* key)
 {
-    struct Variant* variant = hashmap_value_get(hashmap, key);
-    if(variant->type == VT_STR)	variant_from_str(variant, variant->val_str, VT_INT);
-    return variant->val_int;
+    struct Variant value;
+    hashmap_value_read(hashmap, key, VT_INT, &value);
+    return value.val_int;
 }
 
 uint hashmap_uint_get(const struct Hashmap* hashmap, const char* key)
 {
-    struct Variant* variant = hashmap_value_get(hashmap, key);
-    if(variant->type == VT_STR)	variant_from_str(variant, variant->val_str, VT_UINT);
-    return variant->val_uint;
+    struct Variant value;
+    hashmap_value_read(hashmap, key, VT_UINT, &value);
+    return value.val_uint;
 }
 
 double hashmap_double_get(const struct Hashmap* hashmap, const char* key)
 {
-    struct Variant* variant = hashmap_value_get(hashmap, key);
-    if(variant->type == VT_STR)	variant_from_str(variant, variant->val_str, VT_DOUBLE);
-    return variant->val_double;
+    struct Variant value;
+    hashmap_value_read(hashmap, key, VT_DOUBLE, &value);
+    return value.val_double;
 }
 
 bool hashmap_bool_get(const struct Hashmap* hashmap, const char* key)
 {
-    struct Variant* variant = hashmap_value_get(hashmap, key);
-    if(variant->type == VT_STR)	variant_from_str(variant, variant->val_str, VT_BOOL);
-    return variant->val_bool;
+    struct Variant value;
+    hashmap_value_read(hashmap, key, VT_BOOL, &value);
+    return value.val_bool;
 }
 
 vec2 hashmap_vec2_get(const struct Hashmap* hashmap, const char* key)
 {
-    struct Variant* variant = hashmap_value_get(hashmap, key);
-    if(variant->type == VT_STR)	variant_from_str(variant, variant->val_str, VT_VEC2);
-    return variant->val_vec2;
+    struct Variant value;
+    hashmap_value_read(hashmap, key, VT_VEC2, &value);
+    return value.val_vec2;
 }
 
 vec3 hashmap_vec3_get(const struct Hashmap* hashmap, const char* key)
 {
-    struct Variant* variant = hashmap_value_get(hashmap, key);
-    if(variant->type == VT_STR)	variant_from_str(variant, variant->val_str, VT_VEC3);
-    return variant->val_vec3;
+    struct Variant value;
+    hashmap_value_read(hashmap, key, VT_VEC3, &value);
+    return value.val_vec3;
 }
 
 vec4 hashmap_vec4_get(const struct Hashmap* hashmap, const char* key)
 {
-    struct Variant* variant = hashmap_value_get(hashmap, key);
-    if(variant->type == VT_STR)	variant_from_str(variant, variant->val_str, VT_VEC4);
-    return variant->val_vec4;
+    struct Variant value;
+    hashmap_value_read(hashmap, key, VT_VEC4, &value);
+    return value.val_vec4;
 }
 
 quat hashmap_quat_get(const struct Hashmap* hashmap, const char* key)
 {
-    struct Variant* variant = hashmap_value_get(hashmap, key);
-    if(variant->type == VT_STR)	variant_from_str(variant, variant->val_str, VT_QUAT);
-    return variant->val_quat;
+    struct Variant value;
+    hashmap_value_read(hashmap, key, VT_QUAT, &value);
+    return value.val_quat;
 }
 
 const mat4* hashmap_mat4_get(const struct Hashmap* hashmap, const char* key)
@@ -323,47 +381,37 @@ void hashmap_debug_print(const struct Hashmap* hashmap)
     if(!hashmap) return;
     static char str[128];
     memset(str, '\0', 128);
-	for(int i = 0; i < HASH_MAP_NUM_BUCKETS; i++)
+	log_message("Entries : %d, Capacity : %d", hashmap->count, hashmap->capacity);
+	for(int i = 0; i < hashmap->capacity; i++)
 	{
-		log_message("Bucket : %d", i);
-		log_message("Bucket len : %d", array_len(hashmap->buckets[i]));
-		for(int j = 0; j < array_len(hashmap->buckets[i]); j++)
-		{
-			struct Hashmap_Entry* entry = &hashmap->buckets[i][j];
-			const struct Variant* value = &entry->value;
-			const char* key = entry->key;
-			log_message("Key : %s", key);
-			variant_to_str(value, str, 128);
-			log_message("Value : %s", str);
-			memset(str, '\0', 128);
-		}
+		struct Hashmap_Entry* entry = &hashmap->entries[i];
+		if(entry->hash == 0) continue;
+
+		const struct Variant* value = &entry->value;
+		log_message("Slot : %d, Home : %d, Key : %s", i, entry->hash & (hashmap->capacity - 1), entry->key);
+		variant_to_str(value, str, 128);
+		log_message("Value : %s", str);
+		memset(str, '\0', 128);
 	}
 }
 
 void hashmap_iter_begin(struct Hashmap* hashmap)
 {
     assert(hashmap);
-    hashmap->iter_bucket = 0;
-    hashmap->iter_index  = -1;
+    hashmap->iter_index = -1;
 }
 
 int hashmap_iter_next(struct Hashmap* hashmap, char** key, struct Variant** value)
 {
     assert(hashmap);
-	for(; hashmap->iter_bucket < HASH_MAP_NUM_BUCKETS; hashmap->iter_bucket++)
+	while(++hashmap->iter_index < hashmap->capacity)
 	{
-		if(hashmap->buckets[hashmap->iter_bucket])
+		struct Hashmap_Entry* entry = &hashmap->entries[hashmap->iter_index];
+		if(entry->hash != 0)
 		{
-			if(++hashmap->iter_index < array_len(hashmap->buckets[hashmap->iter_bucket]))
-			{
-				*key = hashmap->buckets[hashmap->iter_bucket][hashmap->iter_index].key;
-				*value = &hashmap->buckets[hashmap->iter_bucket][hashmap->iter_index].value;
-				return 1;
-			}
-			else
-			{
-				hashmap->iter_index = -1;
-			}
+			*key   = entry->key;
+			*value = &entry->value;
+			return 1;
 		}
 	}
 	return 0;
@@ -379,3 +427,20 @@ void hashmap_copy(struct Hashmap* from, struct Hashmap* to)
 		hashmap_value_set(to, from_key, from_val);
     }
 }
+
+/* Values that are still text, as the parser stores them, are converted into out_value every
+   time they are read so the map itself is never changed by a read. Anything else is returned
+   as it is stored */
+static void hashmap_value_read(const struct Hashmap* hashmap, const char* key, int variant_type, struct Variant* out_value)
+{
+    const struct Variant* variant = hashmap_value_get(hashmap, key);
+    if(variant->type != VT_STR)
+    {
+        memcpy(out_value, variant, sizeof(*out_value));
+        return;
+    }
+
+    memset(out_value, 0, sizeof(*out_value));
+    variant_init_empty(out_value);
+    variant_from_str(out_value, variant->val_str, variant_type);
+}
@@ -17,6 +17,8 @@ void            hashmap_value_remove(struct Hashmap* hashmap, const char* key);
 bool            hashmap_value_exists(struct Hashmap* hashmap, const char* key);
 void            hashmap_value_set(struct Hashmap* hashmap, const char* key, const struct Variant* value);
 struct Variant* hashmap_value_get(const struct Hashmap* hashmap, const char* key);
+struct Variant* hashmap_value_get_hashed(const struct Hashmap* hashmap, uint32 hash, const char* key); // hash must come from hashmap_key_hash(key), lets hot paths hash constant keys once
+uint32          hashmap_key_hash(const char* key);
 
 void  	  	hashmap_float_set(struct Hashmap* hashmap, const char* key, const float value);
 void  	  	hashmap_int_set(struct Hashmap* hashmap, const char* key, const int value);
@@ -49,7 +51,7 @@ const char*	hashmap_str_get(const struct Hashmap* hashmap, const char* key);
 void*      	hashmap_ptr_get(const struct Hashmap* hashmap, const char* key);
 
 void            hashmap_debug_print(const struct Hashmap* hashmap);
-/* Only used during iteration */
+/* Only used during iteration, setting or removing values while iterating is not supported */
 void            hashmap_iter_begin(struct Hashmap* hashmap);
 int             hashmap_iter_next(struct Hashmap* hashmap, char** key, struct Variant** value);
 
@@ -0,0 +1,297 @@
+#include "job_system.h"
+#include "atomics.h"
+#include "log.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#define MAX_JOB_WORKERS       16
+#define MAX_JOB_DEQUE_RANGES  64 // Splitting in half means a deque holds about log2(count / batch_size) ranges
+#define MAX_JOB_STEAL_RETRIES 64 // Attempts a worker makes at finding work while a loop is still running before going to sleep
+
+struct Job_Range
+{
+	int start;
+	int end;
+};
+
+struct Job_Deque
+{
+	struct Job_Range ranges[MAX_JOB_DEQUE_RANGES];
+	int              top;    // Oldest range, taken by thieves
+	int              bottom; // One past the newest range, pushed and popped by the owner
+	volatile uint32  lock;
+};
+
+struct Job_System
+{
+	struct Job_System_Threading threading;
+	struct Thread*              threads[MAX_JOB_WORKERS];
+	int                         num_workers;
+	struct Job_Deque            deques[MAX_JOB_WORKERS + 1]; // Deque 0 belongs to the main thread
+	struct Mutex*               mutex;
+	struct Condition*           work_available;
+	struct Condition*           work_done;
+	Job_Worker_Init_Func        worker_init;
+	Job_Func                    func;
+	void*                       data;
+	int                         batch_size;
+	volatile uint32             remaining;  // Indices of the current loop that have not been processed yet
+	uint32                      generation; // Bumped for every loop so sleeping workers can tell there is new work, guarded by mutex
+	bool                        quit;
+};
+
+static struct Job_System jobs;
+
+static int  job_system_worker(void* param);
+static bool job_range_take(int deque_index, struct Job_Range* out_range);
+static void job_range_run(int deque_index, struct Job_Range* range);
+static void job_deque_lock(struct Job_Deque* deque);
+static void job_deque_unlock(struct Job_Deque* deque);
+static bool job_deque_push(struct Job_Deque* deque, const struct Job_Range* range);
+static bool job_deque_pop(struct Job_Deque* deque, struct Job_Range* out_range);
+static bool job_deque_steal(struct Job_Deque* deque, struct Job_Range* out_range);
+
+void job_system_init(int num_workers, const struct Job_System_Threading* threading, Job_Worker_Init_Func worker_init)
+{
+	memset(&jobs.threading, 0, sizeof(jobs.threading));
+	if(!threading) num_workers = 0;
+	if(num_workers < 0)
+	{
+		// The main thread works on loops as well so it gets a core of its own
+		num_workers = threading->cpu_count_get() - 1;
+		if(num_workers < 0) num_workers = 0;
+	}
+	if(num_workers > MAX_JOB_WORKERS) num_workers = MAX_JOB_WORKERS;
+
+	jobs.num_workers = 0;
+	jobs.worker_init = worker_init;
+	jobs.remaining   = 0;
+	jobs.generation  = 0;
+	jobs.quit        = false;
+	for(int i = 0; i <= MAX_JOB_WORKERS; i++)
+	{
+		jobs.deques[i].top    = 0;
+		jobs.deques[i].bottom = 0;
+		jobs.deques[i].lock   = 0;
+	}
+	if(num_workers == 0) return;
+
+	jobs.threading      = *threading;
+	jobs.mutex          = jobs.threading.mutex_create();
+	jobs.work_available = jobs.threading.condition_create();
+	jobs.work_done      = jobs.threading.condition_create();
+	if(!jobs.mutex || !jobs.work_available || !jobs.work_done)
+	{
+		log_error("job_system:init", "Failed to create synchronization objects, jobs will run on the main thread");
+		return;
+	}
+
+	for(int i = 0; i < num_workers; i++)
+	{
+		char thread_name[32];
+		snprintf(thread_name, sizeof(thread_name), "Job_Worker_%d", i);
+		struct Thread* thread = jobs.threading.thread_create(&job_system_worker, thread_name, (void*)(intptr_t)(i + 1));
+		if(!thread) break;
+		jobs.threads[jobs.num_workers++] = thread;
+	}
+	log_message("Job system started with %d workers", jobs.num_workers);
+}
+
+void job_system_cleanup(void)
+{
+	if(jobs.num_workers > 0)
+	{
+		jobs.threading.mutex_lock(jobs.mutex);
+		jobs.quit = true;
+		jobs.threading.condition_broadcast(jobs.work_available);
+		jobs.threading.mutex_unlock(jobs.mutex);
+
+		for(int i = 0; i < jobs.num_workers; i++)
+			jobs.threading.thread_wait(jobs.threads[i]);
+	}
+
+	jobs.num_workers = 0;
+	if(jobs.threading.mutex_destroy)
+	{
+		jobs.threading.condition_destroy(jobs.work_done);
+		jobs.threading.condition_destroy(jobs.work_available);
+		jobs.threading.mutex_destroy(jobs.mutex);
+	}
+	jobs.work_done      = NULL;
+	jobs.work_available = NULL;
+	jobs.mutex          = NULL;
+}
+
+int job_system_worker_count_get(void)
+{
+	return jobs.num_workers;
+}
+
+void job_system_parallel_for(Job_Func func, void* data, int count, int batch_size)
+{
+	assert(func);
+	if(count <= 0) return;
+	if(batch_size < 1) batch_size = 1;
+
+	if(jobs.num_workers == 0 || count <= batch_size)
+	{
+		func(data, 0, count);
+		return;
+	}
+
+	// Everything written here is published to the workers by the deque lock or the mutex
+	jobs.func       = func;
+	jobs.data       = data;
+	jobs.batch_size = batch_size;
+	atomic_uint32_store(&jobs.remaining, (uint32)count);
+
+	struct Job_Range range = { 0, count };
+	job_deque_lock(&jobs.deques[0]);
+	job_deque_push(&jobs.deques[0], &range);
+	job_deque_unlock(&jobs.deques[0]);
+
+	jobs.threading.mutex_lock(jobs.mutex);
+	jobs.generation++;
+	jobs.threading.condition_broadcast(jobs.work_available);
+	jobs.threading.mutex_unlock(jobs.mutex);
+
+	while(job_range_take(0, &range))
+		job_range_run(0, &range);
+
+	// Nothing left to take but workers may still be busy with ranges they took earlier
+	jobs.threading.mutex_lock(jobs.mutex);
+	while(atomic_uint32_load(&jobs.remaining) > 0)
+		jobs.threading.condition_wait(jobs.work_done, jobs.mutex);
+	jobs.threading.mutex_unlock(jobs.mutex);
+}
+
+static int job_system_worker(void* param)
+{
+	int deque_index = (int)(intptr_t)param;
+	if(jobs.worker_init) jobs.worker_init(deque_index - 1);
+
+	uint32 seen_generation = 0;
+	while(true)
+	{
+		// Sleeping comes first so the worker count set up in init is visible before any deques are touched
+		jobs.threading.mutex_lock(jobs.mutex);
+		while(!jobs.quit && jobs.generation == seen_generation)
+			jobs.threading.condition_wait(jobs.work_available, jobs.mutex);
+		seen_generation = jobs.generation;
+		bool quit = jobs.quit;
+		jobs.threading.mutex_unlock(jobs.mutex);
+		if(quit) break;
+
+		int num_retries = 0;
+		while(true)
+		{
+			struct Job_Range range;
+			if(job_range_take(deque_index, &range))
+			{
+				job_range_run(deque_index, &range);
+				num_retries = 0;
+				continue;
+			}
+
+			// Ranges that are still running may be split further so keep looking for a while
+			if(atomic_uint32_load(&jobs.remaining) > 0 && ++num_retries < MAX_JOB_STEAL_RETRIES)
+				continue;
+			break;
+		}
+	}
+	return 0;
+}
+
+static bool job_range_take(int deque_index, struct Job_Range* out_range)
+{
+	struct Job_Deque* deque = &jobs.deques[deque_index];
+	job_deque_lock(deque);
+	bool found = job_deque_pop(deque, out_range);
+	job_deque_unlock(deque);
+
+	// Start with the next deque over so thieves spread out instead of all hitting the main thread
+	int num_deques = jobs.num_workers + 1;
+	for(int i = 1; i < num_deques && !found; i++)
+	{
+		struct Job_Deque* victim = &jobs.deques[(deque_index + i) % num_deques];
+		job_deque_lock(victim);
+		found = job_deque_steal(victim, out_range);
+		job_deque_unlock(victim);
+	}
+	if(!found) return false;
+
+	// Keep the lower half and leave the upper half for others until the range is small enough to run
+	job_deque_lock(deque);
+	while(out_range->end - out_range->start > jobs.batch_size)
+	{
+		int middle = out_range->start + (out_range->end - out_range->start) / 2;
+		struct Job_Range upper = { middle, out_range->end };
+		if(!job_deque_push(deque, &upper)) break;
+		out_range->end = middle;
+	}
+	job_deque_unlock(deque);
+	return true;
+}
+
+static void job_range_run(int deque_index, struct Job_Range* range)
+{
+	jobs.func(jobs.data, range->start, range->end);
+
+	uint32 num_processed = (uint32)(range->end - range->start);
+	if(atomic_uint32_add(&jobs.remaining, (uint32)0 - num_processed) == 0 && deque_index != 0)
+	{
+		jobs.threading.mutex_lock(jobs.mutex);
+		jobs.threading.condition_signal(jobs.work_done);
+		jobs.threading.mutex_unlock(jobs.mutex);
+	}
+}
+
+static void job_deque_lock(struct Job_Deque* deque)
+{
+	while(atomic_uint32_exchange(&deque->lock, 1) != 0) {}
+}
+
+static void job_deque_unlock(struct Job_Deque* deque)
+{
+	atomic_uint32_store(&deque->lock, 0);
+}
+
+static bool job_deque_push(struct Job_Deque* deque, const struct Job_Range* range)
+{
+	if(deque->bottom == MAX_JOB_DEQUE_RANGES)
+	{
+		if(deque->top == 0) return false;
+
+		// Slide the remaining ranges down to make room, thieves only ever move top forward
+		int num_ranges = deque->bottom - deque->top;
+		for(int i = 0; i < num_ranges; i++)
+			deque->ranges[i] = deque->ranges[deque->top + i];
+		deque->top    = 0;
+		deque->bottom = num_ranges;
+	}
+	deque->ranges[deque->bottom++] = *range;
+	return true;
+}
+
+static bool job_deque_pop(struct Job_Deque* deque, struct Job_Range* out_range)
+{
+	if(deque->bottom == deque->top) return false;
+
+	*out_range = deque->ranges[--deque->bottom];
+	if(deque->bottom == deque->top)
+		deque->top = deque->bottom = 0;
+	return true;
+}
+
+static bool job_deque_steal(struct Job_Deque* deque, struct Job_Range* out_range)
+{
+	if(deque->bottom == deque->top) return false;
+
+	*out_range = deque->ranges[deque->top++];
+	if(deque->bottom == deque->top)
+		deque->top = deque->bottom = 0;
+	return true;
+}
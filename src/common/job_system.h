@@ -0,0 +1,44 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+/* Work stealing job system for data parallel loops. Every thread, the main thread included,
+   owns a deque of index ranges. Ranges bigger than the batch size are split in half when
+   they are taken and the upper half is left in the deque for idle threads to steal, oldest
+   and therefore biggest first. Job functions run concurrently on any thread so they must only
+   write to data owned by the indices they were given and must not touch gl, the log, events,
+   transforms or other engine state. Side effects should be written to a result per index and
+   applied on the main thread afterwards in index order, that way the outcome does not depend
+   on how many workers there are or which of them ran a range */
+
+typedef void (*Job_Func)(void* data, int start, int end); // Processes indices from start up to but not including end
+typedef void (*Job_Worker_Init_Func)(int worker_index);  // Runs on a worker thread before it takes any work, e.g. to name the thread in a profiler
+
+struct Thread;
+struct Mutex;
+struct Condition;
+
+/* Threads and synchronization the job system runs on. Passed in by whoever starts the job
+   system so common code does not depend on the platform layer, the platform_* functions of
+   the same names fit every member */
+struct Job_System_Threading
+{
+	int               (*cpu_count_get)(void);
+	struct Thread*    (*thread_create)(int (*func)(void* param), const char* name, void* param);
+	void              (*thread_wait)(struct Thread* thread);
+	struct Mutex*     (*mutex_create)(void);
+	void              (*mutex_destroy)(struct Mutex* mutex);
+	void              (*mutex_lock)(struct Mutex* mutex);
+	void              (*mutex_unlock)(struct Mutex* mutex);
+	struct Condition* (*condition_create)(void);
+	void              (*condition_destroy)(struct Condition* condition);
+	void              (*condition_wait)(struct Condition* condition, struct Mutex* mutex);
+	void              (*condition_signal)(struct Condition* condition);
+	void              (*condition_broadcast)(struct Condition* condition);
+};
+
+void job_system_init(int num_workers, const struct Job_System_Threading* threading, Job_Worker_Init_Func worker_init); // Passing a negative number picks a worker count based on the number of cpus, 0 or a NULL threading runs every job on the main thread. worker_init may be NULL
+void job_system_cleanup(void);
+int  job_system_worker_count_get(void);
+void job_system_parallel_for(Job_Func func, void* data, int count, int batch_size); // Main thread only, returns once every index has been processed
+
+#endif
@@ -5,19 +5,12 @@
 
 #define MAX_FILENAME_LEN 128
 
-#define MAX_EVENTS 128
-#define MAX_EVENT_SUBSCRIPTIONS 2048
+#define MAX_QUEUED_EVENTS 512 // Per delivery queue, must be a power of two
 
-#define MAX_SCENE_ENTITIES          32
-#define MAX_SCENE_LIGHTS            30
+#define MAX_SCENE_LIGHTS            1024 // Lights sent to the shaders each frame, the scene itself can hold any number
 #define MAX_SCENE_CAMERAS           2
-#define MAX_SCENE_STATIC_MESHES     1024
-#define MAX_SCENE_SOUND_SOURCES     128
 #define MAX_SCENE_ENTITY_ARCHETYPES 32
-#define MAX_SCENE_ENEMIES           64
-#define MAX_SCENE_TRIGGERS          256
-#define MAX_SCENE_DOORS             256
-#define MAX_SCENE_PICKUPS           32
+#define SCENE_POOL_BLOCK_CAPACITY   64 // Entity pools grow by this many objects at a time
 
 #define MAX_UNIFORM_NAME_LEN 64
 
@@ -25,6 +18,9 @@
 
 #define MAX_FRAME_TIME 0.5f
 
+#define FRAME_ARENA_CAPACITY   (1024 * 1024)
+#define SCRATCH_ARENA_CAPACITY (1024 * 1024)
+
 #define MAX_ENEMY_SOUND_SOURCES 2
 #define MAX_ENEMY_MESHES 2
 #define MAX_ENEMY_LIGHTS 1
@@ -38,7 +34,6 @@
 #define MAX_DEBUG_VARS_PER_FRAME_NUMERIC  64
 #define MAX_DEBUG_VARS_PER_FRAME_TEXTURES 8
 
-#define HASH_MAP_NUM_BUCKETS 10
 #define MAX_HASH_KEY_LEN     64
 
 #define MAX_PLAYER_HEALTH 100
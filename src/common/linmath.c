@@ -3,6 +3,17 @@
 #include <math.h>
 #include <string.h>
 
+/* mat4_mul, mat4_inverse, mat4_from_quat, mat4_from_trs and quat_mul_vec3 use SSE when the
+   compiler targets it, the scalar code is kept as the fallback and as the reference the SSE
+   paths must match.
+   Defining LINMATH_NO_SSE builds the scalar code even when SSE is available, the
+   Linmath_Test targets use that to check one against the other.
+   quat_mul stays scalar since the compiler already does as well with it */
+#if !defined(LINMATH_NO_SSE) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+	#define LINMATH_SSE
+	#include <xmmintrin.h>
+#endif
+
 
 const vec3 UNIT_X = { 1, 0, 0 };
 const vec3 UNIT_Y = { 0, 1, 0 };
@@ -357,8 +368,37 @@ void mat4_identity(mat4* res)
 	res->mat[0] = res->mat[5] = res->mat[10] = res->mat[15] = 1.0f;
 }
 
+#if defined(LINMATH_SSE)
+// Broadcasting from a loaded register avoids four scalar loads per column
+static inline __m128 mat4_mul_column_sse(__m128 col0, __m128 col1, __m128 col2, __m128 col3, __m128 weights)
+{
+	__m128 sum01 = _mm_add_ps(_mm_mul_ps(col0, _mm_shuffle_ps(weights, weights, 0x00)),
+							  _mm_mul_ps(col1, _mm_shuffle_ps(weights, weights, 0x55)));
+	__m128 sum23 = _mm_add_ps(_mm_mul_ps(col2, _mm_shuffle_ps(weights, weights, 0xAA)),
+							  _mm_mul_ps(col3, _mm_shuffle_ps(weights, weights, 0xFF)));
+	return _mm_add_ps(sum01, sum23);
+}
+#endif
+
 void mat4_mul(mat4* res, const mat4* mat1, const mat4* mat2)
 {
+#if defined(LINMATH_SSE)
+	/* Each result column is the columns of mat1 weighted by a column of mat2, all four are
+	   computed before storing so res may alias either input */
+	const float *m1 = mat1->mat, *m2 = mat2->mat;
+	__m128 col0 = _mm_loadu_ps(&m1[0]);
+	__m128 col1 = _mm_loadu_ps(&m1[4]);
+	__m128 col2 = _mm_loadu_ps(&m1[8]);
+	__m128 col3 = _mm_loadu_ps(&m1[12]);
+	__m128 result0 = mat4_mul_column_sse(col0, col1, col2, col3, _mm_loadu_ps(&m2[0]));
+	__m128 result1 = mat4_mul_column_sse(col0, col1, col2, col3, _mm_loadu_ps(&m2[4]));
+	__m128 result2 = mat4_mul_column_sse(col0, col1, col2, col3, _mm_loadu_ps(&m2[8]));
+	__m128 result3 = mat4_mul_column_sse(col0, col1, col2, col3, _mm_loadu_ps(&m2[12]));
+	_mm_storeu_ps(&res->mat[0],  result0);
+	_mm_storeu_ps(&res->mat[4],  result1);
+	_mm_storeu_ps(&res->mat[8],  result2);
+	_mm_storeu_ps(&res->mat[12], result3);
+#else
 	float mat[16];
 	const float *m1 = mat1->mat, *m2 = mat2->mat;
 
@@ -383,6 +423,7 @@ void mat4_mul(mat4* res, const mat4* mat1, const mat4* mat2)
 	mat[15] = m1[3] * m2[12] + m1[7] * m2[13] + m1[11] * m2[14] + m1[15] * m2[15];
 
 	memcpy(res->mat, mat, sizeof(float) * 16);
+#endif
 }
 
 void mat4_translate(mat4* res, float x, float y, float z)
@@ -479,8 +520,40 @@ void mat4_scale(mat4* res, float x, float y, float z)
 	res->mat[15] = 1.0f;
 }
 
+#if defined(LINMATH_SSE)
+/* Rotation columns of a unit quaternion with a zero last lane. The squares, the cross terms
+   and the w terms are each one multiply, the columns are assembled from them with shuffles */
+static inline void mat4_rotation_columns_sse(const quat* q, __m128* col0, __m128* col1, __m128* col2)
+{
+	__m128 qvec     = _mm_set_ps(0.f, q->z, q->y, q->x);
+	__m128 qvec2    = _mm_add_ps(qvec, qvec);
+	__m128 squares  = _mm_mul_ps(qvec, qvec2);                                                // 2xx 2yy 2zz 0
+	__m128 crosses  = _mm_mul_ps(qvec, _mm_shuffle_ps(qvec2, qvec2, _MM_SHUFFLE(3, 0, 2, 1))); // 2xy 2yz 2zx 0
+	__m128 w_terms  = _mm_mul_ps(qvec2, _mm_set1_ps(q->w));                                   // 2xw 2yw 2zw 0
+	w_terms         = _mm_shuffle_ps(w_terms, w_terms, _MM_SHUFFLE(3, 1, 0, 2));              // 2zw 2xw 2yw 0
+	__m128 sums     = _mm_add_ps(crosses, w_terms);
+	__m128 diffs    = _mm_sub_ps(crosses, w_terms);
+	__m128 diagonal = _mm_sub_ps(_mm_set_ps(0.f, 1.f, 1.f, 1.f),
+								 _mm_add_ps(_mm_shuffle_ps(squares, squares, _MM_SHUFFLE(3, 0, 0, 1)),
+											_mm_shuffle_ps(squares, squares, _MM_SHUFFLE(3, 1, 2, 2))));
+
+	// col0 = diagonal.x sums.x diffs.z, col1 = diffs.x diagonal.y sums.y, col2 = sums.z diffs.y diagonal.z
+	*col0 = _mm_shuffle_ps(_mm_shuffle_ps(diagonal, sums, _MM_SHUFFLE(0, 0, 0, 0)), diffs, _MM_SHUFFLE(3, 2, 2, 0));
+	*col1 = _mm_shuffle_ps(_mm_shuffle_ps(diffs, diagonal, _MM_SHUFFLE(1, 1, 0, 0)), sums, _MM_SHUFFLE(3, 1, 2, 0));
+	*col2 = _mm_shuffle_ps(_mm_shuffle_ps(sums, diffs, _MM_SHUFFLE(1, 1, 2, 2)), diagonal, _MM_SHUFFLE(3, 2, 2, 0));
+}
+#endif
+
 void mat4_from_quat(mat4* res, const quat* q)
 {
+#if defined(LINMATH_SSE)
+	__m128 col0, col1, col2;
+	mat4_rotation_columns_sse(q, &col0, &col1, &col2);
+	_mm_storeu_ps(&res->mat[0],  col0);
+	_mm_storeu_ps(&res->mat[4],  col1);
+	_mm_storeu_ps(&res->mat[8],  col2);
+	_mm_storeu_ps(&res->mat[12], _mm_set_ps(1.f, 0.f, 0.f, 0.f));
+#else
 	float xx = q->x * q->x;
 	float xy = q->x * q->y;
 	float xz = q->x * q->z;
@@ -512,6 +585,55 @@ void mat4_from_quat(mat4* res, const quat* q)
 	res->mat[13] = 0.0;
 	res->mat[14] = 0.0;
 	res->mat[15] = 1.0;
+#endif
+}
+
+void mat4_from_trs(mat4* res, const vec3* translation, const quat* rotation, const vec3* scale)
+{
+#if defined(LINMATH_SSE)
+	/* Rotation columns scaled by the per axis scale, translation in the last column */
+	__m128 col0, col1, col2;
+	mat4_rotation_columns_sse(rotation, &col0, &col1, &col2);
+	__m128 col3 = _mm_set_ps(1.f, translation->z, translation->y, translation->x);
+	_mm_storeu_ps(&res->mat[0],  _mm_mul_ps(col0, _mm_set1_ps(scale->x)));
+	_mm_storeu_ps(&res->mat[4],  _mm_mul_ps(col1, _mm_set1_ps(scale->y)));
+	_mm_storeu_ps(&res->mat[8],  _mm_mul_ps(col2, _mm_set1_ps(scale->z)));
+	_mm_storeu_ps(&res->mat[12], col3);
+#else
+	const quat* q = rotation;
+	float xx = q->x * q->x;
+	float xy = q->x * q->y;
+	float xz = q->x * q->z;
+	float xw = q->x * q->w;
+
+	float yy = q->y * q->y;
+	float yz = q->y * q->z;
+	float yw = q->y * q->w;
+
+	float zz = q->z * q->z;
+	float zw = q->z * q->w;
+
+	/* Rotation columns scaled by the per axis scale, translation in the last column */
+	res->mat[0]  = (1 - 2 * (yy + zz)) * scale->x;
+	res->mat[1]  = (2 * (xy + zw)) * scale->x;
+	res->mat[2]  = (2 * (xz - yw)) * scale->x;
+	res->mat[3]  = 0.f;
+
+	res->mat[4]  = (2 * (xy - zw)) * scale->y;
+	res->mat[5]  = (1 - 2 * (xx + zz)) * scale->y;
+	res->mat[6]  = (2 * (yz + xw)) * scale->y;
+	res->mat[7]  = 0.f;
+
+	res->mat[8]  = (2 * (xz + yw)) * scale->z;
+	res->mat[9]  = (2 * (yz - xw)) * scale->z;
+	res->mat[10] = (1 - 2 * (xx + yy)) * scale->z;
+	res->mat[11] = 0.f;
+
+	res->mat[12] = translation->x;
+	res->mat[13] = translation->y;
+	res->mat[14] = translation->z;
+	res->mat[15] = 1.f;
+#endif
 }
 
 void mat4_rot_x(mat4* res, const float angle)
@@ -596,6 +718,93 @@ void mat4_assign(mat4* res, const mat4* m)
 
 void mat4_inverse(mat4* res, mat4* mat)
 {
+#if defined(LINMATH_SSE)
+	/* Cramer's rule on four lanes at a time, based on Intel's "Streaming SIMD Extensions -
+	   Inverse of 4x4 Matrix". The loads transpose the matrix which gives the transposed
+	   inverse, that is the inverse again once stored back in column major order */
+	const float* src = mat->mat;
+	__m128 minor0, minor1, minor2, minor3;
+	__m128 row0, row1, row2, row3;
+	__m128 det, tmp1;
+
+	tmp1 = _mm_setzero_ps();
+	row1 = _mm_setzero_ps();
+	row3 = _mm_setzero_ps();
+	tmp1 = _mm_loadh_pi(_mm_loadl_pi(tmp1, (const __m64*)(src)),     (const __m64*)(src + 4));
+	row1 = _mm_loadh_pi(_mm_loadl_pi(row1, (const __m64*)(src + 8)), (const __m64*)(src + 12));
+	row0 = _mm_shuffle_ps(tmp1, row1, 0x88);
+	row1 = _mm_shuffle_ps(row1, tmp1, 0xDD);
+	tmp1 = _mm_loadh_pi(_mm_loadl_pi(tmp1, (const __m64*)(src + 2)),  (const __m64*)(src + 6));
+	row3 = _mm_loadh_pi(_mm_loadl_pi(row3, (const __m64*)(src + 10)), (const __m64*)(src + 14));
+	row2 = _mm_shuffle_ps(tmp1, row3, 0x88);
+	row3 = _mm_shuffle_ps(row3, tmp1, 0xDD);
+
+	tmp1   = _mm_mul_ps(row2, row3);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor0 = _mm_mul_ps(row1, tmp1);
+	minor1 = _mm_mul_ps(row0, tmp1);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp1), minor0);
+	minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor1);
+	minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+	tmp1   = _mm_mul_ps(row1, row2);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor0);
+	minor3 = _mm_mul_ps(row0, tmp1);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp1));
+	minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor3);
+	minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+	tmp1   = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	row2   = _mm_shuffle_ps(row2, row2, 0x4E);
+	minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor0);
+	minor2 = _mm_mul_ps(row0, tmp1);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp1));
+	minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor2);
+	minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+	tmp1   = _mm_mul_ps(row0, row1);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor2);
+	minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp1), minor3);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp1), minor2);
+	minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp1));
+
+	tmp1   = _mm_mul_ps(row0, row3);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp1));
+	minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor2);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor1);
+	minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp1));
+
+	tmp1   = _mm_mul_ps(row0, row2);
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor1);
+	minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp1));
+	tmp1   = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp1));
+	minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor3);
+
+	det = _mm_mul_ps(row0, minor0);
+	det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+	det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+	if(_mm_cvtss_f32(det) == 0.f)
+		return;
+
+	// A full division rather than the reciprocal estimate keeps results in line with the scalar path
+	det = _mm_div_ss(_mm_set_ss(1.f), det);
+	det = _mm_shuffle_ps(det, det, 0x00);
+	_mm_storeu_ps(&res->mat[0],  _mm_mul_ps(det, minor0));
+	_mm_storeu_ps(&res->mat[4],  _mm_mul_ps(det, minor1));
+	_mm_storeu_ps(&res->mat[8],  _mm_mul_ps(det, minor2));
+	_mm_storeu_ps(&res->mat[12], _mm_mul_ps(det, minor3));
+#else
 	mat4 tmp;
 	float det;
 	int i;
@@ -723,6 +932,7 @@ void mat4_inverse(mat4* res, mat4* mat)
 	for(i = 0; i < 16; i++) {
 		res->mat[i] = tmp.mat[i] * det;
 	}
+#endif
 }
 
 
@@ -746,6 +956,24 @@ void quat_identity(quat* res)
 
 void quat_mul_vec3(vec3* res, const quat* q, const vec3* v)
 {
+#if defined(LINMATH_SSE)
+	/* v + 2w(q x v) + 2(q x (q x v)), the crosses are done with yzx/zxy shuffles */
+	__m128 qvec  = _mm_set_ps(0.f, q->z, q->y, q->x);
+	__m128 vec   = _mm_set_ps(0.f, v->z, v->y, v->x);
+	__m128 q_yzx = _mm_shuffle_ps(qvec, qvec, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 q_zxy = _mm_shuffle_ps(qvec, qvec, _MM_SHUFFLE(3, 1, 0, 2));
+	__m128 uv    = _mm_sub_ps(_mm_mul_ps(q_yzx, _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(3, 1, 0, 2))),
+							  _mm_mul_ps(q_zxy, _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(3, 0, 2, 1))));
+	__m128 uuv   = _mm_sub_ps(_mm_mul_ps(q_yzx, _mm_shuffle_ps(uv, uv, _MM_SHUFFLE(3, 1, 0, 2))),
+							  _mm_mul_ps(q_zxy, _mm_shuffle_ps(uv, uv, _MM_SHUFFLE(3, 0, 2, 1))));
+	uv  = _mm_mul_ps(uv, _mm_set1_ps(2.f * q->w));
+	uuv = _mm_mul_ps(uuv, _mm_set1_ps(2.f));
+	float result[4];
+	_mm_storeu_ps(result, _mm_add_ps(_mm_add_ps(vec, uv), uuv));
+	res->x = result[0];
+	res->y = result[1];
+	res->z = result[2];
+#else
 	vec3 uv, uuv, qvec;
 	qvec.x = q->x;
 	qvec.y = q->y;
@@ -759,6 +987,7 @@ void quat_mul_vec3(vec3* res, const quat* q, const vec3* v)
 
 	vec3_add(res, v, &uv);
 	vec3_add(res, res, &uuv);
+#endif
 }
 
 void quat_assign(quat* res, const quat* val)
@@ -114,6 +114,7 @@ void mat4_rot_z(mat4* res, float angle);
 void mat4_rot_y(mat4* res, float angle);
 void mat4_rot_x(mat4* res, const float angle);
 void mat4_from_quat(mat4* res, const quat* q);
+void mat4_from_trs(mat4* res, const vec3* translation, const quat* rotation, const vec3* scale); // Same as translation * rotation * scale
 void mat4_scale(mat4* res, float x, float y, float z);
 void mat4_ortho(mat4* res,
 				float left,   float right,
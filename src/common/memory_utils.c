@@ -1,83 +1,458 @@
-#include "memory_utils.h"
-#include "log.h"
-
-#include <stdlib.h>
-
-static struct Memory memory = { .allocated = 0, .freed = 0 };
-
-struct Memory_Allocation* memory_get_allocation_ptr(void* memory_block)
-{
-	return (struct Memory_Allocation*)((unsigned char*) memory_block - offsetof(struct Memory_Allocation, allocation));
-}
-
-void* memory_allocate(size_t size)
-{
-	struct Memory_Allocation* allocation = malloc(sizeof(*allocation) + size);
-	if(!allocation)
-	{
-		log_raw("MEMORY: Failed to allocate memory of size %d", size);
-	}
-	else
-	{
-		allocation->size = size;
-		//memory->allocated += size;
-		memory.allocated += size + sizeof(*allocation);
-	}
-	return allocation ? allocation->allocation : NULL;
-}
-
-void* memory_reallocate_(void** ptr, size_t size)
-{
-	if(ptr != NULL && *ptr == NULL) // Behave like malloc
-	{
-		return memory_allocate(size);
-	}
-
-	struct Memory_Allocation* current_allocation = memory_get_allocation_ptr(*ptr);
-	int current_allocation_size = current_allocation->size;
-	void* reallocated_memory = realloc(current_allocation, sizeof(*current_allocation) + size);
-	if(!reallocated_memory)
-	{
-		log_raw("MEMORY: Failed to reallocated memory of size %d", size);
-	}
-	else
-	{
-		memory.allocated += (size - current_allocation_size);
-		struct Memory_Allocation* new_allocation = (struct Memory_Allocation*)reallocated_memory;
-		new_allocation->size = size;
-		current_allocation = reallocated_memory;
-	}
-
-	return current_allocation->allocation;
-}
-
-void* memory_allocate_and_clear(size_t count, size_t size)
-{
-	struct Memory_Allocation* allocation = calloc(count, sizeof(*allocation) + size);
-	if(!allocation)
-	{
-		log_raw("MEMORY: Failed to allocate memory of size %d", size);
-	}
-	else
-	{
-		allocation->size = size;
-		//memory->allocated += size;
-		memory.allocated += size + sizeof(*allocation);
-	}
-	return allocation ? allocation->allocation : NULL;
-}
-
-void memory_free(void* ptr)
-{
-	if(!ptr) return;
-	struct Memory_Allocation* allocation = memory_get_allocation_ptr(ptr);
-	//memory->allocated -= allocation->size;
-	memory.allocated -= allocation->size + sizeof(*allocation);
-	memory.freed += allocation->size + sizeof(*allocation);
-	free(allocation);
-}
-
-struct Memory* memory_get(void)
-{
-	return &memory;
-}
+#include "memory_utils.h"
+#include "log.h"
+#include "atomics.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#define MAX_MEMORY_LEAK_SITES 256
+
+struct Memory_Arena_Block
+{
+	struct Memory_Arena_Block* next;
+	size_t                     size;
+};
+
+static struct Memory       memory;
+static struct Memory_Arena frame_arena;
+static struct Memory_Arena scratch_arena;
+static const char*         tag_names[MT_MAX] =
+{
+	"general",
+	"geometry",
+	"texture",
+	"parser",
+	"hashmap",
+	"array",
+	"sound",
+	"gui",
+	"editor"
+};
+
+#ifdef DEBUG
+static struct Memory_Allocation* live_allocations = NULL; // Most recent first
+static volatile uint32           live_allocations_lock = 0;
+#endif
+
+static void           memory_atomic_max(size_t* value, size_t candidate);
+static void           memory_track_allocation(struct Memory_Allocation* allocation);
+static void           memory_track_free(struct Memory_Allocation* allocation);
+#ifdef DEBUG
+static void           memory_live_list_lock(void);
+static void           memory_live_list_unlock(void);
+static void           memory_live_list_add(struct Memory_Allocation* allocation);
+static void           memory_live_list_remove(struct Memory_Allocation* allocation);
+#endif
+static size_t         memory_arena_align(size_t size);
+static unsigned char* memory_arena_align_ptr(void* ptr);
+static void           memory_arena_overflow_release(struct Memory_Arena* arena, struct Memory_Arena_Block* until);
+
+static struct Memory_Allocation* memory_get_allocation_ptr(void* memory_block)
+{
+	return (struct Memory_Allocation*)((unsigned char*) memory_block - offsetof(struct Memory_Allocation, allocation));
+}
+
+void* memory_allocate_tracked(size_t size, int tag, const char* file, int line)
+{
+	struct Memory_Allocation* allocation = malloc(sizeof(*allocation) + size);
+	if(!allocation)
+	{
+		log_raw("MEMORY: Failed to allocate memory of size %d", size);
+	}
+	else
+	{
+		allocation->size = size;
+		allocation->tag  = tag;
+		allocation->line = line;
+#ifdef DEBUG
+		allocation->file = file;
+#else
+		(void)file;
+#endif
+		memory_track_allocation(allocation);
+	}
+	return allocation ? allocation->allocation : NULL;
+}
+
+void* memory_reallocate_tracked(void** ptr, size_t size, int tag, const char* file, int line)
+{
+	if(ptr != NULL && *ptr == NULL) // Behave like malloc
+	{
+		return memory_allocate_tracked(size, tag, file, line);
+	}
+
+	struct Memory_Allocation* current_allocation = memory_get_allocation_ptr(*ptr);
+#ifdef DEBUG
+	// The block may move so take it out of the live list until realloc is done with it
+	memory_live_list_remove(current_allocation);
+#endif
+	memory_track_free(current_allocation);
+	void* reallocated_memory = realloc(current_allocation, sizeof(*current_allocation) + size);
+	if(!reallocated_memory)
+	{
+		log_raw("MEMORY: Failed to reallocated memory of size %d", size);
+	}
+	else
+	{
+		struct Memory_Allocation* new_allocation = (struct Memory_Allocation*)reallocated_memory;
+		new_allocation->size = size;
+		current_allocation = reallocated_memory;
+	}
+	memory_track_allocation(current_allocation);
+
+	return current_allocation->allocation;
+}
+
+void* memory_allocate_and_clear_tracked(size_t count, size_t size, int tag, const char* file, int line)
+{
+	struct Memory_Allocation* allocation = calloc(count, sizeof(*allocation) + size);
+	if(!allocation)
+	{
+		log_raw("MEMORY: Failed to allocate memory of size %d", size);
+	}
+	else
+	{
+		allocation->size = size;
+		allocation->tag  = tag;
+		allocation->line = line;
+#ifdef DEBUG
+		allocation->file = file;
+#else
+		(void)file;
+#endif
+		memory_track_allocation(allocation);
+	}
+	return allocation ? allocation->allocation : NULL;
+}
+
+void memory_free(void* ptr)
+{
+	if(!ptr) return;
+	struct Memory_Allocation* allocation = memory_get_allocation_ptr(ptr);
+#ifdef DEBUG
+	memory_live_list_remove(allocation);
+#endif
+	memory_track_free(allocation);
+	atomic_size_add(&memory.freed, allocation->size + sizeof(*allocation));
+	free(allocation);
+}
+
+struct Memory* memory_get(void)
+{
+	return &memory;
+}
+
+const char* memory_tag_name_get(int tag)
+{
+	return tag >= 0 && tag < MT_MAX ? tag_names[tag] : "invalid";
+}
+
+void memory_budget_set(int tag, size_t budget)
+{
+	assert(tag >= 0 && tag < MT_MAX);
+	memory.tags[tag].budget      = budget;
+	memory.tags[tag].over_budget = false;
+}
+
+void memory_budgets_check(void)
+{
+	for(int i = 0; i < MT_MAX; i++)
+	{
+		struct Memory_Tag_Stats* stats = &memory.tags[i];
+		if(stats->budget == 0) continue;
+
+		bool over_budget = stats->allocated > stats->budget;
+		if(over_budget && !stats->over_budget)
+			log_warning("Memory budget for '%s' exceeded, %.2f MB in use with a budget of %.2f MB",
+						tag_names[i], (double)stats->allocated / (1024.0 * 1024.0), (double)stats->budget / (1024.0 * 1024.0));
+		stats->over_budget = over_budget;
+	}
+}
+
+void memory_report_log(void)
+{
+	log_message("%-10s %12s %12s %10s %12s %12s", "Tag", "Live KB", "Peak KB", "Live", "Allocations", "Budget KB");
+	for(int i = 0; i < MT_MAX; i++)
+	{
+		struct Memory_Tag_Stats* stats = &memory.tags[i];
+		log_message("%-10s %12.1f %12.1f %10zu %12zu %12.1f%s",
+					tag_names[i],
+					(double)stats->allocated / 1024.0,
+					(double)stats->peak / 1024.0,
+					stats->num_live,
+					stats->num_allocations,
+					(double)stats->budget / 1024.0,
+					stats->over_budget ? " OVER" : "");
+	}
+	log_message("%-10s %12.1f %12.1f %10s %12zu", "total", (double)memory.allocated / 1024.0, (double)memory.peak / 1024.0, "", memory.num_allocations);
+}
+
+void memory_leak_report(void)
+{
+	size_t num_leaked = 0;
+	for(int i = 0; i < MT_MAX; i++)
+		num_leaked += memory.tags[i].num_live;
+
+	if(num_leaked == 0)
+	{
+		log_message("No memory leaks");
+		return;
+	}
+
+	log_warning("%zu allocations still alive at shutdown", num_leaked);
+	for(int i = 0; i < MT_MAX; i++)
+	{
+		struct Memory_Tag_Stats* stats = &memory.tags[i];
+		if(stats->num_live > 0)
+			log_warning("    %-10s %zu allocations, %zu bytes", tag_names[i], stats->num_live, stats->allocated);
+	}
+
+#ifdef DEBUG
+	/* Group by call site, this runs at shutdown so a quadratic search over the
+	   handful of distinct sites is fine. Plain malloc keeps the report out of its own numbers */
+	struct Leak_Site
+	{
+		const char* file;
+		int         line;
+		int         tag;
+		size_t      count;
+		size_t      bytes;
+		size_t      first_sequence;
+	};
+	int num_sites = 0;
+	struct Leak_Site* sites = malloc(sizeof(*sites) * MAX_MEMORY_LEAK_SITES);
+	if(!sites) return;
+
+	memory_live_list_lock();
+	for(struct Memory_Allocation* allocation = live_allocations; allocation; allocation = allocation->next)
+	{
+		struct Leak_Site* site = NULL;
+		for(int i = 0; i < num_sites; i++)
+		{
+			if(sites[i].line == allocation->line && sites[i].tag == allocation->tag && strcmp(sites[i].file, allocation->file) == 0)
+			{
+				site = &sites[i];
+				break;
+			}
+		}
+
+		if(!site)
+		{
+			if(num_sites == MAX_MEMORY_LEAK_SITES) continue;
+			site = &sites[num_sites++];
+			site->file  = allocation->file;
+			site->line  = allocation->line;
+			site->tag   = allocation->tag;
+			site->count = 0;
+			site->bytes = 0;
+		}
+		site->count++;
+		site->bytes += allocation->size;
+		site->first_sequence = allocation->sequence; // List is most recent first so the last one seen is the oldest
+	}
+	memory_live_list_unlock();
+
+	for(int i = 0; i < num_sites; i++)
+		log_warning("    [%s] %s:%d, %zu allocations, %zu bytes, first was allocation #%zu",
+					tag_names[sites[i].tag], sites[i].file, sites[i].line, sites[i].count, sites[i].bytes, sites[i].first_sequence);
+	if(num_sites == MAX_MEMORY_LEAK_SITES)
+		log_warning("    Only the first %d call sites are listed", MAX_MEMORY_LEAK_SITES);
+	free(sites);
+#endif
+}
+
+bool memory_arena_init(struct Memory_Arena* arena, size_t capacity)
+{
+	memset(arena, 0, sizeof(*arena));
+	capacity = memory_arena_align(capacity);
+	if(capacity == 0) return true;
+
+	// Heap allocations are only guaranteed to be pointer aligned so leave room to align the start
+	arena->allocation = memory_allocate(capacity + MEMORY_ARENA_ALIGNMENT);
+	if(!arena->allocation)
+	{
+		log_error("memory:arena_init", "Failed to allocate arena of %zu bytes, every allocation will fall back to the heap", capacity);
+		return false;
+	}
+	arena->buffer   = memory_arena_align_ptr(arena->allocation);
+	arena->capacity = capacity;
+	return true;
+}
+
+void memory_arena_destroy(struct Memory_Arena* arena)
+{
+	memory_arena_overflow_release(arena, NULL);
+	if(arena->allocation) memory_free(arena->allocation);
+	memset(arena, 0, sizeof(*arena));
+}
+
+void* memory_arena_allocate(struct Memory_Arena* arena, size_t size)
+{
+	size = memory_arena_align(size > 0 ? size : 1);
+	if(arena->capacity - arena->used >= size)
+	{
+		void* allocation = arena->buffer + arena->used;
+		arena->used += size;
+		if(arena->used + arena->overflow_used > arena->high_water) arena->high_water = arena->used + arena->overflow_used;
+		return allocation;
+	}
+
+	// Out of space, hand out a heap block that lives until the next reset
+	struct Memory_Arena_Block* block = memory_allocate(sizeof(*block) + MEMORY_ARENA_ALIGNMENT + size);
+	if(!block)
+	{
+		log_error("memory:arena_allocate", "Failed to allocate overflow block of %zu bytes", size);
+		return NULL;
+	}
+	block->size           = size;
+	block->next           = arena->overflow;
+	arena->overflow       = block;
+	arena->overflow_used += size;
+	arena->num_overflows++;
+	if(arena->used + arena->overflow_used > arena->high_water) arena->high_water = arena->used + arena->overflow_used;
+	return memory_arena_align_ptr(block + 1);
+}
+
+void memory_arena_reset(struct Memory_Arena* arena)
+{
+	memory_arena_overflow_release(arena, NULL);
+	arena->used = 0;
+}
+
+struct Memory_Arena_Scope memory_arena_scope_begin(struct Memory_Arena* arena)
+{
+	struct Memory_Arena_Scope scope =
+	{
+		.arena         = arena,
+		.used          = arena->used,
+		.overflow_used = arena->overflow_used,
+		.overflow      = arena->overflow
+	};
+	return scope;
+}
+
+void memory_arena_scope_end(struct Memory_Arena_Scope* scope)
+{
+	struct Memory_Arena* arena = scope->arena;
+	assert(arena->used >= scope->used);
+	memory_arena_overflow_release(arena, scope->overflow);
+	arena->used          = scope->used;
+	arena->overflow_used = scope->overflow_used;
+}
+
+bool memory_arenas_init(size_t frame_arena_capacity, size_t scratch_arena_capacity)
+{
+	bool success = memory_arena_init(&frame_arena, frame_arena_capacity);
+	return memory_arena_init(&scratch_arena, scratch_arena_capacity) && success;
+}
+
+void memory_arenas_cleanup(void)
+{
+	if(frame_arena.num_overflows > 0 || scratch_arena.num_overflows > 0)
+		log_warning("Arena overflows, frame : %d (capacity %zu, high water %zu), scratch : %d (capacity %zu, high water %zu)",
+					frame_arena.num_overflows, frame_arena.capacity, frame_arena.high_water,
+					scratch_arena.num_overflows, scratch_arena.capacity, scratch_arena.high_water);
+	memory_arena_destroy(&frame_arena);
+	memory_arena_destroy(&scratch_arena);
+}
+
+struct Memory_Arena* memory_frame_arena_get(void)
+{
+	return &frame_arena;
+}
+
+struct Memory_Arena* memory_scratch_arena_get(void)
+{
+	return &scratch_arena;
+}
+
+static size_t memory_arena_align(size_t size)
+{
+	return (size + MEMORY_ARENA_ALIGNMENT - 1) & ~((size_t)MEMORY_ARENA_ALIGNMENT - 1);
+}
+
+static unsigned char* memory_arena_align_ptr(void* ptr)
+{
+	return (unsigned char*)(((uintptr_t)ptr + MEMORY_ARENA_ALIGNMENT - 1) & ~((uintptr_t)MEMORY_ARENA_ALIGNMENT - 1));
+}
+
+static void memory_arena_overflow_release(struct Memory_Arena* arena, struct Memory_Arena_Block* until)
+{
+	while(arena->overflow && arena->overflow != until)
+	{
+		struct Memory_Arena_Block* next = arena->overflow->next;
+		arena->overflow_used -= arena->overflow->size;
+		memory_free(arena->overflow);
+		arena->overflow = next;
+	}
+}
+
+static void memory_atomic_max(size_t* value, size_t candidate)
+{
+	size_t current = atomic_size_relaxed_load(value);
+	while(candidate > current)
+	{
+		if(atomic_size_compare_exchange(value, &current, candidate)) break;
+	}
+}
+
+static void memory_track_allocation(struct Memory_Allocation* allocation)
+{
+	assert(allocation->tag >= 0 && allocation->tag < MT_MAX);
+	struct Memory_Tag_Stats* stats = &memory.tags[allocation->tag];
+	size_t total_size = allocation->size + sizeof(*allocation);
+
+	size_t sequence = atomic_size_add(&memory.num_allocations, 1);
+	memory_atomic_max(&memory.peak, atomic_size_add(&memory.allocated, total_size));
+	memory_atomic_max(&stats->peak, atomic_size_add(&stats->allocated, total_size));
+	atomic_size_add(&stats->num_live, 1);
+	atomic_size_add(&stats->num_allocations, 1);
+#ifdef DEBUG
+	allocation->sequence = sequence;
+	memory_live_list_add(allocation);
+#else
+	(void)sequence;
+#endif
+}
+
+static void memory_track_free(struct Memory_Allocation* allocation)
+{
+	struct Memory_Tag_Stats* stats = &memory.tags[allocation->tag];
+	size_t total_size = allocation->size + sizeof(*allocation);
+	atomic_size_add(&memory.allocated, (size_t)0 - total_size);
+	atomic_size_add(&stats->allocated, (size_t)0 - total_size);
+	atomic_size_add(&stats->num_live, (size_t)-1);
+}
+
+#ifdef DEBUG
+static void memory_live_list_lock(void)
+{
+	while(atomic_uint32_exchange(&live_allocations_lock, 1) != 0) {}
+}
+
+static void memory_live_list_unlock(void)
+{
+	atomic_uint32_store(&live_allocations_lock, 0);
+}
+
+static void memory_live_list_add(struct Memory_Allocation* allocation)
+{
+	memory_live_list_lock();
+	allocation->prev = NULL;
+	allocation->next = live_allocations;
+	if(live_allocations) live_allocations->prev = allocation;
+	live_allocations = allocation;
+	memory_live_list_unlock();
+}
+
+static void memory_live_list_remove(struct Memory_Allocation* allocation)
+{
+	memory_live_list_lock();
+	if(allocation->prev) allocation->prev->next = allocation->next;
+	else                 live_allocations       = allocation->next;
+	if(allocation->next) allocation->next->prev = allocation->prev;
+	memory_live_list_unlock();
+}
+#endif
@@ -2,25 +2,121 @@
 #define MEMORY_UTILS_H
 
 #include <stddef.h>
+#include <stdbool.h>
+
+#define MEMORY_ARENA_ALIGNMENT 16
+
+/* Every heap allocation carries a tag naming the subsystem it belongs to. Plain memory_allocate
+   uses MT_GENERAL, subsystems that want to show up separately in the mem report use the _tagged
+   variants. Counters are updated atomically since asset loader threads allocate too. Debug builds
+   also keep every live allocation in a list along with the file and line it came from, which is
+   what memory_leak_report walks at shutdown */
+enum Memory_Tag
+{
+	MT_GENERAL = 0,
+	MT_GEOMETRY,
+	MT_TEXTURE,
+	MT_PARSER,
+	MT_HASHMAP,
+	MT_ARRAY,
+	MT_SOUND,
+	MT_GUI,
+	MT_EDITOR,
+	MT_MAX
+};
+
+struct Memory_Tag_Stats
+{
+	size_t allocated;       // Live bytes
+	size_t peak;            // Highest value allocated has reached
+	size_t num_live;        // Allocations that have not been freed yet
+	size_t num_allocations; // Allocations and reallocations made so far, never decreases
+	size_t budget;          // Soft limit in bytes, 0 means no limit
+	bool   over_budget;     // Set once a warning has been logged, cleared when usage falls back under budget
+};
 
 struct Memory
 {
-	size_t allocated;
-	size_t freed;
+	size_t                  allocated;
+	size_t                  freed;
+	size_t                  peak;            // Highest value allocated has reached
+	size_t                  num_allocations; // Number of heap allocations and reallocations made so far, never decreases
+	struct Memory_Tag_Stats tags[MT_MAX];
 };
 
+/* Linear allocator, allocations are bumped out of a single block and are all released at once
+   by memory_arena_reset or by ending a scope. When the block runs out, allocations fall back
+   to the heap and those blocks are released along with the rest on reset so nothing leaks, but
+   num_overflows going above zero means the arena's capacity should be raised.
+   Arenas are not thread safe, the global frame and scratch arenas must only be used on the main thread */
+struct Memory_Arena_Block;
+
+struct Memory_Arena
+{
+	void*                      allocation;     // Block returned by memory_allocate, buffer is its aligned start
+	unsigned char*             buffer;
+	size_t                     capacity;
+	size_t                     used;
+	size_t                     overflow_used;  // Bytes handed out from heap blocks since the last reset
+	size_t                     high_water;     // Highest value used + overflow_used has reached
+	int                        num_overflows;  // Number of allocations that did not fit, since init
+	struct Memory_Arena_Block* overflow;
+};
+
+struct Memory_Arena_Scope
+{
+	struct Memory_Arena*       arena;
+	size_t                     used;
+	size_t                     overflow_used;
+	struct Memory_Arena_Block* overflow;
+};
+
+/* Header in front of every allocation, its size must stay a multiple of 16 so the memory handed out
+   keeps the alignment malloc gives us */
 struct Memory_Allocation
 {
-	size_t size;
-	unsigned char allocation[];
+#ifdef DEBUG
+	struct Memory_Allocation* prev;
+	struct Memory_Allocation* next;
+	const char*               file;
+	size_t                    sequence; // Value of num_allocations when this was allocated, also pads the header to 48 bytes
+#endif
+	size_t                    size;
+	int                       tag;
+	int                       line;
+	unsigned char             allocation[];
 };
 
-void*          memory_allocate(size_t size);
-void*          memory_reallocate_(void** ptr, size_t size);
-void*          memory_allocate_and_clear(size_t count, size_t size);
+void*          memory_allocate_tracked(size_t size, int tag, const char* file, int line);
+void*          memory_reallocate_tracked(void** ptr, size_t size, int tag, const char* file, int line); // Keeps the original tag, tag is only used when *ptr is NULL
+void*          memory_allocate_and_clear_tracked(size_t count, size_t size, int tag, const char* file, int line);
 void           memory_free(void* ptr);
 struct Memory* memory_get(void);
+const char*    memory_tag_name_get(int tag);
+void           memory_budget_set(int tag, size_t budget);
+void           memory_budgets_check(void);  // Main thread only, logs a warning for every tag that went over its budget since the last check
+void           memory_report_log(void);     // Logs a table of usage per tag
+void           memory_leak_report(void);    // Logs outstanding allocations by tag, and by call site in debug builds
+
+bool                      memory_arena_init(struct Memory_Arena* arena, size_t capacity);
+void                      memory_arena_destroy(struct Memory_Arena* arena);
+void*                     memory_arena_allocate(struct Memory_Arena* arena, size_t size); // Never returns NULL unless the heap fallback also fails
+void                      memory_arena_reset(struct Memory_Arena* arena);
+struct Memory_Arena_Scope memory_arena_scope_begin(struct Memory_Arena* arena);
+void                      memory_arena_scope_end(struct Memory_Arena_Scope* scope); // Releases everything allocated since the matching begin
+
+bool                      memory_arenas_init(size_t frame_arena_capacity, size_t scratch_arena_capacity);
+void                      memory_arenas_cleanup(void);
+struct Memory_Arena*      memory_frame_arena_get(void);   // Reset once at the end of every frame
+struct Memory_Arena*      memory_scratch_arena_get(void); // Only use inside a scope, for memory that does not outlive the function
 
+#define memory_allocate(size)                              memory_allocate_tracked(size, MT_GENERAL, __FILE__, __LINE__)
+#define memory_allocate_tagged(size, tag)                  memory_allocate_tracked(size, tag, __FILE__, __LINE__)
+#define memory_allocate_and_clear(count, size)             memory_allocate_and_clear_tracked(count, size, MT_GENERAL, __FILE__, __LINE__)
+#define memory_allocate_and_clear_tagged(count, size, tag) memory_allocate_and_clear_tracked(count, size, tag, __FILE__, __LINE__)
+#define memory_reallocate_(ptr, size)                      memory_reallocate_tracked(ptr, size, MT_GENERAL, __FILE__, __LINE__)
+#define memory_reallocate_tagged_(ptr, size, tag)          memory_reallocate_tracked(ptr, size, tag, __FILE__, __LINE__)
 #define memory_reallocate(ptr, size) memory_reallocate_(&ptr, size);
+#define memory_reallocate_tagged(ptr, size, tag) memory_reallocate_tagged_(&ptr, size, tag);
 
 #endif
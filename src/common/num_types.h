@@ -8,6 +8,7 @@ typedef int8_t        int8;
 typedef int32_t       int32;
 typedef int64_t       int64;
 typedef unsigned int  uint;
+typedef uint16_t      uint16;
 typedef uint32_t      uint32;
 typedef uint64_t      uint64;
 typedef uint8_t       uint8;
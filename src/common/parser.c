@@ -14,6 +14,8 @@
 #define MAX_LINE_LEN 512
 #define MAX_VALUE_LEN 512
 
+static bool parser_object_value_coerce(const struct Parser_Object* object, const char* key, int type, struct Variant* out_value);
+
 bool parser_load(FILE* file, const char* filename, Parser_Assign_Func assign_func, bool return_on_emptyline, int current_line)
 {
     if(!file)
@@ -81,7 +83,7 @@ struct Parser* parser_load_objects(FILE* file, const char* filename)
 		return false;
     }
 
-    struct Parser* parser = memory_allocate(sizeof(*parser));
+    struct Parser* parser = memory_allocate_tagged(sizeof(*parser), MT_PARSER);
     if(!parser)
     {
         log_error("parser:load_objects", "Out of memeory");
@@ -286,7 +288,7 @@ void parser_free(struct Parser *parser)
 struct Parser* parser_new(void)
 {
     struct Parser* parser = NULL;
-    parser = memory_allocate(sizeof(*parser));
+    parser = memory_allocate_tagged(sizeof(*parser), MT_PARSER);
     if(!parser)
     {
 		log_error("parser:new", "Out of memory");
@@ -313,12 +315,170 @@ struct Parser_Object* parser_object_new(struct Parser* parser, int type)
 		log_error("parser:object_new", "Failed to add new parser object");
 		return NULL;
     }
-    object->type = type;
-    object->data = hashmap_create();
+    object->type         = type;
+    object->data         = hashmap_create();
+    object->values       = NULL;
+    object->num_values   = 0;
+    object->string_table = NULL;
 
     return object;
 }
 
+struct Parser_Object* parser_object_compiled_new(struct Parser* parser, int type, const struct Parser_Value* values, int num_values, const char* string_table)
+{
+    assert(parser && (values || num_values == 0) && string_table);
+    struct Parser_Object* object = array_grow(parser->objects, struct Parser_Object);
+    if(!object)
+    {
+		log_error("parser:object_compiled_new", "Failed to add new parser object");
+		return NULL;
+    }
+    object->type         = type;
+    object->data         = NULL;
+    object->values       = values;
+    object->num_values   = num_values;
+    object->string_table = string_table;
+
+    return object;
+}
+
+bool parser_object_value_exists(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_value_exists(object->data, key);
+
+    for(int i = 0; i < object->num_values; i++)
+    {
+        if(strcmp(&object->string_table[object->values[i].key], key) == 0)
+            return true;
+    }
+    return false;
+}
+
+/* Compiled values are used as they are when their stored type is the one asked for, anything
+   else is converted from the original text exactly like a hashmap filled by the text parser would.
+   Rotations are compiled as vec4 records and quats are parsed from text the same way, so a quat
+   is read straight from a vec4 record */
+static bool parser_object_value_coerce(const struct Parser_Object* object, const char* key, int type, struct Variant* out_value)
+{
+    memset(out_value, 0, sizeof(*out_value));
+    variant_init_empty(out_value);
+    for(int i = 0; i < object->num_values; i++)
+    {
+        const struct Parser_Value* value = &object->values[i];
+        if(strcmp(&object->string_table[value->key], key) != 0) continue;
+
+        if(value->type != type && !(value->type == VT_VEC4 && type == VT_QUAT))
+        {
+            variant_from_str(out_value, &object->string_table[value->text], type);
+            return out_value->type == type;
+        }
+
+        out_value->type = type;
+        switch(type)
+        {
+        case VT_BOOL:  out_value->val_bool  = value->val_int != 0;                    break;
+        case VT_INT:   out_value->val_int   = value->val_int;                         break;
+        case VT_FLOAT: out_value->val_float = value->val_float[0];                    break;
+        case VT_VEC2:  memcpy(&out_value->val_vec2, value->val_float, sizeof(vec2)); break;
+        case VT_VEC3:  memcpy(&out_value->val_vec3, value->val_float, sizeof(vec3)); break;
+        case VT_VEC4:  memcpy(&out_value->val_vec4, value->val_float, sizeof(vec4)); break;
+        case VT_QUAT:  memcpy(&out_value->val_quat, value->val_float, sizeof(quat)); break;
+        default:       out_value->type = VT_NONE;                                    break;
+        }
+        return out_value->type == type;
+    }
+
+    log_error("parser:object_value_coerce", "No value found for key '%s'", key);
+    return false;
+}
+
+int parser_object_int_get(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_int_get(object->data, key);
+
+    struct Variant value;
+    return parser_object_value_coerce(object, key, VT_INT, &value) ? value.val_int : 0;
+}
+
+uint parser_object_uint_get(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_uint_get(object->data, key);
+
+    struct Variant value;
+    return parser_object_value_coerce(object, key, VT_UINT, &value) ? value.val_uint : 0;
+}
+
+float parser_object_float_get(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_float_get(object->data, key);
+
+    struct Variant value;
+    return parser_object_value_coerce(object, key, VT_FLOAT, &value) ? value.val_float : 0.f;
+}
+
+bool parser_object_bool_get(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_bool_get(object->data, key);
+
+    struct Variant value;
+    return parser_object_value_coerce(object, key, VT_BOOL, &value) ? value.val_bool : false;
+}
+
+vec2 parser_object_vec2_get(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_vec2_get(object->data, key);
+
+    struct Variant value;
+    return parser_object_value_coerce(object, key, VT_VEC2, &value) ? value.val_vec2 : (vec2) { 0.f, 0.f };
+}
+
+vec3 parser_object_vec3_get(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_vec3_get(object->data, key);
+
+    struct Variant value;
+    return parser_object_value_coerce(object, key, VT_VEC3, &value) ? value.val_vec3 : (vec3) { 0.f, 0.f, 0.f };
+}
+
+vec4 parser_object_vec4_get(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_vec4_get(object->data, key);
+
+    struct Variant value;
+    return parser_object_value_coerce(object, key, VT_VEC4, &value) ? value.val_vec4 : (vec4) { 0.f, 0.f, 0.f, 0.f };
+}
+
+quat parser_object_quat_get(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_quat_get(object->data, key);
+
+    struct Variant value;
+    return parser_object_value_coerce(object, key, VT_QUAT, &value) ? value.val_quat : (quat) { 0.f, 0.f, 0.f, 1.f };
+}
+
+const char* parser_object_str_get(const struct Parser_Object* object, const char* key)
+{
+    assert(object && key);
+    if(object->data) return hashmap_str_get(object->data, key);
+
+    // The text is always kept so strings come straight out of the string table
+    for(int i = 0; i < object->num_values; i++)
+    {
+        if(strcmp(&object->string_table[object->values[i].key], key) == 0)
+            return &object->string_table[object->values[i].text];
+    }
+    return NULL;
+}
+
 bool parser_write_objects(struct Parser* parser, FILE* file, const char* filename)
 {
     assert(parser);
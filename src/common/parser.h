@@ -4,6 +4,9 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+#include "linmath.h"
+#include "num_types.h"
+
 enum Parser_Object_Type
 {
     PO_CONFIG,
@@ -17,10 +20,28 @@ enum Parser_Object_Type
     PO_UNKNOWN
 };
 
+/* Value record of an object that is backed by a compiled file instead of a hashmap.
+   The original text is always kept so string getters never have to convert, values
+   that are plain numbers or bools are additionally stored with their type */
+struct Parser_Value
+{
+	uint32 key;  // Offset into string table
+	uint32 text; // Offset into string table
+	int32  type;
+	union
+	{
+		int32 val_int; // Also used for bools
+		float val_float[4];
+	};
+};
+
 struct Parser_Object
 {
-    int   type;
-    struct Hashmap* data;
+    int                        type;
+    struct Hashmap*            data;         // NULL for objects backed by a compiled file
+    const struct Parser_Value* values;       // Only used when data is NULL, owned by whoever created the object
+    int                        num_values;
+    const char*                string_table;
 };
 
 struct Parser
@@ -35,8 +56,21 @@ struct Parser*        parser_load_objects(FILE* file, const char* filename);
 void                  parser_free(struct Parser* parser);
 struct Parser*        parser_new(void);
 struct Parser_Object* parser_object_new(struct Parser* parser, int type);
+struct Parser_Object* parser_object_compiled_new(struct Parser* parser, int type, const struct Parser_Value* values, int num_values, const char* string_table);
 bool                  parser_write_objects(struct Parser* parser, FILE* file, const char* filename);
 int                   parser_object_type_from_str(const char* str);
 const char*           parser_object_type_to_str(int type);
 
+/* Getters that work on both kinds of objects, they behave like the matching hashmap getters */
+bool                  parser_object_value_exists(const struct Parser_Object* object, const char* key);
+int                   parser_object_int_get(const struct Parser_Object* object, const char* key);
+uint                  parser_object_uint_get(const struct Parser_Object* object, const char* key);
+float                 parser_object_float_get(const struct Parser_Object* object, const char* key);
+bool                  parser_object_bool_get(const struct Parser_Object* object, const char* key);
+vec2                  parser_object_vec2_get(const struct Parser_Object* object, const char* key);
+vec3                  parser_object_vec3_get(const struct Parser_Object* object, const char* key);
+vec4                  parser_object_vec4_get(const struct Parser_Object* object, const char* key);
+quat                  parser_object_quat_get(const struct Parser_Object* object, const char* key);
+const char*           parser_object_str_get(const struct Parser_Object* object, const char* key);
+
 #endif
@@ -0,0 +1,132 @@
+#include "pool.h"
+#include "memory_utils.h"
+#include "log.h"
+#include "num_types.h"
+
+#include <assert.h>
+
+static bool pool_block_add(struct Pool* pool);
+
+void pool_init(struct Pool* pool, size_t object_size, int block_capacity)
+{
+	assert(pool && object_size > 0 && block_capacity > 0);
+	pool->object_size    = object_size;
+	pool->block_capacity = block_capacity;
+	pool->num_blocks     = 0;
+	pool->blocks         = NULL;
+	pool->generations    = NULL;
+	pool->dense_index    = NULL;
+	pool->live           = NULL;
+	pool->num_live       = 0;
+	pool->free_list      = NULL;
+	pool->num_free       = 0;
+}
+
+void pool_destroy(struct Pool* pool)
+{
+	assert(pool);
+	for(int i = 0; i < pool->num_blocks; i++)
+		memory_free(pool->blocks[i]);
+
+	memory_free(pool->blocks);
+	memory_free(pool->generations);
+	memory_free(pool->dense_index);
+	memory_free(pool->live);
+	memory_free(pool->free_list);
+	pool_init(pool, pool->object_size, pool->block_capacity);
+}
+
+static bool pool_block_add(struct Pool* pool)
+{
+	int old_capacity = pool_capacity(pool);
+	int new_capacity = old_capacity + pool->block_capacity;
+
+	void* block = memory_allocate_and_clear(1, pool->object_size * pool->block_capacity);
+	if(!block)
+	{
+		log_error("pool:block_add", "Failed to allocate block of %d objects", pool->block_capacity);
+		return false;
+	}
+
+	pool->blocks      = memory_reallocate_((void**)&pool->blocks,      sizeof(*pool->blocks) * (pool->num_blocks + 1));
+	pool->generations = memory_reallocate_((void**)&pool->generations, sizeof(*pool->generations) * new_capacity);
+	pool->dense_index = memory_reallocate_((void**)&pool->dense_index, sizeof(*pool->dense_index) * new_capacity);
+	pool->live        = memory_reallocate_((void**)&pool->live,        sizeof(*pool->live) * new_capacity);
+	pool->free_list   = memory_reallocate_((void**)&pool->free_list,   sizeof(*pool->free_list) * new_capacity);
+	pool->blocks[pool->num_blocks++] = block;
+
+	// Push new slots in reverse so that the lowest index is handed out first
+	for(int i = new_capacity - 1; i >= old_capacity; i--)
+	{
+		pool->generations[i] = 0;
+		pool->dense_index[i] = -1;
+		pool->free_list[pool->num_free++] = i;
+	}
+
+	return true;
+}
+
+void* pool_alloc(struct Pool* pool, int* out_index)
+{
+	assert(pool);
+	if(pool->num_free == 0 && !pool_block_add(pool))
+		return NULL;
+
+	int index = pool->free_list[--pool->num_free];
+	pool->dense_index[index] = pool->num_live;
+	pool->live[pool->num_live++] = index;
+	if(out_index) *out_index = index;
+	return pool_get(pool, index);
+}
+
+void pool_free(struct Pool* pool, int index)
+{
+	assert(pool && index >= 0 && index < pool_capacity(pool));
+	int dense_index = pool->dense_index[index];
+	if(dense_index == -1)
+	{
+		log_error("pool:free", "Slot %d is not in use", index);
+		return;
+	}
+
+	// Move the last live slot into the hole so the live list stays packed
+	int last = pool->live[--pool->num_live];
+	pool->live[dense_index] = last;
+	pool->dense_index[last] = dense_index;
+
+	pool->dense_index[index] = -1;
+	pool->generations[index]++;
+	pool->free_list[pool->num_free++] = index;
+}
+
+void* pool_get(struct Pool* pool, int index)
+{
+	assert(pool && index >= 0 && index < pool_capacity(pool));
+	char* block = pool->blocks[index / pool->block_capacity];
+	return block + (size_t)(index % pool->block_capacity) * pool->object_size;
+}
+
+void* pool_get_live(struct Pool* pool, int index, int generation)
+{
+	assert(pool);
+	if(index < 0 || index >= pool_capacity(pool)) return NULL;
+	if(pool->dense_index[index] == -1 || pool->generations[index] != generation) return NULL;
+	return pool_get(pool, index);
+}
+
+int pool_generation(struct Pool* pool, int index)
+{
+	assert(pool && index >= 0 && index < pool_capacity(pool));
+	return pool->generations[index];
+}
+
+bool pool_is_live(struct Pool* pool, int index)
+{
+	assert(pool);
+	return index >= 0 && index < pool_capacity(pool) && pool->dense_index[index] != -1;
+}
+
+int pool_capacity(struct Pool* pool)
+{
+	return pool->num_blocks * pool->block_capacity;
+}
@@ -0,0 +1,42 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Growable pool of fixed size objects. Storage is handed out in blocks that are
+   never moved or freed until the pool is destroyed so pointers to objects stay
+   valid for as long as the slot is alive. Live slots are additionally tracked in a
+   packed list so iterating a pool only touches objects that are in use and every
+   slot carries a generation that is bumped when it is freed so stale references
+   to a reused slot can be detected */
+struct Pool
+{
+	size_t object_size;
+	int    block_capacity;
+	int    num_blocks;
+	void** blocks;
+	int*   generations; // Per slot
+	int*   dense_index; // Per slot, position of the slot inside live or -1 if the slot is free
+	int*   live;        // Packed slot indices of all live objects
+	int    num_live;
+	int*   free_list;   // Stack of free slot indices, the most recently freed slot is reused first
+	int    num_free;
+};
+
+void  pool_init(struct Pool* pool, size_t object_size, int block_capacity);
+void  pool_destroy(struct Pool* pool);
+void* pool_alloc(struct Pool* pool, int* out_index); // Returns NULL if a new block could not be allocated. Memory of reused slots is not cleared
+void  pool_free(struct Pool* pool, int index);
+void* pool_get(struct Pool* pool, int index);
+void* pool_get_live(struct Pool* pool, int index, int generation); // Returns NULL if the slot has been freed since generation was read
+int   pool_generation(struct Pool* pool, int index);
+bool  pool_is_live(struct Pool* pool, int index);
+int   pool_capacity(struct Pool* pool);
+
+/* Live objects are visited with
+   for(int i = 0; i < pool->num_live; i++) { type* obj = pool_live_at(pool, i); }
+   Freeing objects while iterating is only safe when walking the list backwards */
+#define pool_live_at(pool, live_index) pool_get(pool, (pool)->live[live_index])
+
+#endif
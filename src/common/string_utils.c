@@ -46,6 +46,28 @@ char* str_new(const char* string, ...)
 	return new_string;
 }
 
+char* str_arena_new(struct Memory_Arena* arena, const char* string, ...)
+{
+	va_list list;
+	va_start(list, string);
+	int length = vsnprintf(NULL, 0, string, list);
+	va_end(list);
+
+	if(length < 0)
+	{
+		log_error("str_arena_new", "Could not find length of string");
+		return NULL;
+	}
+
+	char* new_string = memory_arena_allocate(arena, length + 1);
+	if(!new_string) return NULL;
+
+	va_start(list, string);
+	vsnprintf(new_string, length + 1, string, list);
+	va_end(list);
+	return new_string;
+}
+
 char* str_concat(char* string, const char* str_to_concat)
 {
 	size_t length      = strlen(str_to_concat);
@@ -5,7 +5,10 @@
 Convenience methods for handling strings
  */
 
+struct Memory_Arena;
+
 char* str_new(const char* string, ...);
+char* str_arena_new(struct Memory_Arena* arena, const char* string, ...); // Same as str_new but the result lives in the arena and must not be freed
 char* str_concat(char* string, const char* str_to_concat);
 char* str_replace(char* string, const char* pattern, const char* replacement);
 
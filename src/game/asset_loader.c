@@ -0,0 +1,252 @@
+#include "asset_loader.h"
+#include "../common/array.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "../system/platform.h"
+#include "profiler.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+
+#define MAX_ASSET_LOADER_THREADS 4
+
+struct Asset_Request
+{
+	Asset_Load_Func     load;
+	Asset_Finalize_Func finalize;
+	void*               data;
+};
+
+struct Asset_Loader
+{
+	struct Thread*        threads[MAX_ASSET_LOADER_THREADS];
+	int                   num_threads;
+	struct Mutex*         mutex;
+	struct Condition*     request_available;
+	struct Condition*     request_loaded;
+	struct Asset_Request* queued;    // Waiting for a worker, oldest first
+	struct Asset_Request* loaded;    // Waiting to be finalized on the main thread, oldest first
+	int                   num_pending; // Requests that have not been finalized yet
+	bool                  quit;
+	bool                  running;
+};
+
+static struct Asset_Loader loader;
+
+static int  asset_loader_worker(void* param);
+static bool asset_loader_finalize_next(void);
+
+void asset_loader_init(int num_threads)
+{
+	if(num_threads <= 0)
+	{
+		// Leave one cpu for the main thread
+		num_threads = platform_cpu_count_get() - 1;
+		if(num_threads < 1) num_threads = 1;
+	}
+	if(num_threads > MAX_ASSET_LOADER_THREADS) num_threads = MAX_ASSET_LOADER_THREADS;
+
+	loader.num_threads       = 0;
+	loader.num_pending       = 0;
+	loader.quit              = false;
+	loader.running           = false;
+	loader.queued            = array_new(struct Asset_Request);
+	loader.loaded            = array_new(struct Asset_Request);
+	loader.mutex             = platform_mutex_create();
+	loader.request_available = platform_condition_create();
+	loader.request_loaded    = platform_condition_create();
+	if(!loader.mutex || !loader.request_available || !loader.request_loaded)
+	{
+		log_error("asset_loader:init", "Failed to create synchronization objects, assets will be loaded synchronously");
+		return;
+	}
+
+	for(int i = 0; i < num_threads; i++)
+	{
+		char thread_name[32];
+		snprintf(thread_name, sizeof(thread_name), "Asset_Loader_%d", i);
+		struct Thread* thread = platform_thread_create(&asset_loader_worker, thread_name, (void*)(intptr_t)i);
+		if(!thread) break;
+		loader.threads[loader.num_threads++] = thread;
+	}
+
+	loader.running = loader.num_threads > 0;
+	if(loader.running)
+		log_message("Asset loader started with %d threads", loader.num_threads);
+	else
+		log_error("asset_loader:init", "Failed to create any worker threads, assets will be loaded synchronously");
+}
+
+void asset_loader_cleanup(void)
+{
+	if(loader.running)
+	{
+		asset_loader_flush();
+
+		platform_mutex_lock(loader.mutex);
+		loader.quit = true;
+		platform_condition_broadcast(loader.request_available);
+		platform_mutex_unlock(loader.mutex);
+
+		for(int i = 0; i < loader.num_threads; i++)
+			platform_thread_wait(loader.threads[i]);
+	}
+
+	loader.num_threads = 0;
+	loader.running     = false;
+	platform_condition_destroy(loader.request_loaded);
+	platform_condition_destroy(loader.request_available);
+	platform_mutex_destroy(loader.mutex);
+	array_free(loader.loaded);
+	array_free(loader.queued);
+	loader.mutex             = NULL;
+	loader.request_available = NULL;
+	loader.request_loaded    = NULL;
+	loader.loaded            = NULL;
+	loader.queued            = NULL;
+}
+
+bool asset_loader_is_running(void)
+{
+	return loader.running;
+}
+
+void asset_loader_request(Asset_Load_Func load, Asset_Finalize_Func finalize, void* data)
+{
+	assert(load && finalize);
+	if(!loader.running)
+	{
+		load(data);
+		finalize(data);
+		return;
+	}
+
+	platform_mutex_lock(loader.mutex);
+	struct Asset_Request* request = array_grow(loader.queued, struct Asset_Request);
+	request->load     = load;
+	request->finalize = finalize;
+	request->data     = data;
+	loader.num_pending++;
+	platform_condition_signal(loader.request_available);
+	platform_mutex_unlock(loader.mutex);
+}
+
+void asset_loader_update(float budget_ms)
+{
+	if(!loader.running) return;
+
+	uint64 frequency = platform_counter_frequency_get();
+	uint64 start     = platform_counter_get();
+	uint64 budget    = (uint64)((double)budget_ms * (double)frequency / 1000.0);
+	PROFILE_BEGIN("Asset Finalize");
+	while(asset_loader_finalize_next())
+	{
+		if(platform_counter_get() - start >= budget)
+			break;
+	}
+	PROFILE_END();
+}
+
+void asset_loader_flush(void)
+{
+	if(!loader.running) return;
+
+	platform_mutex_lock(loader.mutex);
+	while(loader.num_pending > 0)
+	{
+		while(array_len(loader.loaded) == 0)
+			platform_condition_wait(loader.request_loaded, loader.mutex);
+
+		platform_mutex_unlock(loader.mutex);
+		asset_loader_finalize_next();
+		platform_mutex_lock(loader.mutex);
+	}
+	platform_mutex_unlock(loader.mutex);
+}
+
+int asset_loader_pending_count(void)
+{
+	if(!loader.running) return 0;
+
+	platform_mutex_lock(loader.mutex);
+	int num_pending = loader.num_pending;
+	platform_mutex_unlock(loader.mutex);
+	return num_pending;
+}
+
+char* asset_loader_file_read(const char* full_path, int memory_tag, long* out_size)
+{
+	FILE* file = fopen(full_path, "rb");
+	if(!file) return NULL;
+
+	char* data = NULL;
+	long  size = -1;
+	if(fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0)
+	{
+		rewind(file);
+		data = memory_allocate_tagged(size + 1, memory_tag);
+		if(data && fread(data, size, 1, file) == 1)
+		{
+			data[size] = '\0';
+			if(out_size) *out_size = size;
+		}
+		else if(data)
+		{
+			memory_free(data);
+			data = NULL;
+		}
+	}
+	fclose(file);
+	return data;
+}
+
+static bool asset_loader_finalize_next(void)
+{
+	platform_mutex_lock(loader.mutex);
+	if(array_len(loader.loaded) == 0)
+	{
+		platform_mutex_unlock(loader.mutex);
+		return false;
+	}
+	struct Asset_Request request = loader.loaded[0];
+	array_remove_at(loader.loaded, 0);
+	platform_mutex_unlock(loader.mutex);
+
+	request.finalize(request.data);
+
+	platform_mutex_lock(loader.mutex);
+	loader.num_pending--;
+	platform_mutex_unlock(loader.mutex);
+	return true;
+}
+
+static int asset_loader_worker(void* param)
+{
+	char thread_name[MAX_PROFILER_THREAD_NAME_LEN];
+	snprintf(thread_name, sizeof(thread_name), "Asset_Loader_%d", (int)(intptr_t)param);
+	profiler_thread_name_set(thread_name);
+
+	platform_mutex_lock(loader.mutex);
+	while(true)
+	{
+		while(!loader.quit && array_len(loader.queued) == 0)
+			platform_condition_wait(loader.request_available, loader.mutex);
+
+		if(array_len(loader.queued) == 0) break; // Only reached when quitting
+
+		struct Asset_Request request = loader.queued[0];
+		array_remove_at(loader.queued, 0);
+		platform_mutex_unlock(loader.mutex);
+
+		PROFILE_SCOPE("Asset Load")
+			request.load(request.data);
+
+		platform_mutex_lock(loader.mutex);
+		struct Asset_Request* loaded = array_grow(loader.loaded, struct Asset_Request);
+		*loaded = request;
+		platform_condition_signal(loader.request_loaded);
+	}
+	platform_mutex_unlock(loader.mutex);
+	return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <stdbool.h>
+
+/* Background loading of assets. Requests are picked up by a small pool of worker threads
+   which read and decode files into staging memory, the main thread then finishes each
+   request in asset_loader_update which is where gpu uploads happen. Load functions run
+   on a worker thread so they must not touch gl, engine lists or the log, anything that
+   went wrong should be stored in the request and reported from the finalize function */
+
+typedef void (*Asset_Load_Func)(void* data);     // Worker thread
+typedef void (*Asset_Finalize_Func)(void* data); // Main thread, responsible for freeing data
+
+void  asset_loader_init(int num_threads); // Passing 0 or less picks a thread count based on the number of cpus
+void  asset_loader_cleanup(void);         // Finishes every outstanding request before stopping the workers
+bool  asset_loader_is_running(void);
+void  asset_loader_request(Asset_Load_Func load, Asset_Finalize_Func finalize, void* data);
+void  asset_loader_update(float budget_ms); // Finalizes completed requests until budget_ms has been used up, at least one is always finalized if available
+void  asset_loader_flush(void);             // Blocks until every request made so far has been finalized
+int   asset_loader_pending_count(void);
+char* asset_loader_file_read(const char* full_path, int memory_tag, long* out_size); // Safe to call from load functions, never logs, returns NULL on failure
+
+#endif
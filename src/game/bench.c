@@ -0,0 +1,262 @@
+#include "bench.h"
+#include "entity.h"
+#include "transform.h"
+#include "renderer.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "../system/file_io.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+struct Bench_Summary
+{
+	float mean;
+	float p50;
+	float p95;
+	float p99;
+	float max;
+};
+
+static const char* sample_names[BS_MAX] =
+{
+	"frame_ms",
+	"update_ms",
+	"physics_ms",
+	"render_ms",
+	"draw_calls",
+	"rendered",
+	"heap_allocations",
+	"gpu_materials_ms",
+	"gpu_debug_draw_ms",
+	"gpu_editor_ms",
+	"gpu_immediate_mode_ms",
+	"gpu_sprites_ms",
+	"gpu_gui_ms"
+};
+
+static void  bench_summary_get(struct Bench* bench, int sample, float* scratch, struct Bench_Summary* out_summary);
+static float bench_percentile(const float* sorted, int count, float percentile);
+static int   bench_float_compare(const void* a, const void* b);
+
+bool bench_init(struct Bench* bench, const struct Bench_Params* params)
+{
+	memcpy(&bench->params, params, sizeof(bench->params));
+	if(bench->params.num_frames <= 0) bench->params.num_frames = BENCH_DEFAULT_FRAMES;
+	bench->num_frames_recorded         = 0;
+	bench->memory_peak                 = 0;
+	bench->num_allocating_frames       = 0;
+	bench->max_frame_allocations       = 0;
+	bench->max_frame_allocations_frame = -1;
+	memset(bench->tag_allocations, 0, sizeof(bench->tag_allocations));
+	memset(bench->tag_allocations_start, 0, sizeof(bench->tag_allocations_start));
+	vec3_fill(&bench->path_origin, 0.f, 0.f, 0.f);
+
+	for(int i = 0; i < BS_MAX; i++)
+	{
+		bench->samples[i] = memory_allocate(sizeof(float) * bench->params.num_frames);
+		if(!bench->samples[i])
+		{
+			log_error("bench:init", "Failed to allocate samples for %d frames", bench->params.num_frames);
+			bench_destroy(bench);
+			return false;
+		}
+	}
+	return true;
+}
+
+void bench_destroy(struct Bench* bench)
+{
+	for(int i = 0; i < BS_MAX; i++)
+	{
+		memory_free(bench->samples[i]);
+		bench->samples[i] = NULL;
+	}
+	bench->num_frames_recorded = 0;
+}
+
+void bench_path_start(struct Bench* bench, struct Player* player)
+{
+	transform_get_absolute_position(&player->base, &bench->path_origin);
+}
+
+void bench_path_apply(struct Bench* bench, struct Player* player, int frame)
+{
+	/* Circle that starts at the origin heading down -z, which is the player's forward, and turns
+	   the player along with it so the camera sweeps over a different part of the scene every frame */
+	float angle  = ((float)(frame % BENCH_PATH_FRAMES) / (float)BENCH_PATH_FRAMES) * 2.f * M_PI;
+	vec3  center = { bench->path_origin.x + BENCH_PATH_RADIUS, bench->path_origin.y, bench->path_origin.z };
+	vec3  position =
+	{
+		center.x - cosf(angle) * BENCH_PATH_RADIUS,
+		center.y,
+		center.z - sinf(angle) * BENCH_PATH_RADIUS
+	};
+	transform_set_position(&player->base, &position);
+	quat_axis_angle(&player->base.transform.rotation, &UNIT_Y, -TO_DEGREES(angle));
+	transform_mark_dirty(&player->base);
+}
+
+void bench_recording_start(struct Bench* bench)
+{
+	struct Memory* memory = memory_get();
+	for(int i = 0; i < MT_MAX; i++)
+		bench->tag_allocations_start[i] = memory->tags[i].num_allocations;
+}
+
+void bench_frame_record(struct Bench* bench, float frame_ms, float update_ms, float physics_ms, float render_ms, int heap_allocations, const struct Render_Stats* render_stats)
+{
+	if(bench->num_frames_recorded >= bench->params.num_frames) return;
+
+	int frame = bench->num_frames_recorded++;
+	bench->samples[BS_FRAME][frame]      = frame_ms;
+	bench->samples[BS_UPDATE][frame]     = update_ms;
+	bench->samples[BS_PHYSICS][frame]    = physics_ms;
+	bench->samples[BS_RENDER][frame]     = render_ms;
+	bench->samples[BS_DRAW_CALLS][frame] = (float)render_stats->num_draw_calls;
+	bench->samples[BS_RENDERED][frame]   = (float)render_stats->num_rendered;
+	bench->samples[BS_HEAP_ALLOCATIONS][frame] = (float)heap_allocations;
+	for(int i = 0; i < RGT_MAX; i++)
+		bench->samples[BS_GPU_MATERIALS + i][frame] = render_stats->gpu_ms[RGT_MATERIALS + i];
+
+	struct Memory* memory = memory_get();
+	if(memory->peak > bench->memory_peak) bench->memory_peak = memory->peak;
+
+	// Split the frame's heap allocations by tag so the report points at whoever still allocates per frame
+	for(int i = 0; i < MT_MAX; i++)
+	{
+		bench->tag_allocations[i]       += memory->tags[i].num_allocations - bench->tag_allocations_start[i];
+		bench->tag_allocations_start[i]  = memory->tags[i].num_allocations;
+	}
+	if(heap_allocations > 0) bench->num_allocating_frames++;
+	if(heap_allocations > bench->max_frame_allocations)
+	{
+		bench->max_frame_allocations       = heap_allocations;
+		bench->max_frame_allocations_frame = frame;
+	}
+}
+
+bool bench_report_write(struct Bench* bench)
+{
+	if(bench->num_frames_recorded == 0)
+	{
+		log_error("bench:report_write", "No frames were recorded");
+		return false;
+	}
+
+	FILE* file = io_file_open(DIRT_USER, bench->params.output_filename, "w");
+	if(!file)
+	{
+		log_error("bench:report_write", "Failed to open %s for writing", bench->params.output_filename);
+		return false;
+	}
+
+	float* scratch = memory_allocate(sizeof(float) * bench->num_frames_recorded);
+	if(!scratch)
+	{
+		log_error("bench:report_write", "Out of memory");
+		fclose(file);
+		return false;
+	}
+
+	struct Bench_Summary summaries[BS_MAX];
+	for(int i = 0; i < BS_MAX; i++)
+		bench_summary_get(bench, i, scratch, &summaries[i]);
+	memory_free(scratch);
+
+	const char* extension = strrchr(bench->params.output_filename, '.');
+	bool json = extension && strcmp(extension, ".json") == 0;
+	if(json)
+	{
+		fprintf(file, "{\n");
+		fprintf(file, "\t\"scene\": \"%s\",\n", bench->params.scene_filename);
+		fprintf(file, "\t\"frames\": %d,\n", bench->num_frames_recorded);
+		fprintf(file, "\t\"fixed_dt\": %s,\n", bench->params.fixed_dt ? "true" : "false");
+		fprintf(file, "\t\"memory_peak_bytes\": %zu,\n", bench->memory_peak);
+		fprintf(file, "\t\"heap_allocating_frames\": %d,\n", bench->num_allocating_frames);
+		fprintf(file, "\t\"heap_allocations_by_tag\": {");
+		for(int i = 0; i < MT_MAX; i++)
+			fprintf(file, "%s \"%s\": %zu", i == 0 ? "" : ",", memory_tag_name_get(i), bench->tag_allocations[i]);
+		fprintf(file, " }");
+		for(int i = 0; i < BS_MAX; i++)
+		{
+			struct Bench_Summary* summary = &summaries[i];
+			fprintf(file, ",\n\t\"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }",
+					sample_names[i], summary->mean, summary->p50, summary->p95, summary->p99, summary->max);
+		}
+		fprintf(file, "\n}\n");
+	}
+	else
+	{
+		fprintf(file, "metric,mean,p50,p95,p99,max\n");
+		for(int i = 0; i < BS_MAX; i++)
+		{
+			struct Bench_Summary* summary = &summaries[i];
+			fprintf(file, "%s,%.4f,%.4f,%.4f,%.4f,%.4f\n", sample_names[i], summary->mean, summary->p50, summary->p95, summary->p99, summary->max);
+		}
+		fprintf(file, "memory_peak_bytes,%zu,,,,\n", bench->memory_peak);
+		fprintf(file, "heap_allocating_frames,%d,,,,\n", bench->num_allocating_frames);
+		for(int i = 0; i < MT_MAX; i++)
+			fprintf(file, "heap_allocations_%s,%zu,,,,\n", memory_tag_name_get(i), bench->tag_allocations[i]);
+	}
+	fclose(file);
+
+	log_message("Bench %s: %d frames, frame time p50 %.3fms p95 %.3fms p99 %.3fms, written to %s",
+				bench->params.scene_filename,
+				bench->num_frames_recorded,
+				summaries[BS_FRAME].p50,
+				summaries[BS_FRAME].p95,
+				summaries[BS_FRAME].p99,
+				bench->params.output_filename);
+
+	if(bench->num_allocating_frames > 0)
+	{
+		log_warning("Bench %s: %d of %d frames made heap allocations after warm up, at most %d in frame %d",
+					bench->params.scene_filename,
+					bench->num_allocating_frames,
+					bench->num_frames_recorded,
+					bench->max_frame_allocations,
+					bench->max_frame_allocations_frame);
+		for(int i = 0; i < MT_MAX; i++)
+		{
+			if(bench->tag_allocations[i] > 0)
+				log_warning("    %-10s %zu allocations, %.2f per frame", memory_tag_name_get(i), bench->tag_allocations[i], (double)bench->tag_allocations[i] / bench->num_frames_recorded);
+		}
+	}
+	return true;
+}
+
+void bench_summary_get(struct Bench* bench, int sample, float* scratch, struct Bench_Summary* out_summary)
+{
+	int count = bench->num_frames_recorded;
+	memcpy(scratch, bench->samples[sample], sizeof(float) * count);
+	qsort(scratch, count, sizeof(float), bench_float_compare);
+
+	double total = 0.0;
+	for(int i = 0; i < count; i++)
+		total += scratch[i];
+
+	out_summary->mean = (float)(total / count);
+	out_summary->p50  = bench_percentile(scratch, count, 50.f);
+	out_summary->p95  = bench_percentile(scratch, count, 95.f);
+	out_summary->p99  = bench_percentile(scratch, count, 99.f);
+	out_summary->max  = scratch[count - 1];
+}
+
+float bench_percentile(const float* sorted, int count, float percentile)
+{
+	// Nearest rank, always one of the recorded values
+	int rank = (int)ceilf(percentile / 100.f * (float)count);
+	if(rank < 1) rank = 1;
+	if(rank > count) rank = count;
+	return sorted[rank - 1];
+}
+
+int bench_float_compare(const void* a, const void* b)
+{
+	float value_a = *(const float*)a;
+	float value_b = *(const float*)b;
+	return (value_a > value_b) - (value_a < value_b);
+}
@@ -0,0 +1,72 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "../common/limits.h"
+#include "../common/linmath.h"
+#include "../common/memory_utils.h"
+
+struct Player;
+struct Render_Stats;
+
+/* Headless benchmark runs, started with --bench on the command line. A scene is rendered
+   into an offscreen framebuffer for a fixed number of frames while the player follows a
+   scripted path so that two runs of the same build see the same work. Per frame timings
+   are reduced to percentiles and written to the user directory when the run ends */
+
+#define BENCH_DEFAULT_FRAMES 1000
+#define BENCH_WARMUP_FRAMES  30   // Run before recording starts so that loading hitches stay out of the results
+#define BENCH_RANDOM_SEED    1
+#define BENCH_PATH_RADIUS    15.f
+#define BENCH_PATH_FRAMES    600  // Frames taken to go around the path once
+
+enum Bench_Sample
+{
+	BS_FRAME = 0,
+	BS_UPDATE,
+	BS_PHYSICS,
+	BS_RENDER,
+	BS_DRAW_CALLS,
+	BS_RENDERED,
+	BS_HEAP_ALLOCATIONS,
+	BS_GPU_MATERIALS,      // Gpu stages follow the order of enum Render_Gpu_Timer
+	BS_GPU_DEBUG_DRAW,
+	BS_GPU_EDITOR,
+	BS_GPU_IMMEDIATE_MODE,
+	BS_GPU_SPRITES,
+	BS_GPU_GUI,
+	BS_MAX
+};
+
+struct Bench_Params
+{
+	char scene_filename[MAX_FILENAME_LEN];
+	char output_filename[MAX_FILENAME_LEN]; // A .json extension writes json, anything else is written as csv
+	int  num_frames;
+	bool fixed_dt;                          // Advance by exactly one fixed_delta_time per frame instead of wall clock time
+};
+
+struct Bench
+{
+	struct Bench_Params params;
+	float*              samples[BS_MAX]; // num_frames values per sample type
+	int                 num_frames_recorded;
+	vec3                path_origin;
+	size_t              memory_peak;
+	int                 num_allocating_frames; // Recorded frames that made at least one heap allocation, should be zero once a scene is running
+	int                 max_frame_allocations;
+	int                 max_frame_allocations_frame; // First recorded frame that made max_frame_allocations
+	size_t              tag_allocations[MT_MAX]; // Heap allocations per memory tag across all recorded frames
+	size_t              tag_allocations_start[MT_MAX]; // Per tag allocation counts when the current frame started
+};
+
+bool bench_init(struct Bench* bench, const struct Bench_Params* params);
+void bench_destroy(struct Bench* bench);
+void bench_path_start(struct Bench* bench, struct Player* player);          // Path begins at the player's current position
+void bench_path_apply(struct Bench* bench, struct Player* player, int frame); // Moves the player to where it should be on the given frame
+void bench_recording_start(struct Bench* bench);                              // Called once warm up is over, heap allocations are counted from here on
+void bench_frame_record(struct Bench* bench, float frame_ms, float update_ms, float physics_ms, float render_ms, int heap_allocations, const struct Render_Stats* render_stats);
+bool bench_report_write(struct Bench* bench);
+
+#endif
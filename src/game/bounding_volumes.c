@@ -1,7 +1,19 @@
 #include "bounding_volumes.h"
 #include "../common/log.h"
+#include "../common/memory_utils.h"
 
 #include <math.h>
+#include <string.h>
+#include <assert.h>
+
+/* The batched frustum test picks the widest instruction set the compiler targets */
+#if defined(__AVX__)
+	#define BV_SIMD_AVX
+	#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define BV_SIMD_SSE
+	#include <xmmintrin.h>
+#endif
 
 int bv_intersect_frustum_box(vec4* frustum, struct Bounding_Box* box)
 {
@@ -411,3 +423,139 @@ vec3 bv_bounding_box_normal_from_intersection_point(struct Bounding_Box* box, ve
 	vec3_norm(&normal, &normal);
 	return normal;
 }
+
+void bv_box_soa_init(struct Bounding_Box_Soa* boxes)
+{
+	assert(boxes);
+	boxes->min_x    = NULL;
+	boxes->min_y    = NULL;
+	boxes->min_z    = NULL;
+	boxes->max_x    = NULL;
+	boxes->max_y    = NULL;
+	boxes->max_z    = NULL;
+	boxes->capacity = 0;
+}
+
+void bv_box_soa_destroy(struct Bounding_Box_Soa* boxes)
+{
+	assert(boxes);
+	if(boxes->min_x) memory_free(boxes->min_x); // All six arrays share one allocation
+	bv_box_soa_init(boxes);
+}
+
+bool bv_box_soa_reserve(struct Bounding_Box_Soa* boxes, int count)
+{
+	assert(boxes && count >= 0);
+	if(count <= boxes->capacity) return true;
+
+	int new_capacity = (count + BV_BOX_SOA_WIDTH - 1) / BV_BOX_SOA_WIDTH * BV_BOX_SOA_WIDTH;
+	float* data = memory_allocate_and_clear(1, sizeof(float) * 6 * new_capacity);
+	if(!data)
+	{
+		log_error("bv:box_soa_reserve", "Failed to allocate space for %d boxes", new_capacity);
+		return false;
+	}
+
+	float* old_arrays[6] = { boxes->min_x, boxes->min_y, boxes->min_z, boxes->max_x, boxes->max_y, boxes->max_z };
+	for(int i = 0; i < 6 && boxes->capacity > 0; i++)
+		memcpy(data + i * new_capacity, old_arrays[i], sizeof(float) * boxes->capacity);
+
+	if(boxes->min_x) memory_free(boxes->min_x);
+	boxes->min_x    = data;
+	boxes->min_y    = data + new_capacity;
+	boxes->min_z    = data + new_capacity * 2;
+	boxes->max_x    = data + new_capacity * 3;
+	boxes->max_y    = data + new_capacity * 4;
+	boxes->max_z    = data + new_capacity * 5;
+	boxes->capacity = new_capacity;
+	return true;
+}
+
+void bv_box_soa_set(struct Bounding_Box_Soa* boxes, int index, const struct Bounding_Box* box)
+{
+	assert(boxes && box && index >= 0 && index < boxes->capacity);
+	boxes->min_x[index] = box->min.x;
+	boxes->min_y[index] = box->min.y;
+	boxes->min_z[index] = box->min.z;
+	boxes->max_x[index] = box->max.x;
+	boxes->max_y[index] = box->max.y;
+	boxes->max_z[index] = box->max.z;
+}
+
+void bv_intersect_frustum_boxes(vec4* frustum, const struct Bounding_Box_Soa* boxes, int count, uint32* out_visible)
+{
+	assert(frustum && boxes && out_visible && count <= boxes->capacity);
+	memset(out_visible, 0, sizeof(*out_visible) * ((count + 31) / 32));
+
+	/* Same test as bv_intersect_frustum_box without telling intersecting and inside apart,
+	   a box is outside when its center is further behind any plane than its projected extent */
+	int padded_count = (count + BV_BOX_SOA_WIDTH - 1) / BV_BOX_SOA_WIDTH * BV_BOX_SOA_WIDTH;
+#if defined(BV_SIMD_AVX)
+	__m256 half = _mm256_set1_ps(0.5f);
+	__m256 sign = _mm256_set1_ps(-0.f);
+	for(int i = 0; i < padded_count; i += 8)
+	{
+		__m256 min_x = _mm256_loadu_ps(&boxes->min_x[i]), max_x = _mm256_loadu_ps(&boxes->max_x[i]);
+		__m256 min_y = _mm256_loadu_ps(&boxes->min_y[i]), max_y = _mm256_loadu_ps(&boxes->max_y[i]);
+		__m256 min_z = _mm256_loadu_ps(&boxes->min_z[i]), max_z = _mm256_loadu_ps(&boxes->max_z[i]);
+		__m256 center_x = _mm256_mul_ps(_mm256_add_ps(min_x, max_x), half), extent_x = _mm256_mul_ps(_mm256_sub_ps(max_x, min_x), half);
+		__m256 center_y = _mm256_mul_ps(_mm256_add_ps(min_y, max_y), half), extent_y = _mm256_mul_ps(_mm256_sub_ps(max_y, min_y), half);
+		__m256 center_z = _mm256_mul_ps(_mm256_add_ps(min_z, max_z), half), extent_z = _mm256_mul_ps(_mm256_sub_ps(max_z, min_z), half);
+		__m256 outside  = _mm256_setzero_ps();
+		for(int j = 0; j < FP_NUM_PLANES; j++)
+		{
+			__m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(frustum[j].x), center_x),
+													  _mm256_mul_ps(_mm256_set1_ps(frustum[j].y), center_y)),
+										_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(frustum[j].z), center_z),
+													  _mm256_set1_ps(frustum[j].w)));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(fabsf(frustum[j].x)), extent_x),
+														_mm256_mul_ps(_mm256_set1_ps(fabsf(frustum[j].y)), extent_y)),
+										  _mm256_mul_ps(_mm256_set1_ps(fabsf(frustum[j].z)), extent_z));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, _mm256_xor_ps(radius, sign), _CMP_LT_OQ));
+		}
+		uint32 visible = (uint32)(~_mm256_movemask_ps(outside) & 0xFF);
+		out_visible[i >> 5] |= visible << (i & 31);
+	}
+#elif defined(BV_SIMD_SSE)
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128 sign = _mm_set1_ps(-0.f);
+	for(int i = 0; i < padded_count; i += 4)
+	{
+		__m128 min_x = _mm_loadu_ps(&boxes->min_x[i]), max_x = _mm_loadu_ps(&boxes->max_x[i]);
+		__m128 min_y = _mm_loadu_ps(&boxes->min_y[i]), max_y = _mm_loadu_ps(&boxes->max_y[i]);
+		__m128 min_z = _mm_loadu_ps(&boxes->min_z[i]), max_z = _mm_loadu_ps(&boxes->max_z[i]);
+		__m128 center_x = _mm_mul_ps(_mm_add_ps(min_x, max_x), half), extent_x = _mm_mul_ps(_mm_sub_ps(max_x, min_x), half);
+		__m128 center_y = _mm_mul_ps(_mm_add_ps(min_y, max_y), half), extent_y = _mm_mul_ps(_mm_sub_ps(max_y, min_y), half);
+		__m128 center_z = _mm_mul_ps(_mm_add_ps(min_z, max_z), half), extent_z = _mm_mul_ps(_mm_sub_ps(max_z, min_z), half);
+		__m128 outside  = _mm_setzero_ps();
+		for(int j = 0; j < FP_NUM_PLANES; j++)
+		{
+			__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(frustum[j].x), center_x),
+												_mm_mul_ps(_mm_set1_ps(frustum[j].y), center_y)),
+									 _mm_add_ps(_mm_mul_ps(_mm_set1_ps(frustum[j].z), center_z),
+												_mm_set1_ps(frustum[j].w)));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(fabsf(frustum[j].x)), extent_x),
+												  _mm_mul_ps(_mm_set1_ps(fabsf(frustum[j].y)), extent_y)),
+									   _mm_mul_ps(_mm_set1_ps(fabsf(frustum[j].z)), extent_z));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_xor_ps(radius, sign)));
+		}
+		uint32 visible = (uint32)(~_mm_movemask_ps(outside) & 0xF);
+		out_visible[i >> 5] |= visible << (i & 31);
+	}
+#else
+	for(int i = 0; i < padded_count; i++)
+	{
+		float center_x = (boxes->min_x[i] + boxes->max_x[i]) * 0.5f, extent_x = (boxes->max_x[i] - boxes->min_x[i]) * 0.5f;
+		float center_y = (boxes->min_y[i] + boxes->max_y[i]) * 0.5f, extent_y = (boxes->max_y[i] - boxes->min_y[i]) * 0.5f;
+		float center_z = (boxes->min_z[i] + boxes->max_z[i]) * 0.5f, extent_z = (boxes->max_z[i] - boxes->min_z[i]) * 0.5f;
+		bool  outside  = false;
+		for(int j = 0; j < FP_NUM_PLANES && !outside; j++)
+		{
+			float dist   = frustum[j].x * center_x + frustum[j].y * center_y + frustum[j].z * center_z + frustum[j].w;
+			float radius = fabsf(frustum[j].x) * extent_x + fabsf(frustum[j].y) * extent_y + fabsf(frustum[j].z) * extent_z;
+			outside = dist < -radius;
+		}
+		if(!outside) out_visible[i >> 5] |= 1u << (i & 31);
+	}
+#endif
+}
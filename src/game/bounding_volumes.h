@@ -43,9 +43,24 @@ struct Ray
 };
 
 
+#define BV_BOX_SOA_WIDTH 8 // Box capacity is kept a multiple of this so the batched tests never need a scalar tail
+
+/* Boxes stored one component per array so that several can be tested against a plane at once */
+struct Bounding_Box_Soa
+{
+	float* min_x;
+	float* min_y;
+	float* min_z;
+	float* max_x;
+	float* max_y;
+	float* max_z;
+	int    capacity;
+};
+
 struct Raycast_Result
 {
 	struct Entity* entities_intersected[MAX_RAYCAST_ENTITIES_INTERSECT];
+	float          entity_distances[MAX_RAYCAST_ENTITIES_INTERSECT];
 	int            num_entities_intersected;
 };
 
@@ -63,4 +78,10 @@ void  bv_bounding_box_vertices_get_line_visualization(struct Bounding_Box* bound
 float bv_distance_ray_bounding_box(struct Ray* ray, struct Bounding_Box* box);
 vec3  bv_bounding_box_normal_from_intersection_point(struct Bounding_Box* box, vec3 intersection_point);
 
+void  bv_box_soa_init(struct Bounding_Box_Soa* boxes);
+void  bv_box_soa_destroy(struct Bounding_Box_Soa* boxes);
+bool  bv_box_soa_reserve(struct Bounding_Box_Soa* boxes, int count); // New entries are empty boxes at the origin
+void  bv_box_soa_set(struct Bounding_Box_Soa* boxes, int index, const struct Bounding_Box* box);
+void  bv_intersect_frustum_boxes(vec4* frustum, const struct Bounding_Box_Soa* boxes, int count, uint32* out_visible); // Sets bit i of out_visible unless box i is outside the frustum, out_visible needs room for (count + 31) / 32 entries
+
 #endif
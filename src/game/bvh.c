@@ -0,0 +1,466 @@
+#include "bvh.h"
+#include "../common/array.h"
+#include "../common/log.h"
+
+#include <assert.h>
+#include <math.h>
+
+#define BVH_STACK_SIZE 256
+
+static int   bvh_node_allocate(struct Bvh* bvh);
+static void  bvh_node_free(struct Bvh* bvh, int index);
+static void  bvh_leaf_insert(struct Bvh* bvh, int leaf);
+static void  bvh_leaf_remove(struct Bvh* bvh, int leaf);
+static void  bvh_refit_upwards(struct Bvh* bvh, int index);
+static int   bvh_balance(struct Bvh* bvh, int index);
+static void  bvh_box_union(struct Bounding_Box* out, const struct Bounding_Box* a, const struct Bounding_Box* b);
+static void  bvh_box_fatten(struct Bounding_Box* out, const struct Bounding_Box* box);
+static float bvh_box_area(const struct Bounding_Box* box);
+static bool  bvh_box_contains(const struct Bounding_Box* outer, const struct Bounding_Box* inner);
+static bool  bvh_slab_clip(float min, float max, float origin, float inv_direction, float* tmin, float* tmax);
+static bool  bvh_box_ray_entry(const struct Bounding_Box* box, const vec3* origin, const vec3* inv_direction, float* out_tmin);
+
+void bvh_init(struct Bvh* bvh)
+{
+	assert(bvh);
+	bvh->nodes      = array_new(struct Bvh_Node);
+	bvh->root       = BVH_NULL_NODE;
+	bvh->free_list  = BVH_NULL_NODE;
+	bvh->num_leaves = 0;
+}
+
+void bvh_destroy(struct Bvh* bvh)
+{
+	assert(bvh);
+	if(bvh->nodes) array_free(bvh->nodes);
+	bvh->nodes      = NULL;
+	bvh->root       = BVH_NULL_NODE;
+	bvh->free_list  = BVH_NULL_NODE;
+	bvh->num_leaves = 0;
+}
+
+int bvh_proxy_create(struct Bvh* bvh, struct Bounding_Box* box, struct Entity* entity)
+{
+	assert(bvh && box && entity);
+	int leaf = bvh_node_allocate(bvh);
+	bvh_box_fatten(&bvh->nodes[leaf].box, box);
+	bvh->nodes[leaf].entity = entity;
+	bvh_leaf_insert(bvh, leaf);
+	bvh->num_leaves++;
+	return leaf;
+}
+
+void bvh_proxy_destroy(struct Bvh* bvh, int proxy)
+{
+	assert(bvh && proxy >= 0 && proxy < array_len(bvh->nodes) && bvh->nodes[proxy].height == 0);
+	bvh_leaf_remove(bvh, proxy);
+	bvh_node_free(bvh, proxy);
+	bvh->num_leaves--;
+}
+
+bool bvh_proxy_move(struct Bvh* bvh, int proxy, struct Bounding_Box* box)
+{
+	assert(bvh && box && proxy >= 0 && proxy < array_len(bvh->nodes) && bvh->nodes[proxy].height == 0);
+
+	// Still inside the fattened box, nothing above this leaf needs to change
+	if(bvh_box_contains(&bvh->nodes[proxy].box, box))
+		return false;
+
+	bvh_leaf_remove(bvh, proxy);
+	bvh_box_fatten(&bvh->nodes[proxy].box, box);
+	bvh_leaf_insert(bvh, proxy);
+	return true;
+}
+
+void bvh_ray_query(struct Bvh* bvh, struct Ray* ray, Bvh_Ray_Func callback, void* user_data)
+{
+	assert(bvh && ray && callback);
+	if(bvh->root == BVH_NULL_NODE) return;
+
+	vec3 inv_direction = { 1.f / ray->direction.x, 1.f / ray->direction.y, 1.f / ray->direction.z };
+	float max_distance = INFINITY;
+
+	int   stack[BVH_STACK_SIZE];
+	float stack_tmin[BVH_STACK_SIZE];
+	int   stack_count = 0;
+
+	float root_tmin = 0.f;
+	if(!bvh_box_ray_entry(&bvh->nodes[bvh->root].box, &ray->origin, &inv_direction, &root_tmin))
+		return;
+	stack[stack_count]        = bvh->root;
+	stack_tmin[stack_count++] = root_tmin;
+
+	while(stack_count > 0)
+	{
+		stack_count--;
+		// Skip subtrees that begin beyond the closest distance the callback cares about
+		if(stack_tmin[stack_count] > max_distance) continue;
+
+		struct Bvh_Node* node = &bvh->nodes[stack[stack_count]];
+		if(node->left == BVH_NULL_NODE)
+		{
+			float distance = callback(node->entity, ray, user_data);
+			if(distance < max_distance) max_distance = distance;
+			continue;
+		}
+
+		if(stack_count + 2 > BVH_STACK_SIZE)
+		{
+			log_error("bvh:ray_query", "Traversal stack overflow, tree height %d", node->height);
+			return;
+		}
+
+		float tmin_left = 0.f, tmin_right = 0.f;
+		bool  hit_left  = bvh_box_ray_entry(&bvh->nodes[node->left].box, &ray->origin, &inv_direction, &tmin_left);
+		bool  hit_right = bvh_box_ray_entry(&bvh->nodes[node->right].box, &ray->origin, &inv_direction, &tmin_right);
+
+		// Push the farther child first so that the nearer one is visited next
+		if(hit_left && hit_right)
+		{
+			bool left_first = tmin_left <= tmin_right;
+			stack[stack_count]        = left_first ? node->right : node->left;
+			stack_tmin[stack_count++] = left_first ? tmin_right : tmin_left;
+			stack[stack_count]        = left_first ? node->left : node->right;
+			stack_tmin[stack_count++] = left_first ? tmin_left : tmin_right;
+		}
+		else if(hit_left)
+		{
+			stack[stack_count]        = node->left;
+			stack_tmin[stack_count++] = tmin_left;
+		}
+		else if(hit_right)
+		{
+			stack[stack_count]        = node->right;
+			stack_tmin[stack_count++] = tmin_right;
+		}
+	}
+}
+
+int bvh_node_allocate(struct Bvh* bvh)
+{
+	int index = BVH_NULL_NODE;
+	if(bvh->free_list != BVH_NULL_NODE)
+	{
+		index = bvh->free_list;
+		bvh->free_list = bvh->nodes[index].parent;
+	}
+	else
+	{
+		array_grow(bvh->nodes, struct Bvh_Node);
+		index = array_len(bvh->nodes) - 1;
+	}
+
+	struct Bvh_Node* node = &bvh->nodes[index];
+	node->parent = BVH_NULL_NODE;
+	node->left   = BVH_NULL_NODE;
+	node->right  = BVH_NULL_NODE;
+	node->height = 0;
+	node->entity = NULL;
+	return index;
+}
+
+void bvh_node_free(struct Bvh* bvh, int index)
+{
+	struct Bvh_Node* node = &bvh->nodes[index];
+	node->parent   = bvh->free_list;
+	node->height   = -1;
+	node->entity   = NULL;
+	bvh->free_list = index;
+}
+
+void bvh_leaf_insert(struct Bvh* bvh, int leaf)
+{
+	if(bvh->root == BVH_NULL_NODE)
+	{
+		bvh->root = leaf;
+		bvh->nodes[leaf].parent = BVH_NULL_NODE;
+		return;
+	}
+
+	/* Find the best sibling for the new leaf by walking down the tree and following
+	   the child whose surface area grows the least */
+	struct Bounding_Box leaf_box = bvh->nodes[leaf].box;
+	int index = bvh->root;
+	while(bvh->nodes[index].left != BVH_NULL_NODE)
+	{
+		struct Bvh_Node* node = &bvh->nodes[index];
+		struct Bounding_Box combined;
+		bvh_box_union(&combined, &node->box, &leaf_box);
+		float area          = bvh_box_area(&node->box);
+		float combined_area = bvh_box_area(&combined);
+
+		float cost             = 2.f * combined_area;          // Cost of pairing the leaf with this node
+		float inheritance_cost = 2.f * (combined_area - area); // Minimum cost of pushing the leaf further down
+
+		float child_costs[2];
+		int   children[2] = { node->left, node->right };
+		for(int i = 0; i < 2; i++)
+		{
+			struct Bvh_Node* child = &bvh->nodes[children[i]];
+			bvh_box_union(&combined, &child->box, &leaf_box);
+			if(child->left == BVH_NULL_NODE)
+				child_costs[i] = bvh_box_area(&combined) + inheritance_cost;
+			else
+				child_costs[i] = (bvh_box_area(&combined) - bvh_box_area(&child->box)) + inheritance_cost;
+		}
+
+		if(cost < child_costs[0] && cost < child_costs[1])
+			break;
+
+		index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+	}
+
+	// Allocating may move the node array so only indices are held across this call
+	int sibling    = index;
+	int old_parent = bvh->nodes[sibling].parent;
+	int new_parent = bvh_node_allocate(bvh);
+
+	struct Bvh_Node* parent_node = &bvh->nodes[new_parent];
+	parent_node->parent = old_parent;
+	parent_node->left   = sibling;
+	parent_node->right  = leaf;
+	parent_node->height = bvh->nodes[sibling].height + 1;
+	bvh_box_union(&parent_node->box, &leaf_box, &bvh->nodes[sibling].box);
+	bvh->nodes[sibling].parent = new_parent;
+	bvh->nodes[leaf].parent    = new_parent;
+
+	if(old_parent != BVH_NULL_NODE)
+	{
+		if(bvh->nodes[old_parent].left == sibling)
+			bvh->nodes[old_parent].left = new_parent;
+		else
+			bvh->nodes[old_parent].right = new_parent;
+	}
+	else
+	{
+		bvh->root = new_parent;
+	}
+
+	bvh_refit_upwards(bvh, new_parent);
+}
+
+void bvh_leaf_remove(struct Bvh* bvh, int leaf)
+{
+	if(leaf == bvh->root)
+	{
+		bvh->root = BVH_NULL_NODE;
+		return;
+	}
+
+	int parent       = bvh->nodes[leaf].parent;
+	int grand_parent = bvh->nodes[parent].parent;
+	int sibling      = bvh->nodes[parent].left == leaf ? bvh->nodes[parent].right : bvh->nodes[parent].left;
+
+	// The sibling takes the place of the parent which is no longer needed
+	if(grand_parent != BVH_NULL_NODE)
+	{
+		if(bvh->nodes[grand_parent].left == parent)
+			bvh->nodes[grand_parent].left = sibling;
+		else
+			bvh->nodes[grand_parent].right = sibling;
+		bvh->nodes[sibling].parent = grand_parent;
+		bvh_node_free(bvh, parent);
+		bvh_refit_upwards(bvh, grand_parent);
+	}
+	else
+	{
+		bvh->root = sibling;
+		bvh->nodes[sibling].parent = BVH_NULL_NODE;
+		bvh_node_free(bvh, parent);
+	}
+}
+
+void bvh_refit_upwards(struct Bvh* bvh, int index)
+{
+	while(index != BVH_NULL_NODE)
+	{
+		index = bvh_balance(bvh, index);
+
+		struct Bvh_Node* node  = &bvh->nodes[index];
+		struct Bvh_Node* left  = &bvh->nodes[node->left];
+		struct Bvh_Node* right = &bvh->nodes[node->right];
+		node->height = 1 + (left->height > right->height ? left->height : right->height);
+		bvh_box_union(&node->box, &left->box, &right->box);
+
+		index = node->parent;
+	}
+}
+
+/* Rotates the taller child of index_a up a level if the subtree is out of balance
+   and returns the index of the node now at the top of the subtree */
+int bvh_balance(struct Bvh* bvh, int index_a)
+{
+	struct Bvh_Node* nodes = bvh->nodes;
+	struct Bvh_Node* a     = &nodes[index_a];
+	if(a->left == BVH_NULL_NODE || a->height < 2)
+		return index_a;
+
+	int index_b = a->left;
+	int index_c = a->right;
+	struct Bvh_Node* b = &nodes[index_b];
+	struct Bvh_Node* c = &nodes[index_c];
+	int balance = c->height - b->height;
+
+	// Rotate c up
+	if(balance > 1)
+	{
+		int index_f = c->left;
+		int index_g = c->right;
+		struct Bvh_Node* f = &nodes[index_f];
+		struct Bvh_Node* g = &nodes[index_g];
+
+		c->left   = index_a;
+		c->parent = a->parent;
+		a->parent = index_c;
+
+		if(c->parent != BVH_NULL_NODE)
+		{
+			if(nodes[c->parent].left == index_a)
+				nodes[c->parent].left = index_c;
+			else
+				nodes[c->parent].right = index_c;
+		}
+		else
+		{
+			bvh->root = index_c;
+		}
+
+		if(f->height > g->height)
+		{
+			c->right  = index_f;
+			a->right  = index_g;
+			g->parent = index_a;
+			bvh_box_union(&a->box, &b->box, &g->box);
+			bvh_box_union(&c->box, &a->box, &f->box);
+			a->height = 1 + (b->height > g->height ? b->height : g->height);
+			c->height = 1 + (a->height > f->height ? a->height : f->height);
+		}
+		else
+		{
+			c->right  = index_g;
+			a->right  = index_f;
+			f->parent = index_a;
+			bvh_box_union(&a->box, &b->box, &f->box);
+			bvh_box_union(&c->box, &a->box, &g->box);
+			a->height = 1 + (b->height > f->height ? b->height : f->height);
+			c->height = 1 + (a->height > g->height ? a->height : g->height);
+		}
+		return index_c;
+	}
+
+	// Rotate b up
+	if(balance < -1)
+	{
+		int index_d = b->left;
+		int index_e = b->right;
+		struct Bvh_Node* d = &nodes[index_d];
+		struct Bvh_Node* e = &nodes[index_e];
+
+		b->left   = index_a;
+		b->parent = a->parent;
+		a->parent = index_b;
+
+		if(b->parent != BVH_NULL_NODE)
+		{
+			if(nodes[b->parent].left == index_a)
+				nodes[b->parent].left = index_b;
+			else
+				nodes[b->parent].right = index_b;
+		}
+		else
+		{
+			bvh->root = index_b;
+		}
+
+		if(d->height > e->height)
+		{
+			b->right  = index_d;
+			a->left   = index_e;
+			e->parent = index_a;
+			bvh_box_union(&a->box, &c->box, &e->box);
+			bvh_box_union(&b->box, &a->box, &d->box);
+			a->height = 1 + (c->height > e->height ? c->height : e->height);
+			b->height = 1 + (a->height > d->height ? a->height : d->height);
+		}
+		else
+		{
+			b->right  = index_e;
+			a->left   = index_d;
+			d->parent = index_a;
+			bvh_box_union(&a->box, &c->box, &d->box);
+			bvh_box_union(&b->box, &a->box, &e->box);
+			a->height = 1 + (c->height > d->height ? c->height : d->height);
+			b->height = 1 + (a->height > e->height ? a->height : e->height);
+		}
+		return index_b;
+	}
+
+	return index_a;
+}
+
+void bvh_box_union(struct Bounding_Box* out, const struct Bounding_Box* a, const struct Bounding_Box* b)
+{
+	out->min.x = a->min.x < b->min.x ? a->min.x : b->min.x;
+	out->min.y = a->min.y < b->min.y ? a->min.y : b->min.y;
+	out->min.z = a->min.z < b->min.z ? a->min.z : b->min.z;
+	out->max.x = a->max.x > b->max.x ? a->max.x : b->max.x;
+	out->max.y = a->max.y > b->max.y ? a->max.y : b->max.y;
+	out->max.z = a->max.z > b->max.z ? a->max.z : b->max.z;
+}
+
+void bvh_box_fatten(struct Bounding_Box* out, const struct Bounding_Box* box)
+{
+	vec3 margin = { BVH_FAT_MARGIN, BVH_FAT_MARGIN, BVH_FAT_MARGIN };
+	vec3_sub(&out->min, &box->min, &margin);
+	vec3_add(&out->max, &box->max, &margin);
+}
+
+float bvh_box_area(const struct Bounding_Box* box)
+{
+	float x = box->max.x - box->min.x;
+	float y = box->max.y - box->min.y;
+	float z = box->max.z - box->min.z;
+	return 2.f * (x * y + y * z + z * x);
+}
+
+bool bvh_box_contains(const struct Bounding_Box* outer, const struct Bounding_Box* inner)
+{
+	return outer->min.x <= inner->min.x && outer->min.y <= inner->min.y && outer->min.z <= inner->min.z &&
+		   outer->max.x >= inner->max.x && outer->max.y >= inner->max.y && outer->max.z >= inner->max.z;
+}
+
+/* Clips [tmin, tmax] against one slab of a box. Rays parallel to the slab only
+   pass if the origin is between its planes, which keeps the test conservative
+   compared to the leaf test in bv_intersect_bounding_box_ray */
+bool bvh_slab_clip(float min, float max, float origin, float inv_direction, float* tmin, float* tmax)
+{
+	if(isinf(inv_direction))
+		return origin >= min && origin <= max;
+
+	float t0 = (min - origin) * inv_direction;
+	float t1 = (max - origin) * inv_direction;
+	if(t0 > t1)
+	{
+		float temp = t0;
+		t0 = t1;
+		t1 = temp;
+	}
+
+	if(t0 > *tmin) *tmin = t0;
+	if(t1 < *tmax) *tmax = t1;
+	return *tmin <= *tmax;
+}
+
+/* The ray is treated as a line, like bv_intersect_bounding_box_ray, so boxes behind
+   the origin are hits too and the entry distance is negative for those */
+bool bvh_box_ray_entry(const struct Bounding_Box* box, const vec3* origin, const vec3* inv_direction, float* out_tmin)
+{
+	float tmin = -INFINITY;
+	float tmax = INFINITY;
+	if(!bvh_slab_clip(box->min.x, box->max.x, origin->x, inv_direction->x, &tmin, &tmax)) return false;
+	if(!bvh_slab_clip(box->min.y, box->max.y, origin->y, inv_direction->y, &tmin, &tmax)) return false;
+	if(!bvh_slab_clip(box->min.z, box->max.z, origin->z, inv_direction->z, &tmin, &tmax)) return false;
+
+	*out_tmin = tmin;
+	return true;
+}
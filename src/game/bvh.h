@@ -0,0 +1,43 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "../common/linmath.h"
+#include "../common/num_types.h"
+#include "bounding_volumes.h"
+
+struct Entity;
+
+#define BVH_NULL_NODE   -1
+#define BVH_FAT_MARGIN  0.25f // Leaf boxes are inflated by this much so that small movements don't touch the tree
+
+/* Called for every leaf whose box is hit by the ray, nearer subtrees are visited first.
+   Return the distance along the ray beyond which the rest of the tree can be skipped,
+   returning INFINITY keeps visiting every leaf that the ray touches */
+typedef float (*Bvh_Ray_Func)(struct Entity* entity, struct Ray* ray, void* user_data);
+
+struct Bvh_Node
+{
+	struct Bounding_Box box;
+	int                 parent; // Doubles as the next index in the free list when the node is unused
+	int                 left;
+	int                 right;
+	int                 height; // Leaves have a height of 0, free nodes have -1
+	struct Entity*      entity;
+};
+
+struct Bvh
+{
+	struct Bvh_Node* nodes;
+	int              root;
+	int              free_list;
+	int              num_leaves;
+};
+
+void bvh_init(struct Bvh* bvh);
+void bvh_destroy(struct Bvh* bvh);
+int  bvh_proxy_create(struct Bvh* bvh, struct Bounding_Box* box, struct Entity* entity); // Returns the leaf node index to be used as the proxy handle
+void bvh_proxy_destroy(struct Bvh* bvh, int proxy);
+bool bvh_proxy_move(struct Bvh* bvh, int proxy, struct Bounding_Box* box); // Returns true if the leaf had to be re-inserted
+void bvh_ray_query(struct Bvh* bvh, struct Ray* ray, Bvh_Ray_Func callback, void* user_data);
+
+#endif
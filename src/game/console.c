@@ -4,11 +4,14 @@
 #include "../common/log.h"
 #include "../system/platform.h"
 #include "scene.h"
+#include "scene_binary.h"
 #include "entity.h"
 #include "debug_vars.h"
 #include "../system/file_io.h"
 #include "event.h"
 #include "input.h"
+#include "profiler.h"
+#include "../common/memory_utils.h"
 
 #include <assert.h>
 #include <string.h>
@@ -23,11 +26,15 @@ static void console_command_scene_empty(struct Console* console, const char* com
 static void console_command_scene_save(struct Console* console, const char* command);
 static void console_command_scene_load(struct Console* console, const char* command);
 static void console_command_scene_reload(struct Console* console, const char* command);
+static void console_command_scene_compile(struct Console* console, const char* command);
 static void console_command_entity_save(struct Console* console, const char* command);
 static void console_command_entity_load(struct Console* console, const char* command);
 static void console_command_debug_vars_toggle(struct Console* console, const char* command);
 static void console_command_debug_vars_location_set(struct Console* console, const char* command);
 static void console_command_switch_camera(struct Console* console, const char* command);
+static void console_command_profiler_toggle(struct Console* console, const char* command);
+static void console_command_profiler_capture(struct Console* console, const char* command);
+static void console_command_mem(struct Console* console, const char* command);
 static void console_command_help(struct Console* console, const char* command);
 
 void console_init(struct Console* console)
@@ -63,11 +70,15 @@ void console_init(struct Console* console)
 	hashmap_ptr_set(console->commands, "scene_save", &console_command_scene_save);
 	hashmap_ptr_set(console->commands, "scene_load", &console_command_scene_load);
 	hashmap_ptr_set(console->commands, "scene_reload", &console_command_scene_reload);
+	hashmap_ptr_set(console->commands, "scene_compile", &console_command_scene_compile);
 	hashmap_ptr_set(console->commands, "entity_save", &console_command_entity_save);
 	hashmap_ptr_set(console->commands, "entity_load", &console_command_entity_load);
 	hashmap_ptr_set(console->commands, "debug_vars_toggle", &console_command_debug_vars_toggle);
 	hashmap_ptr_set(console->commands, "debug_vars_location", &console_command_debug_vars_location_set);
 	hashmap_ptr_set(console->commands, "switch_camera", &console_command_switch_camera);
+	hashmap_ptr_set(console->commands, "profiler_toggle", &console_command_profiler_toggle);
+	hashmap_ptr_set(console->commands, "profiler_capture", &console_command_profiler_capture);
+	hashmap_ptr_set(console->commands, "mem", &console_command_mem);
 	hashmap_ptr_set(console->commands, "help", &console_command_help);
 
 	struct Event_Manager* event_manager = game_state_get()->event_manager;
@@ -322,6 +333,23 @@ void console_command_scene_load(struct Console* console, const char* command)
 		log_error("scene_load", "Command failed");
 }
 
+void console_command_scene_compile(struct Console* console, const char* command)
+{
+	char filename[MAX_FILENAME_LEN];
+	memset(filename, '\0', MAX_FILENAME_LEN);
+
+	int params_read = sscanf(command, "%s", filename);
+	if(params_read != 1)
+	{
+		log_warning("Invalid parameters for command");
+		log_warning("Usage: scene_compile [file name]");
+		return;
+	}
+
+	if(!scene_binary_compile(filename, DIRT_INSTALL))
+		log_error("scene_compile", "Command failed");
+}
+
 void console_command_scene_empty(struct Console* console, const char* command)
 {
 	char filename[MAX_FILENAME_LEN];
@@ -368,3 +396,32 @@ void console_command_switch_camera(struct Console* console, const char* command)
 	struct Scene* scene = game_state_get()->scene;
 	scene->active_camera_index = scene->active_camera_index == CAM_GAME ? CAM_EDITOR : CAM_GAME;
 }
+
+void console_command_profiler_toggle(struct Console* console, const char* command)
+{
+	profiler_enabled_set(!profiler_enabled);
+	log_message("Profiler %s", profiler_enabled ? "enabled" : "disabled");
+}
+
+void console_command_profiler_capture(struct Console* console, const char* command)
+{
+	char filename[MAX_FILENAME_LEN];
+	memset(filename, '\0', MAX_FILENAME_LEN);
+
+	if(sscanf(command, "%s", filename) != 1)
+		strncpy(filename, "profile_capture.json", MAX_FILENAME_LEN);
+
+	if(!profiler_enabled)
+	{
+		log_warning("Profiler is not enabled, use profiler_toggle and let it run for a while first");
+		return;
+	}
+
+	if(!profiler_trace_write(filename, DIRT_USER))
+		log_error("profiler_capture", "Command failed");
+}
+
+void console_command_mem(struct Console* console, const char* command)
+{
+	memory_report_log();
+}
@@ -30,7 +30,7 @@ void door_init(struct Door* door, int mask)
 	door->close_position = 0.f;
 	door->state          = DOOR_CLOSED;
 
-	event_manager_subscribe_with_subscriber(event_manager, EVT_SCENE_LOADED, &door_on_scene_loaded, (void*)door);
+	door->scene_loaded_subscription = event_manager_subscribe_with_subscriber(event_manager, EVT_SCENE_LOADED, &door_on_scene_loaded, (void*)door);
 }
 
 void door_reset(struct Door* door)
@@ -39,7 +39,8 @@ void door_reset(struct Door* door)
 	door->speed = 0.f;
 
 	struct Event_Manager* event_manager = game_state_get()->event_manager;
-	event_manager_unsubscribe_with_subscriber(event_manager, EVT_SCENE_LOADED, &door_on_scene_loaded, (void*)door);
+	event_manager_unsubscribe_handle(event_manager, door->scene_loaded_subscription);
+	door->scene_loaded_subscription = EVENT_SUBSCRIPTION_HANDLE_INVALID;
 }
 
 struct Door* door_read(struct Parser_Object* object, const char* name, struct Entity* parent_entity)
@@ -48,11 +49,11 @@ struct Door* door_read(struct Parser_Object* object, const char* name, struct En
 	struct Scene* scene = game_state_get()->scene;
 
 	new_door = scene_door_create(scene, name, parent_entity, DOOR_KEY_MASK_NONE);
-	if(hashmap_value_exists(object->data, "door_speed"))          new_door->speed          = hashmap_float_get(object->data, "door_speed");
-	if(hashmap_value_exists(object->data, "door_state"))          new_door->state          = hashmap_int_get(object->data, "door_state");
-	if(hashmap_value_exists(object->data, "door_mask"))           new_door->mask           = hashmap_int_get(object->data, "door_mask");
-	if(hashmap_value_exists(object->data, "door_open_position"))  new_door->open_position  = hashmap_float_get(object->data, "door_open_position");
-	if(hashmap_value_exists(object->data, "door_close_position")) new_door->close_position = hashmap_float_get(object->data, "door_close_position");
+	if(parser_object_value_exists(object, "door_speed"))          new_door->speed          = parser_object_float_get(object, "door_speed");
+	if(parser_object_value_exists(object, "door_state"))          new_door->state          = parser_object_int_get(object, "door_state");
+	if(parser_object_value_exists(object, "door_mask"))           new_door->mask           = parser_object_int_get(object, "door_mask");
+	if(parser_object_value_exists(object, "door_open_position"))  new_door->open_position  = parser_object_float_get(object, "door_open_position");
+	if(parser_object_value_exists(object, "door_close_position")) new_door->close_position = parser_object_float_get(object, "door_close_position");
 
 	return new_door;
 
@@ -111,6 +111,7 @@ static void editor_window_settings_editor(struct nk_context* context, struct Edi
 static void editor_window_settings_scene(struct nk_context* context, struct Editor* editor, struct Game_State* game_state);
 static void editor_axis_set(struct Editor* editor, int axis);
 static void editor_entity_select(struct Editor* editor, struct Entity* entity);
+static struct Entity* editor_selected_entity_get(struct Editor* editor);
 static void editor_tool_set(struct Editor* editor, int mode);
 static void editor_tool_reset(struct Editor* editor);
 static void editor_scene_dialog(struct Editor* editor, struct nk_context* context);
@@ -126,8 +127,8 @@ void editor_init(struct Editor* editor)
 	editor->window_scene_dialog                = 0;
 	editor->window_entity_dialog               = 0;
 	editor->camera_looking_around              = 0;
-    editor->selected_entity                    = NULL;
-    editor->hovered_entity                     = NULL;
+    editor->selected_entity                    = ENTITY_HANDLE_NULL;
+    editor->hovered_entity                     = ENTITY_HANDLE_NULL;
     editor->top_panel_height                   = 30;
     editor->camera_turn_speed                  = 90.f;
     editor->camera_move_speed                  = 20.f;
@@ -181,7 +182,7 @@ void editor_init(struct Editor* editor)
 
 void editor_init_entities(struct Editor* editor)
 {
-	editor->selected_entity = NULL;
+	editor->selected_entity = ENTITY_HANDLE_NULL;
 	editor->cursor_entity = scene_static_mesh_create(game_state_get()->scene, "EDITOR_SELECTED_ENTITY_WIREFRAME", NULL, "cube.symbres", MAT_UNSHADED);
 	editor->cursor_entity->base.flags |= EF_TRANSIENT | EF_SKIP_RENDER | EF_HIDE_IN_EDITOR_SCENE_HIERARCHY | EF_IGNORE_RAYCAST;
 }
@@ -212,24 +213,25 @@ void editor_render(struct Editor* editor, struct Camera * active_camera)
 {
 	struct Game_State* game_state = game_state_get();
 	struct Renderer* renderer = game_state->renderer;
+	struct Entity* selected_entity = editor_selected_entity_get(editor);
 
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LEQUAL);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glEnable(GL_BLEND);
 
-	if(game_state->editor->selected_entity)
+	if(selected_entity)
 	{
 		/* Visualize entity specific state */
 		vec3 abs_pos;
 		quat abs_rot;
-		transform_get_absolute_position(editor->selected_entity, &abs_pos);
-		transform_get_absolute_rotation(editor->selected_entity, &abs_rot);
-		switch(editor->selected_entity->type)
+		transform_get_absolute_position(selected_entity, &abs_pos);
+		transform_get_absolute_rotation(selected_entity, &abs_rot);
+		switch(selected_entity->type)
 		{
 		case ET_LIGHT:
 		{
-			struct Light* light = (struct Light*)editor->selected_entity;
+			struct Light* light = (struct Light*)selected_entity;
 			if(light->type != LT_POINT)
 			{
 				struct Ray light_ray;
@@ -240,7 +242,7 @@ void editor_render(struct Editor* editor, struct Camera * active_camera)
 
 			if(light->type != LT_DIR)
 			{
-				quat rotation = editor->selected_entity->transform.rotation;
+				quat rotation = selected_entity->transform.rotation;
 				quat_axis_angle(&rotation, &UNIT_X, -90.f);
 				im_circle(light->radius, 30, false, abs_pos, rotation, editor->cursor_entity_color, 3);
 
@@ -259,7 +261,7 @@ void editor_render(struct Editor* editor, struct Camera * active_camera)
 		break;
 		case ET_SOUND_SOURCE:
 		{
-			struct Sound_Source* sound_source = (struct Sound_Source*)editor->selected_entity;
+			struct Sound_Source* sound_source = (struct Sound_Source*)selected_entity;
 			quat rot = { 0.f, 0.f, 0.f, 1.f };
 			quat_axis_angle(&rot, &UNIT_X, 90.f);
 			im_circle(sound_source->min_distance, 32, false, abs_pos, rot, editor->selected_entity_color, 5);
@@ -268,7 +270,7 @@ void editor_render(struct Editor* editor, struct Camera * active_camera)
 		break;
 		case ET_TRIGGER:
 		{
-			struct Trigger* trigger = (struct Trigger*)editor->selected_entity;
+			struct Trigger* trigger = (struct Trigger*)selected_entity;
 			vec3 extents = { 0.f };
 			vec3_sub(&extents, &trigger->base.derived_bounding_box.max, &trigger->base.derived_bounding_box.min);
 			im_box(extents.x, extents.y, extents.z, abs_pos, abs_rot, (vec4) { 1.f, 0.f, 0.f, 0.5f }, GDM_TRIANGLES, 5);
@@ -278,7 +280,7 @@ void editor_render(struct Editor* editor, struct Camera * active_camera)
 		
 		/* Draw bounding box for selected entity */
 		static vec3 vertices[24];
-		bv_bounding_box_vertices_get_line_visualization(&editor->selected_entity->derived_bounding_box, vertices);
+		bv_bounding_box_vertices_get_line_visualization(&selected_entity->derived_bounding_box, vertices);
 		for(int i = 0; i <= 22; i += 2)
 			im_line(vertices[i], vertices[i + 1], (vec3) { 0.f, 0.f, 0.f }, (quat) { 0.f, 0.f, 0.f, 1.f }, editor->cursor_entity_color, 3);
 
@@ -289,14 +291,14 @@ void editor_render(struct Editor* editor, struct Camera * active_camera)
 			shader_bind(renderer->debug_shader);
 			{
 				static mat4 mvp;
-				shader_set_uniform_vec4(renderer->debug_shader, "debug_color", &editor->cursor_entity_color);
+				shader_set_uniform(UT_VEC4, renderer->debug_uniform_color, &editor->cursor_entity_color);
 				struct Static_Mesh* mesh      = editor->cursor_entity;
-				struct Model*       model     = editor->selected_entity->type == ET_STATIC_MESH ? &((struct Static_Mesh*)editor->selected_entity)->model : &mesh->model;
+				struct Model*       model     = selected_entity->type == ET_STATIC_MESH ? &((struct Static_Mesh*)selected_entity)->model : &mesh->model;
 				struct Transform*   transform = &mesh->base.transform;
 				int                 geometry  = model->geometry_index;
 				mat4_identity(&mvp);
 				mat4_mul(&mvp, &active_camera->view_proj_mat, &transform->trans_mat);
-				shader_set_uniform_mat4(renderer->debug_shader, "mvp", &mvp);
+				shader_set_uniform(UT_MAT4, renderer->debug_uniform_mvp, &mvp);
 				geom_render(geometry, GDM_TRIANGLES);
 			}
 			shader_unbind();
@@ -305,22 +307,23 @@ void editor_render(struct Editor* editor, struct Camera * active_camera)
 	}
 
 	/* If cursor is hovering over an entity, draw it*/
-	if(editor->hovered_entity)
+	struct Entity* hovered_entity = scene_entity_handle_resolve(game_state->scene, editor->hovered_entity);
+	if(hovered_entity)
 	{
-		if(editor->hovered_entity->type == ET_STATIC_MESH)
+		if(hovered_entity->type == ET_STATIC_MESH)
 		{
 			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 			shader_bind(renderer->debug_shader);
 			{
 				static mat4 mvp;
-				shader_set_uniform_vec4(renderer->debug_shader, "debug_color", &editor->hovered_entity_color);
-				struct Static_Mesh* mesh      = editor->hovered_entity;
+				shader_set_uniform(UT_VEC4, renderer->debug_uniform_color, &editor->hovered_entity_color);
+				struct Static_Mesh* mesh      = hovered_entity;
 				struct Model*       model     = &mesh->model;
 				struct Transform*   transform = &mesh->base.transform;
 				int                 geometry  = model->geometry_index;
 				mat4_identity(&mvp);
 				mat4_mul(&mvp, &active_camera->view_proj_mat, &transform->trans_mat);
-				shader_set_uniform_mat4(renderer->debug_shader, "mvp", &mvp);
+				shader_set_uniform(UT_MAT4, renderer->debug_uniform_mvp, &mvp);
 				geom_render(geometry, GDM_TRIANGLES);
 			}
 			shader_unbind();
@@ -330,8 +333,8 @@ void editor_render(struct Editor* editor, struct Camera * active_camera)
 		{
 			vec3 abs_pos;
 			quat abs_rot;
-			transform_get_absolute_position(editor->hovered_entity, &abs_pos);
-			transform_get_absolute_rotation(editor->hovered_entity, &abs_rot);
+			transform_get_absolute_position(hovered_entity, &abs_pos);
+			transform_get_absolute_rotation(hovered_entity, &abs_rot);
 			im_sphere(1.f, abs_pos, abs_rot, editor->hovered_entity_color, GDM_TRIANGLES, 4);
 		}
 	}
@@ -353,9 +356,9 @@ void editor_render(struct Editor* editor, struct Camera * active_camera)
 	//Draw Grid
 	if(editor->grid_enabled)
 	{
-		if(editor->grid_relative && editor->selected_entity)
+		if(editor->grid_relative && selected_entity)
 		{
-			transform_get_absolute_position(editor->selected_entity, &position);
+			transform_get_absolute_position(selected_entity, &position);
 		}
 
 		im_begin(position, rotation, scale, editor->grid_color, GDM_LINES, 0);
@@ -387,8 +390,9 @@ void editor_update(struct Editor* editor, float dt)
 	if(editor->notification_timer > 0.f)
 		editor->notification_timer -= editor->notification_timer_speed * dt;
 
-	struct Game_State* game_state = game_state_get();
-	struct nk_context* context    = &game_state->gui_editor->context;
+	struct Game_State* game_state      = game_state_get();
+	struct nk_context* context         = &game_state->gui_editor->context;
+	struct Entity*     selected_entity = editor_selected_entity_get(editor);
 	int win_width = 0, win_height = 0;
 	window_get_drawable_size(game_state->window, &win_width, &win_height);
 	int half_width = win_width / 2, half_height = win_height / 2;
@@ -531,18 +535,19 @@ void editor_update(struct Editor* editor, float dt)
 			nk_flags alignment_flags_center = NK_TEXT_ALIGN_MIDDLE | NK_TEXT_ALIGN_CENTERED;
 			float tooltip_width = 250.f;
 
-			if(editor->hovered_entity)
+			struct Entity* hovered_entity = scene_entity_handle_resolve(game_state->scene, editor->hovered_entity);
+			if(hovered_entity)
 			{
 				if(nk_tooltip_begin(context, tooltip_width))
 				{
 					nk_layout_row_dynamic(context, 20, 2);
-					nk_label(context, "Hovered Entity: ", alignment_flags_left); nk_label_colored(context, editor->hovered_entity->name, alignment_flags_right, nk_rgba_fv(&editor->hovered_entity_color));
-					nk_label(context, "Hovered Entity Type: ", alignment_flags_left);   nk_label_colored(context, entity_type_name_get(editor->hovered_entity), alignment_flags_right, nk_rgba_fv(&editor->hovered_entity_color));
+					nk_label(context, "Hovered Entity: ", alignment_flags_left); nk_label_colored(context, hovered_entity->name, alignment_flags_right, nk_rgba_fv(&editor->hovered_entity_color));
+					nk_label(context, "Hovered Entity Type: ", alignment_flags_left);   nk_label_colored(context, entity_type_name_get(hovered_entity), alignment_flags_right, nk_rgba_fv(&editor->hovered_entity_color));
 					nk_tooltip_end(context);
 				}
 			}
 
-			if(editor->selected_entity && editor->current_axis != EDITOR_AXIS_NONE)
+			if(selected_entity && editor->current_axis != EDITOR_AXIS_NONE)
 			{
 				switch(editor->current_tool)
 				{
@@ -552,7 +557,7 @@ void editor_update(struct Editor* editor, float dt)
 					{
 						vec3 abs_pos_selected = { 0.f, 0.f, 0.f };
 						vec3 abs_pos_cursor = { 0.f, 0.f, 0.f };
-						transform_get_absolute_position(editor->selected_entity, &abs_pos_selected);
+						transform_get_absolute_position(selected_entity, &abs_pos_selected);
 						transform_get_absolute_position(editor->cursor_entity, &abs_pos_cursor);
 						nk_layout_row_dynamic(context, 20, 2);
 						nk_label(context, "Current Position: ", alignment_flags_left); nk_labelf_colored(context, alignment_flags_right, nk_rgba_fv(&editor->selected_entity_color), "%.1f %.1f %.1f", abs_pos_selected.x, abs_pos_selected.y, abs_pos_selected.z);
@@ -600,7 +605,7 @@ void editor_update(struct Editor* editor, float dt)
 							nk_layout_row_dynamic(context, 20, 2);
 							vec3 current_scale = { 1.f, 1.f, 1.f };
 							vec3 cursor_entity_scale = { 1.f, 1.f, 1.f };
-							vec3_assign(&current_scale, &editor->selected_entity->transform.scale);
+							vec3_assign(&current_scale, &selected_entity->transform.scale);
 							vec3_assign(&cursor_entity_scale, &editor->cursor_entity->base.transform.scale);
 							nk_label(context, "Current Scale: ", alignment_flags_left); nk_labelf_colored(context, alignment_flags_right, nk_rgba_fv(&editor->selected_entity_color), "%.1f %.1f %.1f", current_scale.x, current_scale.y, current_scale.z);
 							nk_label(context, "New Scale: ", alignment_flags_left);     nk_labelf_colored(context, alignment_flags_right, nk_rgba_fv(&editor->cursor_entity_color), "%.1f %.1f %.1f", cursor_entity_scale.x, cursor_entity_scale.y, cursor_entity_scale.z);
@@ -625,7 +630,7 @@ void editor_update(struct Editor* editor, float dt)
 		nk_label(context, "Selected: ", NK_TEXT_ALIGN_LEFT | NK_TEXT_ALIGN_MIDDLE);
 
 		nk_layout_row_push(context, 0.06f);
-		nk_label_colored(context, editor->selected_entity ? editor->selected_entity->name : "None", NK_TEXT_ALIGN_LEFT | NK_TEXT_ALIGN_MIDDLE, nk_rgba_fv(&editor->selected_entity_color));
+		nk_label_colored(context, selected_entity ? selected_entity->name : "None", NK_TEXT_ALIGN_LEFT | NK_TEXT_ALIGN_MIDDLE, nk_rgba_fv(&editor->selected_entity_color));
 
 		nk_layout_row_push(context, 0.1f);
 		nk_checkbox_label(context, "Snap to grid ", &editor->tool_snap_enabled);
@@ -670,7 +675,9 @@ void editor_update(struct Editor* editor, float dt)
 	if(editor->window_settings_editor) editor_window_settings_editor(context, editor, game_state);
 	if(editor->window_settings_scene) editor_window_settings_scene(context, editor, game_state);
 	
-	if(editor->tool_mesh_draw_enabled && editor->selected_entity)
+	// Windows above can change the selection
+	selected_entity = editor_selected_entity_get(editor);
+	if(editor->tool_mesh_draw_enabled && selected_entity)
 	{
 		switch(editor->current_tool)
 		{
@@ -875,6 +882,7 @@ void editor_on_mousebutton_release(const struct Event* event)
 	if(game_state->game_mode != GAME_MODE_EDITOR || game_state->console->visible)
 		return;
 
+	struct Entity* selected_entity = editor_selected_entity_get(editor);
 	if(editor->camera_looking_around)
 	{
 		input_mouse_mode_set(MM_NORMAL);
@@ -883,7 +891,7 @@ void editor_on_mousebutton_release(const struct Event* event)
 		platform_mouse_position_set(game_state_get()->window, width / 2, height / 2);
 		editor->camera_looking_around = false;
 
-		if(editor->selected_entity && editor->current_tool == EDITOR_TOOL_ROTATE && editor->previous_axis != EDITOR_AXIS_NONE)
+		if(selected_entity && editor->current_tool == EDITOR_TOOL_ROTATE && editor->previous_axis != EDITOR_AXIS_NONE)
 			editor_axis_set(editor, editor->previous_axis);
 	}
 
@@ -906,7 +914,7 @@ void editor_on_mousebutton_release(const struct Event* event)
 			struct Entity* intersected_entity = scene_ray_intersect_closest(scene, &ray, ERM_ALL);
 			if(intersected_entity)
 			{
-				if(intersected_entity != editor->selected_entity)
+				if(intersected_entity != selected_entity)
 					editor_entity_select(editor, intersected_entity);
 			}
 			else
@@ -918,7 +926,8 @@ void editor_on_mousebutton_release(const struct Event* event)
 		}
 	}
 
-	if(editor->selected_entity && event->mousebutton.button == MSB_LEFT && nk_item_is_any_active(&gui->context) == 0)
+	selected_entity = editor_selected_entity_get(editor);
+	if(selected_entity && event->mousebutton.button == MSB_LEFT && nk_item_is_any_active(&gui->context) == 0)
 	{
 		switch(editor->current_tool)
 		{
@@ -927,7 +936,7 @@ void editor_on_mousebutton_release(const struct Event* event)
 			{
 				//editor->picking_enabled = true;
 				//editor->tool_translate_allowed = false;
-				transform_copy(editor->selected_entity, editor->cursor_entity, false);
+				transform_copy(selected_entity, editor->cursor_entity, false);
 				//editor->draw_cursor_entity = false;
 			}
 			break;
@@ -936,7 +945,7 @@ void editor_on_mousebutton_release(const struct Event* event)
 			{
 				//editor->picking_enabled = true;
 				editor->tool_rotate_rotation_started = false;
-				transform_copy(editor->selected_entity, editor->cursor_entity, false);
+				transform_copy(selected_entity, editor->cursor_entity, false);
 				editor->tool_rotate_total_rotation = 0.f;
 				editor->tool_rotate_starting_rotation = 0.f;
 				editor->draw_cursor_entity = false;
@@ -947,7 +956,7 @@ void editor_on_mousebutton_release(const struct Event* event)
 			{
 				//editor->picking_enabled = true;
 				editor->tool_scale_started = false;
-				transform_copy(editor->selected_entity, editor->cursor_entity, false);
+				transform_copy(selected_entity, editor->cursor_entity, false);
 				vec3_fill(&editor->tool_scale_amount, 1.f, 1.f, 1.f);
 				editor->draw_cursor_entity = false;
 			}
@@ -974,7 +983,8 @@ void editor_on_mousebutton_press(const struct Event* event)
 	if(game_state->game_mode != GAME_MODE_EDITOR || nk_window_is_any_hovered(&gui->context) || game_state->console->visible)
 		return;
 
-	if(event->mousebutton.button == MSB_LEFT && editor->selected_entity)
+	struct Entity* selected_entity = editor_selected_entity_get(editor);
+	if(event->mousebutton.button == MSB_LEFT && selected_entity)
 	{
 		if(editor->current_tool == EDITOR_TOOL_ROTATE && editor->tool_rotate_allowed)
 		{
@@ -992,7 +1002,7 @@ void editor_on_mousebutton_press(const struct Event* event)
 	}
 
 	/* Cancel rotation on right mouse press */
-	if(event->mousebutton.button == MSB_RIGHT && editor->selected_entity && editor->current_tool == EDITOR_TOOL_ROTATE)
+	if(event->mousebutton.button == MSB_RIGHT && selected_entity && editor->current_tool == EDITOR_TOOL_ROTATE)
 		editor_tool_reset(editor);
 }
 
@@ -1004,6 +1014,7 @@ void editor_on_mousemotion(const struct Event* event)
 	if(game_state->game_mode != GAME_MODE_EDITOR || nk_window_is_any_hovered(&gui->context) || game_state->console->visible)
 		return;
 
+	struct Entity* selected_entity = editor_selected_entity_get(editor);
 	switch(editor->current_tool)
 	{
 	case EDITOR_TOOL_NORMAL:
@@ -1013,13 +1024,13 @@ void editor_on_mousemotion(const struct Event* event)
 	break;
 	case EDITOR_TOOL_TRANSLATE:
 	{
-		if(editor->selected_entity && editor->tool_translate_allowed)
+		if(selected_entity && editor->tool_translate_allowed)
 		{
 			struct Camera* editor_camera = &game_state->scene->cameras[CAM_EDITOR];
 			vec3 current_position = { 0.f, 0.f, 0.f };
 			vec3 cursor_entity_position;
 			vec3_assign(&cursor_entity_position, &editor->cursor_entity->base.transform.position);
-			transform_get_absolute_position(editor->selected_entity, &current_position);
+			transform_get_absolute_position(selected_entity, &current_position);
 			struct Ray cam_ray;
 			cam_ray = camera_screen_coord_to_ray(editor_camera, event->mousemotion.x, event->mousemotion.y);
 
@@ -1059,13 +1070,13 @@ void editor_on_mousemotion(const struct Event* event)
 	break;
 	case EDITOR_TOOL_ROTATE:
 	{
-		if(editor->selected_entity && editor->current_axis < EDITOR_AXIS_XZ)
+		if(selected_entity && editor->current_axis < EDITOR_AXIS_XZ)
 		{
 			struct Camera* editor_camera = &game_state->scene->cameras[CAM_EDITOR];
 			vec3 position = { 0.f, 0.f, 0.f };
 			vec3 scale = {1.f, 1.f, 1.f};
-			transform_get_absolute_position(editor->selected_entity, &position);
-			//transform_get_absolute_scale(editor->selected_entity, &scale);
+			transform_get_absolute_position(selected_entity, &position);
+			//transform_get_absolute_scale(selected_entity, &scale);
 			struct Ray cam_ray;
 			cam_ray = camera_screen_coord_to_ray(editor_camera, event->mousemotion.x, event->mousemotion.y);
 
@@ -1171,20 +1182,11 @@ void editor_on_mousemotion(const struct Event* event)
 		struct Camera* editor_camera = &scene->cameras[CAM_EDITOR];
 		struct Ray ray = camera_screen_coord_to_ray(editor_camera, event->mousemotion.x, event->mousemotion.y);
 		struct Entity* intersected_entity = scene_ray_intersect_closest(scene, &ray, ERM_ALL);
-		if(intersected_entity)
-		{
-			if(intersected_entity != editor->hovered_entity)
-				editor->hovered_entity = intersected_entity;
-		}
-		else
-		{
-			if(editor->hovered_entity)
-				editor->hovered_entity = NULL;
-		}
+		editor->hovered_entity = scene_entity_handle_get(scene, intersected_entity);
 	}
-	else if(editor->hovered_entity)
+	else
 	{
-		editor->hovered_entity = NULL;
+		editor->hovered_entity = ENTITY_HANDLE_NULL;
 	}
 }
 
@@ -1260,17 +1262,17 @@ void editor_on_key_release(const struct Event* event)
 
 	if(event->key.key == KEY_G) editor->grid_enabled = !editor->grid_enabled;
 
-	if(event->key.key == KEY_DELETE && editor->selected_entity)
+	struct Entity* selected_entity = editor_selected_entity_get(editor);
+	if(event->key.key == KEY_DELETE && selected_entity)
 	{
-		editor->selected_entity->flags |= EF_MARKED_FOR_DELETION;
+		selected_entity->flags |= EF_MARKED_FOR_DELETION;
 		editor_entity_select(editor, NULL);
-		if(editor->hovered_entity == editor->selected_entity)
-			editor->hovered_entity = NULL;
 	}
 
-	if(event->key.key == KEY_D && input_is_key_pressed(KEY_LCTRL) && editor->selected_entity && !editor->camera_looking_around)
+	selected_entity = editor_selected_entity_get(editor);
+	if(event->key.key == KEY_D && input_is_key_pressed(KEY_LCTRL) && selected_entity && !editor->camera_looking_around)
 	{
-		struct Entity* new_entity = scene_entity_duplicate(game_state->scene, editor->selected_entity);
+		struct Entity* new_entity = scene_entity_duplicate(game_state->scene, selected_entity);
 		if(new_entity)
 		{
 			editor_entity_select(editor, new_entity);
@@ -1312,19 +1314,21 @@ void editor_tool_set(struct Editor* editor, int tool)
 
 void editor_entity_select(struct Editor* editor, struct Entity* entity)
 {
-	if(!entity && editor->selected_entity) // Deselect
+	struct Scene*  scene           = game_state_get()->scene;
+	struct Entity* selected_entity = scene_entity_handle_resolve(scene, editor->selected_entity);
+	if(!entity && editor->selected_entity.index != -1) // Deselect, the handle may no longer resolve if the entity was removed
 	{
-		editor->selected_entity->flags &= ~EF_SELECTED_IN_EDITOR;
-		editor->selected_entity = NULL;
+		if(selected_entity) selected_entity->flags &= ~EF_SELECTED_IN_EDITOR;
+		editor->selected_entity = ENTITY_HANDLE_NULL;
 		editor_tool_reset(editor);
 	}
 	else if(entity) // Select
 	{
 		// Deselect already selected entity
-		if(editor->selected_entity && editor->selected_entity != entity)
+		if(selected_entity && selected_entity != entity)
 		{
-			editor->selected_entity->flags &= ~EF_SELECTED_IN_EDITOR;
-			editor->selected_entity = NULL;
+			selected_entity->flags &= ~EF_SELECTED_IN_EDITOR;
+			editor->selected_entity = ENTITY_HANDLE_NULL;
 		}
 
 		if(editor->current_tool == EDITOR_TOOL_TRANSLATE)
@@ -1334,15 +1338,21 @@ void editor_entity_select(struct Editor* editor, struct Entity* entity)
 			editor->draw_cursor_entity = true;
 		}
 		entity->flags |= EF_SELECTED_IN_EDITOR;
-		editor->selected_entity = entity;
-		transform_copy(editor->cursor_entity, editor->selected_entity, false);
+		editor->selected_entity = scene_entity_handle_get(scene, entity);
+		transform_copy(editor->cursor_entity, entity, false);
 	}
 }
 
+struct Entity* editor_selected_entity_get(struct Editor* editor)
+{
+	return scene_entity_handle_resolve(game_state_get()->scene, editor->selected_entity);
+}
+
 void editor_tool_reset(struct Editor* editor)
 {
-	if(editor->selected_entity)
-		transform_copy(editor->cursor_entity, editor->selected_entity, false);
+	struct Entity* selected_entity = editor_selected_entity_get(editor);
+	if(selected_entity)
+		transform_copy(editor->cursor_entity, selected_entity, false);
 	else
 		transform_reset(editor->cursor_entity);
 
@@ -1401,14 +1411,15 @@ void editor_on_key_press(const struct Event* event)
 
 void editor_axis_set(struct Editor* editor, int axis)
 {
+	struct Entity* selected_entity = editor_selected_entity_get(editor);
 	if(editor->current_axis != axis)
 	{
 		editor->previous_axis = editor->current_axis;
 		editor->current_axis = axis;
 
 		/* Reset tool position after axis has changed */
-		if(editor->selected_entity)
-			transform_copy(editor->cursor_entity, editor->selected_entity, false);
+		if(selected_entity)
+			transform_copy(editor->cursor_entity, selected_entity, false);
 
 		if(editor->current_tool == EDITOR_TOOL_ROTATE)
 		{
@@ -1452,8 +1463,8 @@ void editor_axis_set(struct Editor* editor, int axis)
 		editor->previous_axis = editor->current_axis;
 		editor->current_axis = EDITOR_AXIS_NONE;
 
-		if(editor->selected_entity)
-			transform_copy(editor->cursor_entity, editor->selected_entity, false);
+		if(selected_entity)
+			transform_copy(editor->cursor_entity, selected_entity, false);
 		
 		if(editor->current_tool == EDITOR_TOOL_SCALE)
 		{
@@ -1690,9 +1701,10 @@ void editor_show_entity_in_list(struct Editor* editor, struct nk_context* contex
 		else
 			entity->flags &= ~EF_SELECTED_IN_EDITOR;
 
-		if(editor->selected_entity && editor->selected_entity != entity)
+		struct Entity* selected_entity = editor_selected_entity_get(editor);
+		if(selected_entity && selected_entity != entity)
 			editor_entity_select(editor, entity);
-		else if(editor->selected_entity && editor->selected_entity == entity && !(entity->flags & EF_SELECTED_IN_EDITOR))
+		else if(selected_entity && selected_entity == entity && !(entity->flags & EF_SELECTED_IN_EDITOR))
 			editor_entity_select(editor, NULL);
 
 
@@ -1712,8 +1724,6 @@ void editor_show_entity_in_list(struct Editor* editor, struct nk_context* contex
 		{
 			entity->flags |= EF_MARKED_FOR_DELETION;
 			editor_entity_select(editor, NULL);
-			if(editor->hovered_entity == entity)
-				editor->hovered_entity = NULL;
 		}
 
 		if(nk_contextual_item_label(context, "Save", NK_TEXT_ALIGN_LEFT | NK_TEXT_ALIGN_MIDDLE))
@@ -1740,64 +1750,64 @@ void editor_window_scene_hierarchy(struct nk_context* context, struct Editor* ed
 
 			if(nk_tree_push(context, NK_TREE_TAB, "Cameras", NK_MAXIMIZED))
 			{
-				for(int i = 0; i < MAX_SCENE_CAMERAS; i++)       
+				for(int i = 0; i < MAX_SCENE_CAMERAS; i++)
 					editor_show_entity_in_list(editor, context, scene, &scene->cameras[i]);
 				nk_tree_pop(context);
 			}
 
 			if(nk_tree_push(context, NK_TREE_TAB, "Doors", NK_MAXIMIZED))
 			{
-				for(int i = 0; i < MAX_SCENE_DOORS; i++)      
-					editor_show_entity_in_list(editor, context, scene, &scene->doors[i]);
+				for(int i = 0; i < scene->doors.num_live; i++)
+					editor_show_entity_in_list(editor, context, scene, pool_live_at(&scene->doors, i));
 				nk_tree_pop(context);
 			}
 
 			if(nk_tree_push(context, NK_TREE_TAB, "Enemies", NK_MAXIMIZED))
 			{
-				for(int i = 0; i < MAX_SCENE_ENEMIES; i++)      
-					editor_show_entity_in_list(editor, context, scene, &scene->enemies[i]);
+				for(int i = 0; i < scene->enemies.num_live; i++)
+					editor_show_entity_in_list(editor, context, scene, pool_live_at(&scene->enemies, i));
 				nk_tree_pop(context);
 			}
 
 			if(nk_tree_push(context, NK_TREE_TAB, "Entities", NK_MAXIMIZED))
 			{
-				for(int i = 0; i < MAX_SCENE_ENTITIES; i++)      
-					editor_show_entity_in_list(editor, context, scene, &scene->entities[i]);
+				for(int i = 0; i < scene->entities.num_live; i++)
+					editor_show_entity_in_list(editor, context, scene, pool_live_at(&scene->entities, i));
 				nk_tree_pop(context);
 			}
 
 			if(nk_tree_push(context, NK_TREE_TAB, "Lights", NK_MAXIMIZED))
 			{
-				for(int i = 0; i < MAX_SCENE_LIGHTS; i++)        
-					editor_show_entity_in_list(editor, context, scene, &scene->lights[i]);
+				for(int i = 0; i < scene->lights.num_live; i++)
+					editor_show_entity_in_list(editor, context, scene, pool_live_at(&scene->lights, i));
 				nk_tree_pop(context);
 			}
 
 			if(nk_tree_push(context, NK_TREE_TAB, "Pickups", NK_MAXIMIZED))
 			{
-				for(int i = 0; i < MAX_SCENE_PICKUPS; i++)        
-					editor_show_entity_in_list(editor, context, scene, &scene->pickups[i]);
+				for(int i = 0; i < scene->pickups.num_live; i++)
+					editor_show_entity_in_list(editor, context, scene, pool_live_at(&scene->pickups, i));
 				nk_tree_pop(context);
 			}
 
 			if(nk_tree_push(context, NK_TREE_TAB, "Static Meshes", NK_MAXIMIZED))
 			{
-				for(int i = 0; i < MAX_SCENE_STATIC_MESHES; i++) 
-					editor_show_entity_in_list(editor, context, scene, &scene->static_meshes[i]);
+				for(int i = 0; i < scene->static_meshes.num_live; i++)
+					editor_show_entity_in_list(editor, context, scene, pool_live_at(&scene->static_meshes, i));
 				nk_tree_pop(context);
 			}
 
 			if(nk_tree_push(context, NK_TREE_TAB, "Sound Sources", NK_MAXIMIZED))
 			{
-				for(int i = 0; i < MAX_SCENE_SOUND_SOURCES; i++)
-					editor_show_entity_in_list(editor, context, scene, &scene->sound_sources[i]);
+				for(int i = 0; i < scene->sound_sources.num_live; i++)
+					editor_show_entity_in_list(editor, context, scene, pool_live_at(&scene->sound_sources, i));
 				nk_tree_pop(context);
 			}
 
 			if(nk_tree_push(context, NK_TREE_TAB, "Triggers", NK_MAXIMIZED))
 			{
-				for(int i = 0; i < MAX_SCENE_TRIGGERS; i++)      
-					editor_show_entity_in_list(editor, context, scene, &scene->triggers[i]);
+				for(int i = 0; i < scene->triggers.num_live; i++)
+					editor_show_entity_in_list(editor, context, scene, pool_live_at(&scene->triggers, i));
 				nk_tree_pop(context);
 			}
 
@@ -1818,10 +1828,10 @@ void editor_window_property_inspector(struct nk_context* context, struct Editor*
 	if(nk_begin(context, "Properties", nk_recti(win_width - 300, editor->top_panel_height, 300, 600), window_flags))
 	{
 		const int row_height = 20;
-		if(editor->selected_entity)
+		struct Entity* entity = editor_selected_entity_get(editor);
+		if(entity)
 		{
 			struct Scene* scene = game_state_get()->scene;
-			struct Entity* entity = editor->selected_entity;
 
 			struct Entity* parent_ent = entity->transform.parent;
 			nk_layout_row_dynamic(context, row_height + 5, 2);
@@ -1937,7 +1947,7 @@ void editor_window_property_inspector(struct nk_context* context, struct Editor*
 					vec3_fill(&entity->transform.position, 0.f, 0.f, 0.f);
 					vec3_fill(&entity->transform.scale, 1.f, 1.f, 1.f);
 					quat_fill(&entity->transform.rotation, 0.f, 0.f, 0.f, 1.f);
-					transform_update_transmat(entity);
+					transform_mark_dirty(entity);
 				}
 
 				nk_layout_row_dynamic(context, row_height, 1); nk_label(context, "Position", NK_TEXT_ALIGN_CENTERED);
@@ -1945,7 +1955,7 @@ void editor_window_property_inspector(struct nk_context* context, struct Editor*
 				transform_get_absolute_position(entity, &abs_pos);
 				//if(editor_widget_v3(context, &abs_pos, "#X", "#Y", "#Z", -FLT_MAX, FLT_MAX, 1.f, 1.f, row_height)) transform_set_position(entity, &abs_pos);
 				if(editor_widget_v3(context, &entity->transform.position, "#X", "#Y", "#Z", -FLT_MAX, FLT_MAX, 1.f, 1.f, row_height))
-					transform_update_transmat(entity);
+					transform_mark_dirty(entity);
 
 				nk_layout_row_dynamic(context, row_height, 1); nk_label(context, "Rotation", NK_TEXT_ALIGN_CENTERED);
 				vec3 rot_angles = { 0.f, 0.f, 0.f };
@@ -1972,7 +1982,7 @@ void editor_window_property_inspector(struct nk_context* context, struct Editor*
 
 				nk_layout_row_dynamic(context, row_height, 1); nk_label(context, "Scale", NK_TEXT_ALIGN_CENTERED);
 				if(editor_widget_v3(context, &entity->transform.scale, "#X", "#Y", "#Z", 0.1f, FLT_MAX, 1.f, 0.1f, row_height))
-					transform_update_transmat(entity);
+					transform_mark_dirty(entity);
 
 				if(nk_tree_push(context, NK_TREE_NODE, "Absolute Transform Values", NK_MINIMIZED))
 				{
@@ -2799,6 +2809,7 @@ void editor_entity_dialog(struct Editor* editor, struct nk_context* context)
 {
 	struct Game_State* game_state = game_state_get();
 	struct Scene* scene = game_state->scene;
+	struct Entity* selected_entity = editor_selected_entity_get(editor);
 	bool save = editor->entity_operation_save;
 	int row_height = 25;
 	int popup_x = 0;
@@ -2821,7 +2832,7 @@ void editor_entity_dialog(struct Editor* editor, struct nk_context* context)
 		if(nk_popup_begin(context, NK_POPUP_DYNAMIC, save ? "Save Entity" : "Load Entity", popup_flags, nk_recti(popup_x, popup_y, popup_width, popup_height)))
 		{
 			nk_layout_row_dynamic(context, row_height, 1);
-			if(save && !editor->selected_entity)
+			if(save && !selected_entity)
 			{
 				nk_label_colored(context, "Please select an entity first in order to save it", NK_TEXT_ALIGN_CENTERED | NK_TEXT_ALIGN_MIDDLE, nk_rgb_f(1.f, 1.f, 0.f));
 				if(nk_button_label(context, "OK"))
@@ -2840,8 +2851,8 @@ void editor_entity_dialog(struct Editor* editor, struct nk_context* context)
 				if(copy_entity_filename)
 				{
 					memset(entity_filename, '\0', MAX_FILENAME_LEN);
-					if(save && editor->selected_entity->archetype_index != -1)
-						strncpy(entity_filename, scene->entity_archetypes[editor->selected_entity->archetype_index], MAX_FILENAME_LEN);
+					if(save && selected_entity->archetype_index != -1)
+						strncpy(entity_filename, scene->entity_archetypes[selected_entity->archetype_index], MAX_FILENAME_LEN);
 				}
 
 				int entity_filename_flags = NK_EDIT_SIG_ENTER | NK_EDIT_GOTO_END_ON_ACTIVATE | NK_EDIT_FIELD | NK_EDIT_ALWAYS_INSERT_MODE;
@@ -2857,7 +2868,7 @@ void editor_entity_dialog(struct Editor* editor, struct nk_context* context)
 				{
 					if(save)
 					{
-						entity_save(editor->selected_entity, entity_filename, DIRT_INSTALL);
+						entity_save(selected_entity, entity_filename, DIRT_INSTALL);
 					}
 					else
 					{
@@ -2877,7 +2888,7 @@ void editor_entity_dialog(struct Editor* editor, struct nk_context* context)
 				{
 					if(save)
 					{
-						entity_save(editor->selected_entity, entity_filename, DIRT_INSTALL);
+						entity_save(selected_entity, entity_filename, DIRT_INSTALL);
 					}
 					else
 					{
@@ -2915,10 +2926,9 @@ void editor_entity_dialog(struct Editor* editor, struct nk_context* context)
 
 void editor_post_update(struct Editor* editor)
 {
-	if(editor->hovered_entity && !(editor->hovered_entity->flags & EF_ACTIVE))
-		editor->hovered_entity = NULL;
-
-	if(editor->selected_entity && !(editor->selected_entity->flags & EF_ACTIVE))
+	// Hovered and selected entities are held as handles and resolve to NULL once the entity is removed
+	// or deactivated, clear a stale selection so the tools are reset as well
+	if(editor->selected_entity.index != -1 && !editor_selected_entity_get(editor))
 		editor_entity_select(editor, NULL);
 }
 
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include "../common/linmath.h"
 #include "../common/limits.h"
+#include "entity.h"
 
 struct Camera;
 struct Entity;
@@ -20,9 +21,9 @@ struct Editor
 	int                 window_scene_dialog;
 	int                 window_entity_dialog;
 	int                 camera_looking_around;
-    struct Entity*      selected_entity;
+	struct Entity_Handle selected_entity;
 	struct Static_Mesh* cursor_entity;
-	struct Entity*      hovered_entity;
+	struct Entity_Handle hovered_entity;
 	vec4                hovered_entity_color;
 	vec4                cursor_entity_color;
 	bool                draw_cursor_entity;
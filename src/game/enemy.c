@@ -21,7 +21,7 @@
 
 
 static void enemy_on_scene_loaded(struct Event* event, void* enemy_ptr);
-static void enemy_update_physics_turret(struct Enemy* enemy, struct Game_State* game_state, float fixed_dt);
+static void enemy_update_physics_turret(struct Enemy* enemy, float fixed_dt, float ticks, struct Enemy_Physics_Result* result);
 static void enemy_update_ai_turret(struct Enemy* enemy, struct Game_State* game_state, float dt);
 static void enemy_state_set_turret(struct Enemy* enemy, int state);
 
@@ -89,7 +89,7 @@ void enemy_init(struct Enemy* enemy, int type)
 	}
 
 	struct Event_Manager* event_manager = game_state->event_manager;
-	event_manager_subscribe_with_subscriber(event_manager, EVT_SCENE_LOADED, &enemy_on_scene_loaded, (void*)enemy);
+	enemy->scene_loaded_subscription = event_manager_subscribe_with_subscriber(event_manager, EVT_SCENE_LOADED, &enemy_on_scene_loaded, (void*)enemy);
 }
 
 void enemy_weapon_sound_set(struct Enemy* enemy, const char* sound_filename, int type)
@@ -126,7 +126,7 @@ void enemy_update(struct Enemy* enemy, struct Scene* scene, float dt)
 		enemy->muzzle_light_mesh->base.transform.scale.x -= enemy->muzzle_light_intensity_decay * dt;
 		enemy->muzzle_light_mesh->base.transform.scale.y -= enemy->muzzle_light_intensity_decay * dt;
 		enemy->muzzle_light_mesh->base.transform.scale.z -= enemy->muzzle_light_intensity_decay * dt;
-		transform_update_transmat(enemy->muzzle_light_mesh);
+		transform_mark_dirty(enemy->muzzle_light_mesh);
 	}
 
 	// AI Update
@@ -147,14 +147,28 @@ void enemy_update(struct Enemy* enemy, struct Scene* scene, float dt)
 
 }
 
-void enemy_update_physics(struct Enemy* enemy, struct Scene* scene, float fixed_dt)
+void enemy_update_physics_compute(struct Enemy* enemy, float fixed_dt, float ticks, struct Enemy_Physics_Result* result)
 {
-	struct Game_State* game_state = game_state_get();
+	memset(result, 0, sizeof(*result));
 	switch(enemy->type)
 	{
-	case ENEMY_TURRET: enemy_update_physics_turret(enemy, game_state, fixed_dt); break;
+	case ENEMY_TURRET: enemy_update_physics_turret(enemy, fixed_dt, ticks, result); break;
+	}
+}
+
+void enemy_update_physics_apply(struct Enemy* enemy, const struct Enemy_Physics_Result* result)
+{
+	if(result->yaw != 0.f)
+		transform_rotate(enemy, &UNIT_Y, result->yaw, TS_LOCAL);
+
+	if(result->move_mesh)
+	{
+		vec3 mesh_position = result->mesh_position;
+		transform_set_position(enemy->mesh, &mesh_position);
 	}
 
+	if(result->has_difference)
+		debug_vars_show_float("Difference ", result->difference);
 }
 
 void enemy_reset(struct Enemy* enemy)
@@ -164,7 +178,8 @@ void enemy_reset(struct Enemy* enemy)
 	enemy->health = 0;
 
 	struct Event_Manager* event_manager = game_state_get()->event_manager;
-	event_manager_unsubscribe_with_subscriber(event_manager, EVT_SCENE_LOADED, &enemy_on_scene_loaded, (void*)enemy);
+	event_manager_unsubscribe_handle(event_manager, enemy->scene_loaded_subscription);
+	enemy->scene_loaded_subscription = EVENT_SUBSCRIPTION_HANDLE_INVALID;
 }
 
 struct Enemy* enemy_read(struct Parser_Object* object, const char* name, struct Entity* parent_entity)
@@ -173,36 +188,36 @@ struct Enemy* enemy_read(struct Parser_Object* object, const char* name, struct
 	struct Enemy* new_enemy = NULL;
 	struct Scene* scene = game_state_get()->scene;
 
-	if(hashmap_value_exists(object->data, "enemy_type")) enemy_type = hashmap_int_get(object->data, "enemy_type");
+	if(parser_object_value_exists(object, "enemy_type")) enemy_type = parser_object_int_get(object, "enemy_type");
 
 	if(enemy_type != -1)
 	{
 		new_enemy = scene_enemy_create(scene, name, parent_entity, enemy_type); // Create enemy with default values then read and update from file if necessary
 		if(!new_enemy)
 			return new_enemy;
-		if(hashmap_value_exists(object->data, "health"))                       new_enemy->health                       = hashmap_int_get(object->data, "health");
-		if(hashmap_value_exists(object->data, "damage"))                       new_enemy->damage                       = hashmap_int_get(object->data, "damage");
-		if(hashmap_value_exists(object->data, "hit_chance"))                   new_enemy->hit_chance                   = hashmap_int_get(object->data, "hit_chance");
-		if(hashmap_value_exists(object->data, "muzzle_light_intensity_decay")) new_enemy->muzzle_light_intensity_decay = hashmap_float_get(object->data, "muzzle_light_intensity_decay");
-		if(hashmap_value_exists(object->data, "muzzle_light_intensity_min"))   new_enemy->muzzle_light_intensity_min   = hashmap_int_get(object->data, "muzzle_light_intensity_min");
-		if(hashmap_value_exists(object->data, "muzzle_light_intensity_max"))   new_enemy->muzzle_light_intensity_max   = hashmap_int_get(object->data, "muzzle_light_intensity_max");
+		if(parser_object_value_exists(object, "health"))                       new_enemy->health                       = parser_object_int_get(object, "health");
+		if(parser_object_value_exists(object, "damage"))                       new_enemy->damage                       = parser_object_int_get(object, "damage");
+		if(parser_object_value_exists(object, "hit_chance"))                   new_enemy->hit_chance                   = parser_object_int_get(object, "hit_chance");
+		if(parser_object_value_exists(object, "muzzle_light_intensity_decay")) new_enemy->muzzle_light_intensity_decay = parser_object_float_get(object, "muzzle_light_intensity_decay");
+		if(parser_object_value_exists(object, "muzzle_light_intensity_min"))   new_enemy->muzzle_light_intensity_min   = parser_object_int_get(object, "muzzle_light_intensity_min");
+		if(parser_object_value_exists(object, "muzzle_light_intensity_max"))   new_enemy->muzzle_light_intensity_max   = parser_object_int_get(object, "muzzle_light_intensity_max");
 
 		switch(new_enemy->type)
 		{
 		case ENEMY_TURRET:
 		{
-			if(hashmap_value_exists(object->data, "turn_speed_default")) new_enemy->Turret.turn_speed_default = hashmap_float_get(object->data, "turn_speed_default");
-			if(hashmap_value_exists(object->data, "default_yaw")) new_enemy->Turret.default_yaw = hashmap_float_get(object->data, "default_yaw");
-			if(hashmap_value_exists(object->data, "max_yaw")) new_enemy->Turret.max_yaw = hashmap_float_get(object->data, "max_yaw");
-			if(hashmap_value_exists(object->data, "pulsate_speed_scale")) new_enemy->Turret.pulsate_speed_scale = hashmap_float_get(object->data, "pulsate_speed_scale");
-			if(hashmap_value_exists(object->data, "pulsate_height")) new_enemy->Turret.pulsate_height = hashmap_float_get(object->data, "pulsate_height");
-			if(hashmap_value_exists(object->data, "attack_cooldown")) new_enemy->Turret.attack_cooldown = hashmap_float_get(object->data, "attack_cooldown");
-			if(hashmap_value_exists(object->data, "alert_cooldown")) new_enemy->Turret.alert_cooldown = hashmap_float_get(object->data, "alert_cooldown");
-			if(hashmap_value_exists(object->data, "vision_range")) new_enemy->Turret.vision_range = hashmap_float_get(object->data, "vision_range");
-			if(hashmap_value_exists(object->data, "color_default")) new_enemy->Turret.color_default = hashmap_vec4_get(object->data, "color_default");
-			if(hashmap_value_exists(object->data, "color_alert")) new_enemy->Turret.color_alert = hashmap_vec4_get(object->data, "color_alert");
-			if(hashmap_value_exists(object->data, "color_attack")) new_enemy->Turret.color_attack = hashmap_vec4_get(object->data, "color_attack");
-			if(hashmap_value_exists(object->data, "turn_direction_positive")) new_enemy->Turret.yaw_direction_positive = hashmap_bool_get(object->data, "turn_direction_positive");
+			if(parser_object_value_exists(object, "turn_speed_default")) new_enemy->Turret.turn_speed_default = parser_object_float_get(object, "turn_speed_default");
+			if(parser_object_value_exists(object, "default_yaw")) new_enemy->Turret.default_yaw = parser_object_float_get(object, "default_yaw");
+			if(parser_object_value_exists(object, "max_yaw")) new_enemy->Turret.max_yaw = parser_object_float_get(object, "max_yaw");
+			if(parser_object_value_exists(object, "pulsate_speed_scale")) new_enemy->Turret.pulsate_speed_scale = parser_object_float_get(object, "pulsate_speed_scale");
+			if(parser_object_value_exists(object, "pulsate_height")) new_enemy->Turret.pulsate_height = parser_object_float_get(object, "pulsate_height");
+			if(parser_object_value_exists(object, "attack_cooldown")) new_enemy->Turret.attack_cooldown = parser_object_float_get(object, "attack_cooldown");
+			if(parser_object_value_exists(object, "alert_cooldown")) new_enemy->Turret.alert_cooldown = parser_object_float_get(object, "alert_cooldown");
+			if(parser_object_value_exists(object, "vision_range")) new_enemy->Turret.vision_range = parser_object_float_get(object, "vision_range");
+			if(parser_object_value_exists(object, "color_default")) new_enemy->Turret.color_default = parser_object_vec4_get(object, "color_default");
+			if(parser_object_value_exists(object, "color_alert")) new_enemy->Turret.color_alert = parser_object_vec4_get(object, "color_alert");
+			if(parser_object_value_exists(object, "color_attack")) new_enemy->Turret.color_attack = parser_object_vec4_get(object, "color_attack");
+			if(parser_object_value_exists(object, "turn_direction_positive")) new_enemy->Turret.yaw_direction_positive = parser_object_bool_get(object, "turn_direction_positive");
 		}
 		break;
 		}
@@ -285,7 +300,7 @@ void enemy_on_scene_loaded(struct Event* event, void* enemy_ptr)
 	}
 }
 
-void enemy_update_physics_turret(struct Enemy* enemy, struct Game_State* game_state, float fixed_dt)
+void enemy_update_physics_turret(struct Enemy* enemy, float fixed_dt, float ticks, struct Enemy_Physics_Result* result)
 {
 	/* Turning/Rotation */
 	if(enemy->Turret.scan)
@@ -310,8 +325,7 @@ void enemy_update_physics_turret(struct Enemy* enemy, struct Game_State* game_st
 			enemy->Turret.target_yaw = enemy->Turret.default_yaw + enemy->Turret.max_yaw;
 		}
 
-		if(yaw != 0.f)
-			transform_rotate(enemy, &UNIT_Y, yaw, TS_LOCAL);
+		result->yaw = yaw;
 	}
 	else
 	{
@@ -324,19 +338,18 @@ void enemy_update_physics_turret(struct Enemy* enemy, struct Game_State* game_st
 			if(current_yaw > enemy->Turret.target_yaw)
 				yaw *= -1.f;
 
-			transform_rotate(enemy, &UNIT_Y, yaw, TS_LOCAL);
+			result->yaw = yaw;
 		}
-		debug_vars_show_float("Difference ", difference);
+		result->has_difference = true;
+		result->difference     = difference;
 	}
 
 	/* Movement */
 	if(enemy->Turret.pulsate)
 	{
-		float ticks = (float)platform_ticks_get();
-		vec3 translation = { 0.f };
-		vec3_assign(&translation, &enemy->mesh->base.transform.position);
-		translation.y += sinf(TO_RADIANS(ticks * enemy->Turret.pulsate_speed_scale)) * enemy->Turret.pulsate_height * fixed_dt ;
-		transform_set_position(enemy->mesh, &translation);
+		result->move_mesh = true;
+		vec3_assign(&result->mesh_position, &enemy->mesh->base.transform.position);
+		result->mesh_position.y += sinf(TO_RADIANS(ticks * enemy->Turret.pulsate_speed_scale)) * enemy->Turret.pulsate_height * fixed_dt ;
 	}
 }
 
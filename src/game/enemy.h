@@ -1,6 +1,10 @@
 #ifndef ENEMY_H
 #define ENEMY_H
 
+#include "../common/linmath.h"
+
+#include <stdbool.h>
+
 struct Enemy;
 struct Scene;
 struct Parser_Object;
@@ -16,8 +20,19 @@ enum Turret_State
 	TURRET_STATE_MAX
 };
 
+// Changes worked out by enemy_update_physics_compute that have to be made on the main thread
+struct Enemy_Physics_Result
+{
+	float yaw;             // Degrees to turn around UNIT_Y, 0 leaves the rotation alone
+	bool  move_mesh;
+	vec3  mesh_position;
+	bool  has_difference;  // Turning towards a target, difference is shown in the debug vars
+	float difference;
+};
+
 void          enemy_init(struct Enemy* enemy, int type);
-void          enemy_update_physics(struct Enemy* enemy, struct Scene* scene, float dt);
+void          enemy_update_physics_compute(struct Enemy* enemy, float fixed_dt, float ticks, struct Enemy_Physics_Result* result); // Safe on worker threads, only writes state owned by this enemy
+void          enemy_update_physics_apply(struct Enemy* enemy, const struct Enemy_Physics_Result* result);
 void          enemy_update(struct Enemy* enemy, struct Scene* scene, float dt);
 void          enemy_reset(struct Enemy* enemy);
 struct Enemy* enemy_read(struct Parser_Object* object, const char* name, struct Entity* parent_entity);
@@ -34,6 +34,21 @@
 #define MAX_ENTITY_PROP_LEN      256
 #define MAX_LINE_LEN             512
 
+/* Archetype files are parsed once and the objects are kept around so every further instance
+   is read straight from memory. The cached objects are shared by all instances and are only
+   ever read, the typed getters convert text into a copy and never change the stored value */
+struct Entity_Archetype
+{
+	char           filename[MAX_FILENAME_LEN];
+	int            directory_type;
+	int64          modified_time;
+	struct Parser* parser;
+};
+
+static struct Entity_Archetype* entity_archetypes = NULL;
+
+static struct Parser* entity_archetype_parse(const char* filename, int directory_type);
+
 void entity_init(struct Entity* entity, const char* name, struct Entity* parent)
 {
 	assert(entity);
@@ -46,6 +61,7 @@ void entity_init(struct Entity* entity, const char* name, struct Entity* parent)
 	entity_bounding_box_reset(entity, false);
 	entity->derived_bounding_box.min = (vec3){ -0.5f, -0.5f, -0.5f };
 	entity->derived_bounding_box.max = (vec3){  0.5f,  0.5f,  0.5f };
+	entity->bvh_proxy                = BVH_NULL_NODE;
 	transform_init(entity, parent);
 }
 
@@ -83,6 +99,13 @@ void entity_update_derived_bounding_box(struct Entity* entity)
 		if(transformed_vertex.y > derived_box->max.y) derived_box->max.y = transformed_vertex.y;
 		if(transformed_vertex.z > derived_box->max.z) derived_box->max.z = transformed_vertex.z;
 	}
+
+	struct Scene* scene = game_state_get()->scene;
+	if(entity->bvh_proxy != BVH_NULL_NODE)
+		bvh_proxy_move(&scene->bvh, entity->bvh_proxy, derived_box);
+
+	if(entity->type == ET_STATIC_MESH)
+		bv_box_soa_set(&scene->static_mesh_bounds, entity->id, derived_box);
 }
 
 void entity_bounding_box_reset(struct Entity* entity, bool update_derived)
@@ -292,6 +315,7 @@ bool entity_save(struct Entity* entity, const char* filename, int directory_type
 	entity->archetype_index = scene_entity_archetype_add(game_state_get()->scene, filename);
     parser_free(parser);
 	fclose(entity_file);
+	entity_archetype_invalidate(filename); // Modification times only have a resolution of a second
 	return true;
 }
 
@@ -306,8 +330,8 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 		return NULL;
 	}
 
-	const char* name = hashmap_str_get(object->data, "name");
-	int type = hashmap_int_get(object->data, "type");
+	const char* name = parser_object_str_get(object, "name");
+	int type = parser_object_int_get(object, "type");
 	if(!name)
 	{
 		log_error("entity:read", "No entity name provided");
@@ -335,20 +359,20 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 		int fbo_height = -1;
 		struct Camera* camera = scene_camera_create(scene, name, parent_entity, 320, 240);
 		if(!camera) return new_entity;
-		if(hashmap_value_exists(object->data, "fov"))                camera->fov = hashmap_float_get(object->data, "fov");
-		if(hashmap_value_exists(object->data, "resizeable"))         camera->resizeable = hashmap_bool_get(object->data, "resizeable");
-		if(hashmap_value_exists(object->data, "zoom"))               camera->zoom = hashmap_float_get(object->data, "zoom");
-		if(hashmap_value_exists(object->data, "nearz"))              camera->nearz = hashmap_float_get(object->data, "nearz");
-		if(hashmap_value_exists(object->data, "farz"))               camera->farz = hashmap_float_get(object->data, "farz");
-		if(hashmap_value_exists(object->data, "ortho"))              camera->ortho = hashmap_bool_get(object->data, "ortho");
-		if(hashmap_value_exists(object->data, "has_fbo"))            has_fbo = hashmap_bool_get(object->data, "has_fbo");
-		if(hashmap_value_exists(object->data, "fbo_has_depth_tex"))  fbo_has_depth_tex = hashmap_bool_get(object->data, "fbo_has_depth_tex");
-		if(hashmap_value_exists(object->data, "fbo_has_render_tex")) fbo_has_render_tex = hashmap_bool_get(object->data, "fbo_has_render_tex");
-		if(hashmap_value_exists(object->data, "fbo_width"))          fbo_width = hashmap_int_get(object->data, "fbo_width");
-		if(hashmap_value_exists(object->data, "fbo_height"))         fbo_height = hashmap_int_get(object->data, "fbo_height");
-		if(hashmap_value_exists(object->data, "clear_color"))
+		if(parser_object_value_exists(object, "fov"))                camera->fov = parser_object_float_get(object, "fov");
+		if(parser_object_value_exists(object, "resizeable"))         camera->resizeable = parser_object_bool_get(object, "resizeable");
+		if(parser_object_value_exists(object, "zoom"))               camera->zoom = parser_object_float_get(object, "zoom");
+		if(parser_object_value_exists(object, "nearz"))              camera->nearz = parser_object_float_get(object, "nearz");
+		if(parser_object_value_exists(object, "farz"))               camera->farz = parser_object_float_get(object, "farz");
+		if(parser_object_value_exists(object, "ortho"))              camera->ortho = parser_object_bool_get(object, "ortho");
+		if(parser_object_value_exists(object, "has_fbo"))            has_fbo = parser_object_bool_get(object, "has_fbo");
+		if(parser_object_value_exists(object, "fbo_has_depth_tex"))  fbo_has_depth_tex = parser_object_bool_get(object, "fbo_has_depth_tex");
+		if(parser_object_value_exists(object, "fbo_has_render_tex")) fbo_has_render_tex = parser_object_bool_get(object, "fbo_has_render_tex");
+		if(parser_object_value_exists(object, "fbo_width"))          fbo_width = parser_object_int_get(object, "fbo_width");
+		if(parser_object_value_exists(object, "fbo_height"))         fbo_height = parser_object_int_get(object, "fbo_height");
+		if(parser_object_value_exists(object, "clear_color"))
 		{
-			vec4 color = hashmap_vec4_get(object->data, "clear_color");
+			vec4 color = parser_object_vec4_get(object, "clear_color");
 			vec4_assign(&camera->clear_color, &color);
 		}
 
@@ -374,16 +398,16 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 		struct Light* light = scene_light_create(scene, name, parent_entity, LT_POINT);
 		if(!light)
 			return new_entity;
-		if(hashmap_value_exists(object->data, "light_type"))  light->type        = hashmap_int_get(object->data, "light_type");
-		if(hashmap_value_exists(object->data, "outer_angle")) light->outer_angle = hashmap_float_get(object->data, "outer_angle");
-		if(hashmap_value_exists(object->data, "inner_angle")) light->inner_angle = hashmap_float_get(object->data, "inner_angle");
-		if(hashmap_value_exists(object->data, "falloff"))     light->falloff     = hashmap_float_get(object->data, "falloff");
-		if(hashmap_value_exists(object->data, "intensity"))   light->intensity   = hashmap_float_get(object->data, "intensity");
-		if(hashmap_value_exists(object->data, "depth_bias"))  light->depth_bias  = hashmap_float_get(object->data, "depth_bias");
-		if(hashmap_value_exists(object->data, "color"))       light->color       = hashmap_vec3_get(object->data, "color");
-		if(hashmap_value_exists(object->data, "cast_shadow")) light->cast_shadow = hashmap_bool_get(object->data, "cast_shadow");
-		if(hashmap_value_exists(object->data, "pcf_enabled")) light->pcf_enabled = hashmap_bool_get(object->data, "pcf_enabled");
-		if(hashmap_value_exists(object->data, "radius"))      light->radius      = hashmap_int_get(object->data, "radius");
+		if(parser_object_value_exists(object, "light_type"))  light->type        = parser_object_int_get(object, "light_type");
+		if(parser_object_value_exists(object, "outer_angle")) light->outer_angle = parser_object_float_get(object, "outer_angle");
+		if(parser_object_value_exists(object, "inner_angle")) light->inner_angle = parser_object_float_get(object, "inner_angle");
+		if(parser_object_value_exists(object, "falloff"))     light->falloff     = parser_object_float_get(object, "falloff");
+		if(parser_object_value_exists(object, "intensity"))   light->intensity   = parser_object_float_get(object, "intensity");
+		if(parser_object_value_exists(object, "depth_bias"))  light->depth_bias  = parser_object_float_get(object, "depth_bias");
+		if(parser_object_value_exists(object, "color"))       light->color       = parser_object_vec3_get(object, "color");
+		if(parser_object_value_exists(object, "cast_shadow")) light->cast_shadow = parser_object_bool_get(object, "cast_shadow");
+		if(parser_object_value_exists(object, "pcf_enabled")) light->pcf_enabled = parser_object_bool_get(object, "pcf_enabled");
+		if(parser_object_value_exists(object, "radius"))      light->radius      = parser_object_int_get(object, "radius");
 		new_entity = &light->base;
 	}
 	break;
@@ -395,21 +419,21 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 		struct Sound_Source_Buffer* default_source_buffer = sound_source->source_buffer;
 		uint default_source_instance = sound_source->source_instance;
 
-		if(hashmap_value_exists(object->data, "loop"))                   sound_source->loop             = hashmap_bool_get(object->data,  "loop");
-		if(hashmap_value_exists(object->data, "sound_min_distance"))     sound_source->min_distance     = hashmap_float_get(object->data, "sound_min_distance");
-		if(hashmap_value_exists(object->data, "sound_max_distance"))     sound_source->max_distance     = hashmap_float_get(object->data, "sound_max_distance");
-		if(hashmap_value_exists(object->data, "volume"))                 sound_source->volume           = hashmap_float_get(object->data, "volume");
-		if(hashmap_value_exists(object->data, "rolloff_factor"))         sound_source->rolloff_factor   = hashmap_float_get(object->data, "rolloff_factor");
-		if(hashmap_value_exists(object->data, "sound_type"))             sound_source->type             = hashmap_int_get(object->data,   "sound_type");
-		if(hashmap_value_exists(object->data, "sound_attenuation_type")) sound_source->attenuation_type = hashmap_int_get(object->data,   "sound_attenuation_type");
-		if(hashmap_value_exists(object->data, "source_filename"))
+		if(parser_object_value_exists(object, "loop"))                   sound_source->loop             = parser_object_bool_get(object, "loop");
+		if(parser_object_value_exists(object, "sound_min_distance"))     sound_source->min_distance     = parser_object_float_get(object, "sound_min_distance");
+		if(parser_object_value_exists(object, "sound_max_distance"))     sound_source->max_distance     = parser_object_float_get(object, "sound_max_distance");
+		if(parser_object_value_exists(object, "volume"))                 sound_source->volume           = parser_object_float_get(object, "volume");
+		if(parser_object_value_exists(object, "rolloff_factor"))         sound_source->rolloff_factor   = parser_object_float_get(object, "rolloff_factor");
+		if(parser_object_value_exists(object, "sound_type"))             sound_source->type             = parser_object_int_get(object, "sound_type");
+		if(parser_object_value_exists(object, "sound_attenuation_type")) sound_source->attenuation_type = parser_object_int_get(object, "sound_attenuation_type");
+		if(parser_object_value_exists(object, "source_filename"))
 		{
 			struct Sound* sound = game_state_get()->sound;
 			
-			sound_source->source_buffer = sound_source_buffer_create(sound, hashmap_str_get(object->data, "source_filename"), sound_source->type);
+			sound_source->source_buffer = sound_source_buffer_create(sound, parser_object_str_get(object, "source_filename"), sound_source->type);
 			if(sound_source->source_buffer)
 			{
-				bool paused = hashmap_value_exists(object->data, "paused") ? hashmap_bool_get(object->data, "paused") : false;
+				bool paused = parser_object_value_exists(object, "paused") ? parser_object_bool_get(object, "paused") : false;
 				if(!paused)
 				{
 					sound_source->source_instance = sound_source_instance_create(sound, sound_source->source_buffer, true);
@@ -432,7 +456,7 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 			}
 			else
 			{
-				log_error("Failed to create sound source from '%s'", hashmap_str_get(object->data, "source_filename"));
+				log_error("Failed to create sound source from '%s'", parser_object_str_get(object, "source_filename"));
 			}
 		}
 		else
@@ -446,8 +470,8 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 	{
 		const char* geometry_name = NULL;
 		int material_type = MAT_UNSHADED;
-		if(hashmap_value_exists(object->data, "geometry")) geometry_name = hashmap_str_get(object->data, "geometry");
-		if(hashmap_value_exists(object->data, "material")) material_type = hashmap_int_get(object->data, "material");
+		if(parser_object_value_exists(object, "geometry")) geometry_name = parser_object_str_get(object, "geometry");
+		if(parser_object_value_exists(object, "material")) material_type = parser_object_int_get(object, "material");
 		struct Static_Mesh* mesh = scene_static_mesh_create(scene, name, parent_entity, geometry_name, material_type);
 		if(!mesh)
 			return new_entity;
@@ -458,25 +482,25 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 		switch(model->material->type)
 		{
 		case MAT_BLINN:
-			if(hashmap_value_exists(object->data, "diffuse_texture"))
+			if(parser_object_value_exists(object, "diffuse_texture"))
 			{
-				const char* texture_name = hashmap_str_get(object->data, "diffuse_texture");
+				const char* texture_name = parser_object_str_get(object, "diffuse_texture");
 				model->material_params[MMP_DIFFUSE_TEX].val_int = texture_create_from_file(texture_name, TU_DIFFUSE);
 			}
-			if(hashmap_value_exists(object->data, "diffuse_color"))     model->material_params[MMP_DIFFUSE_COL].val_vec4        = hashmap_vec4_get(object->data, "diffuse_color");
-			if(hashmap_value_exists(object->data, "diffuse"))           model->material_params[MMP_DIFFUSE].val_float           = hashmap_float_get(object->data, "diffuse");
-			if(hashmap_value_exists(object->data, "specular"))          model->material_params[MMP_SPECULAR].val_float          = hashmap_float_get(object->data, "specular");
-			if(hashmap_value_exists(object->data, "specular_strength")) model->material_params[MMP_SPECULAR_STRENGTH].val_float = hashmap_float_get(object->data, "specular_strength");
-			if(hashmap_value_exists(object->data, "uv_scale"))          model->material_params[MMP_UV_SCALE].val_vec2           = hashmap_vec2_get(object->data, "uv_scale");
+			if(parser_object_value_exists(object, "diffuse_color"))     model->material_params[MMP_DIFFUSE_COL].val_vec4        = parser_object_vec4_get(object, "diffuse_color");
+			if(parser_object_value_exists(object, "diffuse"))           model->material_params[MMP_DIFFUSE].val_float           = parser_object_float_get(object, "diffuse");
+			if(parser_object_value_exists(object, "specular"))          model->material_params[MMP_SPECULAR].val_float          = parser_object_float_get(object, "specular");
+			if(parser_object_value_exists(object, "specular_strength")) model->material_params[MMP_SPECULAR_STRENGTH].val_float = parser_object_float_get(object, "specular_strength");
+			if(parser_object_value_exists(object, "uv_scale"))          model->material_params[MMP_UV_SCALE].val_vec2           = parser_object_vec2_get(object, "uv_scale");
 			break;
 		case MAT_UNSHADED:
-			if(hashmap_value_exists(object->data, "diffuse_color")) model->material_params[MMP_DIFFUSE_COL].val_vec4 = hashmap_vec4_get(object->data, "diffuse_color");
-			if(hashmap_value_exists(object->data, "diffuse_texture"))
+			if(parser_object_value_exists(object, "diffuse_color")) model->material_params[MMP_DIFFUSE_COL].val_vec4 = parser_object_vec4_get(object, "diffuse_color");
+			if(parser_object_value_exists(object, "diffuse_texture"))
 			{
-				const char* texture_name = hashmap_str_get(object->data, "diffuse_texture");
+				const char* texture_name = parser_object_str_get(object, "diffuse_texture");
 				model->material_params[MMP_DIFFUSE_TEX].val_int = texture_create_from_file(texture_name, TU_DIFFUSE);
 			}
-			if(hashmap_value_exists(object->data, "uv_scale")) model->material_params[MMP_UV_SCALE].val_vec2 = hashmap_vec2_get(object->data, "uv_scale");
+			if(parser_object_value_exists(object, "uv_scale")) model->material_params[MMP_UV_SCALE].val_vec2 = parser_object_vec2_get(object, "uv_scale");
 			break;
 		};
 	}
@@ -490,8 +514,8 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 	break;
 	case ET_TRIGGER:
 	{
-		int type          = hashmap_value_exists(object->data, "trigger_type") ? hashmap_int_get(object->data, "trigger_type") : TRIG_TOGGLE;
-		int mask          = hashmap_value_exists(object->data, "trigger_mask") ? hashmap_int_get(object->data, "trigger_mask") : TRIGM_ALL;
+		int type          = parser_object_value_exists(object, "trigger_type") ? parser_object_int_get(object, "trigger_type") : TRIG_TOGGLE;
+		int mask          = parser_object_value_exists(object, "trigger_mask") ? parser_object_int_get(object, "trigger_mask") : TRIGM_ALL;
 		struct Trigger* trigger = scene_trigger_create(scene, name, parent_entity, type, mask);
 		if(!trigger)
 			return new_entity;
@@ -523,9 +547,9 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 	quat rotation = { 0.f, 0.f, 0.f, 1.f };
 	vec3 scale    = { 1.f, 1.f, 1.f };
 
-	if(hashmap_value_exists(object->data, "position")) position = hashmap_vec3_get(object->data, "position");
-	if(hashmap_value_exists(object->data, "rotation")) rotation = hashmap_quat_get(object->data, "rotation");
-	if(hashmap_value_exists(object->data, "scale"))    scale = hashmap_vec3_get(object->data, "scale");
+	if(parser_object_value_exists(object, "position")) position = parser_object_vec3_get(object, "position");
+	if(parser_object_value_exists(object, "rotation")) rotation = parser_object_quat_get(object, "rotation");
+	if(parser_object_value_exists(object, "scale"))    scale = parser_object_vec3_get(object, "scale");
 
 	transform_set_position(new_entity, &position);
 	transform_scale(new_entity, &scale);
@@ -533,52 +557,110 @@ struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_e
 
 	if(new_entity->type != ET_STATIC_MESH)
 	{
-		if(hashmap_value_exists(object->data, "bounding_box_min")) new_entity->bounding_box.min = hashmap_vec3_get(object->data, "bounding_box_min");
-		if(hashmap_value_exists(object->data, "bounding_box_max")) new_entity->bounding_box.max = hashmap_vec3_get(object->data, "bounding_box_max");
+		if(parser_object_value_exists(object, "bounding_box_min")) new_entity->bounding_box.min = parser_object_vec3_get(object, "bounding_box_min");
+		if(parser_object_value_exists(object, "bounding_box_max")) new_entity->bounding_box.max = parser_object_vec3_get(object, "bounding_box_max");
 	}
 
-	if(hashmap_value_exists(object->data, "flags")) new_entity->flags = hashmap_uint_get(object->data, "flags");
+	if(parser_object_value_exists(object, "flags")) new_entity->flags = parser_object_uint_get(object, "flags");
 
-	transform_update_transmat(new_entity);
-	if(hashmap_value_exists(object->data, "archetype")) new_entity->archetype_index = scene_entity_archetype_add(scene, hashmap_str_get(object->data, "archetype"));
+	transform_mark_dirty(new_entity);
+	if(parser_object_value_exists(object, "archetype")) new_entity->archetype_index = scene_entity_archetype_add(scene, parser_object_str_get(object, "archetype"));
 
 	return new_entity;
 }
 
 struct Entity* entity_load(const char* filename, int directory_type, bool send_on_load_event)
 {
+	struct Parser* parser = entity_archetype_get(filename, directory_type);
+	if(!parser) return NULL;
+
+	return entity_load_objects(parser, filename, send_on_load_event);
+}
+
+void entity_archetype_cache_init(void)
+{
+	entity_archetypes = array_new(struct Entity_Archetype);
+}
+
+void entity_archetype_cache_cleanup(void)
+{
+	for(int i = 0; i < array_len(entity_archetypes); i++)
+		parser_free(entity_archetypes[i].parser);
+	array_free(entity_archetypes);
+	entity_archetypes = NULL;
+}
+
+struct Parser* entity_archetype_get(const char* filename, int directory_type)
+{
+	assert(filename);
+
 	char prefixed_filename[MAX_FILENAME_LEN + 16];
 	snprintf(prefixed_filename, MAX_FILENAME_LEN + 16, "entities/%s.symtres", filename);
-    FILE* entity_file = io_file_open(directory_type, prefixed_filename, "rb");
-	if(!entity_file)
+	int64 modified_time = 0;
+	io_file_modified_time_get(directory_type, prefixed_filename, &modified_time);
+
+	struct Entity_Archetype* archetype = NULL;
+	for(int i = 0; i < array_len(entity_archetypes); i++)
 	{
-		log_error("entity:load", "Failed to open entity file %s for reading", prefixed_filename);
-		return false;
+		if(strncmp(entity_archetypes[i].filename, filename, MAX_FILENAME_LEN) == 0)
+		{
+			archetype = &entity_archetypes[i];
+			break;
+		}
 	}
 
-	struct Parser* parsed_file = parser_load_objects(entity_file, prefixed_filename);
-	struct Entity* new_entity = false;
+	if(archetype && archetype->parser && archetype->directory_type == directory_type && archetype->modified_time == modified_time)
+		return archetype->parser;
 
-	if(!parsed_file)
+	struct Parser* parser = entity_archetype_parse(filename, directory_type);
+	if(!parser) return NULL;
+
+	if(!archetype)
 	{
-		log_error("entity:load", "Failed to parse file '%s' for entity definition", prefixed_filename);
-		fclose(entity_file);
-		return false;
+		archetype = array_grow(entity_archetypes, struct Entity_Archetype);
+		strncpy(archetype->filename, filename, MAX_FILENAME_LEN);
+		archetype->filename[MAX_FILENAME_LEN - 1] = '\0';
+		archetype->parser = NULL;
 	}
+	else if(archetype->parser)
+	{
+		log_message("Entity archetype %s changed on disk, reloading", filename);
+		parser_free(archetype->parser);
+	}
+	archetype->directory_type = directory_type;
+	archetype->modified_time  = modified_time;
+	archetype->parser         = parser;
+	return parser;
+}
 
-	if(array_len(parsed_file->objects) == 0)
+void entity_archetype_invalidate(const char* filename)
+{
+	for(int i = 0; i < array_len(entity_archetypes); i++)
 	{
-		log_error("entity:load", "No objects found in file %s", prefixed_filename);
-		parser_free(parsed_file);
-		fclose(entity_file);
-		return false;
+		struct Entity_Archetype* archetype = &entity_archetypes[i];
+		if(archetype->parser && strncmp(archetype->filename, filename, MAX_FILENAME_LEN) == 0)
+		{
+			parser_free(archetype->parser);
+			archetype->parser = NULL;
+			break;
+		}
+	}
+}
+
+struct Entity* entity_load_objects(struct Parser* parser, const char* filename, bool send_on_load_event)
+{
+	struct Entity* new_entity = NULL;
+	if(array_len(parser->objects) == 0)
+	{
+		log_error("entity:load_objects", "No objects found for entity %s", filename);
+		return NULL;
 	}
 
 	int num_entites_loaded = 0;
 	struct Entity* parent_entity = NULL;
-	for(int i = 0; i < array_len(parsed_file->objects); i++)
+	for(int i = 0; i < array_len(parser->objects); i++)
 	{
-		struct Parser_Object* object = &parsed_file->objects[i];
+		struct Parser_Object* object = &parser->objects[i];
 		if(object->type != PO_ENTITY) continue;
 
 		new_entity = entity_read(object, parent_entity);
@@ -594,11 +676,11 @@ struct Entity* entity_load(const char* filename, int directory_type, bool send_o
 			if(i != 0)
 				new_entity->flags |= EF_TRANSIENT;
 			num_entites_loaded++;
-			log_message("Entity %s loaded from %s", new_entity->name, prefixed_filename);
+			log_message("Entity %s loaded from %s", new_entity->name, filename);
 		}
 		else
 		{
-			log_error("entity:load", "Failed to load entity from %s", prefixed_filename);
+			log_error("entity:load_objects", "Failed to load entity from %s", filename);
 		}
 	}	
 
@@ -615,8 +697,6 @@ struct Entity* entity_load(const char* filename, int directory_type, bool send_o
 		event_manager_send_event_entity(event_manager, &on_scene_loaded_event, parent_entity);
 	}
 
-	parser_free(parsed_file);
-	fclose(entity_file);
 	return parent_entity;
 }
 
@@ -667,3 +747,22 @@ int entity_get_num_children_of_type(struct Entity* entity, int type, struct Enti
 	}
 	return found_count + 1;
 }
+
+static struct Parser* entity_archetype_parse(const char* filename, int directory_type)
+{
+	char prefixed_filename[MAX_FILENAME_LEN + 16];
+	snprintf(prefixed_filename, MAX_FILENAME_LEN + 16, "entities/%s.symtres", filename);
+	FILE* entity_file = io_file_open(directory_type, prefixed_filename, "rb");
+	if(!entity_file)
+	{
+		log_error("entity:load", "Failed to open entity file %s for reading", prefixed_filename);
+		return NULL;
+	}
+
+	struct Parser* parsed_file = parser_load_objects(entity_file, prefixed_filename);
+	fclose(entity_file);
+	if(!parsed_file)
+		log_error("entity:load", "Failed to parse file '%s' for entity definition", prefixed_filename);
+
+	return parsed_file;
+}
@@ -6,12 +6,15 @@
 #include "../system/sound.h"
 #include "bounding_volumes.h"
 #include "material.h"
+#include "event.h"
+#include "entity_handle.h"
 #include "../common/limits.h"
 
 
 struct Entity;
 struct Material_Param;
 struct Parser_Object;
+struct Parser;
 
 typedef void (*Trigger_Func)(struct Trigger* trigger);
 
@@ -123,13 +126,16 @@ struct Transform
     quat            rotation;
     mat4            trans_mat;
     bool            is_modified;
+    bool            is_dirty; // Local transform changed and trans_mat has not been rebuilt yet
     struct Entity*  parent;
     struct Entity** children;
 };
 
+#define ENTITY_HANDLE_NULL ((struct Entity_Handle){ .type = ET_NONE, .index = -1, .generation = 0 })
+
 struct Entity
 {
-    int                 id;
+    int                 id; // Slot inside the scene pool of the entity's type
     int                 type;
 	int                 archetype_index;
 	uint                flags;
@@ -137,6 +143,7 @@ struct Entity
 	struct Bounding_Box bounding_box;
 	struct Bounding_Box derived_bounding_box;
     struct Transform    transform;
+	int                 bvh_proxy; // Leaf in the scene's bvh, -1 if the entity is not in it
 };
 
 struct Model
@@ -234,20 +241,21 @@ struct Player
 
 struct Enemy
 {
-	struct Entity        base;
-	int                  type;
-	int                  health;
-	int                  damage;
-	int                  hit_chance;
-	int                  current_state;
-	float                muzzle_light_intensity_decay;
-	int                  muzzle_light_intensity_min;
-	int                  muzzle_light_intensity_max;
-	struct Static_Mesh*  muzzle_light_mesh;
-	struct Light*        muzzle_light;
-	struct Static_Mesh*  mesh;
-	struct Sound_Source* weapon_sound;
-	struct Sound_Source* ambient_sound;
+	struct Entity             base;
+	int                       type;
+	int                       health;
+	int                       damage;
+	int                       hit_chance;
+	int                       current_state;
+	float                     muzzle_light_intensity_decay;
+	int                       muzzle_light_intensity_min;
+	int                       muzzle_light_intensity_max;
+	struct Static_Mesh*       muzzle_light_mesh;
+	struct Light*             muzzle_light;
+	struct Static_Mesh*       mesh;
+	struct Sound_Source*      weapon_sound;
+	struct Sound_Source*      ambient_sound;
+	Event_Subscription_Handle scene_loaded_subscription;
 	union
 	{
 		struct
@@ -286,19 +294,20 @@ struct Trigger
 
 struct Door
 {
-	struct Entity        base;
-	int                  mask;
-	int                  state;
-	float                speed;
-	float                open_position;
-	float                close_position;
-	bool                 lock_sound_played;
-	struct Static_Mesh*  mesh;
-	struct Static_Mesh*  key_indicator_red;
-	struct Static_Mesh*  key_indicator_green;
-	struct Static_Mesh*  key_indicator_blue;
-	struct Sound_Source* sound;
-	struct Trigger*      trigger;
+	struct Entity             base;
+	int                       mask;
+	int                       state;
+	float                     speed;
+	float                     open_position;
+	float                     close_position;
+	bool                      lock_sound_played;
+	struct Static_Mesh*       mesh;
+	struct Static_Mesh*       key_indicator_red;
+	struct Static_Mesh*       key_indicator_green;
+	struct Static_Mesh*       key_indicator_blue;
+	struct Sound_Source*      sound;
+	struct Trigger*           trigger;
+	Event_Subscription_Handle scene_loaded_subscription;
 };
 
 struct Pickup
@@ -310,17 +319,24 @@ struct Pickup
 		int health;
 		int key_type;
 	};
-	float                spin_speed;
-	bool                 picked_up;
-	struct Static_Mesh*  mesh;
-	struct Trigger*      trigger;
-	struct Sound_Source* sound;
+	float                     spin_speed;
+	bool                      picked_up;
+	struct Static_Mesh*       mesh;
+	struct Trigger*           trigger;
+	struct Sound_Source*      sound;
+	Event_Subscription_Handle scene_loaded_subscription;
+	Event_Subscription_Handle trigger_subscription;
 };
 
 void           entity_init(struct Entity* entity, const char* name, struct Entity* parent);
 void           entity_reset(struct Entity* entity, int id);
 bool           entity_save(struct Entity* entity, const char* filename, int directory_type);
 struct Entity* entity_load(const char* filename, int directory_type, bool send_on_scene_load_event);
+struct Entity* entity_load_objects(struct Parser* parser, const char* filename, bool send_on_scene_load_event); // Same as entity_load but takes objects that have already been parsed from the archetype file
+void           entity_archetype_cache_init(void);
+void           entity_archetype_cache_cleanup(void);
+struct Parser* entity_archetype_get(const char* filename, int directory_type); // Parsed objects of entities/<filename>.symtres, the file is only read again when its modification time changes. Owned by the cache and shared by every instance so it must not be modified
+void           entity_archetype_invalidate(const char* filename);                // Makes the next entity_archetype_get read the file again
 bool           entity_write(struct Entity* entity, struct Parser_Object* object, bool write_transform);
 struct Entity* entity_read(struct Parser_Object* object, struct Entity* parent_entity);
 const char*    entity_type_name_get(struct Entity* entity);
@@ -0,0 +1,13 @@
+#ifndef ENTITY_HANDLE_H
+#define ENTITY_HANDLE_H
+
+/* Weak reference to an entity that can outlive it, resolve through the scene
+   every time it is used instead of holding on to the pointer */
+struct Entity_Handle
+{
+    int type;
+    int index;      // Slot inside the scene pool of the entity's type, -1 for a null handle
+    int generation;
+};
+
+#endif
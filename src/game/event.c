@@ -1,5 +1,7 @@
 #include "event.h"
 #include "../common/log.h"
+#include "../common/array.h"
+#include "../common/atomics.h"
 #include "game.h"
 
 #include <string.h>
@@ -7,140 +9,165 @@
 
 #include <SDL.h>
 
+#if defined(_MSC_VER)
+	#define EVENT_THREAD_LOCAL __declspec(thread)
+#else
+	#define EVENT_THREAD_LOCAL __thread
+#endif
+
+#define EVENT_HANDLE_SLOT_BITS 20
+#define EVENT_HANDLE_SLOT_MASK ((1u << EVENT_HANDLE_SLOT_BITS) - 1)
+#define EVENT_QUEUE_MASK       (MAX_QUEUED_EVENTS - 1)
+#define MAX_EVENT_DRAIN_PASSES 4 // Limits how many times over the end of tick queue can be refilled by handlers in one tick
+
+static EVENT_THREAD_LOCAL bool event_is_main_thread = false;
+
+static Event_Subscription_Handle event_manager_subscription_add(struct Event_Manager* event_manager, const struct Event_Subscription* new_subscription);
+static int                       event_manager_subscription_find(struct Event_Manager* event_manager, const struct Event_Subscription* match);
+static void                      event_manager_subscription_remove(struct Event_Manager* event_manager, int slot_index);
+static void                      event_manager_subscription_release(struct Event_Manager* event_manager, int slot_index);
+static void                      event_manager_dispatch(struct Event_Manager* event_manager, const struct Event* event);
+static void                      event_manager_dispatch_end(struct Event_Manager* event_manager);
+static void                      event_manager_dropped_report(struct Event_Manager* event_manager);
+static bool                      event_subscription_matches(const struct Event_Subscription* subscription, const struct Event_Subscription* match);
+static void                      event_queue_init(struct Event_Queue* queue);
+static bool                      event_queue_push(struct Event_Queue* queue, const struct Event* event);
+static bool                      event_queue_pop(struct Event_Queue* queue, struct Event* out_event);
+
 void event_manager_init(struct Event_Manager* event_manager)
 {
 	assert(event_manager);
 
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		memset(subscription, 0, sizeof(struct Event_Subscription));
-		subscription->event_type = EVT_NONE;
-		subscription->type = EST_NONE;
-	}
+	for(int i = 0; i < EVT_MAX; i++)
+		event_manager->subscriptions[i] = array_new(struct Event_Subscription);
+	event_manager->subscription_slots      = array_new(struct Event_Subscription_Slot);
+	event_manager->free_subscription_slots = array_new(int);
+	event_manager->pending_removals        = array_new(int);
+	event_manager->dispatch_depth          = 0;
+	event_manager->num_dropped             = 0;
+	event_queue_init(&event_manager->end_of_tick_queue);
+	event_queue_init(&event_manager->next_frame_queue);
+
+	// Handlers are only ever run on the thread that created the event manager
+	event_is_main_thread = true;
+}
 
-	for(int i = 0; i < MAX_EVENTS; i++)
-	{
-		struct Event* event = &event_manager->event_pool[i];
-		memset(event, '\0', sizeof(struct Event));
-		event->type = EVT_NONE;
-		event->sender = NULL;
-	}
+Event_Subscription_Handle event_manager_subscribe(struct Event_Manager* event_manager, int event_type, Event_Handler handler_func)
+{
+	assert(event_manager && event_type < EVT_MAX && event_type > EVT_NONE);
 
-	event_manager->sdl_event_id = SDL_RegisterEvents(1);
+	struct Event_Subscription subscription = { .type = EST_WITHOUT_OBJECTS, .event_type = event_type };
+	subscription.Subscription_Without_Objects.handler = handler_func;
+	return event_manager_subscription_add(event_manager, &subscription);
 }
 
-void event_manager_subscribe(struct Event_Manager* event_manager, int event_type, Event_Handler handler_func)
+Event_Subscription_Handle event_manager_subscribe_with_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Sender handler_func, void* sender)
+{
+	assert(event_manager && event_type < EVT_MAX && event_type > EVT_NONE && sender);
+
+	struct Event_Subscription subscription = { .type = EST_SENDER, .event_type = event_type };
+	subscription.Subscription_Sender.handler = handler_func;
+	subscription.Subscription_Sender.sender  = sender;
+	return event_manager_subscription_add(event_manager, &subscription);
+}
+
+Event_Subscription_Handle event_manager_subscribe_with_subscriber(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber handler_func, void* subscriber)
 {
 	assert(event_manager && event_type < EVT_MAX && event_type > EVT_NONE);
 
-	//Check if this handler/subscriber already exists
-	bool subscribed = false;
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		if(subscription->type == EST_WITHOUT_OBJECTS && subscription->event_type == event_type && subscription->Subscription_Without_Objects.handler == handler_func)
-		{
-			log_message("Already subscibed to %s event", event_name_get(event_type));
-			subscribed = true;
-			break;
-		}
-	}
+	struct Event_Subscription subscription = { .type = EST_SUBSCRIBER, .event_type = event_type };
+	subscription.Subscription_Subscriber.handler    = handler_func;
+	subscription.Subscription_Subscriber.subscriber = subscriber;
+	return event_manager_subscription_add(event_manager, &subscription);
+}
 
-	//Now that we've established that we are not subscribed already we find an empty slot and 
-	//create a new subscription there
-	if(!subscribed)
-	{
-		for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-		{
-			struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-			if(subscription->type == EST_NONE)
-			{
-				subscribed                                         = true;
-				subscription->type                                 = EST_WITHOUT_OBJECTS;
-				subscription->event_type                           = event_type;
-				subscription->Subscription_Without_Objects.handler = handler_func;
-				break;
-			}
-		}
-	}
+Event_Subscription_Handle event_manager_subscribe_with_subscriber_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber_Sender handler_func, void* subscriber, void* sender)
+{
+	assert(event_manager && event_type < EVT_MAX && event_type > EVT_NONE && sender && subscriber);
 
-	//if subscribed is still not true, it can only mean that all the existing slots are taken
-	//Show an error message in that case
-	if(!subscribed)
-		log_error("event_manager:subscribe", "Could not subscribe to %s event", event_name_get(event_type));
+	struct Event_Subscription subscription = { .type = EST_SUBSCRIBER_SENDER, .event_type = event_type };
+	subscription.Subscription_Subscriber_Sender.handler    = handler_func;
+	subscription.Subscription_Subscriber_Sender.sender     = sender;
+	subscription.Subscription_Subscriber_Sender.subscriber = subscriber;
+	return event_manager_subscription_add(event_manager, &subscription);
+}
+
+void event_manager_unsubscribe_handle(struct Event_Manager* event_manager, Event_Subscription_Handle handle)
+{
+	assert(event_manager);
+	if(handle == EVENT_SUBSCRIPTION_HANDLE_INVALID) return;
+
+	int    slot_index = (int)(handle & EVENT_HANDLE_SLOT_MASK) - 1;
+	uint32 generation = handle >> EVENT_HANDLE_SLOT_BITS;
+	if(slot_index < 0 || slot_index >= array_len(event_manager->subscription_slots)) return;
+
+	struct Event_Subscription_Slot* slot = &event_manager->subscription_slots[slot_index];
+	if(slot->event_type == EVT_NONE || slot->generation != generation) return; // Already unsubscribed
+	event_manager_subscription_remove(event_manager, slot_index);
 }
 
 void event_manager_unsubscribe(struct Event_Manager* event_manager, int event_type, Event_Handler handler_func)
 {
 	assert(event_manager && event_type < EVT_MAX);
 
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		if(subscription->type != EST_WITHOUT_OBJECTS) continue;
-		if(subscription->event_type == event_type && subscription->Subscription_Without_Objects.handler == handler_func)
-		{
-			subscription->Subscription_Without_Objects.handler = NULL;
-			subscription->event_type                           = EVT_NONE;
-			subscription->type                                 = EST_NONE;
-			break;
-		}
-	}
+	struct Event_Subscription match = { .type = EST_WITHOUT_OBJECTS, .event_type = event_type };
+	match.Subscription_Without_Objects.handler = handler_func;
+	int slot_index = event_manager_subscription_find(event_manager, &match);
+	if(slot_index != -1) event_manager_subscription_remove(event_manager, slot_index);
+}
+
+void event_manager_unsubscribe_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Sender handler_func, void* sender)
+{
+	assert(event_manager && event_type < EVT_MAX);
+
+	struct Event_Subscription match = { .type = EST_SENDER, .event_type = event_type };
+	match.Subscription_Sender.handler = handler_func;
+	match.Subscription_Sender.sender  = sender;
+	int slot_index = event_manager_subscription_find(event_manager, &match);
+	if(slot_index != -1) event_manager_subscription_remove(event_manager, slot_index);
 }
 
 void event_manager_unsubscribe_with_subscriber(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber handler_func, void* subscriber)
 {
 	assert(event_manager && event_type < EVT_MAX);
 
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		if(subscription->type != EST_SUBSCRIBER) continue;
-		if(subscription->event_type == event_type && 
-		   subscription->Subscription_Subscriber.handler == handler_func && 
-		   subscription->Subscription_Subscriber.subscriber == subscriber)
-		{
-			subscription->Subscription_Subscriber.handler    = NULL;
-			subscription->event_type                         = EVT_NONE;
-			subscription->type                               = EST_NONE;
-			subscription->Subscription_Subscriber.subscriber = NULL;
-			break;
-		}
-	}
+	struct Event_Subscription match = { .type = EST_SUBSCRIBER, .event_type = event_type };
+	match.Subscription_Subscriber.handler    = handler_func;
+	match.Subscription_Subscriber.subscriber = subscriber;
+	int slot_index = event_manager_subscription_find(event_manager, &match);
+	if(slot_index != -1) event_manager_subscription_remove(event_manager, slot_index);
 }
 
-void event_manager_send_event(struct Event_Manager* event_manager, struct Event* event)
+void event_manager_unsubscribe_with_subscriber_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber_Sender handler_func, void* subscriber, void* sender)
 {
-	assert(event_manager && event);
-
-	SDL_Event sdl_event;
-	SDL_memset(&sdl_event, 0, sizeof(sdl_event));
-	sdl_event.type = event_manager->sdl_event_id;
-	sdl_event.user.data1 = event;
-	int rc = SDL_PushEvent(&sdl_event);
-	if(rc != 1)
-	{
-		log_error("event_manager:send_event", "Could not push event, %s", event_name_get(event->type));
-	}
+	assert(event_manager && event_type < EVT_MAX);
+
+	struct Event_Subscription match = { .type = EST_SUBSCRIBER_SENDER, .event_type = event_type };
+	match.Subscription_Subscriber_Sender.handler    = handler_func;
+	match.Subscription_Subscriber_Sender.subscriber = subscriber;
+	match.Subscription_Subscriber_Sender.sender     = sender;
+	int slot_index = event_manager_subscription_find(event_manager, &match);
+	if(slot_index != -1) event_manager_subscription_remove(event_manager, slot_index);
 }
 
-struct Event* event_manager_create_new_event(struct Event_Manager* event_manager)
+bool event_manager_send_event(struct Event_Manager* event_manager, const struct Event* event, int delivery)
 {
-	struct Event* new_event = NULL;
-	for(int i = 0; i < MAX_EVENTS; i++)
+	assert(event_manager && event && event->type > EVT_NONE && event->type < EVT_MAX);
+
+	if(delivery == ED_IMMEDIATE && event_is_main_thread)
 	{
-		if(event_manager->event_pool[i].type == EVT_NONE)
-		{
-			new_event = &event_manager->event_pool[i];
-			break;
-		}
+		event_manager_dispatch(event_manager, event);
+		return true;
 	}
 
-	if(!new_event)
-		log_warning("Out of event slots, event pool full!");
-
-	return new_event;
+	struct Event_Queue* queue = delivery == ED_NEXT_FRAME ? &event_manager->next_frame_queue : &event_manager->end_of_tick_queue;
+	if(!event_queue_push(queue, event))
+	{
+		// Logging is not thread safe so dropped events are reported by the main thread when the queues are drained
+		atomic_uint32_add(&event_manager->num_dropped, 1);
+		return false;
+	}
+	return true;
 }
 
 void event_manager_poll_events(struct Event_Manager* event_manager)
@@ -149,6 +176,8 @@ void event_manager_poll_events(struct Event_Manager* event_manager)
 	struct Game_State* game_state = game_state_get();
 	while(SDL_PollEvent(&event) != 0)
 	{
+		struct Event new_event;
+		memset(&new_event, '\0', sizeof(new_event));
 		switch(event.type)
 		{
 		case SDL_QUIT:
@@ -156,172 +185,104 @@ void event_manager_poll_events(struct Event_Manager* event_manager)
 			break;
 		case SDL_KEYDOWN: case SDL_KEYUP:
 		{
-			int  scancode  = event.key.keysym.scancode;
-			int  key       = event.key.keysym.sym;
-			int  state     = event.key.state;
-			bool repeat    = event.key.repeat;
-			bool mod_ctrl  = (event.key.keysym.mod & KMOD_CTRL) ? true : false;
-			bool mod_shift = (event.key.keysym.mod & KMOD_SHIFT) ? true : false;
-			bool mod_alt   = (event.key.keysym.mod & KMOD_ALT) ? true : false;
-
-			struct Event* new_event = event_manager_create_new_event(event_manager);
-			new_event->type = event.type == SDL_KEYDOWN ? EVT_KEY_PRESSED : EVT_KEY_RELEASED;
-			new_event->key.key       = event.key.keysym.sym;
-			new_event->key.scancode  = event.key.keysym.scancode;
-			new_event->key.state     = event.key.state;
-			new_event->key.repeat    = event.key.repeat == 0 ? false : true;
-			new_event->key.mod_ctrl  = (event.key.keysym.mod & KMOD_CTRL) ? true : false;
-			new_event->key.mod_shift = (event.key.keysym.mod & KMOD_SHIFT) ? true : false;
-			new_event->key.mod_alt   = (event.key.keysym.mod & KMOD_ALT) ? true : false;
-			event_manager_send_event(event_manager, new_event);
-			//log_message("Key name : %s", SDL_GetKeyName(key));
+			new_event.type = event.type == SDL_KEYDOWN ? EVT_KEY_PRESSED : EVT_KEY_RELEASED;
+			new_event.key.key       = event.key.keysym.sym;
+			new_event.key.scancode  = event.key.keysym.scancode;
+			new_event.key.state     = event.key.state;
+			new_event.key.repeat    = event.key.repeat == 0 ? false : true;
+			new_event.key.mod_ctrl  = (event.key.keysym.mod & KMOD_CTRL) ? true : false;
+			new_event.key.mod_shift = (event.key.keysym.mod & KMOD_SHIFT) ? true : false;
+			new_event.key.mod_alt   = (event.key.keysym.mod & KMOD_ALT) ? true : false;
+			//log_message("Key name : %s", SDL_GetKeyName(new_event.key.key));
 			break;
 		}
 		case SDL_MOUSEBUTTONDOWN: case SDL_MOUSEBUTTONUP:
 		{
-			struct Event* new_event = event_manager_create_new_event(event_manager);
-			new_event->type = event.type == SDL_MOUSEBUTTONDOWN ? EVT_MOUSEBUTTON_PRESSED : EVT_MOUSEBUTTON_RELEASED;
-			new_event->mousebutton.button     = event.button.button;
-			new_event->mousebutton.state      = event.button.state;
-			new_event->mousebutton.num_clicks = event.button.clicks;
-			new_event->mousebutton.x          = event.button.x;
-			new_event->mousebutton.y          = event.button.y;
-			event_manager_send_event(event_manager, new_event);
+			new_event.type = event.type == SDL_MOUSEBUTTONDOWN ? EVT_MOUSEBUTTON_PRESSED : EVT_MOUSEBUTTON_RELEASED;
+			new_event.mousebutton.button     = event.button.button;
+			new_event.mousebutton.state      = event.button.state;
+			new_event.mousebutton.num_clicks = event.button.clicks;
+			new_event.mousebutton.x          = event.button.x;
+			new_event.mousebutton.y          = event.button.y;
 			break;
 		}
 		case SDL_MOUSEMOTION:
 		{
-			struct Event* new_event = event_manager_create_new_event(event_manager);
-			new_event->type = EVT_MOUSEMOTION;
-			new_event->mousemotion.xrel = event.motion.xrel;
-			new_event->mousemotion.yrel = event.motion.yrel;
-			new_event->mousemotion.x    = event.motion.x;
-			new_event->mousemotion.y    = event.motion.y;
-			event_manager_send_event(event_manager, new_event);
+			new_event.type = EVT_MOUSEMOTION;
+			new_event.mousemotion.xrel = event.motion.xrel;
+			new_event.mousemotion.yrel = event.motion.yrel;
+			new_event.mousemotion.x    = event.motion.x;
+			new_event.mousemotion.y    = event.motion.y;
 			break;
 		}
 		case SDL_MOUSEWHEEL:
 		{
-			struct Event* new_event = event_manager_create_new_event(event_manager);
-			new_event->type = EVT_MOUSEWHEEL;
-			new_event->mousewheel.x = event.wheel.x;
-			new_event->mousewheel.y = event.wheel.y;
-			event_manager_send_event(event_manager, new_event);
+			new_event.type = EVT_MOUSEWHEEL;
+			new_event.mousewheel.x = event.wheel.x;
+			new_event.mousewheel.y = event.wheel.y;
 			break;
 		}
 		case SDL_TEXTINPUT:
 		{
-			struct Event* new_event = event_manager_create_new_event(event_manager);
-			new_event->type = EVT_TEXT_INPUT;
-			memcpy(new_event->text_input.text, event.text.text, 32);
-			event_manager_send_event(event_manager, new_event);
+			new_event.type = EVT_TEXT_INPUT;
+			memcpy(new_event.text_input.text, event.text.text, 32);
 			break;
 		}
 		case SDL_WINDOWEVENT:
 		{
 			if(event.window.event == SDL_WINDOWEVENT_RESIZED)
 			{
-				struct Event* new_event = event_manager_create_new_event(event_manager);
-				new_event->type = EVT_WINDOW_RESIZED;
-				new_event->window_resize.width = event.window.data1;
-				new_event->window_resize.height = event.window.data2;
-				event_manager_send_event(event_manager, new_event);
-			}
-		}
-		break;
-		default:
-		{
-			if(event.type == event_manager->sdl_event_id)
-			{
-				struct Event* user_event = (struct Event*)event.user.data1;
-				//log_message("%s event", event_name_get(user_event->type));
-				for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-				{
-					struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-					if(subscription->type != EST_NONE && subscription->event_type == user_event->type)
-					{
-						switch(subscription->type)
-						{
-						case EST_WITHOUT_OBJECTS:
-							if(subscription->Subscription_Without_Objects.handler)
-								subscription->Subscription_Without_Objects.handler(user_event);
-							break;
-						case EST_SENDER:
-							if(subscription->Subscription_Sender.handler && user_event->sender == subscription->Subscription_Sender.sender)
-								subscription->Subscription_Sender.handler(user_event, subscription->Subscription_Sender.sender);
-							break;
-						case EST_SUBSCRIBER:
-							if(subscription->Subscription_Subscriber.handler)
-								subscription->Subscription_Subscriber.handler(user_event, subscription->Subscription_Subscriber.subscriber);
-							break;
-						case EST_SUBSCRIBER_SENDER:
-							if(subscription->Subscription_Subscriber_Sender.handler && user_event->sender == subscription->Subscription_Sender.sender)
-								subscription->Subscription_Subscriber_Sender.handler(user_event, subscription->Subscription_Subscriber_Sender.subscriber, subscription->Subscription_Subscriber_Sender.sender);
-							break;
-						}
-					}
-				}
-
-				//return event to the pool now that it is consumed
-				memset(user_event, '\0', sizeof(*user_event));
-				user_event->type = EVT_NONE;
-				user_event->sender = NULL;
+				new_event.type = EVT_WINDOW_RESIZED;
+				new_event.window_resize.width = event.window.data1;
+				new_event.window_resize.height = event.window.data2;
 			}
 		}
 		break;
 		}
+
+		// Os input is dispatched right away so handlers see it in the order it happened
+		if(new_event.type != EVT_NONE)
+			event_manager_dispatch(event_manager, &new_event);
 	}
+
+	// Only take what was queued before this point, anything the handlers send with
+	// ED_NEXT_FRAME while we are draining waits for the next frame
+	struct Event_Queue* queue = &event_manager->next_frame_queue;
+	uint32 num_queued = atomic_uint32_load(&queue->head) - queue->tail;
+	struct Event queued_event;
+	for(uint32 i = 0; i < num_queued && event_queue_pop(queue, &queued_event); i++)
+		event_manager_dispatch(event_manager, &queued_event);
+
+	event_manager_dropped_report(event_manager);
 }
 
-void event_manager_subscribe_with_subscriber(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber handler_func, void* subscriber)
+void event_manager_tick_end(struct Event_Manager* event_manager)
 {
-	assert(event_manager && event_type < EVT_MAX && event_type > EVT_NONE);
+	assert(event_is_main_thread);
 
-	//Check if this handler/subscriber already exists
-	bool subscribed = false;
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		if(subscription->type == EST_SUBSCRIBER && 
-		   subscription->event_type == event_type && 
-		   subscription->Subscription_Subscriber.handler == handler_func && 
-		   subscription->Subscription_Subscriber.subscriber == subscriber)
-		{
-			log_message("Already subscibed to %s event", event_name_get(event_type));
-			subscribed = true;
-			break;
-		}
-	}
-
-	//Now that we've established that we are not subscribed already we find an empty slot and 
-	//create a new subscription there
-	if(!subscribed)
-	{
-		for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-		{
-			struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-			if(subscription->type == EST_NONE)
-			{
-				subscribed                                       = true;
-				subscription->type                               = EST_SUBSCRIBER;
-				subscription->event_type                         = event_type;
-				subscription->Subscription_Subscriber.handler    = handler_func;
-				subscription->Subscription_Subscriber.subscriber = subscriber;
-				break;
-			}
-		}
-	}
+	// Events sent by handlers during the drain are delivered in the same tick, up to a limit
+	// so that handlers which keep sending events to each other cannot stall the frame
+	struct Event queued_event;
+	int max_events = MAX_QUEUED_EVENTS * MAX_EVENT_DRAIN_PASSES;
+	for(int i = 0; i < max_events && event_queue_pop(&event_manager->end_of_tick_queue, &queued_event); i++)
+		event_manager_dispatch(event_manager, &queued_event);
 
-	//if subscribed is still not true, it can only mean that all the existing slots are taken
-	//Show an error message in that case
-	if(!subscribed)
-		log_error("event_manager:subscribe_with_obejct", "Could not subscribe to %s event", event_name_get(event_type));
-	
+	event_manager_dropped_report(event_manager);
 }
 
 void event_manager_cleanup(struct Event_Manager* event_manager)
 {
-
+	for(int i = 0; i < EVT_MAX; i++)
+	{
+		array_free(event_manager->subscriptions[i]);
+		event_manager->subscriptions[i] = NULL;
+	}
+	array_free(event_manager->subscription_slots);
+	array_free(event_manager->free_subscription_slots);
+	array_free(event_manager->pending_removals);
+	event_manager->subscription_slots      = NULL;
+	event_manager->free_subscription_slots = NULL;
+	event_manager->pending_removals        = NULL;
 }
 
 const char* event_name_get(int event_type)
@@ -355,12 +316,13 @@ void event_manager_send_event_entity(struct Event_Manager* event_manager, struct
 {
 	// Check if this entity has a subscription, if it does,
 	// call the registered callback with this entity as the parameter to simulate an event
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
+	assert(event->type > EVT_NONE && event->type < EVT_MAX);
+	event_manager->dispatch_depth++;
+	struct Event_Subscription* subscriptions = event_manager->subscriptions[event->type];
+	for(int i = 0; i < array_len(subscriptions); i++)
 	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		if(subscription->type != EST_SUBSCRIBER) continue;
-
-		if(subscription->event_type == event->type && 
+		struct Event_Subscription* subscription = &subscriptions[i];
+		if(subscription->type == EST_SUBSCRIBER &&
 		   subscription->Subscription_Subscriber.subscriber == entity &&
 		   subscription->Subscription_Subscriber.handler)
 		{
@@ -368,140 +330,216 @@ void event_manager_send_event_entity(struct Event_Manager* event_manager, struct
 			break;
 		}
 	}
+	event_manager_dispatch_end(event_manager);
 }
 
-void event_manager_subscribe_with_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Sender handler_func, void* sender)
+static Event_Subscription_Handle event_manager_subscription_add(struct Event_Manager* event_manager, const struct Event_Subscription* new_subscription)
 {
-	assert(event_manager && event_type < EVT_MAX && event_type > EVT_NONE && sender);
+	//Check if this handler/subscriber/sender already exists, only subscriptions of the same event type need to be checked
+	int existing_slot = event_manager_subscription_find(event_manager, new_subscription);
+	if(existing_slot != -1)
+	{
+		log_message("Already subscibed to %s event", event_name_get(new_subscription->event_type));
+		return ((Event_Subscription_Handle)event_manager->subscription_slots[existing_slot].generation << EVENT_HANDLE_SLOT_BITS) | (Event_Subscription_Handle)(existing_slot + 1);
+	}
 
-	//Check if this handler/subscriber already exists
-	bool subscribed = false;
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
+	int slot_index = -1;
+	if(array_len(event_manager->free_subscription_slots) > 0)
+	{
+		slot_index = event_manager->free_subscription_slots[array_len(event_manager->free_subscription_slots) - 1];
+		array_pop(event_manager->free_subscription_slots);
+	}
+	else
 	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		if(subscription->type == EST_SENDER &&
-		   subscription->event_type == event_type &&
-		   subscription->Subscription_Sender.handler == handler_func &&
-		   subscription->Subscription_Sender.sender == sender)
+		if(array_len(event_manager->subscription_slots) >= (int)EVENT_HANDLE_SLOT_MASK)
 		{
-			log_message("Already subscibed to %s event", event_name_get(event_type));
-			subscribed = true;
-			break;
+			log_error("event_manager:subscribe", "Could not subscribe to %s event, out of subscription slots", event_name_get(new_subscription->event_type));
+			return EVENT_SUBSCRIPTION_HANDLE_INVALID;
 		}
+		struct Event_Subscription_Slot* new_slot = array_grow(event_manager->subscription_slots, struct Event_Subscription_Slot);
+		new_slot->generation = 0;
+		slot_index = array_len(event_manager->subscription_slots) - 1;
 	}
 
-	//Now that we've established that we are not subscribed already we find an empty slot and 
-	//create a new subscription there
-	if(!subscribed)
+	struct Event_Subscription* subscription = array_grow(event_manager->subscriptions[new_subscription->event_type], struct Event_Subscription);
+	*subscription      = *new_subscription;
+	subscription->slot = slot_index;
+
+	struct Event_Subscription_Slot* slot = &event_manager->subscription_slots[slot_index];
+	slot->event_type = new_subscription->event_type;
+	slot->index      = array_len(event_manager->subscriptions[new_subscription->event_type]) - 1;
+	return ((Event_Subscription_Handle)slot->generation << EVENT_HANDLE_SLOT_BITS) | (Event_Subscription_Handle)(slot_index + 1);
+}
+
+static int event_manager_subscription_find(struct Event_Manager* event_manager, const struct Event_Subscription* match)
+{
+	struct Event_Subscription* subscriptions = event_manager->subscriptions[match->event_type];
+	for(int i = 0; i < array_len(subscriptions); i++)
 	{
-		for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-		{
-			struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-			if(subscription->type == EST_NONE)
-			{
-				subscribed                                = true;
-				subscription->type                        = EST_SENDER;
-				subscription->event_type                  = event_type;
-				subscription->Subscription_Sender.handler = handler_func;
-				subscription->Subscription_Sender.sender  = sender;
-				break;
-			}
-		}
+		if(event_subscription_matches(&subscriptions[i], match))
+			return subscriptions[i].slot;
 	}
+	return -1;
+}
+
+static void event_manager_subscription_remove(struct Event_Manager* event_manager, int slot_index)
+{
+	struct Event_Subscription_Slot* slot = &event_manager->subscription_slots[slot_index];
 
-	//if subscribed is still not true, it can only mean that all the existing slots are taken
-	//Show an error message in that case
-	if(!subscribed)
-		log_error("event_manager:subscribe_with_sender", "Could not subscribe to %s event", event_name_get(event_type));
+	// Stale handles stop matching right away even if the slot is only released later
+	slot->generation = (slot->generation + 1) & (UINT32_MAX >> EVENT_HANDLE_SLOT_BITS);
+
+	if(event_manager->dispatch_depth > 0)
+	{
+		// Moving subscriptions around would make dispatch skip or repeat listeners so just
+		// mark this one dead, dispatch skips it and it is removed once dispatch is done
+		event_manager->subscriptions[slot->event_type][slot->index].type = EST_NONE;
+		array_push(event_manager->pending_removals, slot_index, int);
+		return;
+	}
+	event_manager_subscription_release(event_manager, slot_index);
 }
 
-void event_manager_subscribe_with_subscriber_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber_Sender handler_func, void* subscriber, void* sender)
+static void event_manager_subscription_release(struct Event_Manager* event_manager, int slot_index)
 {
-	assert(event_manager && event_type < EVT_MAX && event_type > EVT_NONE && sender && subscriber);
+	struct Event_Subscription_Slot* slot = &event_manager->subscription_slots[slot_index];
+	struct Event_Subscription* subscriptions = event_manager->subscriptions[slot->event_type];
+
+	// Swap with the last subscription of this event type and fix up the slot of the one that moved
+	int last_index = array_len(subscriptions) - 1;
+	if(slot->index != last_index)
+	{
+		subscriptions[slot->index] = subscriptions[last_index];
+		event_manager->subscription_slots[subscriptions[slot->index].slot].index = slot->index;
+	}
+	array_pop(event_manager->subscriptions[slot->event_type]);
+
+	slot->event_type = EVT_NONE;
+	slot->index      = -1;
+	array_push(event_manager->free_subscription_slots, slot_index, int);
+}
+
+static void event_manager_dispatch(struct Event_Manager* event_manager, const struct Event* event)
+{
+	if(event->type <= EVT_NONE || event->type >= EVT_MAX) return;
 
-	//Check if this handler/subscriber/sender already exists
-	bool subscribed = false;
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
+	event_manager->dispatch_depth++;
+	// Listeners added by a handler are not called for this event, the array is indexed every
+	// time since adding one may have reallocated it
+	int num_subscriptions = array_len(event_manager->subscriptions[event->type]);
+	for(int i = 0; i < num_subscriptions; i++)
 	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		if(subscription->type == EST_SUBSCRIBER_SENDER && 
-		   subscription->event_type == event_type && 
-		   subscription->Subscription_Subscriber_Sender.handler == handler_func && 
-		   subscription->Subscription_Subscriber_Sender.sender == sender &&
-		   subscription->Subscription_Subscriber_Sender.subscriber == subscriber)
+		struct Event_Subscription* subscription = &event_manager->subscriptions[event->type][i];
+		switch(subscription->type)
 		{
-			log_message("Already subscibed to %s event", event_name_get(event_type));
-			subscribed = true;
+		case EST_WITHOUT_OBJECTS:
+			if(subscription->Subscription_Without_Objects.handler)
+				subscription->Subscription_Without_Objects.handler(event);
+			break;
+		case EST_SENDER:
+			if(subscription->Subscription_Sender.handler && event->sender == subscription->Subscription_Sender.sender)
+				subscription->Subscription_Sender.handler(event, subscription->Subscription_Sender.sender);
+			break;
+		case EST_SUBSCRIBER:
+			if(subscription->Subscription_Subscriber.handler)
+				subscription->Subscription_Subscriber.handler(event, subscription->Subscription_Subscriber.subscriber);
+			break;
+		case EST_SUBSCRIBER_SENDER:
+			if(subscription->Subscription_Subscriber_Sender.handler && event->sender == subscription->Subscription_Subscriber_Sender.sender)
+				subscription->Subscription_Subscriber_Sender.handler(event, subscription->Subscription_Subscriber_Sender.subscriber, subscription->Subscription_Subscriber_Sender.sender);
 			break;
 		}
 	}
+	event_manager_dispatch_end(event_manager);
+}
 
-	//Now that we've established that we are not subscribed already we find an empty slot and 
-	//create a new subscription there
-	if(!subscribed)
+static void event_manager_dispatch_end(struct Event_Manager* event_manager)
+{
+	event_manager->dispatch_depth--;
+	if(event_manager->dispatch_depth > 0) return;
+
+	while(array_len(event_manager->pending_removals) > 0)
 	{
-		for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
-		{
-			struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-			if(subscription->type == EST_NONE)
-			{
-				subscribed                                              = true;
-				subscription->type                                      = EST_SUBSCRIBER_SENDER;
-				subscription->event_type                                = event_type;
-				subscription->Subscription_Subscriber_Sender.handler    = handler_func;
-				subscription->Subscription_Subscriber_Sender.sender     = sender;
-				subscription->Subscription_Subscriber_Sender.subscriber = subscriber;
-				break;
-			}
-		}
+		event_manager_subscription_release(event_manager, *array_get_last(event_manager->pending_removals, int));
+		array_pop(event_manager->pending_removals);
 	}
+}
 
-	//if subscribed is still not true, it can only mean that all the existing slots are taken
-	//Show an error message in that case
-	if(!subscribed)
-		log_error("event_manager:subscribe_with_sender", "Could not subscribe to %s event", event_name_get(event_type));
+static void event_manager_dropped_report(struct Event_Manager* event_manager)
+{
+	uint32 num_dropped = atomic_uint32_exchange(&event_manager->num_dropped, 0);
+	if(num_dropped > 0)
+		log_error("event_manager:send_event", "Dropped %u events, event queue full", num_dropped);
 }
 
-void event_manager_unsubscribe_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Sender handler_func, void* sender)
+static bool event_subscription_matches(const struct Event_Subscription* subscription, const struct Event_Subscription* match)
 {
-	assert(event_manager && event_type < EVT_MAX);
+	if(subscription->type != match->type) return false;
 
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
+	switch(subscription->type)
 	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		if(subscription->type != EST_SENDER) continue;
-		if(subscription->event_type == event_type && 
-		   subscription->Subscription_Sender.handler == handler_func && 
-		   subscription->Subscription_Sender.sender == sender)
-		{
-			subscription->event_type                  = EVT_NONE;
-			subscription->type                        = EST_NONE;
-			subscription->Subscription_Sender.handler = NULL;
-			subscription->Subscription_Sender.sender  = NULL;
-			break;
-		}
+	case EST_WITHOUT_OBJECTS:
+		return subscription->Subscription_Without_Objects.handler == match->Subscription_Without_Objects.handler;
+	case EST_SENDER:
+		return subscription->Subscription_Sender.handler == match->Subscription_Sender.handler &&
+			   subscription->Subscription_Sender.sender  == match->Subscription_Sender.sender;
+	case EST_SUBSCRIBER:
+		return subscription->Subscription_Subscriber.handler    == match->Subscription_Subscriber.handler &&
+			   subscription->Subscription_Subscriber.subscriber == match->Subscription_Subscriber.subscriber;
+	case EST_SUBSCRIBER_SENDER:
+		return subscription->Subscription_Subscriber_Sender.handler    == match->Subscription_Subscriber_Sender.handler &&
+			   subscription->Subscription_Subscriber_Sender.subscriber == match->Subscription_Subscriber_Sender.subscriber &&
+			   subscription->Subscription_Subscriber_Sender.sender     == match->Subscription_Subscriber_Sender.sender;
 	}
+	return false;
 }
 
-void event_manager_unsubscribe_with_subscriber_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber_Sender handler_func, void* subscriber, void* sender)
+static void event_queue_init(struct Event_Queue* queue)
 {
-	assert(event_manager && event_type < EVT_MAX);
+	for(uint32 i = 0; i < MAX_QUEUED_EVENTS; i++)
+		queue->slots[i].sequence = i;
+	queue->head = 0;
+	queue->tail = 0;
+}
 
-	for(int i = 0; i < MAX_EVENT_SUBSCRIPTIONS; i++)
+static bool event_queue_push(struct Event_Queue* queue, const struct Event* event)
+{
+	// A slot is free for position p when its sequence equals p, producers race to move the head
+	// past it and whoever wins owns the slot until it publishes the event by storing p + 1
+	uint32 position = atomic_uint32_load(&queue->head);
+	struct Event_Queue_Slot* slot = NULL;
+	while(true)
 	{
-		struct Event_Subscription* subscription = &event_manager->event_subsciptions[i];
-		if(subscription->type != EST_SUBSCRIBER_SENDER) continue;
-		if(subscription->event_type == event_type && 
-		   subscription->Subscription_Subscriber_Sender.handler == handler_func && 
-		   subscription->Subscription_Subscriber_Sender.subscriber == subscriber &&
-		   subscription->Subscription_Subscriber_Sender.sender == sender)
+		slot = &queue->slots[position & EVENT_QUEUE_MASK];
+		int32 difference = (int32)(atomic_uint32_load(&slot->sequence) - position);
+		if(difference == 0)
 		{
-			subscription->event_type                                = EVT_NONE;
-			subscription->type                                      = EST_NONE;
-			subscription->Subscription_Subscriber_Sender.handler    = NULL;
-			subscription->Subscription_Subscriber_Sender.subscriber = NULL;
-			subscription->Subscription_Subscriber_Sender.sender     = NULL;
-			break;
+			if(atomic_uint32_compare_exchange(&queue->head, &position, position + 1))
+				break;
+		}
+		else if(difference < 0)
+		{
+			return false; // Slot has not been read yet since the last time around, queue is full
+		}
+		else
+		{
+			position = atomic_uint32_load(&queue->head);
 		}
 	}
+
+	slot->event = *event;
+	atomic_uint32_store(&slot->sequence, position + 1);
+	return true;
+}
+
+static bool event_queue_pop(struct Event_Queue* queue, struct Event* out_event)
+{
+	struct Event_Queue_Slot* slot = &queue->slots[queue->tail & EVENT_QUEUE_MASK];
+	if(atomic_uint32_load(&slot->sequence) != queue->tail + 1)
+		return false; // Empty, or the producer that claimed this slot has not finished writing it
+
+	*out_event = slot->event;
+	atomic_uint32_store(&slot->sequence, queue->tail + MAX_QUEUED_EVENTS);
+	queue->tail++;
+	return true;
 }
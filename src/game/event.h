@@ -4,15 +4,23 @@
 #include "../common/linmath.h"
 #include "../common/num_types.h"
 #include "../common/limits.h"
+#include "entity_handle.h"
 
 struct Entity;
 struct Trigger;
+struct Event;
 
 typedef void (*Event_Handler) (const struct Event* event);
 typedef void (*Event_Handler_Sender) (const struct Event* event, void* sender);
 typedef void (*Event_Handler_Subscriber) (const struct Event* event, void* subscriber);
 typedef void (*Event_Handler_Subscriber_Sender) (const struct Event* event, void* subscriber, void* sender);
 
+/* Returned by the subscribe functions and can be used to unsubscribe without searching.
+   Handles go stale once the subscription is removed so unsubscribing twice is harmless */
+typedef uint32 Event_Subscription_Handle;
+
+#define EVENT_SUBSCRIPTION_HANDLE_INVALID 0
+
 
 enum Event_Types
 {
@@ -35,6 +43,13 @@ enum Event_Types
 	EVT_MAX
 };
 
+enum Event_Delivery
+{
+	ED_IMMEDIATE = 0, // Handlers run before event_manager_send_event returns. Only on the main thread, other threads get ED_END_OF_TICK instead
+	ED_END_OF_TICK,   // Handlers run in event_manager_tick_end once the game has been updated for this frame
+	ED_NEXT_FRAME     // Handlers run in event_manager_poll_events at the start of the next frame
+};
+
 enum Event_Subscription_Type
 {
 	EST_NONE = 0,
@@ -106,14 +121,14 @@ struct Scene_Saved_Event
 
 struct Trigger_Event
 {
-	struct Trigger* sender;
-	struct Entity*  triggering_entity;
+	struct Entity_Handle sender;            // The trigger, one-shot triggers are removed right after sending
+	struct Entity_Handle triggering_entity;
 };
 
 struct Player_Death_Event
 {
-	struct Player* player;
-	struct Enemy*  enemy;
+	struct Player*       player;
+	struct Entity_Handle enemy;
 };
 
 struct Scene_Cleared_Event
@@ -146,6 +161,7 @@ struct Event_Subscription
 {
 	int type;
 	int event_type;
+	int slot; // Index into Event_Manager.subscription_slots
 	union
 	{
 		struct 
@@ -174,27 +190,56 @@ struct Event_Subscription
 	};
 };
 
+// Maps a handle to wherever its subscription currently sits in the dense list for its event type
+struct Event_Subscription_Slot
+{
+	int    event_type; // EVT_NONE when the slot is free
+	int    index;
+	uint32 generation;
+};
+
+struct Event_Queue_Slot
+{
+	volatile uint32 sequence; // Equals the position plus one once a producer has finished writing the event
+	struct Event    event;
+};
+
+/* Bounded ring that any thread can post to without locking while only the main thread takes
+   events out. Events are copied in so senders do not need to keep them alive */
+struct Event_Queue
+{
+	struct Event_Queue_Slot slots[MAX_QUEUED_EVENTS];
+	volatile uint32         head; // Next position a producer will claim
+	uint32                  tail; // Next position to be read, only used on the main thread
+};
+
 struct Event_Manager
 {
-	struct Event              event_pool[MAX_EVENTS];
-	struct Event_Subscription event_subsciptions[MAX_EVENT_SUBSCRIPTIONS];
-	uint32                    sdl_event_id;
-};
-
-void          event_manager_init(struct Event_Manager* event_manager);
-void          event_manager_subscribe(struct Event_Manager* event_manager, int event_type, Event_Handler event_handler_func);
-void          event_manager_subscribe_with_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Sender handler_func, void* sender);
-void          event_manager_subscribe_with_subscriber(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber handler_func, void* subscriber);
-void          event_manager_subscribe_with_subscriber_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber_Sender handler_func, void* subscriber, void* sender);
-void          event_manager_unsubscribe(struct Event_Manager* event_manager, int event_type, Event_Handler handler_func);
-void          event_manager_unsubscribe_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Sender handler_func, void* sender);
-void          event_manager_unsubscribe_with_subscriber(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber handler_func, void* subscriber);
-void          event_manager_unsubscribe_with_subscriber_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber_Sender handler_func, void* subscriber, void* sender);
-struct Event* event_manager_create_new_event(struct Event_Manager* event_manager);
-void          event_manager_send_event(struct Event_Manager* event_manager, struct Event* event);
-void          event_manager_send_event_entity(struct Event_Manager* event_manager, struct Event* event, struct Entity* entity);
-void          event_manager_poll_events(struct Event_Manager* event_manager);
-void          event_manager_cleanup(struct Event_Manager* event_manager);
-const char*   event_name_get(int event_type);
+	struct Event_Queue              end_of_tick_queue;
+	struct Event_Queue              next_frame_queue;
+	volatile uint32                 num_dropped;             // Events that did not fit in their queue since the last report
+	struct Event_Subscription*      subscriptions[EVT_MAX];  // One dense array per event type so dispatch only visits listeners of that type
+	struct Event_Subscription_Slot* subscription_slots;
+	int*                            free_subscription_slots;
+	int*                            pending_removals;        // Slots unsubscribed while dispatching, removed from the dense arrays once dispatch is done
+	int                             dispatch_depth;
+};
+
+void                      event_manager_init(struct Event_Manager* event_manager);
+Event_Subscription_Handle event_manager_subscribe(struct Event_Manager* event_manager, int event_type, Event_Handler event_handler_func);
+Event_Subscription_Handle event_manager_subscribe_with_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Sender handler_func, void* sender);
+Event_Subscription_Handle event_manager_subscribe_with_subscriber(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber handler_func, void* subscriber);
+Event_Subscription_Handle event_manager_subscribe_with_subscriber_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber_Sender handler_func, void* subscriber, void* sender);
+void                      event_manager_unsubscribe_handle(struct Event_Manager* event_manager, Event_Subscription_Handle handle);
+void                      event_manager_unsubscribe(struct Event_Manager* event_manager, int event_type, Event_Handler handler_func);
+void                      event_manager_unsubscribe_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Sender handler_func, void* sender);
+void                      event_manager_unsubscribe_with_subscriber(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber handler_func, void* subscriber);
+void                      event_manager_unsubscribe_with_subscriber_sender(struct Event_Manager* event_manager, int event_type, Event_Handler_Subscriber_Sender handler_func, void* subscriber, void* sender);
+bool                      event_manager_send_event(struct Event_Manager* event_manager, const struct Event* event, int delivery); // Safe to call from any thread, returns false if the queue was full
+void                      event_manager_send_event_entity(struct Event_Manager* event_manager, struct Event* event, struct Entity* entity);
+void                      event_manager_poll_events(struct Event_Manager* event_manager); // Dispatches os input from SDL followed by events sent with ED_NEXT_FRAME
+void                      event_manager_tick_end(struct Event_Manager* event_manager);    // Dispatches events sent with ED_END_OF_TICK, including any sent by their handlers
+void                      event_manager_cleanup(struct Event_Manager* event_manager);
+const char*               event_name_get(int event_type);
 
 #endif
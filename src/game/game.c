@@ -38,6 +38,10 @@
 #include "../common/limits.h"
 #include "scene_funcs.h"
 #include "gui_game.h"
+#include "asset_loader.h"
+#include "../common/job_system.h"
+#include "bench.h"
+#include "profiler.h"
 
 #define UNUSED(a) (void)a
 #define MIN_NUM(a,b) ((a) < (b) ? (a) : (b))
@@ -48,6 +52,8 @@ static void game_update(float dt);
 static void game_update_physics(float fixed_dt);
 static void game_post_update(float dt);
 static void game_render(void);
+static float game_counter_ms(uint64 start, uint64 end);
+static void game_frame_end(void);
 static void game_debug(float dt);
 static void game_debug_gui(float dt);
 static void game_scene_setup(void);
@@ -57,8 +63,27 @@ static void game_on_log_error(const char* context, const char* error_message, va
 static void game_on_player_death(struct Event* event);
 static void game_on_scene_loaded(struct Event* event);
 static void game_on_scene_cleared(struct Event* event);
+static void game_job_worker_init(int worker_index);
 
 static struct Game_State* game_state = NULL;
+static size_t             frame_allocations_start = 0; // Heap allocation count when the current frame started
+static int                frame_heap_allocations  = 0; // Heap allocations made during the last complete frame, should stay at zero once a scene is running
+
+static const struct Job_System_Threading game_job_threading =
+{
+	.cpu_count_get       = &platform_cpu_count_get,
+	.thread_create       = &platform_thread_create,
+	.thread_wait         = &platform_thread_wait,
+	.mutex_create        = &platform_mutex_create,
+	.mutex_destroy       = &platform_mutex_destroy,
+	.mutex_lock          = &platform_mutex_lock,
+	.mutex_unlock        = &platform_mutex_unlock,
+	.condition_create    = &platform_condition_create,
+	.condition_destroy   = &platform_condition_destroy,
+	.condition_wait      = &platform_condition_wait,
+	.condition_signal    = &platform_condition_signal,
+	.condition_broadcast = &platform_condition_broadcast
+};
 
 bool game_init(struct Window* window, struct Hashmap* cvars)
 {
@@ -111,14 +136,19 @@ bool game_init(struct Window* window, struct Hashmap* cvars)
 		srand(time(NULL));
 
 		event_manager_init(game_state->event_manager);
+		profiler_init(hashmap_bool_get(cvars, "profiler_enabled"));
 		input_init();
 		shader_init();
-		texture_init();
+		asset_loader_init(hashmap_int_get(cvars, "asset_loader_threads"));
+		job_system_init(hashmap_int_get(cvars, "job_workers"), &game_job_threading, &game_job_worker_init);
+		texture_init(hashmap_bool_get(cvars, "texture_trilinear"), hashmap_float_get(cvars, "texture_anisotropy"));
 		framebuffer_init();
 		gui_init(game_state->gui_editor);
 		gui_game_init(game_state->gui_game);
 		console_init(game_state->console);
 		geom_init();
+		transform_system_init();
+		entity_archetype_cache_init();
 		sound_init(game_state->sound);
 		debug_vars_init(game_state->debug_vars);
 
@@ -534,16 +564,21 @@ bool game_run(void)
 
     while(!game_state->quit)
     {
+		profiler_frame_begin();
+		PROFILE_BEGIN("Frame");
         uint32 current_time = platform_ticks_get();
 		float frame_time = (float)(current_time - previous_time) / 1000.f;
 		previous_time = current_time;
 		if(frame_time > MAX_FRAME_TIME) frame_time = (1.f / 60.f); /* To deal with resuming from breakpoint we artificially set delta time */
 		accumulator += frame_time;
 
-		struct Gui* gui = game_state->game_mode == GAME_MODE_EDITOR ? game_state->gui_editor : game_state->gui_game->gui;
-		gui_input_begin(gui);
-		event_manager_poll_events(game_state->event_manager);
-		gui_input_end(gui);
+		PROFILE_SCOPE("Events")
+		{
+			struct Gui* gui = game_state->game_mode == GAME_MODE_EDITOR ? game_state->gui_editor : game_state->gui_game->gui;
+			gui_input_begin(gui);
+			event_manager_poll_events(game_state->event_manager);
+			gui_input_end(gui);
+		}
 
 		struct Game_State* game_state = game_state_get();
 		while(accumulator >= game_state->fixed_delta_time)
@@ -554,14 +589,132 @@ bool game_run(void)
 		
 		game_update(frame_time);
 		game_post_update(frame_time);
+		asset_loader_update(hashmap_float_get(game_state->cvars, "asset_upload_budget_ms"));
+		PROFILE_SCOPE("Tick End Events")
+			event_manager_tick_end(game_state->event_manager);
 		game_render();
-		window_swap_buffers(game_state->window);
+		PROFILE_SCOPE("Swap Buffers")
+			window_swap_buffers(game_state->window);
+		game_frame_end();
+		PROFILE_END();
     }
     return true;
 }
 
+bool game_bench_run(const struct Bench_Params* params)
+{
+	struct Bench bench;
+	if(!bench_init(&bench, params))
+		return false;
+
+	if(!scene_load(game_state->scene, bench.params.scene_filename, DIRT_INSTALL))
+	{
+		log_error("game:bench_run", "Failed to load scene '%s'", bench.params.scene_filename);
+		bench_destroy(&bench);
+		return false;
+	}
+
+	/* Render into a framebuffer of our own since the contents of a hidden window's
+	   default framebuffer are undefined, this also keeps swap intervals out of the timings */
+	int width = 0, height = 0;
+	window_get_drawable_size(game_state->window, &width, &height);
+	int framebuffer = framebuffer_create(width, height, true, true, false);
+	if(framebuffer == -1)
+	{
+		log_error("game:bench_run", "Failed to create %dx%d offscreen framebuffer", width, height);
+		bench_destroy(&bench);
+		return false;
+	}
+	framebuffer_unbind();
+
+	asset_loader_flush();
+	srand(BENCH_RANDOM_SEED);
+
+	struct Player* player    = &game_state->scene->player;
+	uint64         frequency = platform_counter_frequency_get();
+	uint64         previous  = platform_counter_get();
+	float          accumulator = 0.f;
+	int            total_frames = BENCH_WARMUP_FRAMES + bench.params.num_frames;
+	for(int frame = 0; frame < total_frames && !game_state->quit; frame++)
+	{
+		// Start the path once warm up is over so the scene loaded event has placed the player
+		if(frame == BENCH_WARMUP_FRAMES)
+		{
+			bench_path_start(&bench, player);
+			bench_recording_start(&bench);
+		}
+
+		profiler_frame_begin();
+		uint64 frame_start = platform_counter_get();
+		float frame_time = bench.params.fixed_dt ? game_state->fixed_delta_time : (float)(frame_start - previous) / (float)frequency;
+		previous = frame_start;
+		if(frame_time > MAX_FRAME_TIME) frame_time = game_state->fixed_delta_time;
+		accumulator += frame_time;
+
+		struct Gui* gui = game_state->game_mode == GAME_MODE_EDITOR ? game_state->gui_editor : game_state->gui_game->gui;
+		gui_input_begin(gui);
+		event_manager_poll_events(game_state->event_manager);
+		gui_input_end(gui);
+
+		uint64 physics_start = platform_counter_get();
+		while(accumulator >= game_state->fixed_delta_time)
+		{
+			game_update_physics(game_state->fixed_delta_time);
+			accumulator -= game_state->fixed_delta_time;
+		}
+
+		uint64 update_start = platform_counter_get();
+		if(frame >= BENCH_WARMUP_FRAMES)
+			bench_path_apply(&bench, player, frame - BENCH_WARMUP_FRAMES);
+		game_update(frame_time);
+		game_post_update(frame_time);
+		asset_loader_update(hashmap_float_get(game_state->cvars, "asset_upload_budget_ms"));
+		event_manager_tick_end(game_state->event_manager);
+
+		uint64 render_start = platform_counter_get();
+		framebuffer_bind(framebuffer);
+		game_render();
+		glFinish(); // Include the gpu's share of the frame, there is no swap to wait on
+		framebuffer_unbind();
+		game_frame_end();
+		uint64 frame_end = platform_counter_get();
+
+		if(frame >= BENCH_WARMUP_FRAMES)
+		{
+			bench_frame_record(&bench,
+							   game_counter_ms(frame_start, frame_end),
+							   game_counter_ms(frame_start, physics_start) + game_counter_ms(update_start, render_start),
+							   game_counter_ms(physics_start, update_start),
+							   game_counter_ms(render_start, frame_end),
+							   frame_heap_allocations,
+							   &game_state->renderer->stats);
+		}
+	}
+
+	framebuffer_remove(framebuffer);
+	bool success = bench_report_write(&bench);
+	bench_destroy(&bench);
+	return success;
+}
+
+float game_counter_ms(uint64 start, uint64 end)
+{
+	return (float)((double)(end - start) * 1000.0 / (double)platform_counter_frequency_get());
+}
+
+void game_frame_end(void)
+{
+	struct Memory* memory   = memory_get();
+	frame_heap_allocations  = (int)(memory->num_allocations - frame_allocations_start);
+	frame_allocations_start = memory->num_allocations;
+	memory_arena_reset(memory_frame_arena_get());
+	memory_budgets_check();
+	PROFILE_COUNTER("Heap Allocations", (float)frame_heap_allocations);
+}
+
 void game_update(float dt)
 {	
+	PROFILE_BEGIN("Update");
 	static int   frames = 0;
 	static int   fps = 0;
 	static float seconds = 0.f;
@@ -574,6 +727,9 @@ void game_update(float dt)
 		frames = 0;
 	}
 	debug_vars_show_float("FPS", fps);
+	debug_vars_show_int("Heap Allocations", frame_heap_allocations);
+	debug_vars_show_int("Frame Arena High Water", (int)memory_frame_arena_get()->high_water);
+	debug_vars_show_int("Scratch Arena High Water", (int)memory_scratch_arena_get()->high_water);
 
     if(input_map_state_get("Window_Fullscreen", KS_RELEASED)) window_fullscreen_set(game_state->window, true);
     if(input_map_state_get("Window_Maximize",   KS_RELEASED)) window_fullscreen_set(game_state->window, false);
@@ -605,6 +761,7 @@ void game_update(float dt)
 		editor_update(game_state->editor, dt);
 	else
 		gui_game_update(game_state->gui_game, dt);
+	PROFILE_END();
 }
 
 void game_mode_set(int new_mode)
@@ -647,6 +804,7 @@ void game_post_update(float dt)
     scene_post_update(game_state->scene);
     sound_update_3d(game_state->sound);
 	debug_vars_post_update(game_state->debug_vars);
+	profiler_panel_update(game_state->gui_editor);
 	editor_post_update(game_state->editor);
 }
 
@@ -1970,6 +2128,7 @@ void game_debug_gui(float dt)
 
 void game_render(void)
 {
+    transform_resolve_all();
     renderer_render(game_state->renderer, game_state->scene);
 }
 
@@ -1979,6 +2138,9 @@ void game_cleanup(void)
     {
 		if(game_state->is_initialized)
 		{
+			asset_loader_cleanup();
+			job_system_cleanup();
+			profiler_cleanup();
 			editor_cleanup(game_state->editor);
 			scene_destroy(game_state->scene);
 			input_cleanup();
@@ -1987,6 +2149,8 @@ void game_cleanup(void)
 			gui_cleanup(game_state->gui_editor);
 			console_destroy(game_state->console);
             geom_cleanup();
+            transform_system_cleanup();
+            entity_archetype_cache_cleanup();
 			framebuffer_cleanup();
 			texture_cleanup();
 			shader_cleanup();
@@ -2033,8 +2197,11 @@ void game_on_log_error(const char* context, const char* error_message, va_list a
 void game_update_physics(float fixed_dt)
 {
 	struct Game_State* game_state = game_state_get();
-	if(game_state->update_scene)
-		scene_update_physics(game_state->scene, fixed_dt);
+	PROFILE_SCOPE("Physics")
+	{
+		if(game_state->update_scene)
+			scene_update_physics(game_state->scene, fixed_dt);
+	}
 }
 
 void game_on_scene_loaded(struct Event* event)
@@ -2051,3 +2218,10 @@ void game_on_player_death(struct Event* event)
 {
 	game_state->update_scene = false;
 }
+
+void game_job_worker_init(int worker_index)
+{
+	char thread_name[MAX_PROFILER_THREAD_NAME_LEN];
+	snprintf(thread_name, sizeof(thread_name), "Job_Worker_%d", worker_index);
+	profiler_thread_name_set(thread_name);
+}
@@ -15,6 +15,7 @@ struct Editor;
 struct Hashmap;
 struct Sound;
 struct Game_Gui;
+struct Bench_Params;
 
 enum Game_Mode
 {
@@ -48,6 +49,7 @@ struct Game_State
 struct Game_State* game_state_get(void);
 bool               game_init(struct Window* window, struct Hashmap* cvars);
 bool               game_run(void);
+bool               game_bench_run(const struct Bench_Params* params); // Runs a headless benchmark instead of game_run, returns false if it could not be completed
 void               game_cleanup(void);
 void               game_mode_set(int new_mode);
 
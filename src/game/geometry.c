@@ -5,7 +5,11 @@
 #include "../common/log.h"
 #include "renderer.h"
 #include "transform.h"
+#include "shader.h"
 #include "../system/file_io.h"
+#include "asset_loader.h"
+#include "scene.h"
+#include "game.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -13,14 +17,91 @@
 #include <assert.h>
 #include <math.h>
 #include <float.h>
+#include <stddef.h>
+
+#define GEOMETRY_PLACEHOLDER            "cube.symbres"
+#define MAX_GEOMETRY_ERROR_LEN          256
+#define GEOMETRY_SHARED_VERTEX_CAPACITY 262144  // In vertices, shared buffers double in size whenever they run out
+#define GEOMETRY_SHARED_INDEX_CAPACITY  1048576 // In GEOMETRY_INDEX_UNIT_SIZE units
+
+/* A gl buffer that geometry gets ranges of. Ranges are handed out first fit from the free
+   list and otherwise from the end of the used part, which is also where freed ranges that
+   reach it go back to */
+struct Geometry_Buffer
+{
+	uint                   handle;
+	uint32                 unit_size;   // Bytes per unit of offset and size
+	uint32                 capacity;    // In units
+	uint32                 used;        // Units up to the end of the last allocation, free ranges never reach past it
+	struct Geometry_Range* free_ranges; // Sorted by offset, neighbouring ranges are always merged
+};
 
 GLenum* draw_modes = NULL;
-static struct Geometry* geometry_list;
-static int*             empty_indices;
+static struct Geometry*       geometry_list;
+static int*                   empty_indices;
+static int                    placeholder_index = -1;
+static int                    next_load_id      = 1;
+static uint                   shared_vao        = 0;
+static struct Geometry_Buffer shared_vertices;
+static struct Geometry_Buffer shared_indices;
+
+struct Geometry_File_Header
+{
+	uint32 magic;
+	uint32 version;
+	uint32 vertex_count;
+	uint32 index_count;
+	uint32 index_size;
+};
+
+/* Decoded file contents waiting to be uploaded */
+struct Geometry_Staging
+{
+	char*                   file_data;
+	struct Geometry_Vertex* vertices;      // Points into file_data unless owns_vertices is set
+	void*                   indices;       // Points into file_data unless owns_indices is set
+	int                     vertex_count;
+	int                     index_count;
+	int                     index_size;
+	bool                    owns_vertices;
+	bool                    owns_indices;
+	struct Bounding_Box     bounding_box;
+	struct Bounding_Sphere  bounding_sphere;
+};
+
+struct Geometry_Load_Request
+{
+	int                     index;
+	int                     load_id;
+	char*                   full_path;
+	bool                    success;
+	struct Geometry_Staging staging;
+	char                    error[MAX_GEOMETRY_ERROR_LEN];
+};
 
 static void             create_vao(struct Geometry* geometry, vec3* vertices, vec2* uvs, vec3* normals, vec3* vertex_colors, uint* indices);
+static void             create_vao_interleaved(struct Geometry* geometry, const struct Geometry_Vertex* vertices, int vertex_count, const void* indices, int index_count, int index_size);
+static void             geom_vertex_attributes_set(void);
+static void             geom_instance_attributes_set(uint instance_vbo, int first_instance);
+static void             geom_shared_vao_setup(void);
+static bool             geom_shared_upload(struct Geometry* geometry, struct Geometry_Staging* staging);
+static void             geom_buffer_init(struct Geometry_Buffer* buffer, uint32 unit_size, uint32 capacity);
+static void             geom_buffer_destroy(struct Geometry_Buffer* buffer);
+static bool             geom_buffer_allocate(struct Geometry_Buffer* buffer, uint32 size, struct Geometry_Range* out_range);
+static void             geom_buffer_free(struct Geometry_Buffer* buffer, struct Geometry_Range range);
+static bool             geom_buffer_grow(struct Geometry_Buffer* buffer, uint32 min_capacity);
 static struct Geometry* generate_new_index(int* out_new_index);
-static void             geom_bounding_volume_generate(struct Geometry* geometry, vec3* vertices);
+static void             geom_bounding_volume_generate(struct Bounding_Box* box, struct Bounding_Sphere* sphere, const void* positions, int count, size_t stride);
+static bool             geom_decode(char* data, long size, struct Geometry_Staging* staging, char* error);
+static bool             geom_decode_legacy(const char* data, long size, struct Geometry_Staging* staging, char* error);
+static bool             geom_indices_validate(const void* indices, uint32 index_count, uint32 index_size, uint32 vertex_count, char* error);
+static void             geom_upload(struct Geometry* geometry, struct Geometry_Staging* staging);
+static void             geom_staging_free(struct Geometry_Staging* staging);
+static int              geom_create_from_file_async(const char* name, char* full_path);
+static void             geom_load_request_load(void* data);
+static void             geom_load_request_finalize(void* data);
+static uint32           geom_normal_pack(const vec3* normal);
+static uint16           geom_half_from_float(float value);
 
 void geom_init(void)
 {
@@ -33,6 +114,11 @@ void geom_init(void)
 	draw_modes[GDM_LINE_STRIP]   = GL_LINE_STRIP;
 	draw_modes[GDM_LINE_LOOP]    = GL_LINE_LOOP;
 	draw_modes[GDM_TRIANGLE_FAN] = GL_TRIANGLE_FAN;
+
+	geom_buffer_init(&shared_vertices, sizeof(struct Geometry_Vertex), GEOMETRY_SHARED_VERTEX_CAPACITY);
+	geom_buffer_init(&shared_indices, GEOMETRY_INDEX_UNIT_SIZE, GEOMETRY_SHARED_INDEX_CAPACITY);
+	GL_CHECK(glGenVertexArrays(1, &shared_vao));
+	geom_shared_vao_setup();
 }
 
 int geom_find(const char* filename)
@@ -41,7 +127,7 @@ int geom_find(const char* filename)
 	for(int i = 0; i < array_len(geometry_list); i++)
 	{
 		struct Geometry* geometry = &geometry_list[i];
-		if(strcmp(geometry->filename, filename) == 0)
+		if(geometry->filename && strcmp(geometry->filename, filename) == 0)
 		{
 			index = i;
 			break;
@@ -50,19 +136,16 @@ int geom_find(const char* filename)
 	return index;
 }
 
-void geom_bounding_volume_generate(struct Geometry* geometry, vec3* vertices)
+void geom_bounding_volume_generate(struct Bounding_Box* box, struct Bounding_Sphere* sphere, const void* positions, int count, size_t stride)
 {
-	struct Bounding_Box*    box    = &geometry->bounding_box;
-	struct Bounding_Sphere* sphere = &geometry->bounding_sphere;
-	
 	vec3_fill(&box->max, -FLT_MIN, -FLT_MIN, -FLT_MIN);
 	vec3_fill(&box->min,  FLT_MAX,  FLT_MAX,  FLT_MAX);
 	vec3_fill(&sphere->center, 0.f, 0.f, 0.f);
 	sphere->radius = 0.f;
 	
-	for(int i = 0; i < array_len(vertices); i++)
+	for(int i = 0; i < count; i++)
 	{
-		vec3* vertex = &vertices[i];
+		const vec3* vertex = (const vec3*)((const char*)positions + stride * i);
 		if(vertex->x > box->max.x) box->max.x = vertex->x;
 		if(vertex->y > box->max.y) box->max.y = vertex->y;
 		if(vertex->z > box->max.z) box->max.z = vertex->z;
@@ -109,80 +192,148 @@ int geom_create_from_file(const char* name)
 	assert(name);
 	// check if exists
 	int index = geom_find(name);
-	if(index == -1)
+	if(index != -1)
 	{
-		/* add new geometry object or overwrite existing one */
-		struct Geometry* new_geo = NULL;
-		new_geo = generate_new_index(&index);
-		assert(new_geo);
-		
-		char* full_path = str_new("models/%s", name);
-		FILE* file = io_file_open(DIRT_INSTALL, full_path, "rb");
-		memory_free(full_path);
-		if(file)
+		geometry_list[index].ref_count++;
+		return index;
+	}
+
+	char* full_path = str_new("models/%s", name);
+
+	/* Everything but the placeholder is streamed in when the asset loader is running */
+	if(asset_loader_is_running() && strcmp(name, GEOMETRY_PLACEHOLDER) != 0)
+	{
+		int64 modified_time = 0;
+		if(!io_file_modified_time_get(DIRT_INSTALL, full_path, &modified_time))
 		{
-			const uint32 INDEX_SIZE = sizeof(uint32);
-			const uint32 VEC3_SIZE = sizeof(vec3);
-			const uint32 VEC2_SIZE = sizeof(vec2);
-			uint32 header[4];
-			size_t bytes_read = 0;
-			if((bytes_read = fread(header, INDEX_SIZE, 4, file)) <= 0)
-			{
-				log_error("geometry:load_from_file", "Read failed");
-				/* TODO: Some error here, find it and fix it */
-				array_pop(geometry_list);
-				index = -1;
-			}
-			else
-			{
-				uint32 indices_count  = header[0];
-				uint32 vertices_count = header[1];
-				uint32 normals_count  = header[2];
-				uint32 uvs_count      = header[3];
-				// Indices
-				uint* indices = array_new_cap(uint, indices_count);
-				fread(indices, INDEX_SIZE, indices_count, file);
-				array_match_len_cap(indices);
-				// Vertices
-				vec3* vertices = array_new_cap(vec3, vertices_count);
-				fread(vertices, VEC3_SIZE, vertices_count, file);
-				array_match_len_cap(vertices);
-				// Normals
-				vec3* normals = array_new_cap(vec3, normals_count);
-				fread(normals, VEC3_SIZE, normals_count, file);
-				array_match_len_cap(normals);
-				// Uvs
-				vec2* uvs = array_new_cap(vec2, uvs_count);
-				fread(uvs, VEC2_SIZE, uvs_count, file);
-				array_match_len_cap(uvs);
-
-				new_geo->filename = str_new(name);
-				new_geo->draw_indexed = 1;
-				new_geo->ref_count++;
-
-				create_vao(new_geo, vertices, uvs, normals, NULL, indices);
-				geom_bounding_volume_generate(new_geo, vertices);
-				if(vertices)      array_free(vertices);
-				if(indices)       array_free(indices);
-				if(uvs)           array_free(uvs);
-				if(normals)       array_free(normals);
-			}
-			fclose(file);
+			log_error("geometry:create_from_file", "Could not open file %s", name);
+			memory_free(full_path);
+			return -1;
 		}
-		else
+		index = geom_create_from_file_async(name, io_file_full_path_get(DIRT_INSTALL, full_path));
+		memory_free(full_path);
+		return index;
+	}
+
+	// The whole file is read with a single fread and then decoded from memory
+	long file_size = 0;
+	char* file_data = io_file_read(DIRT_INSTALL, full_path, "rb", &file_size);
+	memory_free(full_path);
+	if(!file_data) return -1;
+
+	struct Geometry_Staging staging;
+	char error[MAX_GEOMETRY_ERROR_LEN] = {'\0'};
+	if(geom_decode(file_data, file_size, &staging, error))
+	{
+		struct Geometry* new_geo = generate_new_index(&index);
+		assert(new_geo);
+		geom_upload(new_geo, &staging);
+		new_geo->filename         = str_new(name);
+		new_geo->draw_indexed     = 1;
+		new_geo->ref_count        = 0;
+		new_geo->load_id          = 0;
+		new_geo->uses_placeholder = false;
+	}
+	else
+	{
+		log_error("geometry:create_from_file", "Failed to load %s, %s", name, error);
+		index = -1;
+	}
+	geom_staging_free(&staging);
+	return index;
+}
+
+static int geom_create_from_file_async(const char* name, char* full_path)
+{
+	if(placeholder_index == -1)
+	{
+		placeholder_index = geom_create_from_file(GEOMETRY_PLACEHOLDER);
+		if(placeholder_index == -1)
 		{
-			/* TODO: Some error here, find it and fix it */
-			array_pop(geometry_list);
-			index = -1;
+			log_error("geometry:create_from_file_async", "Failed to load placeholder geometry %s", GEOMETRY_PLACEHOLDER);
+			memory_free(full_path);
+			return -1;
 		}
 	}
-	else
+
+	struct Geometry_Load_Request* request = memory_allocate_tagged(sizeof(*request), MT_GEOMETRY);
+	if(!request)
 	{
-		geometry_list[index].ref_count++;
+		log_error("geometry:create_from_file_async", "Out of memory");
+		memory_free(full_path);
+		return -1;
 	}
+
+	/* Until the file has been uploaded the new geometry draws the placeholder's buffers and uses its bounds */
+	int index = -1;
+	struct Geometry placeholder = geometry_list[placeholder_index];
+	struct Geometry* new_geo    = generate_new_index(&index);
+	*new_geo                    = placeholder;
+	new_geo->filename           = str_new(name);
+	new_geo->ref_count          = 0;
+	new_geo->load_id            = next_load_id++;
+	new_geo->uses_placeholder   = true;
+
+	request->index     = index;
+	request->load_id   = new_geo->load_id;
+	request->full_path = full_path;
+	request->success   = false;
+	request->error[0]  = '\0';
+	memset(&request->staging, 0, sizeof(request->staging));
+	asset_loader_request(&geom_load_request_load, &geom_load_request_finalize, request);
 	return index;
 }
 
+static void geom_load_request_load(void* data)
+{
+	struct Geometry_Load_Request* request = (struct Geometry_Load_Request*)data;
+	long file_size = 0;
+	char* file_data = asset_loader_file_read(request->full_path, MT_GEOMETRY, &file_size);
+	if(!file_data)
+	{
+		snprintf(request->error, MAX_GEOMETRY_ERROR_LEN, "Could not read file %s", request->full_path);
+		return;
+	}
+	request->success = geom_decode(file_data, file_size, &request->staging, request->error);
+}
+
+static void geom_load_request_finalize(void* data)
+{
+	struct Geometry_Load_Request* request = (struct Geometry_Load_Request*)data;
+
+	/* The geometry might have been removed, and its slot reused, while it was loading */
+	struct Geometry* geometry = request->index < array_len(geometry_list) ? &geometry_list[request->index] : NULL;
+	if(geometry && geometry->load_id == request->load_id)
+	{
+		geometry->load_id = 0;
+		if(request->success)
+		{
+			struct Bounding_Box old_bounding_box = geometry->bounding_box;
+			geometry->vao        = 0;
+			geometry->vertex_vbo = 0;
+			geometry->uv_vbo     = 0;
+			geometry->normal_vbo = 0;
+			geometry->color_vbo  = 0;
+			geometry->index_vbo  = 0;
+			geometry->shared     = false;
+			memset(&geometry->vertex_range, 0, sizeof(geometry->vertex_range));
+			memset(&geometry->index_range, 0, sizeof(geometry->index_range));
+			geom_upload(geometry, &request->staging);
+			geometry->draw_indexed     = 1;
+			geometry->uses_placeholder = false;
+			scene_geometry_changed(game_state_get()->scene, request->index, &old_bounding_box);
+		}
+		else
+		{
+			log_error("geometry:load_request_finalize", "Failed to load %s, %s. Keeping placeholder", geometry->filename, request->error);
+		}
+	}
+
+	geom_staging_free(&request->staging);
+	memory_free(request->full_path);
+	memory_free(request);
+}
+
 int geom_create(const char* name,
 				vec3*       vertices,
 				vec2*       uvs,
@@ -197,11 +348,188 @@ int geom_create(const char* name,
 	new_geometry = generate_new_index(&index);
 	assert(new_geometry);
 	new_geometry->filename = str_new(name);
+	new_geometry->load_id = 0;
+	new_geometry->uses_placeholder = false;
+	new_geometry->shared = false;
+	memset(&new_geometry->vertex_range, 0, sizeof(new_geometry->vertex_range));
+	memset(&new_geometry->index_range, 0, sizeof(new_geometry->index_range));
 	create_vao(new_geometry, vertices, uvs, normals, vertex_colors, indices);
-	geom_bounding_volume_generate(new_geometry, vertices);
+	geom_bounding_volume_generate(&new_geometry->bounding_box, &new_geometry->bounding_sphere, vertices, array_len(vertices), sizeof(vec3));
 	return index;
 }
 
+/* Takes ownership of data, which is released by geom_staging_free whether decoding succeeds
+   or not. Does not touch gl or any shared state so it can run on a loader thread */
+static bool geom_decode(char* data, long size, struct Geometry_Staging* staging, char* error)
+{
+	memset(staging, 0, sizeof(*staging));
+	staging->file_data = data;
+
+	const struct Geometry_File_Header* header = (const struct Geometry_File_Header*)data;
+	if((size_t)size < sizeof(*header) || header->magic != GEOM_FILE_MAGIC)
+		return geom_decode_legacy(data, size, staging, error);
+
+	if(header->version != GEOM_FILE_VERSION || (header->index_size != sizeof(uint16) && header->index_size != sizeof(uint32)))
+	{
+		snprintf(error, MAX_GEOMETRY_ERROR_LEN, "Unsupported version %d or index size %d", header->version, header->index_size);
+		return false;
+	}
+
+	size_t expected_size = sizeof(*header) + (size_t)header->vertex_count * sizeof(struct Geometry_Vertex) + (size_t)header->index_count * header->index_size;
+	if((size_t)size != expected_size || header->vertex_count == 0)
+	{
+		snprintf(error, MAX_GEOMETRY_ERROR_LEN, "File is truncated or corrupted");
+		return false;
+	}
+
+	const struct Geometry_Vertex* vertices = (const struct Geometry_Vertex*)(data + sizeof(*header));
+	if(!geom_indices_validate(vertices + header->vertex_count, header->index_count, header->index_size, header->vertex_count, error))
+		return false;
+
+	staging->vertices     = (struct Geometry_Vertex*)(data + sizeof(*header));
+	staging->indices      = staging->vertices + header->vertex_count;
+	staging->vertex_count = header->vertex_count;
+	staging->index_count  = header->index_count;
+	staging->index_size   = header->index_size;
+	geom_bounding_volume_generate(&staging->bounding_box, &staging->bounding_sphere, &staging->vertices[0].position, staging->vertex_count, sizeof(struct Geometry_Vertex));
+	return true;
+}
+
+/* Version 1 files store indices, positions, normals and uvs as separate float arrays.
+   They are converted to the interleaved layout on load so that every file backed
+   geometry ends up with the same vertex format on the gpu */
+static bool geom_decode_legacy(const char* data, long size, struct Geometry_Staging* staging, char* error)
+{
+	if((size_t)size < sizeof(uint32) * 4)
+	{
+		snprintf(error, MAX_GEOMETRY_ERROR_LEN, "Read failed");
+		return false;
+	}
+
+	const uint32* header = (const uint32*)data;
+	uint32 indices_count  = header[0];
+	uint32 vertices_count = header[1];
+	uint32 normals_count  = header[2];
+	uint32 uvs_count      = header[3];
+	size_t expected_size  = sizeof(uint32) * 4 + sizeof(uint32) * indices_count + sizeof(vec3) * vertices_count + sizeof(vec3) * normals_count + sizeof(vec2) * uvs_count;
+	if((size_t)size < expected_size || vertices_count == 0 || normals_count != vertices_count || uvs_count != vertices_count)
+	{
+		snprintf(error, MAX_GEOMETRY_ERROR_LEN, "File is truncated or has mismatched attribute counts");
+		return false;
+	}
+
+	const uint32* indices  = header + 4;
+	const vec3*   positions = (const vec3*)(indices + indices_count);
+	const vec3*   normals   = positions + vertices_count;
+	const vec2*   uvs       = (const vec2*)(normals + normals_count);
+	if(!geom_indices_validate(indices, indices_count, sizeof(uint32), vertices_count, error))
+		return false;
+
+	staging->vertices = memory_allocate_tagged(sizeof(*staging->vertices) * vertices_count, MT_GEOMETRY);
+	if(!staging->vertices)
+	{
+		snprintf(error, MAX_GEOMETRY_ERROR_LEN, "Out of memory");
+		return false;
+	}
+	staging->owns_vertices = true;
+	staging->vertex_count  = vertices_count;
+	staging->index_count   = indices_count;
+
+	for(uint32 i = 0; i < vertices_count; i++)
+	{
+		struct Geometry_Vertex* vertex = &staging->vertices[i];
+		vec3_assign(&vertex->position, &positions[i]);
+		vertex->normal = geom_normal_pack(&normals[i]);
+		vertex->uv[0]  = geom_half_from_float(uvs[i].x);
+		vertex->uv[1]  = geom_half_from_float(uvs[i].y);
+	}
+
+	if(vertices_count <= UINT16_MAX + 1)
+	{
+		uint16* short_indices = memory_allocate_tagged(sizeof(*short_indices) * (indices_count > 0 ? indices_count : 1), MT_GEOMETRY);
+		if(!short_indices)
+		{
+			snprintf(error, MAX_GEOMETRY_ERROR_LEN, "Out of memory");
+			return false;
+		}
+		for(uint32 i = 0; i < indices_count; i++)
+			short_indices[i] = (uint16)indices[i];
+		staging->indices      = short_indices;
+		staging->owns_indices = true;
+		staging->index_size   = sizeof(uint16);
+	}
+	else
+	{
+		staging->indices    = (void*)indices;
+		staging->index_size = sizeof(uint32);
+	}
+
+	geom_bounding_volume_generate(&staging->bounding_box, &staging->bounding_sphere, positions, vertices_count, sizeof(vec3));
+	return true;
+}
+
+/* Checked once here on the loader thread so the gpu never gets an index past the end of the
+   geometry's vertices, which would read into whatever else lives in the shared vertex buffer */
+static bool geom_indices_validate(const void* indices, uint32 index_count, uint32 index_size, uint32 vertex_count, char* error)
+{
+	for(uint32 i = 0; i < index_count; i++)
+	{
+		uint32 index = index_size == sizeof(uint16) ? ((const uint16*)indices)[i] : ((const uint32*)indices)[i];
+		if(index >= vertex_count)
+		{
+			snprintf(error, MAX_GEOMETRY_ERROR_LEN, "Index %u at %u is out of range for %u vertices", index, i, vertex_count);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void geom_upload(struct Geometry* geometry, struct Geometry_Staging* staging)
+{
+	if(!geom_shared_upload(geometry, staging))
+	{
+		log_warning("Geometry with %d vertices did not fit in the shared buffers, giving it buffers of its own", staging->vertex_count);
+		geometry->shared = false;
+		memset(&geometry->vertex_range, 0, sizeof(geometry->vertex_range));
+		memset(&geometry->index_range, 0, sizeof(geometry->index_range));
+		create_vao_interleaved(geometry, staging->vertices, staging->vertex_count, staging->indices, staging->index_count, staging->index_size);
+	}
+	geometry->bounding_box    = staging->bounding_box;
+	geometry->bounding_sphere = staging->bounding_sphere;
+}
+
+static void geom_staging_free(struct Geometry_Staging* staging)
+{
+	if(staging->owns_vertices && staging->vertices) memory_free(staging->vertices);
+	if(staging->owns_indices && staging->indices)   memory_free(staging->indices);
+	if(staging->file_data)                          memory_free(staging->file_data);
+	memset(staging, 0, sizeof(*staging));
+}
+
+static uint32 geom_normal_pack(const vec3* normal)
+{
+	int x = (int)roundf(fmaxf(-1.f, fminf(1.f, normal->x)) * 511.f);
+	int y = (int)roundf(fmaxf(-1.f, fminf(1.f, normal->y)) * 511.f);
+	int z = (int)roundf(fmaxf(-1.f, fminf(1.f, normal->z)) * 511.f);
+	return ((uint32)x & 0x3FF) | (((uint32)y & 0x3FF) << 10) | (((uint32)z & 0x3FF) << 20);
+}
+
+static uint16 geom_half_from_float(float value)
+{
+	uint32 bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32 sign     = (bits >> 16) & 0x8000;
+	int    exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+	uint32 mantissa = bits & 0x7FFFFF;
+
+	if(exponent <= 0)  return (uint16)sign;            // Too small to be represented, flush to zero
+	if(exponent >= 31) return (uint16)(sign | 0x7C00); // Too large or not a number, clamp to infinity
+
+	uint32 half = sign | ((uint32)exponent << 10) | (mantissa >> 13);
+	if(mantissa & 0x1000) half++; // Round to nearest, a carry into the exponent is still correct
+	return (uint16)half;
+}
+
 
 void geom_remove(int index)
 {
@@ -216,12 +544,21 @@ void geom_remove(int index)
 				if(geometry->filename) memory_free(geometry->filename);
 				geometry->filename = NULL;
 
-				glDeleteBuffers(1, &geometry->vertex_vbo);
-				glDeleteBuffers(1, &geometry->color_vbo);
-				glDeleteBuffers(1, &geometry->uv_vbo);
-				glDeleteBuffers(1, &geometry->normal_vbo);
-				glDeleteBuffers(1, &geometry->index_vbo);
-				glDeleteVertexArrays(1, &geometry->vao);
+				// Geometry that is still loading only borrows the placeholder's buffers
+				if(geometry->shared && !geometry->uses_placeholder)
+				{
+					geom_buffer_free(&shared_vertices, geometry->vertex_range);
+					geom_buffer_free(&shared_indices, geometry->index_range);
+				}
+				else if(!geometry->uses_placeholder)
+				{
+					glDeleteBuffers(1, &geometry->vertex_vbo);
+					glDeleteBuffers(1, &geometry->color_vbo);
+					glDeleteBuffers(1, &geometry->uv_vbo);
+					glDeleteBuffers(1, &geometry->normal_vbo);
+					glDeleteBuffers(1, &geometry->index_vbo);
+					glDeleteVertexArrays(1, &geometry->vao);
+				}
 
 				geometry->vertex_vbo      = 0;
 				geometry->color_vbo	      = 0;
@@ -230,7 +567,13 @@ void geom_remove(int index)
 				geometry->index_vbo       = 0;
 				geometry->vao             = 0;
 				geometry->indices_length  = 0;
-				geometry->vertices_length = 0;
+				geometry->vertices_length  = 0;
+				geometry->load_id          = 0;
+				geometry->uses_placeholder = false;
+				geometry->shared           = false;
+				memset(&geometry->vertex_range, 0, sizeof(geometry->vertex_range));
+				memset(&geometry->index_range, 0, sizeof(geometry->index_range));
+				if(index == placeholder_index) placeholder_index = -1;
 
 				array_push(empty_indices, index, int);
 			}
@@ -246,6 +589,12 @@ void geom_cleanup(void)
 	array_free(geometry_list);
 	array_free(empty_indices);
 	array_free(draw_modes);
+	placeholder_index = -1;
+
+	GL_CHECK(glDeleteVertexArrays(1, &shared_vao));
+	shared_vao = 0;
+	geom_buffer_destroy(&shared_vertices);
+	geom_buffer_destroy(&shared_indices);
 }
 
 void create_vao(struct Geometry* geometry,
@@ -316,24 +665,321 @@ void create_vao(struct Geometry* geometry,
 					 GL_STATIC_DRAW);
 		geometry->draw_indexed = 1;
 		geometry->indices_length = array_len(indices);
+		geometry->index_type = GL_UNSIGNED_INT;
 	}
 	glBindVertexArray(0);
 
 }
 
+void create_vao_interleaved(struct Geometry*              geometry,
+							const struct Geometry_Vertex* vertices,
+							int                           vertex_count,
+							const void*                   indices,
+							int                           index_count,
+							int                           index_size)
+{
+	assert(geometry && vertices && vertex_count > 0);
+	glGenVertexArrays(1, &geometry->vao);
+	glBindVertexArray(geometry->vao);
+
+	// Single buffer, every attribute is read from the same vertex
+	glGenBuffers(1, &geometry->vertex_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, geometry->vertex_vbo);
+	GL_CHECK(glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(struct Geometry_Vertex), vertices, GL_STATIC_DRAW));
+	geom_vertex_attributes_set();
+	geometry->vertices_length = vertex_count;
+
+	if(index_count > 0)
+	{
+		glGenBuffers(1, &geometry->index_vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry->index_vbo);
+		GL_CHECK(glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * index_size, indices, GL_STATIC_DRAW));
+		geometry->draw_indexed = 1;
+		geometry->indices_length = index_count;
+		geometry->index_type = index_size == sizeof(uint16) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+	glBindVertexArray(0);
+}
+
+static void geom_vertex_attributes_set(void)
+{
+	glEnableVertexAttribArray(ATTRIB_LOC_POSITION);
+	glVertexAttribPointer(ATTRIB_LOC_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(struct Geometry_Vertex), (void*)offsetof(struct Geometry_Vertex, position));
+	glEnableVertexAttribArray(ATTRIB_LOC_NORMAL);
+	glVertexAttribPointer(ATTRIB_LOC_NORMAL, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(struct Geometry_Vertex), (void*)offsetof(struct Geometry_Vertex, normal));
+	glEnableVertexAttribArray(ATRRIB_LOC_UV);
+	glVertexAttribPointer(ATRRIB_LOC_UV, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(struct Geometry_Vertex), (void*)offsetof(struct Geometry_Vertex, uv));
+}
+
+static void geom_instance_attributes_set(uint instance_vbo, int first_instance)
+{
+	/* Point the per-instance model and normal matrices at first_instance in the instance buffer,
+	   a matrix attribute is fed as consecutive vec4 columns */
+	glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+	size_t offset = (size_t)first_instance * sizeof(struct Geometry_Instance);
+	for(int i = 0; i < 4; i++)
+	{
+		int location = ATTRIB_LOC_MODEL_MAT + i;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(struct Geometry_Instance), (void*)(offset + offsetof(struct Geometry_Instance, model_mat) + sizeof(vec4) * i));
+		glVertexAttribDivisor(location, 1);
+	}
+	for(int i = 0; i < 3; i++)
+	{
+		int location = ATTRIB_LOC_NORMAL_MAT + i;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, sizeof(struct Geometry_Instance), (void*)(offset + offsetof(struct Geometry_Instance, normal_mat) + sizeof(vec4) * i));
+		glVertexAttribDivisor(location, 1);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static void geom_shared_vao_setup(void)
+{
+	/* Has to be redone whenever a shared buffer is replaced by a bigger one */
+	glBindVertexArray(shared_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, shared_vertices.handle);
+	geom_vertex_attributes_set();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shared_indices.handle);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+static bool geom_shared_upload(struct Geometry* geometry, struct Geometry_Staging* staging)
+{
+	uint32 index_bytes = (uint32)staging->index_count * (uint32)staging->index_size;
+	uint32 index_units = (index_bytes + GEOMETRY_INDEX_UNIT_SIZE - 1) / GEOMETRY_INDEX_UNIT_SIZE;
+	struct Geometry_Range vertex_range = { 0, 0 };
+	struct Geometry_Range index_range  = { 0, 0 };
+	if(!geom_buffer_allocate(&shared_vertices, (uint32)staging->vertex_count, &vertex_range))
+		return false;
+
+	if(index_units > 0 && !geom_buffer_allocate(&shared_indices, index_units, &index_range))
+	{
+		geom_buffer_free(&shared_vertices, vertex_range);
+		return false;
+	}
+
+	/* The copy write target leaves the element array binding of whatever vao is bound alone */
+	glBindBuffer(GL_COPY_WRITE_BUFFER, shared_vertices.handle);
+	GL_CHECK(glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)vertex_range.offset * shared_vertices.unit_size, (GLsizeiptr)staging->vertex_count * sizeof(struct Geometry_Vertex), staging->vertices));
+	if(index_bytes > 0)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, shared_indices.handle);
+		GL_CHECK(glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)index_range.offset * shared_indices.unit_size, (GLsizeiptr)index_bytes, staging->indices));
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	geometry->vao             = shared_vao;
+	geometry->vertex_vbo      = 0;
+	geometry->uv_vbo          = 0;
+	geometry->normal_vbo      = 0;
+	geometry->color_vbo       = 0;
+	geometry->index_vbo       = 0;
+	geometry->shared          = true;
+	geometry->vertex_range    = vertex_range;
+	geometry->index_range     = index_range;
+	geometry->vertices_length = staging->vertex_count;
+	if(staging->index_count > 0)
+	{
+		geometry->draw_indexed   = 1;
+		geometry->indices_length = staging->index_count;
+		geometry->index_type     = staging->index_size == sizeof(uint16) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+	return true;
+}
+
+static void geom_buffer_init(struct Geometry_Buffer* buffer, uint32 unit_size, uint32 capacity)
+{
+	buffer->unit_size   = unit_size;
+	buffer->capacity    = capacity;
+	buffer->used        = 0;
+	buffer->free_ranges = array_new(struct Geometry_Range);
+	GL_CHECK(glGenBuffers(1, &buffer->handle));
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer->handle);
+	GL_CHECK(glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * unit_size, NULL, GL_STATIC_DRAW));
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+static void geom_buffer_destroy(struct Geometry_Buffer* buffer)
+{
+	GL_CHECK(glDeleteBuffers(1, &buffer->handle));
+	array_free(buffer->free_ranges);
+	memset(buffer, 0, sizeof(*buffer));
+}
+
+static bool geom_buffer_allocate(struct Geometry_Buffer* buffer, uint32 size, struct Geometry_Range* out_range)
+{
+	for(int i = 0; i < array_len(buffer->free_ranges); i++)
+	{
+		struct Geometry_Range* range = &buffer->free_ranges[i];
+		if(range->size < size) continue;
+
+		out_range->offset = range->offset;
+		out_range->size   = size;
+		range->offset += size;
+		range->size   -= size;
+		if(range->size == 0) array_remove_at(buffer->free_ranges, i);
+		return true;
+	}
+
+	if(size > UINT32_MAX - buffer->used) return false;
+	if(buffer->used + size > buffer->capacity && !geom_buffer_grow(buffer, buffer->used + size))
+		return false;
+
+	out_range->offset = buffer->used;
+	out_range->size   = size;
+	buffer->used     += size;
+	return true;
+}
+
+static void geom_buffer_free(struct Geometry_Buffer* buffer, struct Geometry_Range range)
+{
+	if(range.size == 0) return;
+
+	int num_ranges = array_len(buffer->free_ranges);
+	int position   = 0;
+	while(position < num_ranges && buffer->free_ranges[position].offset < range.offset)
+		position++;
+
+	struct Geometry_Range* previous = position > 0 ? &buffer->free_ranges[position - 1] : NULL;
+	struct Geometry_Range* next     = position < num_ranges ? &buffer->free_ranges[position] : NULL;
+	if(previous && previous->offset + previous->size == range.offset)
+	{
+		previous->size += range.size;
+		if(next && previous->offset + previous->size == next->offset)
+		{
+			previous->size += next->size;
+			array_remove_at(buffer->free_ranges, position);
+		}
+	}
+	else if(next && range.offset + range.size == next->offset)
+	{
+		next->offset = range.offset;
+		next->size  += range.size;
+	}
+	else
+	{
+		array_grow(buffer->free_ranges, struct Geometry_Range);
+		memmove(&buffer->free_ranges[position + 1], &buffer->free_ranges[position], sizeof(struct Geometry_Range) * (num_ranges - position));
+		buffer->free_ranges[position] = range;
+	}
+
+	/* A free range that reaches the end of the used part goes back to it */
+	num_ranges = array_len(buffer->free_ranges);
+	struct Geometry_Range* last = &buffer->free_ranges[num_ranges - 1];
+	if(last->offset + last->size == buffer->used)
+	{
+		buffer->used = last->offset;
+		array_pop(buffer->free_ranges);
+	}
+}
+
+static bool geom_buffer_grow(struct Geometry_Buffer* buffer, uint32 min_capacity)
+{
+	uint32 new_capacity = buffer->capacity;
+	while(new_capacity < min_capacity)
+	{
+		if(new_capacity > UINT32_MAX / 2) return false;
+		new_capacity *= 2;
+	}
+
+	/* Offsets stay valid since everything used so far is copied to the start of the new buffer */
+	uint new_handle = 0;
+	GL_CHECK(glGenBuffers(1, &new_handle));
+	glBindBuffer(GL_COPY_WRITE_BUFFER, new_handle);
+	GL_CHECK(glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)new_capacity * buffer->unit_size, NULL, GL_STATIC_DRAW));
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer->handle);
+	GL_CHECK(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)buffer->used * buffer->unit_size));
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	GL_CHECK(glDeleteBuffers(1, &buffer->handle));
+
+	log_message("Shared geometry buffer grown from %u to %u KB", (uint32)(((size_t)buffer->capacity * buffer->unit_size) / 1024), (uint32)(((size_t)new_capacity * buffer->unit_size) / 1024));
+	buffer->handle   = new_handle;
+	buffer->capacity = new_capacity;
+	geom_shared_vao_setup();
+	return true;
+}
+
 void geom_render(int index, enum Geometry_Draw_Mode draw_mode)
 {
 	assert((int)draw_mode > -1 && draw_mode < GDM_NUM_DRAWMODES && index >= 0);
 	struct Geometry* geo = &geometry_list[index];
 	glBindVertexArray(geo->vao);
 	if(geo->draw_indexed)
-		glDrawElements(draw_modes[draw_mode], geo->indices_length, GL_UNSIGNED_INT, (void*)0);
+		glDrawElementsBaseVertex(draw_modes[draw_mode], geo->indices_length, geo->index_type, (void*)((size_t)geo->index_range.offset * GEOMETRY_INDEX_UNIT_SIZE), (GLint)geo->vertex_range.offset);
 	else
-		glDrawArrays(draw_modes[draw_mode], 0, geo->vertices_length);
+		glDrawArrays(draw_modes[draw_mode], (GLint)geo->vertex_range.offset, geo->vertices_length);
 	glBindVertexArray(0);
 			
 }
 
+void geom_render_instanced(int index, enum Geometry_Draw_Mode draw_mode, uint instance_vbo, int first_instance, int instance_count)
+{
+	assert((int)draw_mode > -1 && draw_mode < GDM_NUM_DRAWMODES && index >= 0 && first_instance >= 0);
+	if(instance_count <= 0) return;
+
+	struct Geometry* geo = &geometry_list[index];
+	glBindVertexArray(geo->vao);
+	geom_instance_attributes_set(instance_vbo, first_instance);
+	if(geo->draw_indexed)
+		glDrawElementsInstancedBaseVertex(draw_modes[draw_mode], geo->indices_length, geo->index_type, (void*)((size_t)geo->index_range.offset * GEOMETRY_INDEX_UNIT_SIZE), instance_count, (GLint)geo->vertex_range.offset);
+	else
+		glDrawArraysInstanced(draw_modes[draw_mode], (GLint)geo->vertex_range.offset, geo->vertices_length, instance_count);
+	glBindVertexArray(0);
+}
+
+int geom_render_indirect(enum Geometry_Draw_Mode             draw_mode,
+						 uint                                index_type,
+						 uint                                instance_vbo,
+						 uint                                indirect_buffer,
+						 const struct Geometry_Draw_Command* commands,
+						 int                                 first_command,
+						 int                                 num_commands)
+{
+	assert((int)draw_mode > -1 && draw_mode < GDM_NUM_DRAWMODES && first_command >= 0);
+	if(num_commands <= 0) return 0;
+
+	int num_draw_calls = 0;
+	glBindVertexArray(shared_vao);
+	if(indirect_buffer != 0 && gl_multi_draw_elements_indirect)
+	{
+		/* Every command's base_instance is added to the instance index, so the instances are read from the start of the buffer */
+		geom_instance_attributes_set(instance_vbo, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+		GL_CHECK(gl_multi_draw_elements_indirect(draw_modes[draw_mode], index_type, (void*)(sizeof(struct Geometry_Draw_Command) * first_command), num_commands, 0));
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		num_draw_calls = 1;
+	}
+	else
+	{
+		size_t index_size = index_type == GL_UNSIGNED_SHORT ? sizeof(uint16) : sizeof(uint32);
+		for(int i = first_command; i < first_command + num_commands; i++)
+		{
+			const struct Geometry_Draw_Command* command = &commands[i];
+			geom_instance_attributes_set(instance_vbo, (int)command->base_instance);
+			glDrawElementsInstancedBaseVertex(draw_modes[draw_mode], command->count, index_type, (void*)(command->first_index * index_size), command->instance_count, command->base_vertex);
+			num_draw_calls++;
+		}
+	}
+	glBindVertexArray(0);
+	return num_draw_calls;
+}
+
+bool geom_draw_command_get(int index, int first_instance, int instance_count, struct Geometry_Draw_Command* out_command)
+{
+	assert(index > -1 && index < array_len(geometry_list));
+	struct Geometry* geo = &geometry_list[index];
+	size_t index_size = geo->index_type == GL_UNSIGNED_SHORT ? sizeof(uint16) : sizeof(uint32);
+	out_command->count          = geo->indices_length;
+	out_command->instance_count = (uint32)instance_count;
+	out_command->first_index    = (uint32)(((size_t)geo->index_range.offset * GEOMETRY_INDEX_UNIT_SIZE) / index_size);
+	out_command->base_vertex    = (int32)geo->vertex_range.offset;
+	out_command->base_instance  = (uint32)first_instance;
+	return geo->shared && geo->draw_indexed;
+}
+
 int geom_render_in_frustum(int                      index,
 							vec4*                   frustum,
 							struct Entity*          entity,
@@ -21,6 +21,47 @@ enum Geometry_Draw_Mode
 	GDM_NUM_DRAWMODES
 };
 
+#define GEOM_FILE_MAGIC   0x324D4753 // "SGM2", can never be mistaken for the index count at the start of a version 1 file
+#define GEOM_FILE_VERSION 2
+
+/* Version 2 .symbres files are a header followed by vertex_count of these, interleaved,
+   and then index_count indices that are 16-bit when the vertex count allows it. Normals
+   are packed as signed normalized 10_10_10_2 and uvs are stored as half floats */
+struct Geometry_Vertex
+{
+	vec3   position;
+	uint32 normal;
+	uint16 uv[2];
+};
+
+/* File backed geometry is suballocated from a vertex and an index buffer that are shared by all
+   such geometry and drawn through a single vao. Vertex ranges are in vertices so their offset
+   is the base vertex, index ranges are in units of GEOMETRY_INDEX_UNIT_SIZE bytes */
+#define GEOMETRY_INDEX_UNIT_SIZE 4
+
+struct Geometry_Range
+{
+	uint32 offset;
+	uint32 size;
+};
+
+/* Same layout as the DrawElementsIndirectCommand read by glMultiDrawElementsIndirect */
+struct Geometry_Draw_Command
+{
+	uint32 count;
+	uint32 instance_count;
+	uint32 first_index;
+	int32  base_vertex;
+	uint32 base_instance;
+};
+
+/* Per-instance data streamed to the vertex shaders for instanced draws */
+struct Geometry_Instance
+{
+	mat4 model_mat;
+	vec4 normal_mat[3]; // Columns of the inverse transpose of model_mat's upper 3x3, w is unused
+};
+
 struct Geometry 
 {
 	char* 		  		   filename;
@@ -31,9 +72,15 @@ struct Geometry
 	uint  		  		   normal_vbo;
 	uint  		  		   color_vbo;
 	uint  		  		   index_vbo;
+	uint                   index_type; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
 	uint                   vertices_length;
 	uint                   indices_length;
 	int   		  		   ref_count;
+	int                    load_id;          // Non zero while the file is being streamed in
+	bool                   uses_placeholder; // Buffers and bounds are borrowed from the placeholder until loading finishes
+	bool                   shared;           // Lives in the shared buffers, vao is the shared vao and the ranges locate the data
+	struct Geometry_Range  vertex_range;
+	struct Geometry_Range  index_range;
 	struct Bounding_Box    bounding_box;
 	struct Bounding_Sphere bounding_sphere;
 };
@@ -44,6 +91,9 @@ int  			 geom_find(const char* filename);
 void 			 geom_remove(int index);
 void 			 geom_cleanup(void);
 void 			 geom_render(int index, enum Geometry_Draw_Mode draw_mode);
+void 			 geom_render_instanced(int index, enum Geometry_Draw_Mode draw_mode, uint instance_vbo, int first_instance, int instance_count); // Geometry_Instances are read from instance_vbo starting at first_instance
+int              geom_render_indirect(enum Geometry_Draw_Mode draw_mode, uint index_type, uint instance_vbo, uint indirect_buffer, const struct Geometry_Draw_Command* commands, int first_command, int num_commands); // Shared geometry only, issues one multi draw from indirect_buffer when it is not 0 and the driver supports it, otherwise a draw per command. Returns the number of draw calls made
+bool             geom_draw_command_get(int index, int first_instance, int instance_count, struct Geometry_Draw_Command* out_command);                                                                                    // Returns false when the geometry cannot be drawn with geom_render_indirect, the command is filled in either way
 struct Geometry* geom_get(int index);
 int  			 geom_render_in_frustum(int                      index,
 	 			 						vec4*                   frustum,
@@ -3,6 +3,7 @@
 #include "../system/platform.h"
 
 #include <SDL_assert.h>
+#include <string.h>
 
 #ifndef USE_GLAD
 
@@ -12,6 +13,8 @@ SYMMETRY_GL_LIST
 
 #endif
 
+Gl_Multi_Draw_Elements_Indirect_Func gl_multi_draw_elements_indirect = NULL;
+
 int gl_load_library(void)
 {
 	int success = 1;
@@ -33,6 +36,14 @@ bool gl_load_extentions(void)
 #ifdef USE_GLAD
     if(!gladLoadGLLoader(platform_load_function_gl)) 
 		success = false;
+
+	if(success)
+	{
+		/* baseInstance in indirect commands is only honoured with base instance support, which 4.3 includes */
+		bool multi_draw_indirect = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 3) ||
+			                       (gl_extension_supported("GL_ARB_multi_draw_indirect") && gl_extension_supported("GL_ARB_base_instance"));
+		gl_multi_draw_elements_indirect = multi_draw_indirect ? (Gl_Multi_Draw_Elements_Indirect_Func)platform_load_function_gl("glMultiDrawElementsIndirect") : NULL;
+	}
 #else
 	
 #define GLE(ret, name, ...)												\
@@ -48,6 +59,19 @@ bool gl_load_extentions(void)
 	return success;
 }
 
+bool gl_extension_supported(const char* name)
+{
+	GLint num_extensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+	for(GLint i = 0; i < num_extensions; i++)
+	{
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+		if(extension && strcmp(extension, name) == 0)
+			return true;
+	}
+	return false;
+}
+
 void gl_check_error(const char * expression, unsigned int line, const char * file)
 {
 	int error = 1;
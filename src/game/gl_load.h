@@ -62,6 +62,14 @@ SYMMETRY_GL_LIST
 #endif
 
 
+#ifndef GL_DRAW_INDIRECT_BUFFER
+	#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+/* Newer than the core 3.3 functions glad was generated for, loaded by hand when available */
+typedef void (APIENTRYP Gl_Multi_Draw_Elements_Indirect_Func)(GLenum mode, GLenum type, const void* indirect, GLsizei draw_count, GLsizei stride);
+extern Gl_Multi_Draw_Elements_Indirect_Func gl_multi_draw_elements_indirect; // NULL unless gl 4.3, or ARB_multi_draw_indirect along with ARB_base_instance, is available
+
 #ifdef GL_DEBUG_CONTEXT
 	#define GL_CHECK(expression) do { expression; gl_check_error(#expression, __LINE__, __FILE__);} while(false)
 #else
@@ -70,6 +78,7 @@ SYMMETRY_GL_LIST
 
 int  gl_load_library(void);
 bool gl_load_extentions(void);
+bool gl_extension_supported(const char* name); // Only valid once gl_load_extentions has succeeded
 void gl_check_error(const char* expression, unsigned int line, const char* file);
 void gl_cleanup(void);
 
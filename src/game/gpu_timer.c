@@ -0,0 +1,99 @@
+#include "gpu_timer.h"
+#include "gl_load.h"
+#include "../common/log.h"
+
+#include <string.h>
+#include <assert.h>
+
+static void gpu_timer_pool_collect(struct Gpu_Timer_Pool* pool, int frame);
+
+void gpu_timer_pool_init(struct Gpu_Timer_Pool* pool, int num_timers)
+{
+	assert(num_timers > 0 && num_timers <= MAX_GPU_TIMERS);
+	memset(pool, 0, sizeof(*pool));
+	pool->num_timers   = num_timers;
+	pool->active_timer = -1;
+
+	GLint counter_bits = 0;
+	GL_CHECK(glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &counter_bits));
+	if(counter_bits == 0)
+	{
+		log_warning("GPU timer queries are not supported by the driver, gpu timings will not be available");
+		return;
+	}
+
+	for(int i = 0; i < GPU_TIMER_FRAMES; i++)
+		GL_CHECK(glGenQueries(num_timers, pool->queries[i]));
+	pool->supported = true;
+}
+
+void gpu_timer_pool_destroy(struct Gpu_Timer_Pool* pool)
+{
+	if(pool->supported)
+	{
+		for(int i = 0; i < GPU_TIMER_FRAMES; i++)
+			GL_CHECK(glDeleteQueries(pool->num_timers, pool->queries[i]));
+	}
+	memset(pool, 0, sizeof(*pool));
+	pool->active_timer = -1;
+}
+
+void gpu_timer_pool_frame_begin(struct Gpu_Timer_Pool* pool)
+{
+	if(!pool->supported) return;
+
+	if(pool->active_timer != -1)
+	{
+		log_error("gpu_timer:frame_begin", "Timer %d was not ended last frame", pool->active_timer);
+		gpu_timer_end(pool, pool->active_timer);
+	}
+
+	// Oldest first so that the newest available result is the one left in elapsed_ms
+	pool->frame = (pool->frame + 1) % GPU_TIMER_FRAMES;
+	for(int i = 0; i < GPU_TIMER_FRAMES; i++)
+		gpu_timer_pool_collect(pool, (pool->frame + i) % GPU_TIMER_FRAMES);
+}
+
+void gpu_timer_begin(struct Gpu_Timer_Pool* pool, int timer)
+{
+	assert(timer >= 0 && timer < pool->num_timers);
+	if(!pool->supported || pool->active_timer != -1) return;
+
+	// Still waiting on the result from GPU_TIMER_FRAMES ago, skip this frame instead of stalling
+	if(pool->pending[pool->frame][timer]) return;
+
+	GL_CHECK(glBeginQuery(GL_TIME_ELAPSED, pool->queries[pool->frame][timer]));
+	pool->active_timer = timer;
+}
+
+void gpu_timer_end(struct Gpu_Timer_Pool* pool, int timer)
+{
+	if(!pool->supported || pool->active_timer != timer) return;
+
+	GL_CHECK(glEndQuery(GL_TIME_ELAPSED));
+	pool->pending[pool->frame][timer] = true;
+	pool->active_timer = -1;
+}
+
+float gpu_timer_elapsed_ms_get(struct Gpu_Timer_Pool* pool, int timer)
+{
+	assert(timer >= 0 && timer < MAX_GPU_TIMERS);
+	return pool->elapsed_ms[timer];
+}
+
+void gpu_timer_pool_collect(struct Gpu_Timer_Pool* pool, int frame)
+{
+	for(int i = 0; i < pool->num_timers; i++)
+	{
+		if(!pool->pending[frame][i]) continue;
+
+		GLint available = GL_FALSE;
+		GL_CHECK(glGetQueryObjectiv(pool->queries[frame][i], GL_QUERY_RESULT_AVAILABLE, &available));
+		if(!available) continue;
+
+		GLuint64 elapsed_ns = 0;
+		GL_CHECK(glGetQueryObjectui64v(pool->queries[frame][i], GL_QUERY_RESULT, &elapsed_ns));
+		pool->elapsed_ms[i]     = (float)((double)elapsed_ns / 1000000.0);
+		pool->pending[frame][i] = false;
+	}
+}
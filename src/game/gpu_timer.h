@@ -0,0 +1,34 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <stdbool.h>
+#include "../common/num_types.h"
+
+/* Measures how long the gpu spends between a begin and end pair using GL_TIME_ELAPSED
+   queries. Every timer has one query per buffered frame and results are only read back
+   once they are available so the cpu never waits on the gpu, the reported times are
+   therefore a couple of frames old. Only one timer can be running at a time since gl
+   does not allow nesting elapsed time queries */
+
+#define MAX_GPU_TIMERS      16
+#define GPU_TIMER_FRAMES    3
+
+struct Gpu_Timer_Pool
+{
+	bool   supported;                                  // False when the driver reports a zero bit timer, all calls then do nothing
+	int    num_timers;
+	int    frame;                                      // Slot being recorded into, cycles through GPU_TIMER_FRAMES
+	int    active_timer;                               // -1 when no query is running
+	uint   queries[GPU_TIMER_FRAMES][MAX_GPU_TIMERS];
+	bool   pending[GPU_TIMER_FRAMES][MAX_GPU_TIMERS];  // Query was issued and its result has not been read yet
+	float  elapsed_ms[MAX_GPU_TIMERS];                 // Latest result per timer
+};
+
+void  gpu_timer_pool_init(struct Gpu_Timer_Pool* pool, int num_timers);
+void  gpu_timer_pool_destroy(struct Gpu_Timer_Pool* pool);
+void  gpu_timer_pool_frame_begin(struct Gpu_Timer_Pool* pool); // Collects whatever results have become available and moves on to the next slot
+void  gpu_timer_begin(struct Gpu_Timer_Pool* pool, int timer);
+void  gpu_timer_end(struct Gpu_Timer_Pool* pool, int timer);
+float gpu_timer_elapsed_ms_get(struct Gpu_Timer_Pool* pool, int timer);
+
+#endif
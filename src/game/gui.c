@@ -14,6 +14,7 @@
 #include "../system/file_io.h"
 #include "event.h"
 #include "gui_game.h"
+#include "profiler.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -155,6 +156,7 @@ void gui_render(struct Gui* gui, enum nk_anti_aliasing AA)
     struct nk_vec2 scale;
     mat4 gui_mat;
 	
+    PROFILE_BEGIN("Gui Render");
     mat4_identity(&gui_mat);
     struct Game_State* game_state = game_state_get();
     window_get_size(game_state->window, &width, &height);
@@ -248,6 +250,7 @@ void gui_render(struct Gui* gui, enum nk_anti_aliasing AA)
     glBindVertexArray(0);
     glDisable(GL_BLEND);
     glDisable(GL_SCISSOR_TEST);
+    PROFILE_END();
 }
 
 void gui_on_clipbard_paste(nk_handle usr, struct nk_text_edit *edit)
@@ -266,7 +269,7 @@ void gui_on_clipbard_copy(nk_handle usr, const char *text, int len)
     char *str = 0;
     (void)usr;
     if (!len) return;
-    str = (char*)memory_allocate((size_t)len+1);
+    str = (char*)memory_allocate_tagged((size_t)len+1, MT_GUI);
     if (!str) return;
     memcpy(str, text, (size_t)len);
     str[len] = '\0';
@@ -619,7 +622,7 @@ void gui_theme_set(struct Gui* gui, enum Gui_Theme theme)
 
 void* gui_allocate_wrapper(nk_handle handle, void* old, nk_size size)
 {
-    return memory_allocate(size);
+    return memory_allocate_tagged(size, MT_GUI);
 }
 
 void gui_free_wrapper(nk_handle handle, void* old)
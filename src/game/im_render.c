@@ -6,6 +6,7 @@
 #include "../common/num_types.h"
 #include "shader.h"
 #include "../common/log.h"
+#include "profiler.h"
 #include "geometry.h"
 
 #include <string.h>
@@ -22,6 +23,8 @@ static struct
 	uint             vao;
 	uint             vbo;
 	int              im_shader;
+	int              uniform_mvp;
+	int              uniform_geom_color;
 	int              curr_geom;
 	int              curr_vertex;
 }
@@ -59,7 +62,9 @@ void im_init(void)
 	IM_State.curr_geom   = -1;
 	IM_State.curr_vertex =  0;
 
-	IM_State.im_shader = shader_create("im_geom.vert", "im_geom.frag", NULL);
+	IM_State.im_shader          = shader_create("im_geom.vert", "im_geom.frag", NULL);
+	IM_State.uniform_mvp        = shader_get_uniform_location(IM_State.im_shader, "mvp");
+	IM_State.uniform_geom_color = shader_get_uniform_location(IM_State.im_shader, "geom_color");
 }
 
 void im_cleanup(void)
@@ -248,6 +253,7 @@ void im_render(struct Camera* active_viewer)
 	if(IM_State.curr_geom == -1)
 		return;
 
+	PROFILE_BEGIN("Immediate Mode Render");
 	/* If there are more than one geometries, sort by draw order. Geometries with lower draw order get drawn first */
 	if(IM_State.curr_geom + 1 > 1)
 		qsort(IM_State.geometries, IM_State.curr_geom + 1, sizeof(struct IM_Geom), &im_sort_func);
@@ -282,8 +288,8 @@ void im_render(struct Camera* active_viewer)
 
 			mat4_mul(&mvp, &active_viewer->view_proj_mat, &mvp);
 
-			shader_set_uniform_mat4(IM_State.im_shader, "mvp", &mvp);
-			shader_set_uniform_vec4(IM_State.im_shader, "geom_color", &geom->color);
+			shader_set_uniform(UT_MAT4, IM_State.uniform_mvp, &mvp);
+			shader_set_uniform(UT_VEC4, IM_State.uniform_geom_color, &geom->color);
 			if(geom->type == IGT_DYNAMIC)
 			{
 				GL_CHECK(glBindVertexArray(IM_State.vao));
@@ -307,6 +313,7 @@ void im_render(struct Camera* active_viewer)
 
 	IM_State.curr_geom   = -1;
 	IM_State.curr_vertex =  0;
+	PROFILE_END();
 }
 
 void im_geom_reset(struct IM_Geom* geom)
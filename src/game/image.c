@@ -0,0 +1,697 @@
+#include "image.h"
+#include "../common/memory_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The swizzle uses SSE2 when the compiler targets it, the scalar loop handles the pixels
+   left over at the end and is the reference the SSE2 path must match */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define IMAGE_SSE2
+	#include <emmintrin.h>
+#endif
+
+#define TGA_TYPE_TRUE_COLOR     2
+#define TGA_TYPE_TRUE_COLOR_RLE 10
+#define TGA_ORIGIN_TOP          0x20 // Image descriptor bit, rows are stored top to bottom instead of bottom to top
+#define TGA_PACKET_RUN          0x80
+
+#define IMAGE_CONTAINER_MAGIC   0x58544253 // "SBTX" when read as little endian bytes
+#define IMAGE_CONTAINER_VERSION 1
+#define IMAGE_MAX_DIMENSION     (1 << (MAX_IMAGE_LEVELS - 1))
+
+/* Containers hold an image exactly as it is handed to gl, the header is followed by a table
+   with one entry per level and then the level data itself, largest level first */
+#pragma pack(push, 1)
+struct Image_Container_Header
+{
+	uint32 magic;
+	uint32 version;
+	uint32 format;
+	uint32 width;
+	uint32 height;
+	uint32 num_levels;
+};
+
+struct Image_Container_Level
+{
+	uint32 offset; // From the start of the file
+	uint32 size;
+};
+#pragma pack(pop)
+
+static bool   image_tga_decode_rle(const uint8* source, const uint8* source_end, uint8* dest, size_t num_pixels, int channels);
+static void   image_pixel_fill(uint8* dest, const uint8* pixel, size_t num_pixels, int channels);
+static void   image_rows_flip(uint8* pixels, int width, int height, int channels);
+static bool   image_levels_allocate(struct Image* image, int format, int width, int height, int num_levels);
+static void   image_level_downsample(const struct Image_Level* source, const struct Image_Level* dest, int channels);
+static void   image_block_fetch(const struct Image_Level* level, int channels, int block_x, int block_y, uint8 block[16][4]);
+static void   image_block_colour_encode(uint8 block[16][4], uint8* out);
+static void   image_block_alpha_encode(uint8 block[16][4], uint8* out);
+static uint16 image_rgb565_pack(const uint8* colour);
+static void   image_rgb565_unpack(uint16 packed, uint8* colour);
+
+bool image_tga_decode(const uint8* file_data, size_t file_size, uint8** out_pixels, int* out_width, int* out_height, int* out_channels, char* error, size_t error_len)
+{
+	*out_pixels = NULL;
+	if(file_size < sizeof(struct Tga_Header))
+	{
+		snprintf(error, error_len, "Could not read header");
+		return false;
+	}
+
+	struct Tga_Header header;
+	memcpy(&header, file_data, sizeof(header));
+	if(header.datatypecode == 0)
+	{
+		snprintf(error, error_len, "No image data in file");
+		return false;
+	}
+
+	/* only compressed and uncompressed true color image data supported yet */
+	if(header.datatypecode != TGA_TYPE_TRUE_COLOR && header.datatypecode != TGA_TYPE_TRUE_COLOR_RLE)
+	{
+		snprintf(error, error_len, "Unsupported image data type");
+		return false;
+	}
+
+	if(header.bitsperpixel != 24 && header.bitsperpixel != 32)
+	{
+		snprintf(error, error_len, "Unsupported bitsperpixel size(%d), only 24 and 32 supported", header.bitsperpixel);
+		return false;
+	}
+
+	if(header.width <= 0 || header.height <= 0)
+	{
+		snprintf(error, error_len, "Invalid width and height (%d:%d)", header.width, header.height);
+		return false;
+	}
+
+	/* skip over unnecessary things like colormap data */
+	size_t data_offset = sizeof(header) + (uint8)header.idlength;
+	if(header.colourmaptype == 1)
+		data_offset += (size_t)(uint16)header.colourmaplength * (((uint8)header.colourmapdepth + 7) / 8);
+	if(data_offset > file_size)
+	{
+		snprintf(error, error_len, "Unexpected end of file before pixel data");
+		return false;
+	}
+
+	int    channels   = header.bitsperpixel / 8;
+	size_t num_pixels = (size_t)header.width * (size_t)header.height;
+	size_t image_size = num_pixels * channels;
+	const uint8* source     = file_data + data_offset;
+	const uint8* source_end = file_data + file_size;
+
+	uint8* pixels = memory_allocate_tagged(image_size, MT_TEXTURE);
+	if(!pixels)
+	{
+		snprintf(error, error_len, "Out of memory");
+		return false;
+	}
+
+	if(header.datatypecode == TGA_TYPE_TRUE_COLOR)
+	{
+		if((size_t)(source_end - source) < image_size)
+		{
+			snprintf(error, error_len, "Unexpected end of file, expected %zu bytes of pixel data", image_size);
+			memory_free(pixels);
+			return false;
+		}
+		image_swizzle_red_blue(source, pixels, num_pixels, channels);
+	}
+	else
+	{
+		/* Packets are expanded as stored and swizzled in one pass afterwards */
+		if(!image_tga_decode_rle(source, source_end, pixels, num_pixels, channels))
+		{
+			snprintf(error, error_len, "Unexpected end of file in RLE data");
+			memory_free(pixels);
+			return false;
+		}
+		image_swizzle_red_blue(pixels, pixels, num_pixels, channels);
+	}
+
+	if(header.imagedescriptor & TGA_ORIGIN_TOP)
+		image_rows_flip(pixels, header.width, header.height, channels);
+
+	*out_pixels   = pixels;
+	*out_width    = header.width;
+	*out_height   = header.height;
+	*out_channels = channels;
+	return true;
+}
+
+void image_swizzle_red_blue(const uint8* source, uint8* dest, size_t num_pixels, int channels)
+{
+	size_t i = 0;
+#if defined(IMAGE_SSE2)
+	if(channels == 4)
+	{
+		/* Four pixels at a time, green and alpha stay where they are while red and blue trade
+		   places by rotating each 32 bit pixel by 16 bits */
+		const __m128i green_alpha = _mm_set1_epi32((int)0xFF00FF00);
+		const __m128i red_blue    = _mm_set1_epi32(0x00FF00FF);
+		for(; i + 4 <= num_pixels; i += 4)
+		{
+			__m128i pixels  = _mm_loadu_si128((const __m128i*)(source + i * 4));
+			__m128i ga      = _mm_and_si128(pixels, green_alpha);
+			__m128i rb      = _mm_and_si128(pixels, red_blue);
+			__m128i swapped = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+			_mm_storeu_si128((__m128i*)(dest + i * 4), _mm_or_si128(ga, swapped));
+		}
+	}
+	else
+	{
+		/* Sixteen pixels at a time, 48 bytes span three registers and line up with the pixels
+		   again at the end. Every byte either stays, takes the byte two ahead or takes the byte
+		   two behind, which for pixels split between registers comes from the neighbouring one */
+		uint8 keep[3][16], from_ahead[3][16], from_behind[3][16], from_next[3][16], from_previous[3][16];
+		memset(from_next, 0, sizeof(from_next));
+		memset(from_previous, 0, sizeof(from_previous));
+		for(int r = 0; r < 3; r++)
+		{
+			for(int b = 0; b < 16; b++)
+			{
+				int position = r * 16 + b;
+				int channel  = position % 3;
+				keep[r][b]        = channel == 1 ? 0xFF : 0;
+				from_ahead[r][b]  = channel == 0 && b <= 13 ? 0xFF : 0;
+				from_behind[r][b] = channel == 2 && b >= 2  ? 0xFF : 0;
+				if(channel == 0 && b > 13) from_next[r][b]     = 0xFF;
+				if(channel == 2 && b < 2)  from_previous[r][b] = 0xFF;
+			}
+		}
+
+		__m128i keep_mask[3], ahead_mask[3], behind_mask[3], next_mask[3], previous_mask[3];
+		for(int r = 0; r < 3; r++)
+		{
+			keep_mask[r]     = _mm_loadu_si128((const __m128i*)keep[r]);
+			ahead_mask[r]    = _mm_loadu_si128((const __m128i*)from_ahead[r]);
+			behind_mask[r]   = _mm_loadu_si128((const __m128i*)from_behind[r]);
+			next_mask[r]     = _mm_loadu_si128((const __m128i*)from_next[r]);
+			previous_mask[r] = _mm_loadu_si128((const __m128i*)from_previous[r]);
+		}
+
+		for(; i + 16 <= num_pixels; i += 16)
+		{
+			__m128i in[4];
+			in[0] = _mm_setzero_si128();
+			in[1] = _mm_loadu_si128((const __m128i*)(source + i * 3));
+			in[2] = _mm_loadu_si128((const __m128i*)(source + i * 3 + 16));
+			in[3] = _mm_loadu_si128((const __m128i*)(source + i * 3 + 32));
+			__m128i out[3];
+			for(int r = 0; r < 3; r++)
+			{
+				__m128i current  = in[r + 1];
+				__m128i next     = r < 2 ? in[r + 2] : _mm_setzero_si128();
+				__m128i previous = in[r];
+				__m128i result   = _mm_and_si128(current, keep_mask[r]);
+				result = _mm_or_si128(result, _mm_and_si128(_mm_srli_si128(current, 2), ahead_mask[r]));
+				result = _mm_or_si128(result, _mm_and_si128(_mm_slli_si128(current, 2), behind_mask[r]));
+				result = _mm_or_si128(result, _mm_and_si128(_mm_slli_si128(next, 14), next_mask[r]));
+				result = _mm_or_si128(result, _mm_and_si128(_mm_srli_si128(previous, 14), previous_mask[r]));
+				out[r] = result;
+			}
+			_mm_storeu_si128((__m128i*)(dest + i * 3), out[0]);
+			_mm_storeu_si128((__m128i*)(dest + i * 3 + 16), out[1]);
+			_mm_storeu_si128((__m128i*)(dest + i * 3 + 32), out[2]);
+		}
+	}
+#endif
+
+	for(; i < num_pixels; i++)
+	{
+		const uint8* pixel = source + i * channels;
+		uint8*       out   = dest + i * channels;
+		uint8 blue = pixel[0];
+		out[0] = pixel[2];
+		out[1] = pixel[1];
+		out[2] = blue;
+		if(channels == 4) out[3] = pixel[3];
+	}
+}
+
+void image_free(struct Image* image)
+{
+	if(image->storage) memory_free(image->storage);
+	memset(image, 0, sizeof(*image));
+}
+
+size_t image_level_size_get(int format, int width, int height)
+{
+	size_t num_blocks = (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4);
+	switch(format)
+	{
+	case IMF_RGB8:  return (size_t)width * (size_t)height * 3;
+	case IMF_RGBA8: return (size_t)width * (size_t)height * 4;
+	case IMF_BC1:   return num_blocks * 8;
+	case IMF_BC3:   return num_blocks * 16;
+	default:        return 0;
+	}
+}
+
+bool image_mips_build(const uint8* pixels, int width, int height, int channels, int max_levels, struct Image* out_image)
+{
+	memset(out_image, 0, sizeof(*out_image));
+	if((channels != 3 && channels != 4) || width <= 0 || height <= 0 || width > IMAGE_MAX_DIMENSION || height > IMAGE_MAX_DIMENSION)
+		return false;
+
+	int num_levels = 1;
+	for(int size = width > height ? width : height; size > 1; size /= 2)
+		num_levels++;
+	if(max_levels > 0 && num_levels > max_levels) num_levels = max_levels;
+
+	if(!image_levels_allocate(out_image, channels == 3 ? IMF_RGB8 : IMF_RGBA8, width, height, num_levels))
+		return false;
+
+	memcpy(out_image->storage, pixels, out_image->levels[0].size);
+	for(int i = 1; i < num_levels; i++)
+		image_level_downsample(&out_image->levels[i - 1], &out_image->levels[i], channels);
+	return true;
+}
+
+bool image_compress(const struct Image* source, struct Image* out_image)
+{
+	memset(out_image, 0, sizeof(*out_image));
+	if(source->format != IMF_RGB8 && source->format != IMF_RGBA8)
+		return false;
+
+	int channels = source->format == IMF_RGB8 ? 3 : 4;
+	int format   = source->format == IMF_RGB8 ? IMF_BC1 : IMF_BC3;
+	if(!image_levels_allocate(out_image, format, source->width, source->height, source->num_levels))
+		return false;
+
+	for(int i = 0; i < source->num_levels; i++)
+	{
+		const struct Image_Level* level = &source->levels[i];
+		uint8* out = (uint8*)out_image->levels[i].data;
+		for(int block_y = 0; block_y < level->height; block_y += 4)
+		{
+			for(int block_x = 0; block_x < level->width; block_x += 4)
+			{
+				uint8 block[16][4];
+				image_block_fetch(level, channels, block_x, block_y, block);
+				if(format == IMF_BC3)
+				{
+					image_block_alpha_encode(block, out);
+					out += 8;
+				}
+				image_block_colour_encode(block, out);
+				out += 8;
+			}
+		}
+	}
+	return true;
+}
+
+bool image_container_parse(const uint8* file_data, size_t file_size, struct Image* out_image, char* error, size_t error_len)
+{
+	memset(out_image, 0, sizeof(*out_image));
+	struct Image_Container_Header header;
+	if(file_size < sizeof(header))
+	{
+		snprintf(error, error_len, "Could not read header");
+		return false;
+	}
+
+	memcpy(&header, file_data, sizeof(header));
+	if(header.magic != IMAGE_CONTAINER_MAGIC)
+	{
+		snprintf(error, error_len, "Not a texture container");
+		return false;
+	}
+
+	if(header.version != IMAGE_CONTAINER_VERSION)
+	{
+		snprintf(error, error_len, "Unsupported container version %u, expected %u", header.version, IMAGE_CONTAINER_VERSION);
+		return false;
+	}
+
+	if(header.format >= IMF_MAX)
+	{
+		snprintf(error, error_len, "Unknown image format %u", header.format);
+		return false;
+	}
+
+	if(header.width == 0 || header.height == 0 || header.width > IMAGE_MAX_DIMENSION || header.height > IMAGE_MAX_DIMENSION)
+	{
+		snprintf(error, error_len, "Invalid width and height (%u:%u)", header.width, header.height);
+		return false;
+	}
+
+	if(header.num_levels == 0 || header.num_levels > MAX_IMAGE_LEVELS)
+	{
+		snprintf(error, error_len, "Invalid number of levels %u", header.num_levels);
+		return false;
+	}
+
+	const uint8* level_table = file_data + sizeof(header);
+	if(file_size - sizeof(header) < header.num_levels * sizeof(struct Image_Container_Level))
+	{
+		snprintf(error, error_len, "Unexpected end of file in level table");
+		return false;
+	}
+
+	int width  = (int)header.width;
+	int height = (int)header.height;
+	for(uint32 i = 0; i < header.num_levels; i++)
+	{
+		struct Image_Container_Level entry;
+		memcpy(&entry, level_table + i * sizeof(entry), sizeof(entry));
+		size_t expected_size = image_level_size_get((int)header.format, width, height);
+		if(entry.size != expected_size)
+		{
+			snprintf(error, error_len, "Level %u has %u bytes, expected %zu", i, entry.size, expected_size);
+			return false;
+		}
+
+		if(entry.offset > file_size || entry.size > file_size - entry.offset)
+		{
+			snprintf(error, error_len, "Level %u runs past the end of the file", i);
+			return false;
+		}
+
+		struct Image_Level* level = &out_image->levels[i];
+		level->data   = file_data + entry.offset;
+		level->size   = entry.size;
+		level->width  = width;
+		level->height = height;
+		width  = width  > 1 ? width  / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	out_image->format     = (int)header.format;
+	out_image->width      = (int)header.width;
+	out_image->height     = (int)header.height;
+	out_image->num_levels = (int)header.num_levels;
+	return true;
+}
+
+bool image_container_write(const struct Image* image, const char* path)
+{
+	FILE* file = fopen(path, "wb");
+	if(!file) return false;
+
+	struct Image_Container_Header header;
+	header.magic      = IMAGE_CONTAINER_MAGIC;
+	header.version    = IMAGE_CONTAINER_VERSION;
+	header.format     = (uint32)image->format;
+	header.width      = (uint32)image->width;
+	header.height     = (uint32)image->height;
+	header.num_levels = (uint32)image->num_levels;
+
+	struct Image_Container_Level entries[MAX_IMAGE_LEVELS];
+	uint32 offset = sizeof(header) + image->num_levels * sizeof(struct Image_Container_Level);
+	for(int i = 0; i < image->num_levels; i++)
+	{
+		entries[i].offset = offset;
+		entries[i].size   = image->levels[i].size;
+		offset += image->levels[i].size;
+	}
+
+	bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+		           fwrite(entries, sizeof(entries[0]), (size_t)image->num_levels, file) == (size_t)image->num_levels;
+	for(int i = 0; success && i < image->num_levels; i++)
+		success = fwrite(image->levels[i].data, image->levels[i].size, 1, file) == 1;
+
+	if(fclose(file) != 0) success = false;
+	return success;
+}
+
+static bool image_tga_decode_rle(const uint8* source, const uint8* source_end, uint8* dest, size_t num_pixels, int channels)
+{
+	size_t pixel_index = 0;
+	while(pixel_index < num_pixels)
+	{
+		if(source >= source_end) return false;
+
+		uint8  packet = *source++;
+		size_t count  = (size_t)(packet & 0x7f) + 1;
+		if(count > num_pixels - pixel_index) count = num_pixels - pixel_index; // Malformed packet running past the image
+
+		uint8* out = dest + pixel_index * channels;
+		if(packet & TGA_PACKET_RUN)
+		{
+			if(source_end - source < channels) return false;
+			image_pixel_fill(out, source, count, channels);
+			source += channels;
+		}
+		else
+		{
+			size_t size = count * channels;
+			if((size_t)(source_end - source) < size) return false;
+			memcpy(out, source, size);
+			source += size;
+		}
+		pixel_index += count;
+	}
+	return true;
+}
+
+static void image_pixel_fill(uint8* dest, const uint8* pixel, size_t num_pixels, int channels)
+{
+	// Most runs are only a few pixels long where setting up bigger copies costs more than it saves
+	if(num_pixels <= 8)
+	{
+		for(size_t i = 0; i < num_pixels; i++, dest += channels)
+		{
+			dest[0] = pixel[0];
+			dest[1] = pixel[1];
+			dest[2] = pixel[2];
+			if(channels == 4) dest[3] = pixel[3];
+		}
+		return;
+	}
+
+	bool same_bytes = pixel[0] == pixel[1] && pixel[1] == pixel[2] && (channels == 3 || pixel[2] == pixel[3]);
+	if(same_bytes)
+	{
+		memset(dest, pixel[0], num_pixels * channels);
+		return;
+	}
+
+	// Keep doubling what has been written so far so a run takes a handful of copies
+	size_t total  = num_pixels * channels;
+	size_t filled = channels;
+	memcpy(dest, pixel, channels);
+	while(filled < total)
+	{
+		size_t amount = filled < total - filled ? filled : total - filled;
+		memcpy(dest + filled, dest, amount);
+		filled += amount;
+	}
+}
+
+static void image_rows_flip(uint8* pixels, int width, int height, int channels)
+{
+	size_t row_size = (size_t)width * channels;
+	uint8  buffer[1024];
+	for(int row = 0; row < height / 2; row++)
+	{
+		uint8* top    = pixels + row * row_size;
+		uint8* bottom = pixels + (height - 1 - row) * row_size;
+		for(size_t offset = 0; offset < row_size; offset += sizeof(buffer))
+		{
+			size_t amount = row_size - offset < sizeof(buffer) ? row_size - offset : sizeof(buffer);
+			memcpy(buffer, top + offset, amount);
+			memcpy(top + offset, bottom + offset, amount);
+			memcpy(bottom + offset, buffer, amount);
+		}
+	}
+}
+
+static bool image_levels_allocate(struct Image* image, int format, int width, int height, int num_levels)
+{
+	size_t total_size   = 0;
+	int    level_width  = width;
+	int    level_height = height;
+	for(int i = 0; i < num_levels; i++)
+	{
+		struct Image_Level* level = &image->levels[i];
+		level->width  = level_width;
+		level->height = level_height;
+		level->size   = (uint32)image_level_size_get(format, level_width, level_height);
+		total_size   += level->size;
+		level_width   = level_width  > 1 ? level_width  / 2 : 1;
+		level_height  = level_height > 1 ? level_height / 2 : 1;
+	}
+
+	image->storage = memory_allocate_tagged(total_size, MT_TEXTURE);
+	if(!image->storage) return false;
+
+	uint8* data = image->storage;
+	for(int i = 0; i < num_levels; i++)
+	{
+		image->levels[i].data = data;
+		data += image->levels[i].size;
+	}
+	image->format     = format;
+	image->width      = width;
+	image->height     = height;
+	image->num_levels = num_levels;
+	return true;
+}
+
+static void image_level_downsample(const struct Image_Level* source, const struct Image_Level* dest, int channels)
+{
+	/* Box filter, odd rows and columns at the edge are averaged with themselves */
+	size_t row_size = (size_t)source->width * channels;
+	uint8* out      = (uint8*)dest->data;
+	for(int y = 0; y < dest->height; y++)
+	{
+		const uint8* row0 = source->data + (size_t)(y * 2) * row_size;
+		const uint8* row1 = y * 2 + 1 < source->height ? row0 + row_size : row0;
+		for(int x = 0; x < dest->width; x++)
+		{
+			int column0 = x * 2 * channels;
+			int column1 = x * 2 + 1 < source->width ? column0 + channels : column0;
+			for(int c = 0; c < channels; c++)
+				*out++ = (uint8)((row0[column0 + c] + row0[column1 + c] + row1[column0 + c] + row1[column1 + c] + 2) >> 2);
+		}
+	}
+}
+
+static void image_block_fetch(const struct Image_Level* level, int channels, int block_x, int block_y, uint8 block[16][4])
+{
+	/* Blocks hanging over the edge of levels smaller than 4x4, or not a multiple of 4, repeat the last row and column */
+	for(int i = 0; i < 16; i++)
+	{
+		int x = block_x + i % 4;
+		int y = block_y + i / 4;
+		if(x >= level->width)  x = level->width - 1;
+		if(y >= level->height) y = level->height - 1;
+		const uint8* pixel = level->data + ((size_t)y * level->width + x) * channels;
+		block[i][0] = pixel[0];
+		block[i][1] = pixel[1];
+		block[i][2] = pixel[2];
+		block[i][3] = channels == 4 ? pixel[3] : 255;
+	}
+}
+
+static void image_block_colour_encode(uint8 block[16][4], uint8* out)
+{
+	/* Endpoints come from the bounding box of the block's colours, pulled in slightly so the
+	   interpolated colours sit on the bulk of the block rather than on its outliers */
+	uint8 min[3] = {255, 255, 255};
+	uint8 max[3] = {0, 0, 0};
+	for(int i = 0; i < 16; i++)
+	{
+		for(int c = 0; c < 3; c++)
+		{
+			if(block[i][c] < min[c]) min[c] = block[i][c];
+			if(block[i][c] > max[c]) max[c] = block[i][c];
+		}
+	}
+
+	for(int c = 0; c < 3; c++)
+	{
+		uint8 inset = (uint8)((max[c] - min[c]) >> 4);
+		min[c] += inset;
+		max[c] -= inset;
+	}
+
+	/* Every channel of max is at least that of min so colour0 >= colour1, keeping the block in four colour mode.
+	   When both are equal every index is left at 0 so the transparent entry of three colour mode is never used */
+	uint16 colour0 = image_rgb565_pack(max);
+	uint16 colour1 = image_rgb565_pack(min);
+	uint32 indices = 0;
+	if(colour0 != colour1)
+	{
+		uint8 palette[4][3];
+		image_rgb565_unpack(colour0, palette[0]);
+		image_rgb565_unpack(colour1, palette[1]);
+		for(int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (uint8)((2 * palette[0][c] + palette[1][c]) / 3);
+			palette[3][c] = (uint8)((palette[0][c] + 2 * palette[1][c]) / 3);
+		}
+
+		for(int i = 0; i < 16; i++)
+		{
+			int best_index    = 0;
+			int best_distance = 0x7FFFFFFF;
+			for(int p = 0; p < 4; p++)
+			{
+				int distance = 0;
+				for(int c = 0; c < 3; c++)
+				{
+					int difference = block[i][c] - palette[p][c];
+					distance += difference * difference;
+				}
+				if(distance < best_distance)
+				{
+					best_distance = distance;
+					best_index    = p;
+				}
+			}
+			indices |= (uint32)best_index << (i * 2);
+		}
+	}
+
+	out[0] = (uint8)(colour0 & 0xFF);
+	out[1] = (uint8)(colour0 >> 8);
+	out[2] = (uint8)(colour1 & 0xFF);
+	out[3] = (uint8)(colour1 >> 8);
+	for(int i = 0; i < 4; i++)
+		out[4 + i] = (uint8)(indices >> (i * 8));
+}
+
+static void image_block_alpha_encode(uint8 block[16][4], uint8* out)
+{
+	uint8 min = 255;
+	uint8 max = 0;
+	for(int i = 0; i < 16; i++)
+	{
+		if(block[i][3] < min) min = block[i][3];
+		if(block[i][3] > max) max = block[i][3];
+	}
+
+	/* alpha0 > alpha1 selects the mode with six interpolated values between the endpoints */
+	uint64 indices = 0;
+	if(max != min)
+	{
+		uint8 palette[8];
+		palette[0] = max;
+		palette[1] = min;
+		for(int i = 1; i < 7; i++)
+			palette[i + 1] = (uint8)(((7 - i) * max + i * min) / 7);
+
+		for(int i = 0; i < 16; i++)
+		{
+			int best_index    = 0;
+			int best_distance = 256;
+			for(int p = 0; p < 8; p++)
+			{
+				int distance = abs(block[i][3] - palette[p]);
+				if(distance < best_distance)
+				{
+					best_distance = distance;
+					best_index    = p;
+				}
+			}
+			indices |= (uint64)best_index << (i * 3);
+		}
+	}
+
+	out[0] = max;
+	out[1] = min;
+	for(int i = 0; i < 6; i++)
+		out[2 + i] = (uint8)(indices >> (i * 8));
+}
+
+static uint16 image_rgb565_pack(const uint8* colour)
+{
+	return (uint16)(((colour[0] >> 3) << 11) | ((colour[1] >> 2) << 5) | (colour[2] >> 3));
+}
+
+static void image_rgb565_unpack(uint16 packed, uint8* colour)
+{
+	uint8 red   = (uint8)((packed >> 11) & 0x1F);
+	uint8 green = (uint8)((packed >> 5) & 0x3F);
+	uint8 blue  = (uint8)(packed & 0x1F);
+	colour[0] = (uint8)((red << 3) | (red >> 2));
+	colour[1] = (uint8)((green << 2) | (green >> 4));
+	colour[2] = (uint8)((blue << 3) | (blue >> 2));
+}
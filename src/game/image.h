@@ -0,0 +1,71 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include "../common/num_types.h"
+
+#include <stddef.h>
+
+/* Decoding of image files that have already been read into memory. Pixels come out tightly
+   packed with the bottom row first, which is the layout glTexImage2D expects. Nothing here
+   touches gl or engine state so these are safe to call from asset loader workers.
+   The mip chain builder, block compressors and container writer are used by the offline
+   texture importer, the engine only parses containers and uploads their levels as stored */
+
+#define IMAGE_CONTAINER_EXTENSION "symbtex"
+#define MAX_IMAGE_LEVELS          16 // Enough for a 32768 texel wide base level
+
+enum Image_Format
+{
+	IMF_RGB8 = 0,
+	IMF_RGBA8,
+	IMF_BC1,      // 4x4 blocks of 8 bytes, colour only
+	IMF_BC3,      // 4x4 blocks of 16 bytes, colour with interpolated alpha
+	IMF_MAX
+};
+
+struct Image_Level
+{
+	const uint8* data;
+	uint32       size;
+	int          width;
+	int          height;
+};
+
+struct Image
+{
+	int                format;
+	int                width;
+	int                height;
+	int                num_levels;
+	struct Image_Level levels[MAX_IMAGE_LEVELS];
+	uint8*             storage; // Owned by the image when not NULL, otherwise levels point into memory owned by someone else
+};
+
+#pragma pack(push, 1)
+struct Tga_Header
+{
+	char  idlength;
+	char  colourmaptype;
+	char  datatypecode;
+	short colourmaporigin;
+	short colourmaplength;
+	char  colourmapdepth;
+	short x_origin;
+	short y_origin;
+	short width;
+	short height;
+	char  bitsperpixel;
+	char  imagedescriptor;
+};
+#pragma pack(pop)
+
+bool image_tga_decode(const uint8* file_data, size_t file_size, uint8** out_pixels, int* out_width, int* out_height, int* out_channels, char* error, size_t error_len); // Pixels are RGB or RGBA and must be released with memory_free
+void image_swizzle_red_blue(const uint8* source, uint8* dest, size_t num_pixels, int channels); // Turns BGR(A) into RGB(A) and back, source and dest may be the same buffer
+void image_free(struct Image* image);
+size_t image_level_size_get(int format, int width, int height);
+bool image_mips_build(const uint8* pixels, int width, int height, int channels, int max_levels, struct Image* out_image); // Box filtered chain down to 1x1 or max_levels, pixels are copied into the first level
+bool image_compress(const struct Image* source, struct Image* out_image);                                                 // RGB8 becomes BC1 and RGBA8 becomes BC3, every level is compressed
+bool image_container_parse(const uint8* file_data, size_t file_size, struct Image* out_image, char* error, size_t error_len); // Levels point into file_data which has to outlive the image
+bool image_container_write(const struct Image* image, const char* path);
+
+#endif
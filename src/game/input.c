@@ -294,10 +294,9 @@ void input_on_key(const struct Event* event)
 		if(key_binding->key_primary == key && (key_binding->mods_primary & mods) == key_binding->mods_primary)
 		{
 			key_binding->state = event->type == EVT_KEY_PRESSED ? KS_PRESSED : KS_RELEASED;
-			struct Event* input_map_event = event_manager_create_new_event(event_manager);
-			input_map_event->type = event->type == EVT_KEY_PRESSED ? EVT_INPUT_MAP_PRESSED : EVT_INPUT_MAP_RELEASED;
-			strncpy(&input_map_event->input_map.name, map_key, MAX_HASH_KEY_LEN);
-			event_manager_send_event(event_manager, input_map_event);
+			struct Event input_map_event = { .type = event->type == EVT_KEY_PRESSED ? EVT_INPUT_MAP_PRESSED : EVT_INPUT_MAP_RELEASED };
+			strncpy(&input_map_event.input_map.name, map_key, MAX_HASH_KEY_LEN);
+			event_manager_send_event(event_manager, &input_map_event, ED_IMMEDIATE);
 			break;
 		}
 
@@ -305,10 +304,9 @@ void input_on_key(const struct Event* event)
 		if(key_binding->key_secondary == key && (key_binding->mods_secondary & mods) == key_binding->mods_secondary)
 		{
 			key_binding->state = event->type == EVT_KEY_PRESSED ? KS_PRESSED : KS_RELEASED;
-			struct Event* input_map_event = event_manager_create_new_event(event_manager);
-			input_map_event->type = event->type == EVT_KEY_PRESSED ? EVT_INPUT_MAP_PRESSED : EVT_INPUT_MAP_RELEASED;
-			strncpy(&input_map_event->input_map.name, map_key, MAX_HASH_KEY_LEN);
-			event_manager_send_event(event_manager, input_map_event);
+			struct Event input_map_event = { .type = event->type == EVT_KEY_PRESSED ? EVT_INPUT_MAP_PRESSED : EVT_INPUT_MAP_RELEASED };
+			strncpy(&input_map_event.input_map.name, map_key, MAX_HASH_KEY_LEN);
+			event_manager_send_event(event_manager, &input_map_event, ED_IMMEDIATE);
 			break;
 		}
 	}
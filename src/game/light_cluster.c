@@ -0,0 +1,277 @@
+#include "light_cluster.h"
+#include "../common/memory_utils.h"
+#include "../common/log.h"
+
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#define LIGHT_CLUSTER_MIN_NEARZ 0.01f
+
+static void  light_cluster_bounds_build(struct Light_Cluster_Grid* grid, const mat4* proj_mat, float nearz, float farz);
+static void  light_cluster_unproject(vec3* out_point, const mat4* inv_proj_mat, float ndc_x, float ndc_y, float ndc_z);
+static float light_cluster_slice_depth(float nearz, float farz, int slice);
+static int   light_cluster_slice_get(struct Light_Cluster_Grid* grid, float view_depth);
+static bool  light_cluster_sphere_box_overlap(const vec3* center, float radius, const struct Bounding_Box* box);
+static bool  light_cluster_pair_add(struct Light_Cluster_Grid* grid, uint32 pair);
+
+void light_cluster_grid_init(struct Light_Cluster_Grid* grid)
+{
+	assert(grid);
+	memset(grid->cluster_bounds, 0, sizeof(grid->cluster_bounds));
+	memset(grid->clusters, 0, sizeof(grid->clusters));
+	memset(&grid->proj_mat, 0, sizeof(grid->proj_mat));
+	grid->light_indices          = NULL;
+	grid->num_light_indices      = 0;
+	grid->light_indices_capacity = 0;
+	grid->pairs                  = NULL;
+	grid->num_pairs              = 0;
+	grid->pairs_capacity         = 0;
+	grid->nearz                  = 0.f;
+	grid->farz                   = 0.f;
+	grid->z_scale                = 0.f;
+	grid->z_bias                 = 0.f;
+}
+
+void light_cluster_grid_destroy(struct Light_Cluster_Grid* grid)
+{
+	assert(grid);
+	if(grid->light_indices) memory_free(grid->light_indices);
+	if(grid->pairs)         memory_free(grid->pairs);
+	light_cluster_grid_init(grid);
+}
+
+void light_cluster_grid_build(struct Light_Cluster_Grid*    grid,
+							  const mat4*                   view_mat,
+							  const mat4*                   proj_mat,
+							  float                         nearz,
+							  float                         farz,
+							  const struct Bounding_Sphere* light_spheres,
+							  int                           num_lights,
+							  int                           first_light_index)
+{
+	assert(grid && view_mat && proj_mat);
+	assert(num_lights == 0 || light_spheres);
+	assert(first_light_index >= 0 && first_light_index + num_lights <= UINT16_MAX);
+
+	// Slices are spaced logarithmically so the range has to start in front of the camera
+	if(nearz < LIGHT_CLUSTER_MIN_NEARZ) nearz = LIGHT_CLUSTER_MIN_NEARZ;
+	if(farz < nearz * 2.f) farz = nearz * 2.f;
+
+	if(grid->nearz != nearz || grid->farz != farz || memcmp(&grid->proj_mat, proj_mat, sizeof(mat4)) != 0)
+		light_cluster_bounds_build(grid, proj_mat, nearz, farz);
+
+	grid->num_pairs = 0;
+	uint32 counts[LIGHT_CLUSTER_COUNT];
+	memset(counts, 0, sizeof(counts));
+
+	for(int i = 0; i < num_lights; i++)
+	{
+		const struct Bounding_Sphere* sphere = &light_spheres[i];
+		float radius = sphere->radius;
+		vec3 center = sphere->center;
+		vec3_mul_mat4(&center, &center, (mat4*)view_mat);
+
+		float depth = -center.z;
+		if(depth + radius < nearz || depth - radius > farz) continue;
+
+		int min_z = light_cluster_slice_get(grid, depth - radius);
+		int max_z = light_cluster_slice_get(grid, depth + radius);
+
+		/* Project the corners of the sphere's box to find the range of tiles it covers,
+		   spheres that cross the near plane can cover any tile so all of them are tested */
+		int min_x = 0, max_x = LIGHT_CLUSTER_X - 1;
+		int min_y = 0, max_y = LIGHT_CLUSTER_Y - 1;
+		if(depth - radius > nearz)
+		{
+			float ndc_min_x = FLT_MAX, ndc_min_y = FLT_MAX, ndc_max_x = -FLT_MAX, ndc_max_y = -FLT_MAX;
+			for(int corner = 0; corner < 8; corner++)
+			{
+				vec4 point =
+				{
+					center.x + (corner & 1 ? radius : -radius),
+					center.y + (corner & 2 ? radius : -radius),
+					center.z + (corner & 4 ? radius : -radius),
+					1.f
+				};
+				vec4_mul_mat4(&point, &point, (mat4*)proj_mat);
+				float ndc_x = point.x / point.w;
+				float ndc_y = point.y / point.w;
+				if(ndc_x < ndc_min_x) ndc_min_x = ndc_x;
+				if(ndc_x > ndc_max_x) ndc_max_x = ndc_x;
+				if(ndc_y < ndc_min_y) ndc_min_y = ndc_y;
+				if(ndc_y > ndc_max_y) ndc_max_y = ndc_y;
+			}
+			if(ndc_max_x < -1.f || ndc_min_x > 1.f || ndc_max_y < -1.f || ndc_min_y > 1.f) continue;
+
+			min_x = (int)floorf((ndc_min_x * 0.5f + 0.5f) * LIGHT_CLUSTER_X);
+			max_x = (int)floorf((ndc_max_x * 0.5f + 0.5f) * LIGHT_CLUSTER_X);
+			min_y = (int)floorf((ndc_min_y * 0.5f + 0.5f) * LIGHT_CLUSTER_Y);
+			max_y = (int)floorf((ndc_max_y * 0.5f + 0.5f) * LIGHT_CLUSTER_Y);
+			if(min_x < 0) min_x = 0;
+			if(min_y < 0) min_y = 0;
+			if(max_x > LIGHT_CLUSTER_X - 1) max_x = LIGHT_CLUSTER_X - 1;
+			if(max_y > LIGHT_CLUSTER_Y - 1) max_y = LIGHT_CLUSTER_Y - 1;
+		}
+
+		uint32 light_index = (uint32)(first_light_index + i);
+		for(int z = min_z; z <= max_z; z++)
+		{
+			for(int y = min_y; y <= max_y; y++)
+			{
+				for(int x = min_x; x <= max_x; x++)
+				{
+					int cluster = x + LIGHT_CLUSTER_X * (y + LIGHT_CLUSTER_Y * z);
+					if(!light_cluster_sphere_box_overlap(&center, radius, &grid->cluster_bounds[cluster])) continue;
+					if(!light_cluster_pair_add(grid, ((uint32)cluster << 16) | light_index)) return;
+					counts[cluster]++;
+				}
+			}
+		}
+	}
+
+	if(grid->num_pairs > grid->light_indices_capacity)
+	{
+		int new_capacity = grid->num_pairs * 2;
+		uint16* new_indices = memory_reallocate_((void**)&grid->light_indices, sizeof(*grid->light_indices) * new_capacity);
+		if(!new_indices)
+		{
+			log_error("light_cluster:grid_build", "Failed to grow light index list to %d entries", new_capacity);
+			memset(grid->clusters, 0, sizeof(grid->clusters));
+			grid->num_light_indices = 0;
+			return;
+		}
+		grid->light_indices          = new_indices;
+		grid->light_indices_capacity = new_capacity;
+	}
+
+	// Prefix sum the counts into offsets then scatter, pairs were added in light order so every list stays sorted
+	uint32 offset = 0;
+	for(int i = 0; i < LIGHT_CLUSTER_COUNT; i++)
+	{
+		grid->clusters[i][0] = offset;
+		grid->clusters[i][1] = 0;
+		offset += counts[i];
+	}
+
+	for(int i = 0; i < grid->num_pairs; i++)
+	{
+		uint32 cluster = grid->pairs[i] >> 16;
+		uint32* entry  = grid->clusters[cluster];
+		grid->light_indices[entry[0] + entry[1]++] = (uint16)(grid->pairs[i] & 0xFFFF);
+	}
+	grid->num_light_indices = grid->num_pairs;
+}
+
+void light_cluster_bounds_build(struct Light_Cluster_Grid* grid, const mat4* proj_mat, float nearz, float farz)
+{
+	mat4 inv_proj_mat;
+	mat4_assign(&inv_proj_mat, proj_mat);
+	mat4_inverse(&inv_proj_mat, &inv_proj_mat);
+
+	for(int y = 0; y < LIGHT_CLUSTER_Y; y++)
+	{
+		for(int x = 0; x < LIGHT_CLUSTER_X; x++)
+		{
+			/* Rays through the tile's corners, every slice's box lies along them */
+			vec3 near_points[4], far_points[4];
+			for(int corner = 0; corner < 4; corner++)
+			{
+				float ndc_x = -1.f + 2.f * (float)(x + (corner & 1)) / LIGHT_CLUSTER_X;
+				float ndc_y = -1.f + 2.f * (float)(y + ((corner >> 1) & 1)) / LIGHT_CLUSTER_Y;
+				light_cluster_unproject(&near_points[corner], &inv_proj_mat, ndc_x, ndc_y, -1.f);
+				light_cluster_unproject(&far_points[corner],  &inv_proj_mat, ndc_x, ndc_y,  1.f);
+			}
+
+			for(int z = 0; z < LIGHT_CLUSTER_Z; z++)
+			{
+				struct Bounding_Box* box = &grid->cluster_bounds[x + LIGHT_CLUSTER_X * (y + LIGHT_CLUSTER_Y * z)];
+				vec3_fill(&box->min,  FLT_MAX,  FLT_MAX,  FLT_MAX);
+				vec3_fill(&box->max, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+				float slice_depths[2] = { light_cluster_slice_depth(nearz, farz, z), light_cluster_slice_depth(nearz, farz, z + 1) };
+				for(int corner = 0; corner < 4; corner++)
+				{
+					vec3* near_point = &near_points[corner];
+					vec3* far_point  = &far_points[corner];
+					float ray_length = near_point->z - far_point->z;
+					for(int d = 0; d < 2; d++)
+					{
+						float t = ray_length != 0.f ? (slice_depths[d] + near_point->z) / ray_length : 0.f;
+						vec3 point =
+						{
+							near_point->x + (far_point->x - near_point->x) * t,
+							near_point->y + (far_point->y - near_point->y) * t,
+							near_point->z + (far_point->z - near_point->z) * t
+						};
+						if(point.x < box->min.x) box->min.x = point.x;
+						if(point.y < box->min.y) box->min.y = point.y;
+						if(point.z < box->min.z) box->min.z = point.z;
+						if(point.x > box->max.x) box->max.x = point.x;
+						if(point.y > box->max.y) box->max.y = point.y;
+						if(point.z > box->max.z) box->max.z = point.z;
+					}
+				}
+			}
+		}
+	}
+
+	mat4_assign(&grid->proj_mat, proj_mat);
+	grid->nearz   = nearz;
+	grid->farz    = farz;
+	grid->z_scale = (float)LIGHT_CLUSTER_Z / logf(farz / nearz);
+	grid->z_bias  = -(float)LIGHT_CLUSTER_Z * logf(nearz) / logf(farz / nearz);
+}
+
+void light_cluster_unproject(vec3* out_point, const mat4* inv_proj_mat, float ndc_x, float ndc_y, float ndc_z)
+{
+	vec4 point = { ndc_x, ndc_y, ndc_z, 1.f };
+	vec4_mul_mat4(&point, &point, (mat4*)inv_proj_mat);
+	vec3_fill(out_point, point.x / point.w, point.y / point.w, point.z / point.w);
+}
+
+float light_cluster_slice_depth(float nearz, float farz, int slice)
+{
+	return nearz * powf(farz / nearz, (float)slice / LIGHT_CLUSTER_Z);
+}
+
+int light_cluster_slice_get(struct Light_Cluster_Grid* grid, float view_depth)
+{
+	if(view_depth <= grid->nearz) return 0;
+	int slice = (int)floorf(logf(view_depth) * grid->z_scale + grid->z_bias);
+	if(slice < 0) slice = 0;
+	if(slice > LIGHT_CLUSTER_Z - 1) slice = LIGHT_CLUSTER_Z - 1;
+	return slice;
+}
+
+bool light_cluster_sphere_box_overlap(const vec3* center, float radius, const struct Bounding_Box* box)
+{
+	float dist_sq = 0.f;
+	if(center->x < box->min.x) dist_sq += (box->min.x - center->x) * (box->min.x - center->x);
+	else if(center->x > box->max.x) dist_sq += (center->x - box->max.x) * (center->x - box->max.x);
+	if(center->y < box->min.y) dist_sq += (box->min.y - center->y) * (box->min.y - center->y);
+	else if(center->y > box->max.y) dist_sq += (center->y - box->max.y) * (center->y - box->max.y);
+	if(center->z < box->min.z) dist_sq += (box->min.z - center->z) * (box->min.z - center->z);
+	else if(center->z > box->max.z) dist_sq += (center->z - box->max.z) * (center->z - box->max.z);
+	return dist_sq <= radius * radius;
+}
+
+bool light_cluster_pair_add(struct Light_Cluster_Grid* grid, uint32 pair)
+{
+	if(grid->num_pairs == grid->pairs_capacity)
+	{
+		int new_capacity = grid->pairs_capacity > 0 ? grid->pairs_capacity * 2 : 1024;
+		uint32* new_pairs = memory_reallocate_((void**)&grid->pairs, sizeof(*grid->pairs) * new_capacity);
+		if(!new_pairs)
+		{
+			log_error("light_cluster:pair_add", "Failed to grow pair list to %d entries", new_capacity);
+			memset(grid->clusters, 0, sizeof(grid->clusters));
+			grid->num_light_indices = 0;
+			return false;
+		}
+		grid->pairs          = new_pairs;
+		grid->pairs_capacity = new_capacity;
+	}
+	grid->pairs[grid->num_pairs++] = pair;
+	return true;
+}
@@ -0,0 +1,48 @@
+#ifndef LIGHT_CLUSTER_H
+#define LIGHT_CLUSTER_H
+
+#include "../common/linmath.h"
+#include "../common/num_types.h"
+#include "bounding_volumes.h"
+
+/* Clustered light culling. The camera's view frustum is divided into a grid of
+   tiles in screen space and exponentially spaced slices in depth. Every frame each
+   point or spot light is tested against the clusters it could touch and the grid
+   stores, per cluster, an offset and a count into a shared list of light indices.
+   The fragment shader finds its cluster from gl_FragCoord and view depth and only
+   evaluates the lights in that list */
+
+#define LIGHT_CLUSTER_X     16
+#define LIGHT_CLUSTER_Y     9
+#define LIGHT_CLUSTER_Z     24
+#define LIGHT_CLUSTER_COUNT (LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z)
+
+struct Light_Cluster_Grid
+{
+	struct Bounding_Box cluster_bounds[LIGHT_CLUSTER_COUNT]; // View space, rebuilt only when the projection changes
+	uint32              clusters[LIGHT_CLUSTER_COUNT][2];    // Offset into light_indices and light count, laid out to match an RG32UI texel
+	uint16*             light_indices;
+	int                 num_light_indices;
+	int                 light_indices_capacity;
+	uint32*             pairs;          // Scratch list of cluster and light pairs found while testing
+	int                 num_pairs;
+	int                 pairs_capacity;
+	mat4                proj_mat;       // Projection the cluster bounds were built for
+	float               nearz;
+	float               farz;
+	float               z_scale;        // slice = log(view_depth) * z_scale + z_bias
+	float               z_bias;
+};
+
+void light_cluster_grid_init(struct Light_Cluster_Grid* grid);
+void light_cluster_grid_destroy(struct Light_Cluster_Grid* grid);
+void light_cluster_grid_build(struct Light_Cluster_Grid*    grid,
+							  const mat4*                   view_mat,
+							  const mat4*                   proj_mat,
+							  float                         nearz,
+							  float                         farz,
+							  const struct Bounding_Sphere* light_spheres,
+							  int                           num_lights,
+							  int                           first_light_index); // light_spheres are in world space, index i is written to the lists as first_light_index + i
+
+#endif
@@ -7,6 +7,7 @@
 #include "texture.h"
 #include "light.h"
 #include "scene.h"
+#include "light_cluster.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -18,6 +19,7 @@ bool material_init(struct Material* material, int material_type)
 
 	material->type = material_type;
 	memset(material->registered_static_meshes, '\0', sizeof(struct Static_Mesh*) * MAX_MATERIAL_REGISTERED_STATIC_MESHES);
+	material->num_registered_static_meshes = 0;
 	memset(material->model_params, 0, sizeof(struct Uniform) * MMP_MAX);
 	memset(material->pipeline_params, 0, sizeof(struct Uniform) * MPP_MAX);
 
@@ -26,8 +28,8 @@ bool material_init(struct Material* material, int material_type)
 	case MAT_BLINN:
 	{
 		material->lit  = true;
-        char custom_defines[64];
-        snprintf(custom_defines, 64, "#define MAX_LIGHTS %d", MAX_SCENE_LIGHTS);
+        char custom_defines[128];
+        snprintf(custom_defines, 128, "#define LIGHT_CLUSTER_X %d\n#define LIGHT_CLUSTER_Y %d\n#define LIGHT_CLUSTER_Z %d", LIGHT_CLUSTER_X, LIGHT_CLUSTER_Y, LIGHT_CLUSTER_Z);
 		material->shader = shader_create("blinn_phong.vert", "blinn_phong.frag", custom_defines);
         
         if(material->shader == -1)
@@ -37,17 +39,21 @@ bool material_init(struct Material* material, int material_type)
             return false;
         }
 
-		material->pipeline_params[MPP_INV_MODEL_MAT].type = UT_MAT4;
-		material->pipeline_params[MPP_INV_MODEL_MAT].location = shader_get_uniform_location(material->shader, "inv_model_mat");
-
 		material->pipeline_params[MPP_VIEW_MAT].type = UT_MAT4;
 		material->pipeline_params[MPP_VIEW_MAT].location = shader_get_uniform_location(material->shader, "view_mat");
 
 		material->pipeline_params[MPP_CAM_POS].type = UT_VEC3;
 		material->pipeline_params[MPP_CAM_POS].location = shader_get_uniform_location(material->shader, "camera_pos");
 
-		material->pipeline_params[MPP_TOTAL_LIGHTS].type = UT_INT;
-		material->pipeline_params[MPP_TOTAL_LIGHTS].location = shader_get_uniform_location(material->shader, "total_active_lights");
+		shader_uniform_block_bind(material->shader, "Light_Block", UBB_LIGHTS);
+
+		// The light buffer textures always live on the same units, bound by the renderer before drawing
+		int light_units[3] = { TU_LIGHTS, TU_LIGHT_CLUSTERS, TU_LIGHT_INDICES };
+		shader_bind(material->shader);
+		shader_set_uniform(UT_INT, shader_get_uniform_location(material->shader, "light_buffer"),   &light_units[0]);
+		shader_set_uniform(UT_INT, shader_get_uniform_location(material->shader, "light_clusters"), &light_units[1]);
+		shader_set_uniform(UT_INT, shader_get_uniform_location(material->shader, "light_indices"),  &light_units[2]);
+		shader_unbind();
 
 		material->model_params[MMP_DIFFUSE_TEX].type = UT_TEX;
 		material->model_params[MMP_DIFFUSE_TEX].location = shader_get_uniform_location(material->shader, "diffuse_texture");
@@ -111,11 +117,8 @@ bool material_init(struct Material* material, int material_type)
 	material->pipeline_params[MPP_FOG_COLOR].type = UT_VEC3;
 	material->pipeline_params[MPP_FOG_COLOR].location = shader_get_uniform_location(material->shader, "fog.color");
 
-	material->pipeline_params[MPP_MVP].type = UT_MAT4;
-	material->pipeline_params[MPP_MVP].location = shader_get_uniform_location(material->shader, "mvp");
-
-	material->pipeline_params[MPP_MODEL_MAT].type = UT_MAT4;
-	material->pipeline_params[MPP_MODEL_MAT].location = shader_get_uniform_location(material->shader, "model_mat");
+	material->pipeline_params[MPP_VIEW_PROJ_MAT].type = UT_MAT4;
+	material->pipeline_params[MPP_VIEW_PROJ_MAT].location = shader_get_uniform_location(material->shader, "view_proj_mat");
 
 	material->pipeline_params[MPP_AMBIENT_LIGHT].type = UT_VEC3;
 	material->pipeline_params[MPP_AMBIENT_LIGHT].location = shader_get_uniform_location(material->shader, "ambient_light");
@@ -129,6 +132,7 @@ void material_reset(struct Material* material)
 
 	material->type = -1;
 	memset(material->registered_static_meshes, '\0', sizeof(struct Static_Mesh*) * MAX_MATERIAL_REGISTERED_STATIC_MESHES);
+	material->num_registered_static_meshes = 0;
 	memset(material->model_params, 0, sizeof(struct Uniform) * MMP_MAX);
 	memset(material->pipeline_params, 0, sizeof(struct Uniform) * MPP_MAX);
 }
@@ -137,59 +141,57 @@ bool material_register_static_mesh(struct Material* material, struct Static_Mesh
 {
 	assert(material);
 
-	for(int i = 0; i < MAX_MATERIAL_REGISTERED_STATIC_MESHES; i++)
-	{
-		if(!material->registered_static_meshes[i])
-		{
-			material->registered_static_meshes[i] = mesh;
+	if(material->num_registered_static_meshes >= MAX_MATERIAL_REGISTERED_STATIC_MESHES)
+		return false;
 
-			for(int j = 0; j < MMP_MAX; j++)
-				variant_init_empty(&mesh->model.material_params[j]);
-
-			// Set default values for instance parameters
-			switch(material->type)
-			{
-			case MAT_BLINN:
-			{
-				variant_assign_vec4f(&mesh->model.material_params[MMP_DIFFUSE_COL], 1.f, 0.f, 1.f, 1.f);
-				variant_assign_float(&mesh->model.material_params[MMP_DIFFUSE], 1.f);
-				variant_assign_int(&mesh->model.material_params[MMP_DIFFUSE_TEX], texture_create_from_file("default.tga", TU_DIFFUSE));
-				variant_assign_float(&mesh->model.material_params[MMP_SPECULAR], 1.f);
-				variant_assign_float(&mesh->model.material_params[MMP_SPECULAR_STRENGTH], 50.f);
-				variant_assign_vec2f(&mesh->model.material_params[MMP_UV_SCALE], 1.f, 1.f);
-				mesh->model.material = material;
-			}
-			break;
-			case MAT_UNSHADED:
-			{
-				variant_assign_vec4f(&mesh->model.material_params[MMP_DIFFUSE_COL], 1.f, 0.f, 1.f, 1.f);
-				variant_assign_int(&mesh->model.material_params[MMP_DIFFUSE_TEX], texture_create_from_file("default.tga", TU_DIFFUSE));
-				variant_assign_vec2f(&mesh->model.material_params[MMP_UV_SCALE], 1.f, 1.f);
-				mesh->model.material = material;
-			}
-			break;
-			default:
-				log_error("material:register_model", "Invalid material type");
-				break;
-			}
-			return true;
-		}
-	}
+	material->registered_static_meshes[material->num_registered_static_meshes++] = mesh;
+
+	for(int j = 0; j < MMP_MAX; j++)
+		variant_init_empty(&mesh->model.material_params[j]);
 
-	return false;
+	// Set default values for instance parameters
+	switch(material->type)
+	{
+	case MAT_BLINN:
+	{
+		variant_assign_vec4f(&mesh->model.material_params[MMP_DIFFUSE_COL], 1.f, 0.f, 1.f, 1.f);
+		variant_assign_float(&mesh->model.material_params[MMP_DIFFUSE], 1.f);
+		variant_assign_int(&mesh->model.material_params[MMP_DIFFUSE_TEX], texture_create_from_file("default.tga", TU_DIFFUSE));
+		variant_assign_float(&mesh->model.material_params[MMP_SPECULAR], 1.f);
+		variant_assign_float(&mesh->model.material_params[MMP_SPECULAR_STRENGTH], 50.f);
+		variant_assign_vec2f(&mesh->model.material_params[MMP_UV_SCALE], 1.f, 1.f);
+		mesh->model.material = material;
+	}
+	break;
+	case MAT_UNSHADED:
+	{
+		variant_assign_vec4f(&mesh->model.material_params[MMP_DIFFUSE_COL], 1.f, 0.f, 1.f, 1.f);
+		variant_assign_int(&mesh->model.material_params[MMP_DIFFUSE_TEX], texture_create_from_file("default.tga", TU_DIFFUSE));
+		variant_assign_vec2f(&mesh->model.material_params[MMP_UV_SCALE], 1.f, 1.f);
+		mesh->model.material = material;
+	}
+	break;
+	default:
+		log_error("material:register_model", "Invalid material type");
+		break;
+	}
+	return true;
 }
 
 void material_unregister_static_mesh(struct Material* material, struct Static_Mesh* mesh)
 {
 	assert(material);
 
-	for(int i = 0; i < MAX_MATERIAL_REGISTERED_STATIC_MESHES; i++)
+	for(int i = 0; i < material->num_registered_static_meshes; i++)
 	{
 		if(material->registered_static_meshes[i] == mesh)
 		{
-			material->registered_static_meshes[i] = NULL;
-			for(int i = 0; i < MMP_MAX; i++)
-				variant_free(&mesh->model.material_params[i]);
+			// Move the last mesh into the vacated slot so the list stays packed
+			int last = --material->num_registered_static_meshes;
+			material->registered_static_meshes[i] = material->registered_static_meshes[last];
+			material->registered_static_meshes[last] = NULL;
+			for(int j = 0; j < MMP_MAX; j++)
+				variant_free(&mesh->model.material_params[j]);
 			break;
 		}
 	}
@@ -35,17 +35,14 @@ enum Mat_Model_Param
 
 enum Mat_Pipeline_Param
 {
-    MPP_MODEL_MAT = 0,
-    MPP_INV_MODEL_MAT,
-    MPP_VIEW_MAT,
-    MPP_MVP,
+    MPP_VIEW_MAT = 0,
+    MPP_VIEW_PROJ_MAT,
     MPP_FOG_MODE,
     MPP_FOG_DENSITY,
     MPP_FOG_START_DIST,
     MPP_FOG_MAX_DIST,
     MPP_FOG_COLOR,
     MPP_CAM_POS,
-    MPP_TOTAL_LIGHTS,
     MPP_AMBIENT_LIGHT,
     MPP_MAX
 };
@@ -54,7 +51,8 @@ struct Material
 {
     int                 type;
     int                 shader;
-    struct Static_Mesh* registered_static_meshes[MAX_MATERIAL_REGISTERED_STATIC_MESHES];
+    struct Static_Mesh* registered_static_meshes[MAX_MATERIAL_REGISTERED_STATIC_MESHES]; // Kept packed, first num_registered_static_meshes entries are valid
+    int                 num_registered_static_meshes;
     bool                lit;
     struct Uniform      model_params[MMP_MAX];
     struct Uniform      pipeline_params[MPP_MAX];
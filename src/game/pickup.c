@@ -27,14 +27,17 @@ void pickup_init(struct Pickup* pickup, int type)
 	}
 
 	struct Game_State* game_state = game_state_get();
-	event_manager_subscribe_with_subscriber(game_state->event_manager, EVT_SCENE_LOADED, &pickup_on_scene_loaded, (void*)pickup);
+	pickup->trigger_subscription      = EVENT_SUBSCRIPTION_HANDLE_INVALID;
+	pickup->scene_loaded_subscription = event_manager_subscribe_with_subscriber(game_state->event_manager, EVT_SCENE_LOADED, &pickup_on_scene_loaded, (void*)pickup);
 }
 
 void pickup_reset(struct Pickup* pickup)
 {
 	struct Game_State* game_state = game_state_get();
-	event_manager_unsubscribe_with_subscriber(game_state->event_manager, EVT_SCENE_LOADED, &pickup_on_scene_loaded, (void*)pickup);
-	event_manager_unsubscribe_with_subscriber_sender(game_state->event_manager, EVT_TRIGGER, &pickup_on_trigger, (void*)pickup, (void*)pickup->trigger);
+	event_manager_unsubscribe_handle(game_state->event_manager, pickup->scene_loaded_subscription);
+	event_manager_unsubscribe_handle(game_state->event_manager, pickup->trigger_subscription);
+	pickup->scene_loaded_subscription = EVENT_SUBSCRIPTION_HANDLE_INVALID;
+	pickup->trigger_subscription      = EVENT_SUBSCRIPTION_HANDLE_INVALID;
 }
 
 struct Pickup* pickup_read(struct Parser_Object* parser_object, const char* name, struct Entity* parent_entity)
@@ -43,12 +46,12 @@ struct Pickup* pickup_read(struct Parser_Object* parser_object, const char* name
 	struct Scene* scene = game_state_get()->scene;
 
 	new_pickup = scene_pickup_create(scene, name, parent_entity, PICKUP_HEALTH);
-	if(hashmap_value_exists(parser_object->data, "pickup_type")) new_pickup->type = hashmap_int_get(parser_object->data, "pickup_type");
-	if(hashmap_value_exists(parser_object->data, "pickup_spin_speed")) new_pickup->spin_speed = hashmap_float_get(parser_object->data, "pickup_spin_speed");
+	if(parser_object_value_exists(parser_object, "pickup_type")) new_pickup->type = parser_object_int_get(parser_object, "pickup_type");
+	if(parser_object_value_exists(parser_object, "pickup_spin_speed")) new_pickup->spin_speed = parser_object_float_get(parser_object, "pickup_spin_speed");
 	switch(new_pickup->type)
 	{
-	case PICKUP_KEY:    if(hashmap_value_exists(parser_object->data, "pickup_key_type")) new_pickup->key_type = hashmap_int_get(parser_object->data, "pickup_key_type"); break;
-	case PICKUP_HEALTH: if(hashmap_value_exists(parser_object->data, "pickup_health"))   new_pickup->health   = hashmap_int_get(parser_object->data, "pickup_health");   break;
+	case PICKUP_KEY:    if(parser_object_value_exists(parser_object, "pickup_key_type")) new_pickup->key_type = parser_object_int_get(parser_object, "pickup_key_type"); break;
+	case PICKUP_HEALTH: if(parser_object_value_exists(parser_object, "pickup_health"))   new_pickup->health   = parser_object_int_get(parser_object, "pickup_health");   break;
 	}
 	return new_pickup;
 }
@@ -76,7 +79,7 @@ void pickup_on_scene_loaded(struct Event* event, void* pickup_ptr)
 	{
 		pickup->trigger = pickup_trigger[0];
 		struct Event_Manager* event_manager = game_state_get()->event_manager;
-		event_manager_subscribe_with_subscriber_sender(event_manager, EVT_TRIGGER, &pickup_on_trigger, (void*)pickup, pickup->trigger);
+		pickup->trigger_subscription = event_manager_subscribe_with_subscriber_sender(event_manager, EVT_TRIGGER, &pickup_on_trigger, (void*)pickup, pickup->trigger);
 	}
 	else
 	{
@@ -119,9 +122,11 @@ void pickup_on_trigger(struct Event* event, void* pickup_ptr, void* trigger_ptr)
 	struct Pickup* pickup = (struct Pickup*) pickup_ptr;
 	if(!pickup->picked_up)
 	{
-		switch(event->trigger.triggering_entity->type)
+		// The event is delivered at the end of the tick, the entity may have been removed by then
+		struct Entity* triggering_entity = scene_entity_handle_resolve(game_state_get()->scene, event->trigger.triggering_entity);
+		switch(triggering_entity ? triggering_entity->type : ET_NONE)
 		{
-		case ET_PLAYER: player_on_pickup(event->trigger.triggering_entity, pickup); break;
+		case ET_PLAYER: player_on_pickup((struct Player*)triggering_entity, pickup); break;
 		case ET_ENEMY:
 			// Handle this if we add enemies that can move around
 			break;
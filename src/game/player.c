@@ -416,11 +416,10 @@ void player_apply_damage(struct Player* player, struct Enemy* enemy)
 	{
 		log_message("Player Ded!");
 		struct Event_Manager* event_manager = game_state_get()->event_manager;
-		struct Event* player_death_event = event_manager_create_new_event(event_manager);
-		player_death_event->type = EVT_PLAYER_DIED;
-		player_death_event->player_death.player = player;
-		player_death_event->player_death.enemy = enemy;
-		event_manager_send_event(event_manager, player_death_event);
+		struct Event player_death_event = { .type = EVT_PLAYER_DIED };
+		player_death_event.player_death.player = player;
+		player_death_event.player_death.enemy  = scene_entity_handle_get(game_state_get()->scene, &enemy->base);
+		event_manager_send_event(event_manager, &player_death_event, ED_END_OF_TICK);
 	}
 }
 
@@ -451,7 +450,7 @@ void player_update(struct Player* player, float dt)
 		player->muzzle_flash_mesh->base.transform.scale.x -= player->weapon_light_intensity_decay * dt;
 		player->muzzle_flash_mesh->base.transform.scale.y -= player->weapon_light_intensity_decay * dt;
 		player->muzzle_flash_mesh->base.transform.scale.z -= player->weapon_light_intensity_decay * dt;
-		transform_update_transmat(player->muzzle_flash_mesh);
+		transform_mark_dirty(player->muzzle_flash_mesh);
 	}
 }
 
@@ -0,0 +1,352 @@
+#include "profiler.h"
+#include "../common/log.h"
+#include "gui.h"
+#include "../common/memory_utils.h"
+#include "../system/platform.h"
+#include "../system/file_io.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+	#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+	#define PROFILER_THREAD_LOCAL __thread
+#endif
+
+#define PROFILER_ZONE_MASK         (MAX_PROFILER_ZONES_PER_THREAD - 1)
+#define PROFILER_COUNTER_MASK      (MAX_PROFILER_COUNTERS - 1)
+#define PROFILER_PANEL_MAX_DEPTH   8
+#define PROFILER_PANEL_ROW_HEIGHT  18.f
+
+struct Profiler
+{
+	struct Profiler_Thread*  threads[MAX_PROFILER_THREADS]; // Allocated up front so that worker threads never allocate
+	int                      num_threads;                   // Threads that have recorded at least one zone
+	struct Mutex*            mutex;
+	uint64                   start_time;
+	uint64                   frame_starts[MAX_PROFILER_FRAMES];
+	uint32                   frame;
+	int                      generation;
+	struct Profiler_Counter* counters;
+	uint32                   counter_head;
+};
+
+bool profiler_enabled = false;
+
+static struct Profiler profiler;
+static PROFILER_THREAD_LOCAL struct Profiler_Thread* profiler_current_thread = NULL;
+
+static struct Profiler_Thread* profiler_thread_get(void);
+static double                  profiler_counter_to_us(uint64 counter);
+static struct nk_color         profiler_zone_color(const char* name);
+
+void profiler_init(bool enabled)
+{
+	memset(&profiler, 0, sizeof(profiler));
+	profiler.mutex = platform_mutex_create();
+	if(!profiler.mutex)
+	{
+		log_error("profiler:init", "Failed to create mutex, profiling disabled");
+		profiler_enabled = false;
+		return;
+	}
+
+	for(int i = 0; i < MAX_PROFILER_THREADS; i++)
+	{
+		profiler.threads[i] = memory_allocate_and_clear(1, sizeof(struct Profiler_Thread));
+		if(!profiler.threads[i])
+		{
+			log_error("profiler:init", "Failed to allocate zone buffer for thread %d", i);
+			profiler_cleanup();
+			return;
+		}
+	}
+
+	profiler.counters = memory_allocate_and_clear(1, sizeof(struct Profiler_Counter) * MAX_PROFILER_COUNTERS);
+	if(!profiler.counters)
+	{
+		log_error("profiler:init", "Failed to allocate counter buffer");
+		profiler_cleanup();
+		return;
+	}
+
+	profiler.start_time = platform_counter_get();
+	profiler_current_thread = NULL;
+	profiler_thread_name_set("Main");
+	profiler_enabled_set(enabled);
+}
+
+void profiler_cleanup(void)
+{
+	profiler_enabled = false;
+	for(int i = 0; i < MAX_PROFILER_THREADS; i++)
+		memory_free(profiler.threads[i]);
+	memory_free(profiler.counters);
+	platform_mutex_destroy(profiler.mutex);
+	memset(&profiler, 0, sizeof(profiler));
+	profiler_current_thread = NULL;
+}
+
+void profiler_enabled_set(bool enabled)
+{
+	if(!profiler.mutex) return;
+
+	// Zones left open by the last session would otherwise never be closed
+	if(enabled && !profiler_enabled)
+		profiler.generation++;
+	profiler_enabled = enabled;
+}
+
+void profiler_thread_name_set(const char* name)
+{
+	struct Profiler_Thread* thread = profiler_thread_get();
+	if(thread)
+		strncpy(thread->name, name, MAX_PROFILER_THREAD_NAME_LEN - 1);
+}
+
+void profiler_frame_begin(void)
+{
+	if(!profiler_enabled) return;
+	profiler.frame++;
+	profiler.frame_starts[profiler.frame % MAX_PROFILER_FRAMES] = platform_counter_get();
+}
+
+void profiler_zone_begin(const char* name)
+{
+	struct Profiler_Thread* thread = profiler_thread_get();
+	if(!thread) return;
+
+	if(thread->generation != profiler.generation)
+	{
+		thread->generation = profiler.generation;
+		thread->depth      = 0;
+	}
+
+	// Zones nested deeper than the stack are not recorded but still counted so that ends stay matched
+	if(thread->depth < MAX_PROFILER_DEPTH)
+	{
+		uint32 index = thread->head++;
+		struct Profiler_Zone* zone = &thread->zones[index & PROFILER_ZONE_MASK];
+		zone->end   = 0;
+		zone->name  = name;
+		zone->frame = profiler.frame;
+		zone->depth = thread->depth;
+		zone->start = platform_counter_get();
+		thread->open[thread->depth] = index;
+	}
+	thread->depth++;
+}
+
+void profiler_zone_end(void)
+{
+	uint64 end = platform_counter_get();
+	struct Profiler_Thread* thread = profiler_current_thread;
+	if(!thread || thread->depth == 0) return;
+
+	if(thread->generation != profiler.generation)
+	{
+		thread->generation = profiler.generation;
+		thread->depth      = 0;
+		return;
+	}
+
+	thread->depth--;
+	if(thread->depth < MAX_PROFILER_DEPTH)
+	{
+		// The ring may have wrapped around while a long zone was open
+		uint32 index = thread->open[thread->depth];
+		if(thread->head - index <= MAX_PROFILER_ZONES_PER_THREAD)
+			thread->zones[index & PROFILER_ZONE_MASK].end = end;
+	}
+}
+
+void profiler_counter_record(const char* name, float value)
+{
+	if(!profiler.counters) return;
+	struct Profiler_Counter* counter = &profiler.counters[profiler.counter_head++ & PROFILER_COUNTER_MASK];
+	counter->name  = name;
+	counter->time  = platform_counter_get();
+	counter->value = value;
+}
+
+bool profiler_trace_write(const char* filename, int directory_type)
+{
+	if(!profiler.mutex)
+	{
+		log_error("profiler:trace_write", "Profiler is not initialized");
+		return false;
+	}
+
+	FILE* file = io_file_open(directory_type, filename, "w");
+	if(!file)
+	{
+		log_error("profiler:trace_write", "Failed to open %s for writing", filename);
+		return false;
+	}
+
+	/* Other threads keep recording while this runs so a zone may be read halfway through
+	   being overwritten, those are skipped by the sanity checks rather than locking every zone */
+	int num_zones_written = 0;
+	platform_mutex_lock(profiler.mutex);
+	int num_threads = profiler.num_threads;
+	platform_mutex_unlock(profiler.mutex);
+
+	fprintf(file, "{\"traceEvents\":[\n");
+	for(int i = 0; i < num_threads; i++)
+	{
+		struct Profiler_Thread* thread = profiler.threads[i];
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", i == 0 ? "" : ",\n", i, thread->name);
+
+		uint32 head  = thread->head;
+		uint32 count = head < MAX_PROFILER_ZONES_PER_THREAD ? head : MAX_PROFILER_ZONES_PER_THREAD;
+		for(uint32 j = head - count; j != head; j++)
+		{
+			struct Profiler_Zone zone = thread->zones[j & PROFILER_ZONE_MASK];
+			if(!zone.name || zone.end == 0 || zone.end < zone.start || zone.start < profiler.start_time)
+				continue;
+
+			fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+					zone.name,
+					i,
+					profiler_counter_to_us(zone.start - profiler.start_time),
+					profiler_counter_to_us(zone.end - zone.start),
+					zone.frame);
+			num_zones_written++;
+		}
+	}
+
+	uint32 counter_count = profiler.counter_head < MAX_PROFILER_COUNTERS ? profiler.counter_head : MAX_PROFILER_COUNTERS;
+	for(uint32 i = profiler.counter_head - counter_count; i != profiler.counter_head; i++)
+	{
+		struct Profiler_Counter* counter = &profiler.counters[i & PROFILER_COUNTER_MASK];
+		fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"args\":{\"value\":%.4f}}",
+				counter->name,
+				profiler_counter_to_us(counter->time - profiler.start_time),
+				counter->value);
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	log_message("Profiler: Wrote %d zones from %d threads to %s", num_zones_written, num_threads, filename);
+	return true;
+}
+
+void profiler_panel_update(struct Gui* gui)
+{
+	if(!profiler_enabled || profiler.frame <= PROFILER_PANEL_FRAMES) return;
+
+	/* Timeline of the last few complete frames, the frame in progress is left out since
+	   its zones are still open. Each thread gets a lane with one row per nesting level */
+	struct nk_context* context     = &gui->context;
+	uint32             last_frame  = profiler.frame;
+	uint32             first_frame = last_frame - PROFILER_PANEL_FRAMES;
+	uint64             span_start  = profiler.frame_starts[first_frame % MAX_PROFILER_FRAMES];
+	uint64             span_end    = profiler.frame_starts[last_frame % MAX_PROFILER_FRAMES];
+	if(span_end <= span_start) return;
+
+	if(nk_begin(context, "Profiler", nk_rect(50, 50, 900, 360), NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE | NK_WINDOW_TITLE | NK_WINDOW_MINIMIZABLE))
+	{
+		nk_layout_row_dynamic(context, PROFILER_PANEL_ROW_HEIGHT, PROFILER_PANEL_FRAMES);
+		for(uint32 frame = first_frame; frame < last_frame; frame++)
+		{
+			uint64 frame_time = profiler.frame_starts[(frame + 1) % MAX_PROFILER_FRAMES] - profiler.frame_starts[frame % MAX_PROFILER_FRAMES];
+			nk_labelf(context, NK_TEXT_ALIGN_CENTERED | NK_TEXT_ALIGN_MIDDLE, "Frame %u: %.2fms", frame, profiler_counter_to_us(frame_time) / 1000.0);
+		}
+
+		// Counters from the last complete frame, newest first
+		uint64 last_frame_start = profiler.frame_starts[(last_frame - 1) % MAX_PROFILER_FRAMES];
+		uint32 counter_count    = profiler.counter_head < MAX_PROFILER_COUNTERS ? profiler.counter_head : MAX_PROFILER_COUNTERS;
+		nk_layout_row_dynamic(context, PROFILER_PANEL_ROW_HEIGHT, 4);
+		for(uint32 i = profiler.counter_head; i != profiler.counter_head - counter_count; i--)
+		{
+			struct Profiler_Counter* counter = &profiler.counters[(i - 1) & PROFILER_COUNTER_MASK];
+			if(counter->time < last_frame_start) break;
+			if(counter->time >= span_end) continue;
+			nk_labelf(context, NK_TEXT_ALIGN_LEFT | NK_TEXT_ALIGN_MIDDLE, "%s: %.3f", counter->name, counter->value);
+		}
+
+		struct nk_command_buffer* canvas = nk_window_get_canvas(context);
+		const struct Profiler_Zone* hovered = NULL;
+		double span = (double)(span_end - span_start);
+		for(int i = 0; i < profiler.num_threads; i++)
+		{
+			struct Profiler_Thread* thread = profiler.threads[i];
+			nk_layout_row_dynamic(context, PROFILER_PANEL_ROW_HEIGHT, 1);
+			nk_label(context, thread->name, NK_TEXT_ALIGN_LEFT | NK_TEXT_ALIGN_MIDDLE);
+
+			struct nk_rect lane;
+			nk_layout_row_dynamic(context, PROFILER_PANEL_ROW_HEIGHT * PROFILER_PANEL_MAX_DEPTH, 1);
+			if(nk_widget(&lane, context) == NK_WIDGET_INVALID) continue;
+			nk_fill_rect(canvas, lane, 0.f, nk_rgb(30, 30, 30));
+
+			for(uint32 frame = first_frame + 1; frame < last_frame; frame++)
+			{
+				float x = lane.x + (float)((double)(profiler.frame_starts[frame % MAX_PROFILER_FRAMES] - span_start) / span) * lane.w;
+				nk_stroke_line(canvas, x, lane.y, x, lane.y + lane.h, 1.f, nk_rgb(200, 200, 200));
+			}
+
+			// Newest first, zones from before the span can only be parents of what is on screen
+			uint32 head  = thread->head;
+			uint32 count = head < MAX_PROFILER_ZONES_PER_THREAD ? head : MAX_PROFILER_ZONES_PER_THREAD;
+			for(uint32 j = head; j != head - count; j--)
+			{
+				const struct Profiler_Zone* zone = &thread->zones[(j - 1) & PROFILER_ZONE_MASK];
+				if(zone->frame + 1 < first_frame) break;
+				if(!zone->name || zone->end == 0 || zone->end < zone->start || zone->depth >= PROFILER_PANEL_MAX_DEPTH) continue;
+				if(zone->start >= span_end || zone->end <= span_start) continue;
+
+				uint64 start = zone->start < span_start ? span_start : zone->start;
+				uint64 end   = zone->end > span_end ? span_end : zone->end;
+				struct nk_rect bounds;
+				bounds.x = lane.x + (float)((double)(start - span_start) / span) * lane.w;
+				bounds.w = (float)((double)(end - start) / span) * lane.w;
+				bounds.y = lane.y + zone->depth * PROFILER_PANEL_ROW_HEIGHT;
+				bounds.h = PROFILER_PANEL_ROW_HEIGHT - 1.f;
+				if(bounds.w < 1.f) bounds.w = 1.f;
+
+				nk_fill_rect(canvas, bounds, 0.f, profiler_zone_color(zone->name));
+				if(bounds.w > 30.f)
+					nk_draw_text(canvas, bounds, zone->name, (int)strlen(zone->name), context->style.font, nk_rgba(0, 0, 0, 0), nk_rgb(0, 0, 0));
+				if(nk_input_is_mouse_hovering_rect(&context->input, bounds))
+					hovered = zone;
+			}
+		}
+
+		if(hovered)
+			nk_tooltipf(context, "%s: %.3fms", hovered->name, profiler_counter_to_us(hovered->end - hovered->start) / 1000.0);
+	}
+	nk_end(context);
+}
+
+struct Profiler_Thread* profiler_thread_get(void)
+{
+	if(profiler_current_thread) return profiler_current_thread;
+	if(!profiler.mutex) return NULL;
+
+	platform_mutex_lock(profiler.mutex);
+	if(profiler.num_threads < MAX_PROFILER_THREADS)
+	{
+		struct Profiler_Thread* thread = profiler.threads[profiler.num_threads];
+		snprintf(thread->name, MAX_PROFILER_THREAD_NAME_LEN, "Thread %d", profiler.num_threads);
+		thread->generation = profiler.generation;
+		profiler_current_thread = thread;
+		profiler.num_threads++;
+	}
+	platform_mutex_unlock(profiler.mutex);
+	return profiler_current_thread;
+}
+
+double profiler_counter_to_us(uint64 counter)
+{
+	return (double)counter * 1000000.0 / (double)platform_counter_frequency_get();
+}
+
+struct nk_color profiler_zone_color(const char* name)
+{
+	// Zones with the same name share a color, hashing the characters keeps it stable between runs
+	uint32 hash = 2166136261u;
+	for(const char* c = name; *c; c++)
+		hash = (hash ^ (uint32)*c) * 16777619u;
+	return nk_rgb(120 + (hash & 0x7F), 120 + ((hash >> 8) & 0x7F), 120 + ((hash >> 16) & 0x7F));
+}
@@ -0,0 +1,66 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include "../common/num_types.h"
+
+struct Gui;
+
+/* Hierarchical cpu zones recorded into a ring buffer per thread. Wrap code in a
+   PROFILE_SCOPE("Name") { } block or a PROFILE_BEGIN("Name") / PROFILE_END() pair when
+   the code returns early, names must be string literals since only the pointer is kept.
+   While the profiler is disabled every zone costs a single branch on profiler_enabled */
+
+#define MAX_PROFILER_THREADS          8
+#define MAX_PROFILER_ZONES_PER_THREAD 8192 // Must be a power of two
+#define MAX_PROFILER_DEPTH            32
+#define MAX_PROFILER_FRAMES           128
+#define MAX_PROFILER_THREAD_NAME_LEN  32
+#define MAX_PROFILER_COUNTERS         4096 // Must be a power of two
+#define PROFILER_PANEL_FRAMES         4    // Complete frames shown in the timeline panel
+
+#define PROFILE_BEGIN(name) (profiler_enabled ? profiler_zone_begin(name) : (void)0)
+#define PROFILE_END()       (profiler_enabled ? profiler_zone_end() : (void)0)
+#define PROFILE_SCOPE(name) for(int profile_scope_ = (PROFILE_BEGIN(name), 1); profile_scope_; profile_scope_ = (PROFILE_END(), 0))
+#define PROFILE_COUNTER(name, value) (profiler_enabled ? profiler_counter_record(name, value) : (void)0)
+
+struct Profiler_Zone
+{
+	const char* name;
+	uint64      start;
+	uint64      end;   // Zero while the zone is still open
+	uint32      frame;
+	int         depth;
+};
+
+struct Profiler_Counter
+{
+	const char* name;
+	uint64      time;
+	float       value;
+};
+
+struct Profiler_Thread
+{
+	char                 name[MAX_PROFILER_THREAD_NAME_LEN];
+	struct Profiler_Zone zones[MAX_PROFILER_ZONES_PER_THREAD];
+	uint32               head;                      // Total zones begun, the newest is at (head - 1) % MAX_PROFILER_ZONES_PER_THREAD
+	uint32               open[MAX_PROFILER_DEPTH];  // Values of head for the zones currently open on this thread
+	int                  depth;
+	int                  generation;                // Open zones are dropped when this falls behind the profiler's generation
+};
+
+extern bool profiler_enabled;
+
+void profiler_init(bool enabled);
+void profiler_cleanup(void);
+void profiler_enabled_set(bool enabled);
+void profiler_thread_name_set(const char* name); // Optional, threads that record zones without calling this are named by index
+void profiler_frame_begin(void);                 // Main thread, once at the start of every frame
+void profiler_zone_begin(const char* name);
+void profiler_zone_end(void);
+void profiler_counter_record(const char* name, float value); // Main thread only, values that are not durations such as gpu timings
+bool profiler_trace_write(const char* filename, int directory_type); // Writes the buffered zones in chrome://tracing json format
+void profiler_panel_update(struct Gui* gui);
+
+#endif
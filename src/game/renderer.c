@@ -28,13 +28,34 @@
 #include "event.h"
 #include "debug_vars.h"
 #include "gui_game.h"
+#include "profiler.h"
 
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <stddef.h>
+#include <math.h>
 
 static void renderer_on_framebuffer_size_changed(const struct Event* event);
+static void renderer_light_block_update(struct Renderer* renderer, struct Scene* scene, struct Camera* camera, int width, int height);
+static void renderer_light_buffers_bind(struct Renderer* renderer);
+static void renderer_static_mesh_visibility_update(struct Renderer* renderer, struct Scene* scene, struct Camera* camera);
+static int  renderer_render_queue_build(struct Renderer* renderer, struct Material* material, int* out_num_culled);
+static int  renderer_render_queue_item_compare(const void* a, const void* b);
+static int  renderer_model_param_size(const struct Variant* param);
+static bool renderer_model_params_equal(struct Static_Mesh* a, struct Static_Mesh* b);
+static void renderer_instance_set(struct Geometry_Instance* instance, const mat4* model_mat);
+
+static const char* gpu_timer_names[RGT_MAX] =
+{
+    "GPU Materials",
+    "GPU Debug Draw",
+    "GPU Editor",
+    "GPU Immediate Mode",
+    "GPU Sprites",
+    "GPU Gui"
+};
 
 void renderer_init(struct Renderer* renderer)
 {
@@ -48,6 +69,7 @@ void renderer_init(struct Renderer* renderer)
 
     struct Game_State* game_state = game_state_get();
 	event_manager_subscribe(game_state->event_manager, EVT_WINDOW_RESIZED, &renderer_on_framebuffer_size_changed);
+    gpu_timer_pool_init(&renderer->gpu_timers, RGT_MAX);
 
     struct Hashmap* cvars = game_state->cvars;
     renderer->settings.fog.mode           = hashmap_int_get(cvars,   "fog_mode");
@@ -60,8 +82,11 @@ void renderer_init(struct Renderer* renderer)
     renderer->settings.debug_draw_mode    = hashmap_int_get(cvars,   "debug_draw_mode");
     renderer->settings.debug_draw_color   = hashmap_vec4_get(cvars,  "debug_draw_color");
     renderer->settings.ambient_light      = hashmap_vec3_get(cvars,  "ambient_light");
+    renderer->settings.multi_draw_indirect = hashmap_bool_get(cvars, "render_multi_draw_indirect");
 	
-    renderer->debug_shader = shader_create("debug.vert", "debug.frag", NULL);
+    renderer->debug_shader        = shader_create("debug.vert", "debug.frag", NULL);
+    renderer->debug_uniform_mvp   = shader_get_uniform_location(renderer->debug_shader, "mvp");
+    renderer->debug_uniform_color = shader_get_uniform_location(renderer->debug_shader, "debug_color");
     renderer->sprite_batch = memory_allocate(sizeof(*renderer->sprite_batch));
 
     if(!renderer->sprite_batch)
@@ -71,6 +96,56 @@ void renderer_init(struct Renderer* renderer)
 
     im_init();
 
+    // Light uniform buffer shared by all lit materials
+    memset(&renderer->light_block, 0, sizeof(renderer->light_block));
+    GL_CHECK(glGenBuffers(1, &renderer->light_ubo));
+    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, renderer->light_ubo));
+    GL_CHECK(glBufferData(GL_UNIFORM_BUFFER, sizeof(renderer->light_block), &renderer->light_block, GL_DYNAMIC_DRAW));
+    GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+    GL_CHECK(glBindBufferBase(GL_UNIFORM_BUFFER, UBB_LIGHTS, renderer->light_ubo));
+
+    // Light data, per cluster light lists and the light indices they point into are read through buffer textures
+    light_cluster_grid_init(&renderer->light_clusters);
+    renderer->light_index_capacity = LIGHT_CLUSTER_COUNT;
+    GL_CHECK(glGenBuffers(1, &renderer->light_buffer));
+    GL_CHECK(glGenBuffers(1, &renderer->light_cluster_buffer));
+    GL_CHECK(glGenBuffers(1, &renderer->light_index_buffer));
+    GL_CHECK(glBindBuffer(GL_TEXTURE_BUFFER, renderer->light_buffer));
+    GL_CHECK(glBufferData(GL_TEXTURE_BUFFER, sizeof(renderer->lights), NULL, GL_DYNAMIC_DRAW));
+    GL_CHECK(glBindBuffer(GL_TEXTURE_BUFFER, renderer->light_cluster_buffer));
+    GL_CHECK(glBufferData(GL_TEXTURE_BUFFER, sizeof(renderer->light_clusters.clusters), NULL, GL_DYNAMIC_DRAW));
+    GL_CHECK(glBindBuffer(GL_TEXTURE_BUFFER, renderer->light_index_buffer));
+    GL_CHECK(glBufferData(GL_TEXTURE_BUFFER, sizeof(uint16) * renderer->light_index_capacity, NULL, GL_DYNAMIC_DRAW));
+    GL_CHECK(glBindBuffer(GL_TEXTURE_BUFFER, 0));
+
+    GL_CHECK(glGenTextures(1, &renderer->light_buffer_tex));
+    GL_CHECK(glGenTextures(1, &renderer->light_cluster_tex));
+    GL_CHECK(glGenTextures(1, &renderer->light_index_tex));
+    GL_CHECK(glBindTexture(GL_TEXTURE_BUFFER, renderer->light_buffer_tex));
+    GL_CHECK(glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, renderer->light_buffer));
+    GL_CHECK(glBindTexture(GL_TEXTURE_BUFFER, renderer->light_cluster_tex));
+    GL_CHECK(glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, renderer->light_cluster_buffer));
+    GL_CHECK(glBindTexture(GL_TEXTURE_BUFFER, renderer->light_index_tex));
+    GL_CHECK(glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, renderer->light_index_buffer));
+    GL_CHECK(glBindTexture(GL_TEXTURE_BUFFER, 0));
+
+    // Per-instance model and normal matrices for static meshes, refilled once per material every frame
+    GL_CHECK(glGenBuffers(1, &renderer->instance_vbo));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, renderer->instance_vbo));
+    GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(renderer->instances), NULL, GL_STREAM_DRAW));
+    GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+    // Indirect draw commands for static meshes, refilled once per material every frame
+    renderer->indirect_buffer = 0;
+    if(gl_multi_draw_elements_indirect)
+    {
+        GL_CHECK(glGenBuffers(1, &renderer->indirect_buffer));
+        GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, renderer->indirect_buffer));
+        GL_CHECK(glBufferData(GL_COPY_WRITE_BUFFER, sizeof(renderer->draw_commands), NULL, GL_STREAM_DRAW));
+        GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    }
+    log_message("Static meshes are drawn with %s", renderer->indirect_buffer ? "glMultiDrawElementsIndirect" : "a draw call per batch");
+
     // Initialize materials
     for(int i = 0; i < MAT_MAX; i++)
 		material_init(&renderer->materials[i], i);
@@ -78,9 +153,11 @@ void renderer_init(struct Renderer* renderer)
 
 void renderer_render(struct Renderer* renderer, struct Scene* scene)
 {
+	PROFILE_BEGIN("Render");
 	struct Game_State* game_state = game_state_get();
 	struct Camera* active_camera = &scene->cameras[scene->active_camera_index];
-	int num_rendered = 0, num_culled = 0, num_indices = 0;
+	int num_rendered = 0, num_culled = 0, num_indices = 0, num_draw_calls = 0;
+	gpu_timer_pool_frame_begin(&renderer->gpu_timers);
 
 	int width = 0, height = 0;
 	window_get_drawable_size(game_state->window, &width, &height);
@@ -98,79 +175,29 @@ void renderer_render(struct Renderer* renderer, struct Scene* scene)
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	static mat4 mvp;
+	PROFILE_SCOPE("Lights And Culling")
+	{
+		renderer_light_block_update(renderer, scene, active_camera, width, height);
+		renderer_static_mesh_visibility_update(renderer, scene, active_camera);
+	}
+	PROFILE_BEGIN("Static Meshes");
+	gpu_timer_begin(&renderer->gpu_timers, RGT_MATERIALS);
 	for(int i = 0; i < MAT_MAX; i++)
 	{
-		/* for each material, get all the registered models and render them */
+		/* for each material, queue the visible registered meshes and render them in sorted batches */
 		struct Material* material = &renderer->materials[i];
+		int queue_length = renderer_render_queue_build(renderer, material, &num_culled);
+		if(queue_length == 0) continue;
+
 		GL_CHECK(shader_bind(material->shader));
 
-		if(material->lit)	/* Set light information */
+		if(material->lit)
 		{
-			char uniform_name[MAX_UNIFORM_NAME_LEN];
-			memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-			int light_count = -1;
-			for(int j = 0; j < MAX_SCENE_LIGHTS; j++)
-			{
-				struct Light* light = &scene->lights[j]; /* TODO: Cull lights according to camera frustum */
-				if(!(light->base.flags & EF_ACTIVE) || !light->valid) continue;
-				light_count++;
-
-				vec3 light_pos = { 0, 0, 0 };
-				transform_get_absolute_position(&light->base, &light_pos);
-
-				if(light->type != LT_POINT)
-				{
-					snprintf(uniform_name, MAX_UNIFORM_NAME_LEN, "lights[%d].direction", light_count);
-					vec3 light_dir = { 0.f, 0.f, 0.f };
-					transform_get_absolute_forward(&light->base, &light_dir);
-					vec3_norm(&light_dir, &light_dir);
-					shader_set_uniform_vec3(material->shader, uniform_name, &light_dir);
-					memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-				}
-
-				if(light->type != LT_DIR)
-				{
-					snprintf(uniform_name, MAX_UNIFORM_NAME_LEN, "lights[%d].position", light_count);
-					shader_set_uniform_vec3(material->shader, uniform_name, &light_pos);
-					memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-
-					snprintf(uniform_name, MAX_UNIFORM_NAME_LEN, "lights[%d].outer_angle", light_count);
-					shader_set_uniform_float(material->shader, uniform_name, TO_RADIANS(light->outer_angle));
-					memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-
-					snprintf(uniform_name, MAX_UNIFORM_NAME_LEN, "lights[%d].inner_angle", light_count);
-					shader_set_uniform_float(material->shader, uniform_name, TO_RADIANS(light->inner_angle));
-					memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-
-					snprintf(uniform_name, MAX_UNIFORM_NAME_LEN, "lights[%d].falloff", light_count);
-					shader_set_uniform_float(material->shader, uniform_name, light->falloff);
-					memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-
-					snprintf(uniform_name, MAX_UNIFORM_NAME_LEN, "lights[%d].radius", light_count);
-					shader_set_uniform_int(material->shader, uniform_name, light->radius);
-					memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-				}
-
-				snprintf(uniform_name, MAX_UNIFORM_NAME_LEN, "lights[%d].color", light_count);
-				shader_set_uniform_vec3(material->shader, uniform_name, &light->color);
-				memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-
-				snprintf(uniform_name, MAX_UNIFORM_NAME_LEN, "lights[%d].intensity", light_count);
-				shader_set_uniform_float(material->shader, uniform_name, light->intensity);
-				memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-
-				snprintf(uniform_name, MAX_UNIFORM_NAME_LEN, "lights[%d].type", light_count);
-				shader_set_uniform_int(material->shader, uniform_name, light->type);
-				memset(uniform_name, '\0', MAX_UNIFORM_NAME_LEN);
-			}
-
-			light_count++; // this variable is going to be sent as a uniform and be used for looping an array so increase its length by one
-			GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_TOTAL_LIGHTS].type, material->pipeline_params[MPP_TOTAL_LIGHTS].location, &light_count));
-
 			vec3 camera_pos = { 0, 0, 0 };
 			transform_get_absolute_position(&active_camera->base, &camera_pos);
 			GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_CAM_POS].type, material->pipeline_params[MPP_CAM_POS].location, &camera_pos));
+			GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_VIEW_MAT].type, material->pipeline_params[MPP_VIEW_MAT].location, &active_camera->view_mat));
+			renderer_light_buffers_bind(renderer);
 		}
 
 		/* Set material pipeline uniforms */
@@ -180,31 +207,70 @@ void renderer_render(struct Renderer* renderer, struct Scene* scene)
 		GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_FOG_MAX_DIST].type, material->pipeline_params[MPP_FOG_MAX_DIST].location, &renderer->settings.fog.max_dist));
 		GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_FOG_COLOR].type, material->pipeline_params[MPP_FOG_COLOR].location, &renderer->settings.fog.color));
 		GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_AMBIENT_LIGHT].type, material->pipeline_params[MPP_AMBIENT_LIGHT].location, &renderer->settings.ambient_light));
-		if(material->lit) GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_VIEW_MAT].type, material->pipeline_params[MPP_VIEW_MAT].location, &active_camera->view_mat));
-
-
-		for(int j = 0; j < MAX_MATERIAL_REGISTERED_STATIC_MESHES; j++)
+		GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_VIEW_PROJ_MAT].type, material->pipeline_params[MPP_VIEW_PROJ_MAT].location, &active_camera->view_proj_mat));
+
+		/* Upload the instance data of every queued mesh in one go, batches index into this range */
+		for(int j = 0; j < queue_length; j++)
+			renderer_instance_set(&renderer->instances[j], &renderer->render_queue[j].mesh->base.transform.trans_mat);
+		GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, renderer->instance_vbo));
+		GL_CHECK(glBufferData(GL_ARRAY_BUFFER, sizeof(renderer->instances), NULL, GL_STREAM_DRAW));
+		GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(struct Geometry_Instance) * queue_length, renderer->instances));
+		GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+		/* Turn the queue into batches and the batches into groups that only differ in geometry,
+		   every batch becomes one draw command and the commands for the material are uploaded at once */
+		int num_commands = 0;
+		int num_groups   = 0;
+		int batch_start  = 0;
+		while(batch_start < queue_length)
 		{
-			if(!material->registered_static_meshes[j] || (material->registered_static_meshes[j]->base.flags & EF_SKIP_RENDER)) continue;
-
-			/* for each registered model, set up uniforms and render */
-			struct Static_Mesh* mesh = material->registered_static_meshes[j];
-			struct Geometry* geometry = geom_get(mesh->model.geometry_index);
-
-			/* Check if model is in frustum */
-			int intersection = mesh->base.flags & EF_ALWAYS_RENDER ? IT_INSIDE : bv_intersect_frustum_box(&active_camera->frustum, &mesh->base.derived_bounding_box);
-			if(intersection == IT_INSIDE || intersection == IT_INTERSECT)
+			/* Grow the batch while meshes share geometry, culling mode and model parameters */
+			struct Static_Mesh* mesh = renderer->render_queue[batch_start].mesh;
+			int batch_end = batch_start + 1;
+			while(batch_end < queue_length &&
+				  renderer->render_queue[batch_end].sort_key == renderer->render_queue[batch_start].sort_key &&
+				  renderer->render_queue[batch_end].mesh->model.geometry_index == mesh->model.geometry_index &&
+				  renderer_model_params_equal(mesh, renderer->render_queue[batch_end].mesh))
 			{
-				num_indices += geometry->indices_length;
-				num_rendered++;
+				batch_end++;
 			}
-			else
+
+			int instance_count = batch_end - batch_start;
+			struct Geometry* geometry = geom_get(mesh->model.geometry_index);
+			bool shared = geom_draw_command_get(mesh->model.geometry_index, batch_start, instance_count, &renderer->draw_commands[num_commands]);
+			struct Render_Draw_Group* group = num_groups > 0 ? &renderer->draw_groups[num_groups - 1] : NULL;
+			if(!group || !shared || !group->shared || group->index_type != geometry->index_type || !renderer_model_params_equal(group->mesh, mesh))
 			{
-				num_culled++;
-				continue;
+				group = &renderer->draw_groups[num_groups++];
+				group->mesh          = mesh;
+				group->first_command = num_commands;
+				group->num_commands  = 0;
+				group->index_type    = geometry->index_type;
+				group->shared        = shared;
 			}
+			group->num_commands++;
+			num_commands++;
+			num_indices  += geometry->indices_length * instance_count;
+			num_rendered += instance_count;
+			batch_start = batch_end;
+		}
 
-			/* set material params for the model */
+		uint indirect_buffer = renderer->settings.multi_draw_indirect ? renderer->indirect_buffer : 0;
+		if(indirect_buffer)
+		{
+			GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, indirect_buffer));
+			GL_CHECK(glBufferData(GL_COPY_WRITE_BUFFER, sizeof(renderer->draw_commands), NULL, GL_STREAM_DRAW));
+			GL_CHECK(glBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(struct Geometry_Draw_Command) * num_commands, renderer->draw_commands));
+			GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+		}
+
+		int cull_disabled = -1;
+		for(int g = 0; g < num_groups; g++)
+		{
+			struct Render_Draw_Group* group = &renderer->draw_groups[g];
+			struct Static_Mesh*       mesh  = group->mesh;
+
+			/* set material params for the group */
 			for(int k = 0; k < MMP_MAX; k++)
 			{
 				switch(mesh->model.material_params[k].type)
@@ -217,77 +283,93 @@ void renderer_render(struct Renderer* renderer, struct Scene* scene)
 				}
 			}
 
-			/* Set pipeline uniforms that are derived per model */
-			mat4_identity(&mvp);
-			mat4_mul(&mvp, &active_camera->view_proj_mat, &mesh->base.transform.trans_mat);
-			GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_MVP].type, material->pipeline_params[MPP_MVP].location, &mvp));
-
-			if(material->lit)
+			/* Only touch cull state when it actually changes between batches */
+			int disable_cull = (mesh->base.flags & EF_DISABLE_BACKFACE_CULL) ? 1 : 0;
+			if(disable_cull != cull_disabled)
 			{
-				GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_VIEW_MAT].type, material->pipeline_params[MPP_VIEW_MAT].location, &active_camera->view_mat));
-				GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_MODEL_MAT].type, material->pipeline_params[MPP_MODEL_MAT].location, &mesh->base.transform.trans_mat));
-				mat4 inv_mat;
-				mat4_identity(&inv_mat);
-				mat4_inverse(&inv_mat, &mesh->base.transform.trans_mat);
-				GL_CHECK(shader_set_uniform(material->pipeline_params[MPP_INV_MODEL_MAT].type, material->pipeline_params[MPP_INV_MODEL_MAT].location, &inv_mat));
+				if(disable_cull)
+					glDisable(GL_CULL_FACE);
+				else
+					glEnable(GL_CULL_FACE);
+				cull_disabled = disable_cull;
 			}
 
-			/* Render the geometry */
-			if(mesh->base.flags & EF_DISABLE_BACKFACE_CULL)
-				glDisable(GL_CULL_FACE);
+			if(group->shared)
+			{
+				num_draw_calls += geom_render_indirect(GDM_TRIANGLES, group->index_type, renderer->instance_vbo, indirect_buffer, renderer->draw_commands, group->first_command, group->num_commands);
+			}
 			else
-				glEnable(GL_CULL_FACE);
-			geom_render(mesh->model.geometry_index, GDM_TRIANGLES);
-
-			for(int k = 0; k < MMP_MAX; k++)
 			{
-				/* unbind textures, if any */
-				if(material->model_params[k].type == UT_TEX)
-					GL_CHECK(texture_unbind(mesh->model.material_params[k].val_int));
+				const struct Geometry_Draw_Command* command = &renderer->draw_commands[group->first_command];
+				geom_render_instanced(mesh->model.geometry_index, GDM_TRIANGLES, renderer->instance_vbo, (int)command->base_instance, (int)command->instance_count);
+				num_draw_calls++;
 			}
 		}
+
+		for(int k = 0; k < MMP_MAX; k++)
+		{
+			/* unbind textures, if any */
+			if(material->model_params[k].type == UT_TEX)
+				GL_CHECK(texture_unbind(renderer->render_queue[queue_length - 1].mesh->model.material_params[k].val_int));
+		}
+		glEnable(GL_CULL_FACE);
 		shader_unbind();
 	}
+	gpu_timer_end(&renderer->gpu_timers, RGT_MATERIALS);
+	PROFILE_END();
 
 	debug_vars_show_int("Rendered", num_rendered);
 	debug_vars_show_int("Culled", num_culled);
 	debug_vars_show_int("Num Indices", num_indices);
+	debug_vars_show_int("Draw Calls", num_draw_calls);
+	debug_vars_show_int("Uniform Queries", shader_uniform_location_queries_reset());
+	renderer->stats.num_rendered   = num_rendered;
+	renderer->stats.num_culled     = num_culled;
+	renderer->stats.num_indices    = num_indices;
+	renderer->stats.num_draw_calls = num_draw_calls;
 
     /* Debug Render */
 	if(renderer->settings.debug_draw_enabled)
     {
+		gpu_timer_begin(&renderer->gpu_timers, RGT_DEBUG_DRAW);
 		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 		shader_bind(renderer->debug_shader);
 		{
 			static mat4 mvp;
-			shader_set_uniform_vec4(renderer->debug_shader, "debug_color", &renderer->settings.debug_draw_color);
-			for(int i = 0; i < MAX_SCENE_STATIC_MESHES; i++)
+			shader_set_uniform(UT_VEC4, renderer->debug_uniform_color, &renderer->settings.debug_draw_color);
+			for(int i = 0; i < scene->static_meshes.num_live; i++)
 			{
-				struct Static_Mesh* mesh = &scene->static_meshes[i];
+				struct Static_Mesh* mesh = pool_live_at(&scene->static_meshes, i);
 				if(!(mesh->base.flags & EF_ACTIVE)) continue;
 				struct Model*     model     = &mesh->model;
 				struct Transform* transform = &mesh->base.transform;
 				int               geometry  = model->geometry_index;
 				mat4_identity(&mvp);
 				mat4_mul(&mvp, &active_camera->view_proj_mat, &transform->trans_mat);
-				shader_set_uniform_mat4(renderer->debug_shader, "mvp", &mvp);
+				shader_set_uniform(UT_MAT4, renderer->debug_uniform_mvp, &mvp);
 				geom_render(geometry, renderer->settings.debug_draw_mode);
 			}
 		}
 		shader_unbind();
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		gpu_timer_end(&renderer->gpu_timers, RGT_DEBUG_DRAW);
     }
 
 	//Editor related rendering
 	if(game_state->game_mode == GAME_MODE_EDITOR)
 	{
+		gpu_timer_begin(&renderer->gpu_timers, RGT_EDITOR);
 		editor_render(game_state->editor, active_camera);
+		gpu_timer_end(&renderer->gpu_timers, RGT_EDITOR);
 	}
 
     //Immediate mode geometry render
+    gpu_timer_begin(&renderer->gpu_timers, RGT_IMMEDIATE_MODE);
     im_render(active_camera);
+    gpu_timer_end(&renderer->gpu_timers, RGT_IMMEDIATE_MODE);
 
     /* Render 2D stuff */
+    gpu_timer_begin(&renderer->gpu_timers, RGT_SPRITES);
     shader_bind(renderer->sprite_batch->shader);
     {
 		static mat4 ortho_mat;
@@ -297,15 +379,29 @@ void renderer_render(struct Renderer* renderer, struct Scene* scene)
 		window_get_size(game_state->window, &width, &height);
 
 		mat4_ortho(&ortho_mat, 0.f, (float)width, (float)height, 0.f, -10.f, 10.f);
-		shader_set_uniform_mat4(renderer->sprite_batch->shader, "mvp", &ortho_mat);
+		shader_set_uniform(UT_MAT4, renderer->sprite_batch->uniform_mvp, &ortho_mat);
 
 		sprite_batch_render(renderer->sprite_batch);
     }
     shader_unbind();
+    gpu_timer_end(&renderer->gpu_timers, RGT_SPRITES);
 
     /* Render UI */
+    gpu_timer_begin(&renderer->gpu_timers, RGT_GUI);
     gui_render(game_state->gui_editor, NK_ANTI_ALIASING_ON);
     gui_render(game_state->gui_game->gui, NK_ANTI_ALIASING_ON);
+    gpu_timer_end(&renderer->gpu_timers, RGT_GUI);
+
+    /* Stages that did not run this frame report zero rather than a stale time */
+    for(int i = 0; i < RGT_MAX; i++)
+    {
+		bool stage_ran = (i != RGT_DEBUG_DRAW || renderer->settings.debug_draw_enabled) && (i != RGT_EDITOR || game_state->game_mode == GAME_MODE_EDITOR);
+		renderer->stats.gpu_ms[i] = stage_ran ? gpu_timer_elapsed_ms_get(&renderer->gpu_timers, i) : 0.f;
+		if(!renderer->gpu_timers.supported) continue;
+		debug_vars_show_float(gpu_timer_names[i], renderer->stats.gpu_ms[i]);
+		PROFILE_COUNTER(gpu_timer_names[i], renderer->stats.gpu_ms[i]);
+    }
+    PROFILE_END();
 }
 
 void renderer_cleanup(struct Renderer* renderer)
@@ -315,10 +411,220 @@ void renderer_cleanup(struct Renderer* renderer)
 		material_reset(&renderer->materials[i]);
     }
     im_cleanup();
+    gpu_timer_pool_destroy(&renderer->gpu_timers);
+    GL_CHECK(glDeleteBuffers(1, &renderer->light_ubo));
+    renderer->light_ubo = 0;
+    GL_CHECK(glDeleteTextures(1, &renderer->light_buffer_tex));
+    GL_CHECK(glDeleteTextures(1, &renderer->light_cluster_tex));
+    GL_CHECK(glDeleteTextures(1, &renderer->light_index_tex));
+    GL_CHECK(glDeleteBuffers(1, &renderer->light_buffer));
+    GL_CHECK(glDeleteBuffers(1, &renderer->light_cluster_buffer));
+    GL_CHECK(glDeleteBuffers(1, &renderer->light_index_buffer));
+    renderer->light_buffer_tex     = 0;
+    renderer->light_cluster_tex    = 0;
+    renderer->light_index_tex      = 0;
+    renderer->light_buffer         = 0;
+    renderer->light_cluster_buffer = 0;
+    renderer->light_index_buffer   = 0;
+    light_cluster_grid_destroy(&renderer->light_clusters);
+    if(renderer->static_mesh_visibility) memory_free(renderer->static_mesh_visibility);
+    renderer->static_mesh_visibility          = NULL;
+    renderer->static_mesh_visibility_capacity = 0;
+    GL_CHECK(glDeleteBuffers(1, &renderer->instance_vbo));
+    renderer->instance_vbo = 0;
+    if(renderer->indirect_buffer) GL_CHECK(glDeleteBuffers(1, &renderer->indirect_buffer));
+    renderer->indirect_buffer = 0;
     sprite_batch_remove(renderer->sprite_batch);
     memory_free(renderer->sprite_batch);
 }
 
+void renderer_light_block_update(struct Renderer* renderer, struct Scene* scene, struct Camera* camera, int width, int height)
+{
+	struct Light_Block* light_block = &renderer->light_block;
+
+	/* Directional lights are written first since they light every fragment, point and
+	   spot lights follow and only reach the shader through their cluster's light list */
+	int light_count = 0;
+	for(int pass = 0; pass < 2; pass++)
+	{
+		if(pass == 1) light_block->num_directional_lights = light_count;
+		for(int i = 0; i < scene->lights.num_live && light_count < MAX_SCENE_LIGHTS; i++)
+		{
+			struct Light* light = pool_live_at(&scene->lights, i);
+			if(!(light->base.flags & EF_ACTIVE) || !light->valid || (light->type == LT_DIR) != (pass == 0)) continue;
+
+			struct Light_Block_Entry* entry = &renderer->lights[light_count++];
+			transform_get_absolute_position(&light->base, &entry->position);
+			transform_get_absolute_forward(&light->base, &entry->direction);
+			vec3_norm(&entry->direction, &entry->direction);
+			vec3_assign(&entry->color, &light->color);
+			entry->outer_angle = TO_RADIANS(light->outer_angle);
+			entry->inner_angle = TO_RADIANS(light->inner_angle);
+			entry->falloff     = light->falloff;
+			entry->intensity   = light->intensity;
+			entry->radius      = (float)light->radius;
+			entry->type        = light->type;
+			entry->padding     = 0;
+			if(pass == 0) continue;
+
+			/* Spot lights are bounded by the smallest sphere around their cone, narrow
+			   cones only need a fraction of the sphere a point light of the same radius would */
+			struct Bounding_Sphere* sphere = &renderer->light_spheres[light_count - 1 - light_block->num_directional_lights];
+			vec3_assign(&sphere->center, &entry->position);
+			sphere->radius = entry->radius;
+			if(entry->type == LT_SPOT && entry->outer_angle < (float)M_PI * 0.5f)
+			{
+				float cos_angle = cosf(entry->outer_angle);
+				float offset    = entry->outer_angle > (float)M_PI * 0.25f ? entry->radius * cos_angle : entry->radius / (2.f * cos_angle);
+				sphere->radius  = entry->outer_angle > (float)M_PI * 0.25f ? entry->radius * sinf(entry->outer_angle) : offset;
+				vec3 center_offset = { 0.f, 0.f, 0.f };
+				vec3_scale(&center_offset, &entry->direction, offset);
+				vec3_add(&sphere->center, &sphere->center, &center_offset);
+			}
+		}
+	}
+	light_block->total_active_lights = light_count;
+
+	int num_clustered_lights = light_count - light_block->num_directional_lights;
+	struct Light_Cluster_Grid* grid = &renderer->light_clusters;
+	light_cluster_grid_build(grid, &camera->view_mat, &camera->proj_mat, camera->nearz, camera->farz, renderer->light_spheres, num_clustered_lights, light_block->num_directional_lights);
+	light_block->cluster_z_scale     = grid->z_scale;
+	light_block->cluster_z_bias      = grid->z_bias;
+	light_block->cluster_tile_size.x = (float)width / LIGHT_CLUSTER_X;
+	light_block->cluster_tile_size.y = (float)height / LIGHT_CLUSTER_Y;
+
+	GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, renderer->light_ubo));
+	GL_CHECK(glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(*light_block), light_block));
+	GL_CHECK(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+
+	// Only upload the lights that are in use
+	if(light_count > 0)
+	{
+		GL_CHECK(glBindBuffer(GL_TEXTURE_BUFFER, renderer->light_buffer));
+		GL_CHECK(glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeof(struct Light_Block_Entry) * light_count, &renderer->lights[0]));
+	}
+	GL_CHECK(glBindBuffer(GL_TEXTURE_BUFFER, renderer->light_cluster_buffer));
+	GL_CHECK(glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeof(grid->clusters), grid->clusters));
+	GL_CHECK(glBindBuffer(GL_TEXTURE_BUFFER, renderer->light_index_buffer));
+	if(grid->num_light_indices > renderer->light_index_capacity)
+	{
+		renderer->light_index_capacity = grid->light_indices_capacity;
+		GL_CHECK(glBufferData(GL_TEXTURE_BUFFER, sizeof(uint16) * renderer->light_index_capacity, NULL, GL_DYNAMIC_DRAW));
+	}
+	if(grid->num_light_indices > 0)
+		GL_CHECK(glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeof(uint16) * grid->num_light_indices, grid->light_indices));
+	GL_CHECK(glBindBuffer(GL_TEXTURE_BUFFER, 0));
+
+	debug_vars_show_int("Active Lights", light_count);
+	debug_vars_show_int("Cluster Light Indices", grid->num_light_indices);
+}
+
+void renderer_light_buffers_bind(struct Renderer* renderer)
+{
+	GL_CHECK(glActiveTexture(GL_TEXTURE0 + TU_LIGHTS));
+	GL_CHECK(glBindTexture(GL_TEXTURE_BUFFER, renderer->light_buffer_tex));
+	GL_CHECK(glActiveTexture(GL_TEXTURE0 + TU_LIGHT_CLUSTERS));
+	GL_CHECK(glBindTexture(GL_TEXTURE_BUFFER, renderer->light_cluster_tex));
+	GL_CHECK(glActiveTexture(GL_TEXTURE0 + TU_LIGHT_INDICES));
+	GL_CHECK(glBindTexture(GL_TEXTURE_BUFFER, renderer->light_index_tex));
+	GL_CHECK(glActiveTexture(GL_TEXTURE0));
+}
+
+void renderer_static_mesh_visibility_update(struct Renderer* renderer, struct Scene* scene, struct Camera* camera)
+{
+	/* Every static mesh in the scene is culled in one batched pass, materials then only look up their bits */
+	int count     = pool_capacity(&scene->static_meshes);
+	int num_words = (count + 31) / 32;
+	if(num_words > renderer->static_mesh_visibility_capacity)
+	{
+		renderer->static_mesh_visibility          = memory_reallocate_((void**)&renderer->static_mesh_visibility, sizeof(uint32) * num_words);
+		renderer->static_mesh_visibility_capacity = num_words;
+	}
+	if(count > 0)
+		bv_intersect_frustum_boxes(camera->frustum, &scene->static_mesh_bounds, count, renderer->static_mesh_visibility);
+}
+
+int renderer_render_queue_build(struct Renderer* renderer, struct Material* material, int* out_num_culled)
+{
+	int queue_length = 0;
+	for(int i = 0; i < material->num_registered_static_meshes; i++)
+	{
+		struct Static_Mesh* mesh = material->registered_static_meshes[i];
+		if(mesh->base.flags & EF_SKIP_RENDER) continue;
+
+		/* Check if model is in frustum */
+		int slot = mesh->base.id;
+		bool visible = (mesh->base.flags & EF_ALWAYS_RENDER) || (renderer->static_mesh_visibility[slot >> 5] & (1u << (slot & 31)));
+		if(!visible)
+		{
+			(*out_num_culled)++;
+			continue;
+		}
+
+		/* Hash the raw values of the model parameters, meshes with identical parameters
+		   get identical keys and only need a full comparison when batching */
+		uint32 params_hash = 2166136261u;
+		for(int k = 0; k < MMP_MAX; k++)
+		{
+			const struct Variant* param = &mesh->model.material_params[k];
+			const uint8* bytes = (const uint8*)&param->val_int;
+			int size = renderer_model_param_size(param);
+			for(int b = 0; b < size; b++)
+				params_hash = (params_hash ^ bytes[b]) * 16777619u;
+		}
+
+		const struct Variant* diffuse_tex = &mesh->model.material_params[MMP_DIFFUSE_TEX];
+		uint64 texture  = diffuse_tex->type == VT_INT ? (uint64)(diffuse_tex->val_int + 1) : 0;
+		uint64 geometry = (uint64)mesh->model.geometry_index;
+		uint64 cull     = (mesh->base.flags & EF_DISABLE_BACKFACE_CULL) ? 1 : 0;
+
+		struct Render_Queue_Item* item = &renderer->render_queue[queue_length++];
+		item->mesh     = mesh;
+		item->sort_key = ((texture & 0xFFFF) << 48) | (cull << 47) | ((uint64)(params_hash & 0x7FFFFFFF) << 16) | (geometry & 0xFFFF);
+	}
+
+	if(queue_length > 1)
+		qsort(renderer->render_queue, queue_length, sizeof(struct Render_Queue_Item), renderer_render_queue_item_compare);
+
+	return queue_length;
+}
+
+int renderer_render_queue_item_compare(const void* a, const void* b)
+{
+	const struct Render_Queue_Item* item_a = (const struct Render_Queue_Item*)a;
+	const struct Render_Queue_Item* item_b = (const struct Render_Queue_Item*)b;
+	if(item_a->sort_key < item_b->sort_key) return -1;
+	if(item_a->sort_key > item_b->sort_key) return 1;
+	return 0;
+}
+
+int renderer_model_param_size(const struct Variant* param)
+{
+	switch(param->type)
+	{
+	case VT_INT:   return sizeof(int);
+	case VT_FLOAT: return sizeof(float);
+	case VT_VEC2:  return sizeof(vec2);
+	case VT_VEC3:  return sizeof(vec3);
+	case VT_VEC4:  return sizeof(vec4);
+	default:       return 0;
+	}
+}
+
+bool renderer_model_params_equal(struct Static_Mesh* a, struct Static_Mesh* b)
+{
+	if((a->base.flags & EF_DISABLE_BACKFACE_CULL) != (b->base.flags & EF_DISABLE_BACKFACE_CULL)) return false;
+
+	for(int k = 0; k < MMP_MAX; k++)
+	{
+		const struct Variant* param_a = &a->model.material_params[k];
+		const struct Variant* param_b = &b->model.material_params[k];
+		if(param_a->type != param_b->type) return false;
+		if(memcmp(&param_a->val_int, &param_b->val_int, renderer_model_param_size(param_a)) != 0) return false;
+	}
+	return true;
+}
+
 void renderer_on_framebuffer_size_changed(const struct Event* event)
 {
 	int width  = event->window_resize.width;
@@ -353,3 +659,22 @@ void renderer_debug_draw_enabled(struct Renderer* renderer, bool enabled)
 {
     renderer->settings.debug_draw_mode = enabled;
 }
+
+static void renderer_instance_set(struct Geometry_Instance* instance, const mat4* model_mat)
+{
+	/* The inverse transpose of a 3x3 matrix with columns a, b and c has the columns b x c, c x a
+	   and a x b divided by the determinant, which is three cross products per instance on the
+	   cpu instead of a matrix inverse for every vertex in the shader */
+	memcpy(&instance->model_mat, model_mat, sizeof(mat4));
+	vec3 a = { model_mat->mat[0], model_mat->mat[1], model_mat->mat[2] };
+	vec3 b = { model_mat->mat[4], model_mat->mat[5], model_mat->mat[6] };
+	vec3 c = { model_mat->mat[8], model_mat->mat[9], model_mat->mat[10] };
+	vec3 columns[3];
+	vec3_cross(&columns[0], &b, &c);
+	vec3_cross(&columns[1], &c, &a);
+	vec3_cross(&columns[2], &a, &b);
+	float determinant = vec3_dot(&a, &columns[0]);
+	float inv_determinant = fabsf(determinant) > EPSILON ? 1.f / determinant : 0.f;
+	for(int i = 0; i < 3; i++)
+		vec4_fill(&instance->normal_mat[i], columns[i].x * inv_determinant, columns[i].y * inv_determinant, columns[i].z * inv_determinant, 0.f);
+}
@@ -4,6 +4,9 @@
 #include "../common/linmath.h"
 #include "../common/num_types.h"
 #include "material.h"
+#include "light_cluster.h"
+#include "gpu_timer.h"
+#include "geometry.h"
 
 struct Sprite_Batch;
 struct Scene;
@@ -26,6 +29,53 @@ struct Fog
 };
 
 
+/* Every light takes four RGBA32F texels of the light buffer read by blinn_phong.frag,
+   vec3s share their texel with a scalar and type is read back with floatBitsToInt */
+struct Light_Block_Entry
+{
+    vec3  position;
+    float outer_angle;
+    vec3  direction;
+    float inner_angle;
+    vec3  color;
+    float falloff;
+    float intensity;
+    float radius;
+    int   type;
+    int   padding;
+};
+
+/* Mirrors the std140 layout of Light_Block in blinn_phong.frag */
+struct Light_Block
+{
+    int   total_active_lights;
+    int   num_directional_lights; // Directional lights come first in the light buffer and are applied everywhere
+    float cluster_z_scale;
+    float cluster_z_bias;
+    vec2  cluster_tile_size;      // In pixels
+    vec2  padding;
+};
+
+/* Entry in the per-material render queue, the sort key packs diffuse texture, culling mode,
+   a hash of the remaining model parameters and geometry so that meshes which can be drawn
+   together end up next to each other, and meshes that only differ in geometry follow each other */
+struct Render_Queue_Item
+{
+    uint64              sort_key;
+    struct Static_Mesh* mesh;
+};
+
+/* Consecutive batches of the render queue that share model parameters and culling mode, the
+   commands of a group are submitted with a single multi draw when it is supported */
+struct Render_Draw_Group
+{
+    struct Static_Mesh* mesh;          // First mesh of the group, its model parameters apply to every batch in it
+    int                 first_command;
+    int                 num_commands;
+    uint                index_type;
+    bool                shared;        // Geometry lives in the shared buffers, otherwise the group holds a single batch drawn on its own
+};
+
 struct Render_Settings
 {
     struct Fog fog;
@@ -34,14 +84,59 @@ struct Render_Settings
     vec4       debug_draw_color;
     int        debug_draw_mode;
     bool       debug_draw_physics;
+    bool       multi_draw_indirect; // Falls back to a draw per batch when off or not supported by the driver
+};
+
+enum Render_Gpu_Timer
+{
+    RGT_MATERIALS = 0,
+    RGT_DEBUG_DRAW,
+    RGT_EDITOR,
+    RGT_IMMEDIATE_MODE,
+    RGT_SPRITES,
+    RGT_GUI,
+    RGT_MAX
+};
+
+struct Render_Stats
+{
+    int   num_rendered;
+    int   num_culled;
+    int   num_indices;
+    int   num_draw_calls;
+    float gpu_ms[RGT_MAX]; // Gpu time per stage, lags a few frames behind the other counters
 };
 
 struct Renderer
 {
     int                    debug_shader;
+    int                    debug_uniform_mvp;
+    int                    debug_uniform_color;
     struct Sprite_Batch*   sprite_batch;
     struct Render_Settings settings;
+    struct Render_Stats    stats; // Counters from the last call to renderer_render
+    struct Gpu_Timer_Pool  gpu_timers;
     struct Material        materials[MAT_MAX];
+    uint                   light_ubo;
+    struct Light_Block     light_block;
+    struct Light_Block_Entry lights[MAX_SCENE_LIGHTS];
+    struct Bounding_Sphere light_spheres[MAX_SCENE_LIGHTS]; // World space bounds of the point and spot lights, which follow the directional ones in lights
+    struct Light_Cluster_Grid light_clusters;
+    uint                   light_buffer;
+    uint                   light_buffer_tex;
+    uint                   light_cluster_buffer;
+    uint                   light_cluster_tex;
+    uint                   light_index_buffer;
+    uint                   light_index_tex;
+    int                    light_index_capacity;
+    uint32*                static_mesh_visibility; // Bit per static mesh pool slot, set when the mesh's box is not outside the active camera's frustum
+    int                    static_mesh_visibility_capacity;
+    uint                   instance_vbo;
+    uint                   indirect_buffer; // 0 when glMultiDrawElementsIndirect is not available
+    struct Render_Queue_Item render_queue[MAX_MATERIAL_REGISTERED_STATIC_MESHES];
+    struct Geometry_Instance instances[MAX_MATERIAL_REGISTERED_STATIC_MESHES];
+    struct Geometry_Draw_Command draw_commands[MAX_MATERIAL_REGISTERED_STATIC_MESHES]; // One per batch, refilled for every material
+    struct Render_Draw_Group draw_groups[MAX_MATERIAL_REGISTERED_STATIC_MESHES];
 };
 
 void renderer_init(struct Renderer* renderer);
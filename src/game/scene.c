@@ -23,6 +23,11 @@
 #include "trigger.h"
 #include "door.h"
 #include "pickup.h"
+#include "bvh.h"
+#include "scene_binary.h"
+#include "profiler.h"
+#include "../common/job_system.h"
+#include "../common/memory_utils.h"
 
 #include <assert.h>
 #include <string.h>
@@ -31,6 +36,43 @@
 
 static void scene_write_entity_entry(struct Scene* scene, struct Entity* entity, struct Parser* parser);
 static void scene_write_entity_list(struct Scene* scene, int entity_type, struct Parser* parser);
+static void scene_write_entity(struct Scene* scene, struct Entity* entity, struct Parser* parser);
+static struct Pool* scene_entity_pool_get(struct Scene* scene, int entity_type);
+static void scene_entity_bvh_insert(struct Scene* scene, struct Entity* entity);
+static void scene_entity_bvh_remove(struct Scene* scene, struct Entity* entity);
+static bool scene_entity_raycastable(struct Entity* entity, int ray_mask);
+static float scene_ray_intersect_visit(struct Entity* entity, struct Ray* ray, void* user_data);
+static float scene_ray_intersect_closest_visit(struct Entity* entity, struct Ray* ray, void* user_data);
+static void scene_enemy_physics_job(void* data, int start, int end);
+static void scene_trigger_physics_job(void* data, int start, int end);
+
+#define SCENE_ENEMY_PHYSICS_BATCH_SIZE   64
+#define SCENE_TRIGGER_PHYSICS_BATCH_SIZE 16 // Each trigger is tested against every enemy
+
+// Shared with the physics jobs, entities are gathered up front so the apply phase is not affected by removals
+struct Scene_Physics_Job
+{
+	struct Scene*                scene;
+	float                        fixed_dt;
+	float                        ticks;
+	struct Enemy**               enemies;
+	struct Enemy_Physics_Result* enemy_results;
+	struct Trigger**             triggers;
+	struct Entity**              triggering_entities;
+};
+
+struct Scene_Raycast_Query
+{
+	struct Raycast_Result* results;
+	int                    ray_mask;
+};
+
+struct Scene_Closest_Query
+{
+	struct Entity* closest;
+	float          distance;
+	int            ray_mask;
+};
 
 void scene_init(struct Scene* scene)
 {
@@ -39,6 +81,8 @@ void scene_init(struct Scene* scene)
 
 	strncpy(scene->filename, "UNNAMED_SCENE", MAX_FILENAME_LEN);
 	memset(scene->next_level_filename, '\0', MAX_FILENAME_LEN);
+	bvh_init(&scene->bvh);
+	bv_box_soa_init(&scene->static_mesh_bounds);
 
 	//Initialize the root entity
 	entity_init(&scene->root_entity, "ROOT_ENTITY", NULL);
@@ -46,32 +90,14 @@ void scene_init(struct Scene* scene)
 	scene->root_entity.id = 0;
 	scene->root_entity.type = ET_ROOT;
 
-	for(int i = 0; i < MAX_SCENE_ENTITIES; i++) 
-	{
-		entity_init(&scene->entities[i], NULL, NULL);
-		scene->entities[i].id = i;
-	}
-
-	for(int i = 0; i < MAX_SCENE_LIGHTS; i++)
-	{
-		entity_init(&scene->lights[i], NULL, NULL);
-		scene->lights[i].base.id = i;
-	}
-	
-	for(int i = 0; i < MAX_SCENE_STATIC_MESHES; i++)
-	{
-		entity_init(&scene->static_meshes[i], NULL, NULL);
-		scene->static_meshes[i].base.id = i;
-		struct Static_Mesh* mesh = &scene->static_meshes[i];
-		mesh->model.geometry_index = -1;
-		mesh->model.material = NULL;
-	}
-
-	for(int i = 0; i < MAX_SCENE_SOUND_SOURCES; i++)
-	{
-		entity_init(&scene->sound_sources[i], NULL, NULL);
-		scene->sound_sources[i].base.id = i;
-	}
+	pool_init(&scene->entities,      sizeof(struct Entity),       SCENE_POOL_BLOCK_CAPACITY);
+	pool_init(&scene->lights,        sizeof(struct Light),        SCENE_POOL_BLOCK_CAPACITY);
+	pool_init(&scene->static_meshes, sizeof(struct Static_Mesh),  SCENE_POOL_BLOCK_CAPACITY);
+	pool_init(&scene->sound_sources, sizeof(struct Sound_Source), SCENE_POOL_BLOCK_CAPACITY);
+	pool_init(&scene->enemies,       sizeof(struct Enemy),        SCENE_POOL_BLOCK_CAPACITY);
+	pool_init(&scene->triggers,      sizeof(struct Trigger),      SCENE_POOL_BLOCK_CAPACITY);
+	pool_init(&scene->doors,         sizeof(struct Door),         SCENE_POOL_BLOCK_CAPACITY);
+	pool_init(&scene->pickups,       sizeof(struct Pickup),       SCENE_POOL_BLOCK_CAPACITY);
 
 	int width = 1280, height = 720;
 	window_get_drawable_size(game_state->window, &width, &height);
@@ -87,32 +113,16 @@ void scene_init(struct Scene* scene)
 	for(int i = 0; i < MAX_SCENE_ENTITY_ARCHETYPES; i++)
 		memset(&scene->entity_archetypes[i][0], '\0', MAX_FILENAME_LEN);
 
-	for(int i = 0; i < MAX_SCENE_ENEMIES; i++)
-	{
-		entity_init(&scene->enemies[i], NULL, NULL);
-		scene->enemies[i].base.id = i;
-	}
-
-	for(int i = 0; i < MAX_SCENE_TRIGGERS; i++)
-	{
-		entity_init(&scene->triggers[i], NULL, NULL);
-		scene->triggers[i].base.id = i;
-	}
-
-	for(int i = 0; i < MAX_SCENE_DOORS; i++)
-	{
-		entity_init(&scene->doors[i], NULL, NULL);
-		scene->doors[i].base.id = i;
-	}
+	player_init(&scene->player, scene);
+	editor_camera_init(game_state->editor, game_state->cvars);
 
-	for(int i = 0; i < MAX_SCENE_PICKUPS; i++)
+	// Player and the default cameras are not created through the scene so they are added to the bvh here
+	scene_entity_bvh_insert(scene, &scene->player.base);
+	for(int i = 0; i < MAX_SCENE_CAMERAS; i++)
 	{
-		entity_init(&scene->pickups[i], NULL, NULL);
-		scene->pickups[i].base.id = i;
+		if(scene->cameras[i].base.flags & EF_ACTIVE)
+			scene_entity_bvh_insert(scene, &scene->cameras[i].base);
 	}
-
-	player_init(&scene->player, scene);
-	editor_camera_init(game_state->editor, game_state->cvars);
 	editor_init_entities(game_state->editor);
 
 	scene->background_music_volume = 0.01f;
@@ -206,28 +216,40 @@ bool scene_load(struct Scene* scene, const char* filename, int directory_type)
 {
 	char prefixed_filename[MAX_FILENAME_LEN + 16];
 	snprintf(prefixed_filename, MAX_FILENAME_LEN + 16, "scenes/%s.symtres", filename);
-    FILE* scene_file = io_file_open(directory_type, prefixed_filename, "rb");
-	if(!scene_file)
+
+	// Prefer the compiled scene if there is an up to date one, otherwise parse the text file
+	FILE* scene_file = NULL;
+	struct Parser* parsed_file = NULL;
+	struct Scene_Binary* scene_binary = scene_binary_load(filename, directory_type);
+	if(scene_binary)
 	{
-		log_error("scene:load", "Failed to open scene file %s for reading", filename);
-		return false;
+		parsed_file = scene_binary->scene_objects;
 	}
-
-	// Load scene config and apply renderer settings
-	struct Parser* parsed_file = parser_load_objects(scene_file, prefixed_filename);
-
-	if(!parsed_file)
+	else
 	{
-		log_error("scene:load", "Failed to parse file '%s' for loading scene", prefixed_filename);
-		fclose(scene_file);
-		return false;
+		scene_file = io_file_open(directory_type, prefixed_filename, "rb");
+		if(!scene_file)
+		{
+			log_error("scene:load", "Failed to open scene file %s for reading", filename);
+			return false;
+		}
+
+		// Load scene config and apply renderer settings
+		parsed_file = parser_load_objects(scene_file, prefixed_filename);
 	}
 
-	if(array_len(parsed_file->objects) == 0)
+	if(!parsed_file || array_len(parsed_file->objects) == 0)
 	{
-		log_error("scene:load", "No objects found in file %s", prefixed_filename);
-		parser_free(parsed_file);
-		fclose(scene_file);
+		if(!parsed_file)
+			log_error("scene:load", "Failed to parse file '%s' for loading scene", prefixed_filename);
+		else
+			log_error("scene:load", "No objects found in file %s", prefixed_filename);
+
+		if(scene_binary)
+			scene_binary_free(scene_binary);
+		else if(parsed_file)
+			parser_free(parsed_file);
+		if(scene_file) fclose(scene_file);
 		return false;
 	}
 
@@ -244,30 +266,30 @@ bool scene_load(struct Scene* scene, const char* filename, int directory_type)
 		{
 		case PO_SCENE_CONFIG:
 		{
-			struct Hashmap* scene_data = object->data;
+			struct Parser_Object* scene_data = object;
 			struct Render_Settings* render_settings = &game_state_get()->renderer->settings;
 			struct Game_State* game_state = game_state_get();
 
-			if(hashmap_value_exists(scene_data, "fog_type"))           render_settings->fog.mode           = hashmap_int_get(scene_data, "fog_type");
-			if(hashmap_value_exists(scene_data, "fog_density"))        render_settings->fog.density        = hashmap_float_get(scene_data, "fog_density");
-			if(hashmap_value_exists(scene_data, "fog_start_distance")) render_settings->fog.start_dist     = hashmap_float_get(scene_data, "fog_start_distance");
-			if(hashmap_value_exists(scene_data, "fog_max_distance"))   render_settings->fog.max_dist       = hashmap_float_get(scene_data, "fog_max_distance");
-			if(hashmap_value_exists(scene_data, "fog_color"))          render_settings->fog.color          = hashmap_vec3_get(scene_data, "fog_color");
-			if(hashmap_value_exists(scene_data, "ambient_light"))      render_settings->ambient_light      = hashmap_vec3_get(scene_data, "ambient_light");
-			if(hashmap_value_exists(scene_data, "debug_draw_color"))   render_settings->debug_draw_color   = hashmap_vec4_get(scene_data, "debug_draw_color");
-			if(hashmap_value_exists(scene_data, "debug_draw_enabled")) render_settings->debug_draw_enabled = hashmap_bool_get(scene_data, "debug_draw_enabled");
-			if(hashmap_value_exists(scene_data, "debug_draw_mode"))    render_settings->debug_draw_mode    = hashmap_int_get(scene_data, "debug_draw_mode");
-			if(hashmap_value_exists(scene_data, "debug_draw_physics")) render_settings->debug_draw_physics = hashmap_bool_get(scene_data, "debug_draw_physics");
+			if(parser_object_value_exists(scene_data, "fog_type"))           render_settings->fog.mode           = parser_object_int_get(scene_data, "fog_type");
+			if(parser_object_value_exists(scene_data, "fog_density"))        render_settings->fog.density        = parser_object_float_get(scene_data, "fog_density");
+			if(parser_object_value_exists(scene_data, "fog_start_distance")) render_settings->fog.start_dist     = parser_object_float_get(scene_data, "fog_start_distance");
+			if(parser_object_value_exists(scene_data, "fog_max_distance"))   render_settings->fog.max_dist       = parser_object_float_get(scene_data, "fog_max_distance");
+			if(parser_object_value_exists(scene_data, "fog_color"))          render_settings->fog.color          = parser_object_vec3_get(scene_data, "fog_color");
+			if(parser_object_value_exists(scene_data, "ambient_light"))      render_settings->ambient_light      = parser_object_vec3_get(scene_data, "ambient_light");
+			if(parser_object_value_exists(scene_data, "debug_draw_color"))   render_settings->debug_draw_color   = parser_object_vec4_get(scene_data, "debug_draw_color");
+			if(parser_object_value_exists(scene_data, "debug_draw_enabled")) render_settings->debug_draw_enabled = parser_object_bool_get(scene_data, "debug_draw_enabled");
+			if(parser_object_value_exists(scene_data, "debug_draw_mode"))    render_settings->debug_draw_mode    = parser_object_int_get(scene_data, "debug_draw_mode");
+			if(parser_object_value_exists(scene_data, "debug_draw_physics")) render_settings->debug_draw_physics = parser_object_bool_get(scene_data, "debug_draw_physics");
 			
-			scene_init_func_assign(scene, hashmap_value_exists(scene_data, "init_func") ? hashmap_str_get(scene_data, "init_func") : "scene_func_stub");
-			scene_cleanup_func_assign(scene, hashmap_value_exists(scene_data, "cleanup_func") ? hashmap_str_get(scene_data, "cleanup_func") : "scene_func_stub");
+			scene_init_func_assign(scene, parser_object_value_exists(scene_data, "init_func") ? parser_object_str_get(scene_data, "init_func") : "scene_func_stub");
+			scene_cleanup_func_assign(scene, parser_object_value_exists(scene_data, "cleanup_func") ? parser_object_str_get(scene_data, "cleanup_func") : "scene_func_stub");
 
-			if(hashmap_value_exists(scene_data, "next_scene"))
-				strncpy(scene->next_level_filename, hashmap_value_exists(scene_data, "next_scene") ? hashmap_str_get(scene_data, "next_scene") : "NONE", MAX_FILENAME_LEN);
+			if(parser_object_value_exists(scene_data, "next_scene"))
+				strncpy(scene->next_level_filename, parser_object_value_exists(scene_data, "next_scene") ? parser_object_str_get(scene_data, "next_scene") : "NONE", MAX_FILENAME_LEN);
 
-			if(hashmap_value_exists(scene_data, "background_music_filename"))
+			if(parser_object_value_exists(scene_data, "background_music_filename"))
 			{
-				const char* background_music_filename = hashmap_str_get(scene_data, "background_music_filename");
+				const char* background_music_filename = parser_object_str_get(scene_data, "background_music_filename");
 				if(!scene_background_music_set(scene, background_music_filename))
 				{
 					log_error("scene:load", "Faield to set scene background music to '%s'. Reverting to default", background_music_filename);
@@ -275,9 +297,9 @@ bool scene_load(struct Scene* scene, const char* filename, int directory_type)
 				}
 			}
 
-			if(hashmap_value_exists(scene_data, "background_music_volume"))
+			if(parser_object_value_exists(scene_data, "background_music_volume"))
 			{
-				float new_volume = hashmap_float_get(scene_data, "background_music_volume"); 
+				float new_volume = parser_object_float_get(scene_data, "background_music_volume"); 
 				scene_background_music_volume_set(scene, new_volume);
 			}
 
@@ -292,26 +314,28 @@ bool scene_load(struct Scene* scene, const char* filename, int directory_type)
 		break;
 		case PO_SCENE_ENTITY_ENTRY:
 		{
-			struct Hashmap* entity_entry_data = object->data;
-			if(hashmap_value_exists(object->data, "filename"))
+			struct Parser_Object* entity_entry_data = object;
+			if(parser_object_value_exists(object, "filename"))
 			{
-				struct Entity* loaded_entity = entity_load(hashmap_str_get(entity_entry_data, "filename"), DIRT_INSTALL, false);
+				const char* entity_filename = parser_object_str_get(entity_entry_data, "filename");
+				struct Parser* archetype_objects = scene_binary ? scene_binary_archetype_get(scene_binary, entity_filename) : NULL;
+				struct Entity* loaded_entity = archetype_objects ? entity_load_objects(archetype_objects, entity_filename, false) : entity_load(entity_filename, DIRT_INSTALL, false);
 				if(loaded_entity)
 				{
 					vec3 position = { 0.f, 0.f, 0.f };
 					quat rotation = { 0.f, 0.f, 0.f, 1.f };
 					vec3 scale    = { 1.f, 1.f, 1.f };
 
-					if(hashmap_value_exists(entity_entry_data, "position")) position = hashmap_vec3_get(entity_entry_data, "position");
-					if(hashmap_value_exists(entity_entry_data, "rotation")) rotation = hashmap_quat_get(entity_entry_data, "rotation");
-					if(hashmap_value_exists(entity_entry_data, "scale"))    scale    = hashmap_vec3_get(entity_entry_data, "scale");
+					if(parser_object_value_exists(entity_entry_data, "position")) position = parser_object_vec3_get(entity_entry_data, "position");
+					if(parser_object_value_exists(entity_entry_data, "rotation")) rotation = parser_object_quat_get(entity_entry_data, "rotation");
+					if(parser_object_value_exists(entity_entry_data, "scale"))    scale    = parser_object_vec3_get(entity_entry_data, "scale");
 
 					transform_set_position(loaded_entity, &position);
 					transform_scale(loaded_entity, &scale);
 					quat_assign(&loaded_entity->transform.rotation, &rotation);
-					transform_update_transmat(loaded_entity);
+					transform_mark_dirty(loaded_entity);
 
-					if(hashmap_value_exists(entity_entry_data, "name")) strncpy(loaded_entity->name, hashmap_str_get(entity_entry_data, "name"), MAX_ENTITY_NAME_LEN);
+					if(parser_object_value_exists(entity_entry_data, "name")) strncpy(loaded_entity->name, parser_object_str_get(entity_entry_data, "name"), MAX_ENTITY_NAME_LEN);
 					num_objects_loaded++;
 				}
 			}
@@ -319,24 +343,24 @@ bool scene_load(struct Scene* scene, const char* filename, int directory_type)
 		break;
 		case PO_PLAYER:
 		{
-			struct Hashmap* player_data = object->data;
+			struct Parser_Object* player_data = object;
 			vec3 position = { 0.f, 0.f, 0.f };
 			quat rotation = { 0.f, 0.f, 0.f, 1.f };
 			vec3 scale = { 1.f, 1.f, 1.f };
 
-			if(hashmap_value_exists(player_data, "position")) position = hashmap_vec3_get(player_data, "position");
-			if(hashmap_value_exists(player_data, "rotation")) rotation = hashmap_quat_get(player_data, "rotation");
-			if(hashmap_value_exists(player_data, "scale"))    scale    = hashmap_vec3_get(player_data, "scale");
+			if(parser_object_value_exists(player_data, "position")) position = parser_object_vec3_get(player_data, "position");
+			if(parser_object_value_exists(player_data, "rotation")) rotation = parser_object_quat_get(player_data, "rotation");
+			if(parser_object_value_exists(player_data, "scale"))    scale    = parser_object_vec3_get(player_data, "scale");
 
 			struct Player* player = &scene->player;
 			transform_set_position(player, &position);
 			transform_scale(player, &scale);
 			quat_assign(&player->base.transform.rotation, &rotation);
-			transform_update_transmat(player);
+			transform_mark_dirty(player);
 
-			if(hashmap_value_exists(player_data, "camera_clear_color")) player->camera->clear_color = hashmap_vec4_get(player_data, "camera_clear_color");
-			if(hashmap_value_exists(player_data, "player_health"))      player->health              = hashmap_int_get(player_data, "player_health");
-			if(hashmap_value_exists(player_data, "player_key_mask"))    player->key_mask            = hashmap_int_get(player_data, "player_key_mask");
+			if(parser_object_value_exists(player_data, "camera_clear_color")) player->camera->clear_color = parser_object_vec4_get(player_data, "camera_clear_color");
+			if(parser_object_value_exists(player_data, "player_health"))      player->health              = parser_object_int_get(player_data, "player_health");
+			if(parser_object_value_exists(player_data, "player_key_mask"))    player->key_mask            = parser_object_int_get(player_data, "player_key_mask");
 			num_objects_loaded++;
 		}
 		break;
@@ -346,19 +370,23 @@ bool scene_load(struct Scene* scene, const char* filename, int directory_type)
 		}
 	}
 
-	parser_free(parsed_file);
-	fclose(scene_file);
+	if(scene_binary)
+	{
+		scene_binary_free(scene_binary);
+	}
+	else
+	{
+		parser_free(parsed_file);
+		fclose(scene_file);
+	}
 	strncpy(scene->filename, filename, MAX_FILENAME_LEN);
 	if(num_objects_loaded > 0)
 	{
 		scene->init(scene);
 		struct Event_Manager* event_manager = game_state_get()->event_manager;
-		struct Event* scene_loaded_event = event_manager_create_new_event(event_manager);
-		scene_loaded_event->type = EVT_SCENE_LOADED;
-		memset(scene_loaded_event->scene_load.filename, '\0', MAX_FILENAME_LEN);
-		strncpy(scene_loaded_event->scene_load.filename, filename, MAX_FILENAME_LEN);
-		event_manager_send_event(event_manager, scene_loaded_event);
-		event_manager_poll_events(event_manager); // Force polling for events to make sure on_scene_loaded event handlers are called
+		struct Event scene_loaded_event = { .type = EVT_SCENE_LOADED };
+		strncpy(scene_loaded_event.scene_load.filename, filename, MAX_FILENAME_LEN);
+		event_manager_send_event(event_manager, &scene_loaded_event, ED_IMMEDIATE); // Handlers of the loaded entities need to run before the next update
 	}
 
 	return num_objects_loaded > 0 ? true : false;
@@ -423,90 +451,43 @@ bool scene_save(struct Scene* scene, const char* filename, int directory_type)
 	fclose(scene_file);
 
 	struct Event_Manager* event_manager = game_state_get()->event_manager;
-	struct Event* scene_saved_event = event_manager_create_new_event(event_manager);
-	scene_saved_event->type = EVT_SCENE_SAVED;
-	strncpy(scene_saved_event->scene_save.filename, filename, MAX_FILENAME_LEN);
-	event_manager_send_event(event_manager, scene_saved_event);
+	struct Event scene_saved_event = { .type = EVT_SCENE_SAVED };
+	strncpy(scene_saved_event.scene_save.filename, filename, MAX_FILENAME_LEN);
+	event_manager_send_event(event_manager, &scene_saved_event, ED_END_OF_TICK);
 
 	return true;
 }
 
 void scene_write_entity_list(struct Scene* scene, int entity_type, struct Parser* parser)
 {
-	int max_length = 0;
-	size_t stride = 0;
-	struct Entity* entity = NULL;
-
-	switch(entity_type)
+	if(entity_type == ET_CAMERA)
 	{
-	case ET_DEFAULT:
-		max_length = MAX_SCENE_ENTITIES;
-		entity = &scene->entities[0];
-		stride = sizeof(struct Entity);
-		break;
-	case ET_LIGHT:
-		max_length = MAX_SCENE_LIGHTS;
-		entity = &scene->lights[0].base;
-		stride = sizeof(struct Light);
-		break;
-	case ET_STATIC_MESH:
-		max_length = MAX_SCENE_STATIC_MESHES;
-		entity = &scene->static_meshes[0].base;
-		stride = sizeof(struct Static_Mesh);
-		break;
-	case ET_CAMERA:
-		max_length = MAX_SCENE_CAMERAS;
-		entity = &scene->cameras[0].base;
-		stride = sizeof(struct Camera);
-		break;
-	case ET_SOUND_SOURCE:
-		max_length = MAX_SCENE_SOUND_SOURCES;
-		entity = &scene->sound_sources[0].base;
-		stride = sizeof(struct Sound_Source);
-		break;
-	case ET_ENEMY:
-		max_length = MAX_SCENE_ENEMIES;
-		entity = &scene->enemies[0].base;
-		stride = sizeof(struct Enemy);
-		break;
-	case ET_TRIGGER:
-		max_length = MAX_SCENE_TRIGGERS;
-		entity = &scene->triggers[0].base;
-		stride = sizeof(struct Trigger);
-		break;
-	case ET_DOOR:
-		max_length = MAX_SCENE_DOORS;
-		entity = &scene->doors[0].base;
-		stride = sizeof(struct Door);
-		break;
-	case ET_PICKUP:
-		max_length = MAX_SCENE_PICKUPS;
-		entity = &scene->pickups[0].base;
-		stride = sizeof(struct Pickup);
-		break;
-	default: return;
+		for(int i = 0; i < MAX_SCENE_CAMERAS; i++)
+			scene_write_entity(scene, &scene->cameras[i].base, parser);
+		return;
 	}
 
-	size_t count = 0;
-	while(count < max_length)
+	struct Pool* pool = scene_entity_pool_get(scene, entity_type);
+	if(!pool) return;
+
+	for(int i = 0; i < pool->num_live; i++)
+		scene_write_entity(scene, pool_live_at(pool, i), parser);
+}
+
+void scene_write_entity(struct Scene* scene, struct Entity* entity, struct Parser* parser)
+{
+	if((entity->flags & EF_TRANSIENT) || !(entity->flags & EF_ACTIVE))
+		return;
+
+	if(entity->archetype_index != -1 && array_len(entity->transform.children) != 0)
 	{
-		//((char*)entity) += stride * count;
-		
-		if(!(entity->flags & EF_TRANSIENT) && (entity->flags & EF_ACTIVE))
-		{
-			if(entity->archetype_index != -1 && array_len(entity->transform.children) != 0)
-			{
-				scene_write_entity_entry(scene, entity, parser);
-			}
-			else
-			{
-				struct Parser_Object* object = parser_object_new(parser, PO_ENTITY);
-				if(!entity_write(entity, object, true))
-					log_error("scene:save", "Failed to save entity : %s", entity->name);
-			}
-		}
-		count++;
-		((char*)entity) += stride;
+		scene_write_entity_entry(scene, entity, parser);
+	}
+	else
+	{
+		struct Parser_Object* object = parser_object_new(parser, PO_ENTITY);
+		if(!entity_write(entity, object, true))
+			log_error("scene:save", "Failed to save entity : %s", entity->name);
 	}
 }
 
@@ -527,19 +508,34 @@ void scene_destroy(struct Scene* scene)
 	assert(scene);
 	if(scene->cleanup) scene->cleanup(scene);
 
-	for(int i = 0; i < MAX_SCENE_ENTITIES; i++)          scene_entity_base_remove(scene, &scene->entities[i]);
-	for(int i = 0; i < MAX_SCENE_CAMERAS; i++)           scene_camera_remove(scene, &scene->cameras[i]);
-	for(int i = 0; i < MAX_SCENE_LIGHTS; i++)            scene_light_remove(scene, &scene->lights[i]);
-	for(int i = 0; i < MAX_SCENE_STATIC_MESHES; i++)     scene_static_mesh_remove(scene, &scene->static_meshes[i]);
-	for(int i = 0; i < MAX_SCENE_SOUND_SOURCES; i++)     scene_sound_source_remove(scene, &scene->sound_sources[i]);
-	for(int i = 0; i < MAX_SCENE_ENEMIES; i++)           scene_enemy_remove(scene, &scene->enemies[i]);
-	for(int i = 0; i < MAX_SCENE_TRIGGERS; i++)          scene_trigger_remove(scene, &scene->triggers[i]);
-	for(int i = 0; i < MAX_SCENE_DOORS; i++)             scene_door_remove(scene, &scene->doors[i]);
-	for(int i = 0; i < MAX_SCENE_PICKUPS; i++)           scene_pickup_remove(scene, &scene->pickups[i]);
-	for(int i = 0; i < MAX_SCENE_ENTITY_ARCHETYPES; i++) memset(&scene->entity_archetypes[i][0], '\0', MAX_FILENAME_LEN);
+	// Removal frees the slot and moves the last live object into it so walk the live lists backwards
+	for(int i = scene->entities.num_live - 1; i >= 0; i--)      scene_entity_base_remove(scene, pool_live_at(&scene->entities, i));
+	for(int i = 0; i < MAX_SCENE_CAMERAS; i++)                  scene_camera_remove(scene, &scene->cameras[i]);
+	for(int i = scene->lights.num_live - 1; i >= 0; i--)        scene_light_remove(scene, pool_live_at(&scene->lights, i));
+	for(int i = scene->static_meshes.num_live - 1; i >= 0; i--) scene_static_mesh_remove(scene, pool_live_at(&scene->static_meshes, i));
+	for(int i = scene->sound_sources.num_live - 1; i >= 0; i--) scene_sound_source_remove(scene, pool_live_at(&scene->sound_sources, i));
+	for(int i = scene->enemies.num_live - 1; i >= 0; i--)       scene_enemy_remove(scene, pool_live_at(&scene->enemies, i));
+	for(int i = scene->triggers.num_live - 1; i >= 0; i--)      scene_trigger_remove(scene, pool_live_at(&scene->triggers, i));
+	for(int i = scene->doors.num_live - 1; i >= 0; i--)         scene_door_remove(scene, pool_live_at(&scene->doors, i));
+	for(int i = scene->pickups.num_live - 1; i >= 0; i--)       scene_pickup_remove(scene, pool_live_at(&scene->pickups, i));
+	for(int i = 0; i < MAX_SCENE_ENTITY_ARCHETYPES; i++)        memset(&scene->entity_archetypes[i][0], '\0', MAX_FILENAME_LEN);
+	scene_entity_bvh_remove(scene, &scene->player.base);
 	player_destroy(&scene->player);
 	entity_reset(&scene->root_entity, 0);
 	scene->root_entity.flags &= ~EF_ACTIVE;
+	bvh_destroy(&scene->bvh);
+	bv_box_soa_destroy(&scene->static_mesh_bounds);
+
+	// Pending transform updates may still point into the pools that are about to be freed
+	transform_resolve_discard();
+	pool_destroy(&scene->entities);
+	pool_destroy(&scene->lights);
+	pool_destroy(&scene->static_meshes);
+	pool_destroy(&scene->sound_sources);
+	pool_destroy(&scene->enemies);
+	pool_destroy(&scene->triggers);
+	pool_destroy(&scene->doors);
+	pool_destroy(&scene->pickups);
 
 	struct Sound* sound = game_state_get()->sound;
 	sound_source_instance_destroy(sound, scene->background_music_instance);
@@ -550,57 +546,93 @@ void scene_destroy(struct Scene* scene)
 
 void scene_update(struct Scene* scene, float dt)
 {
+	PROFILE_BEGIN("Scene Update");
 	if(game_state_get()->game_mode == GAME_MODE_GAME) 
 	{
 		player_update(&scene->player, dt);
-		for(int i = 0; i < MAX_SCENE_ENEMIES; i++)
+		for(int i = 0; i < scene->enemies.num_live; i++)
 		{
-			if(scene->enemies[i].base.flags & EF_ACTIVE)
-				enemy_update(&scene->enemies[i], scene, dt);
+			struct Enemy* enemy = pool_live_at(&scene->enemies, i);
+			if(enemy->base.flags & EF_ACTIVE)
+				enemy_update(enemy, scene, dt);
 		}
 
-		for(int i = 0; i < MAX_SCENE_DOORS; i++)
+		for(int i = 0; i < scene->doors.num_live; i++)
 		{
-			if(scene->doors[i].base.flags & EF_ACTIVE)
-				door_update(&scene->doors[i], scene, dt);
+			struct Door* door = pool_live_at(&scene->doors, i);
+			if(door->base.flags & EF_ACTIVE)
+				door_update(door, scene, dt);
 		}
 
-		for(int i = 0; i < MAX_SCENE_PICKUPS; i++)
+		for(int i = 0; i < scene->pickups.num_live; i++)
 		{
-			if(scene->pickups[i].base.flags & EF_ACTIVE)
-				pickup_update(&scene->pickups[i], dt);
+			struct Pickup* pickup = pool_live_at(&scene->pickups, i);
+			if(pickup->base.flags & EF_ACTIVE)
+				pickup_update(pickup, dt);
 		}
 	}
+	PROFILE_END();
 }
 
 void scene_update_physics(struct Scene* scene, float fixed_dt)
 {
 	if(game_state_get()->game_mode == GAME_MODE_GAME) 
 	{
+		transform_resolve_all();
 		player_update_physics(&scene->player, scene, fixed_dt);
-		for(int i = 0; i < MAX_SCENE_ENEMIES; i++)
+
+		/* Entities are updated in two phases. The compute phase runs on the job system and only
+		   reads the scene or writes state owned by the entity being updated, transform changes
+		   and events are then applied here on the main thread in pool order so the result is the
+		   same no matter how many workers there are */
+		struct Memory_Arena* arena = memory_frame_arena_get();
+		struct Scene_Physics_Job job;
+		job.scene    = scene;
+		job.fixed_dt = fixed_dt;
+		job.ticks    = (float)platform_ticks_get(); // Sampled once so every enemy sees the same time
+
+		// Only active entities are handed to the jobs, deactivated ones keep their slot but are skipped
+		int num_enemies = 0;
+		job.enemies       = memory_arena_allocate(arena, sizeof(*job.enemies) * scene->enemies.num_live);
+		job.enemy_results = memory_arena_allocate(arena, sizeof(*job.enemy_results) * scene->enemies.num_live);
+		for(int i = 0; i < scene->enemies.num_live; i++)
 		{
-			if(scene->enemies[i].base.flags & EF_ACTIVE)
-				enemy_update_physics(&scene->enemies[i], scene, fixed_dt);
+			struct Enemy* enemy = pool_live_at(&scene->enemies, i);
+			if(enemy->base.flags & EF_ACTIVE) job.enemies[num_enemies++] = enemy;
 		}
 
-		for(int i = 0; i < MAX_SCENE_TRIGGERS; i++)
+		PROFILE_SCOPE("Enemy Physics")
+			job_system_parallel_for(&scene_enemy_physics_job, &job, num_enemies, SCENE_ENEMY_PHYSICS_BATCH_SIZE);
+		for(int i = 0; i < num_enemies; i++)
+			enemy_update_physics_apply(job.enemies[i], &job.enemy_results[i]);
+
+		// Triggers compare derived bounding boxes so pick up whatever moved above
+		transform_resolve_all();
+		int num_triggers = 0;
+		job.triggers            = memory_arena_allocate(arena, sizeof(*job.triggers) * scene->triggers.num_live);
+		job.triggering_entities = memory_arena_allocate(arena, sizeof(*job.triggering_entities) * scene->triggers.num_live);
+		for(int i = 0; i < scene->triggers.num_live; i++)
 		{
-			if(scene->triggers[i].base.flags & EF_ACTIVE)
-				trigger_update_physics(&scene->triggers[i], scene, fixed_dt);
+			struct Trigger* trigger = pool_live_at(&scene->triggers, i);
+			if(trigger->base.flags & EF_ACTIVE) job.triggers[num_triggers++] = trigger;
 		}
+
+		PROFILE_SCOPE("Trigger Physics")
+			job_system_parallel_for(&scene_trigger_physics_job, &job, num_triggers, SCENE_TRIGGER_PHYSICS_BATCH_SIZE);
+		for(int i = 0; i < num_triggers; i++)
+			trigger_update_physics_apply(job.triggers[i], scene, job.triggering_entities[i]);
 	}
 }
 
 void scene_post_update(struct Scene* scene)
 {
 	assert(scene);
+	PROFILE_BEGIN("Scene Post Update");
 	struct Sound* sound = game_state_get()->sound;
 
-	for(int i = 0; i < MAX_SCENE_ENTITIES; i++)
+	for(int i = scene->entities.num_live - 1; i >= 0; i--)
 	{
-		struct Entity* entity = &scene->entities[i];
-		if(!(entity->flags & EF_ACTIVE)) continue;
+		struct Entity* entity = pool_live_at(&scene->entities, i);
 
 		if(entity->flags & EF_MARKED_FOR_DELETION)
 		{
@@ -629,10 +661,9 @@ void scene_post_update(struct Scene* scene)
 		}
 	}
 
-	for(int i = 0; i < MAX_SCENE_SOUND_SOURCES; i++)
+	for(int i = scene->sound_sources.num_live - 1; i >= 0; i--)
 	{
-		struct Sound_Source* sound_source = &scene->sound_sources[i];
-		if(!(sound_source->base.flags & EF_ACTIVE)) continue;
+		struct Sound_Source* sound_source = pool_live_at(&scene->sound_sources, i);
 
 		if(sound_source->base.flags & EF_MARKED_FOR_DELETION)
 		{
@@ -647,10 +678,9 @@ void scene_post_update(struct Scene* scene)
 		}
 	}
 
-	for(int i = 0; i < MAX_SCENE_STATIC_MESHES; i++)
+	for(int i = scene->static_meshes.num_live - 1; i >= 0; i--)
 	{
-		struct Static_Mesh* static_mesh = &scene->static_meshes[i];
-		if(!(static_mesh->base.flags & EF_ACTIVE)) continue;
+		struct Static_Mesh* static_mesh = pool_live_at(&scene->static_meshes, i);
 
 		if(static_mesh->base.flags & EF_MARKED_FOR_DELETION)
 		{
@@ -659,10 +689,9 @@ void scene_post_update(struct Scene* scene)
 		}
 	}
 
-	for(int i = 0; i < MAX_SCENE_LIGHTS; i++)
+	for(int i = scene->lights.num_live - 1; i >= 0; i--)
 	{
-		struct Light* light = &scene->lights[i];
-		if(!(light->base.flags & EF_ACTIVE)) continue;
+		struct Light* light = pool_live_at(&scene->lights, i);
 
 		if(light->base.flags & EF_MARKED_FOR_DELETION)
 		{
@@ -673,10 +702,9 @@ void scene_post_update(struct Scene* scene)
 		if(light->base.transform.is_modified) light->base.transform.is_modified = false;
 	}
 
-	for(int i = 0; i < MAX_SCENE_ENEMIES; i++)
+	for(int i = scene->enemies.num_live - 1; i >= 0; i--)
 	{
-		struct Enemy* enemy = &scene->enemies[i];
-		if(!(enemy->base.flags & EF_ACTIVE)) continue;
+		struct Enemy* enemy = pool_live_at(&scene->enemies, i);
 
 		if(enemy->base.flags & EF_MARKED_FOR_DELETION)
 		{
@@ -686,10 +714,9 @@ void scene_post_update(struct Scene* scene)
 
 	}
 
-	for(int i = 0; i < MAX_SCENE_TRIGGERS; i++)
+	for(int i = scene->triggers.num_live - 1; i >= 0; i--)
 	{
-		struct Trigger* trigger = &scene->triggers[i];
-		if(!(trigger->base.flags & EF_ACTIVE)) continue;
+		struct Trigger* trigger = pool_live_at(&scene->triggers, i);
 
 		if(trigger->base.flags & EF_MARKED_FOR_DELETION)
 		{
@@ -698,10 +725,9 @@ void scene_post_update(struct Scene* scene)
 		}
 	}
 
-	for(int i = 0; i < MAX_SCENE_DOORS; i++)
+	for(int i = scene->doors.num_live - 1; i >= 0; i--)
 	{
-		struct Door* door = &scene->doors[i];
-		if(!(door->base.flags & EF_ACTIVE)) continue;
+		struct Door* door = pool_live_at(&scene->doors, i);
 
 		if(door->base.flags & EF_MARKED_FOR_DELETION)
 		{
@@ -710,10 +736,9 @@ void scene_post_update(struct Scene* scene)
 		}
 	}
 
-	for(int i = 0; i < MAX_SCENE_PICKUPS; i++)
+	for(int i = scene->pickups.num_live - 1; i >= 0; i--)
 	{
-		struct Pickup* pickup = &scene->pickups[i];
-		if(!(pickup->base.flags & EF_ACTIVE)) continue;
+		struct Pickup* pickup = pool_live_at(&scene->pickups, i);
 
 		if(pickup->base.flags & EF_MARKED_FOR_DELETION)
 		{
@@ -726,34 +751,27 @@ void scene_post_update(struct Scene* scene)
 	{
 		scene->player.base.transform.is_modified = false;
 	}
+	PROFILE_END();
 }
 
 struct Entity* scene_entity_create(struct Scene* scene, const char* name, struct Entity* parent)
 {
 	assert(scene);
 
-	struct Entity* new_entity = NULL;
-	for(int i = 0; i < MAX_SCENE_ENTITIES; i++)
-	{
-		struct Entity* entity = &scene->entities[i];
-		if(!(entity->flags & EF_ACTIVE))
-		{
-			new_entity = entity;
-			break;
-		}
-	}
-
+	int index = -1;
+	struct Entity* new_entity = pool_alloc(&scene->entities, &index);
 	if(new_entity)
 	{
 		if(!parent)
 			parent = &scene->root_entity;
-		entity_reset(new_entity, new_entity->id);
+		entity_reset(new_entity, index);
 		entity_init(new_entity, name, parent);
 		new_entity->flags |= EF_ACTIVE;
+		scene_entity_bvh_insert(scene, new_entity);
 	}
 	else
 	{
-		log_error("scene:entity_create", "Max entity limit reached!");
+		log_error("scene:entity_create", "Failed to allocate new entity");
 	}
 
 	return new_entity;
@@ -762,28 +780,20 @@ struct Entity* scene_entity_create(struct Scene* scene, const char* name, struct
 struct Light* scene_light_create(struct Scene* scene, const char* name, struct Entity* parent, int light_type)
 {
 	assert(scene);
-	struct Light* new_light = NULL;
-	for(int i = 0; i < MAX_SCENE_LIGHTS; i++)
-	{
-		struct Light* light = &scene->lights[i];
-		if(!(light->base.flags & EF_ACTIVE))
-		{
-			new_light = light;
-			break;
-		}
-	}
-
+	int index = -1;
+	struct Light* new_light = pool_alloc(&scene->lights, &index);
 	if(new_light)
 	{
-		entity_reset(new_light, new_light->base.id);
+		entity_reset(new_light, index);
 		entity_init(&new_light->base, name, parent ? parent : &scene->root_entity);
 		new_light->base.type = ET_LIGHT;
 		new_light->base.flags |= EF_ACTIVE;
+		scene_entity_bvh_insert(scene, &new_light->base);
 		light_init(new_light, light_type);
 	}
 	else
 	{
-		log_error("scene:light_create", "Max light limit reached!");
+		log_error("scene:light_create", "Failed to allocate new light");
 	}
 
 	return new_light;
@@ -809,6 +819,7 @@ struct Camera* scene_camera_create(struct Scene* scene, const char* name, struct
 		entity_init(&new_camera->base, name, parent ? parent : &scene->root_entity);
 		new_camera->base.type = ET_CAMERA;
 		new_camera->base.flags |= EF_ACTIVE;
+		scene_entity_bvh_insert(scene, &new_camera->base);
 		camera_init(new_camera, width, height);
 	}
 	else
@@ -822,23 +833,21 @@ struct Camera* scene_camera_create(struct Scene* scene, const char* name, struct
 struct Static_Mesh* scene_static_mesh_create(struct Scene* scene, const char* name, struct Entity* parent, const char* geometry_name, int material_type)
 {
 	assert(scene);
-	struct Static_Mesh* new_static_mesh = NULL;
-	for(int i = 0; i < MAX_SCENE_STATIC_MESHES; i++)
+	int index = -1;
+	struct Static_Mesh* new_static_mesh = pool_alloc(&scene->static_meshes, &index);
+	if(new_static_mesh && !bv_box_soa_reserve(&scene->static_mesh_bounds, pool_capacity(&scene->static_meshes)))
 	{
-		struct Static_Mesh* static_mesh = &scene->static_meshes[i];
-		if(!(static_mesh->base.flags & EF_ACTIVE))
-		{
-			new_static_mesh = static_mesh;
-			break;
-		}
+		pool_free(&scene->static_meshes, index);
+		new_static_mesh = NULL;
 	}
 
 	if(new_static_mesh)
 	{
-		entity_reset(new_static_mesh, new_static_mesh->base.id);
+		entity_reset(new_static_mesh, index);
 		entity_init(&new_static_mesh->base, name, parent ? parent : &scene->root_entity);
 		new_static_mesh->base.type = ET_STATIC_MESH;
 		new_static_mesh->base.flags |= EF_ACTIVE;
+		scene_entity_bvh_insert(scene, &new_static_mesh->base);
 		model_init(&new_static_mesh->model, new_static_mesh, geometry_name, material_type);
 		vec3_assign(&new_static_mesh->base.bounding_box.min, &geom_get(new_static_mesh->model.geometry_index)->bounding_box.min);
 		vec3_assign(&new_static_mesh->base.bounding_box.max, &geom_get(new_static_mesh->model.geometry_index)->bounding_box.max);
@@ -846,7 +855,7 @@ struct Static_Mesh* scene_static_mesh_create(struct Scene* scene, const char* na
 	}
 	else
 	{
-		log_error("scene:static_mesh_create", "Max static mesh limit reached!");
+		log_error("scene:static_mesh_create", "Failed to allocate new static mesh");
 	}
 
 	return new_static_mesh;
@@ -856,22 +865,14 @@ struct Sound_Source* scene_sound_source_create(struct Scene* scene, const char*
 {
 	assert(scene && filename);
 	struct Sound* sound = game_state_get()->sound;
-	struct Sound_Source* new_sound_source = NULL;
-	for(int i = 0; i < MAX_SCENE_SOUND_SOURCES; i++)
-	{
-		struct Sound_Source* sound_source = &scene->sound_sources[i];
-		if(!(sound_source->base.flags & EF_ACTIVE))
-		{
-			new_sound_source = sound_source;
-			break;
-		}
-	}
-
+	int index = -1;
+	struct Sound_Source* new_sound_source = pool_alloc(&scene->sound_sources, &index);
 	if(new_sound_source)
 	{
-		entity_reset(new_sound_source, new_sound_source->base.id);
+		entity_reset(new_sound_source, index);
 		entity_init(&new_sound_source->base, name, parent ? parent : &scene->root_entity);
 		new_sound_source->base.flags |= EF_ACTIVE;
+		scene_entity_bvh_insert(scene, &new_sound_source->base);
 		new_sound_source->base.type = ET_SOUND_SOURCE;
 		struct Entity* entity = &new_sound_source->base;
 
@@ -909,7 +910,7 @@ struct Sound_Source* scene_sound_source_create(struct Scene* scene, const char*
 	}
 	else
 	{
-		log_error("scene:sound_source_create", "Max sound source limit reached!");
+		log_error("scene:sound_source_create", "Failed to allocate new sound source");
 	}
 
 	return new_sound_source;
@@ -918,27 +919,19 @@ struct Sound_Source* scene_sound_source_create(struct Scene* scene, const char*
 struct Enemy* scene_enemy_create(struct Scene* scene, const char* name, struct Entity* parent, int type)
 {
 	assert(scene);
-	struct Enemy* new_enemy = NULL;
-	for(int i = 0; i < MAX_SCENE_ENEMIES; i++)
-	{
-		struct Enemy* enemy = &scene->enemies[i];
-		if(!(enemy->base.flags & EF_ACTIVE))
-		{
-			new_enemy = enemy;
-			break;
-		}
-	}
-
+	int index = -1;
+	struct Enemy* new_enemy = pool_alloc(&scene->enemies, &index);
 	if(new_enemy)
 	{
-		entity_reset(new_enemy, new_enemy->base.id);
+		entity_reset(new_enemy, index);
 		entity_init(&new_enemy->base, name, parent ? parent : &scene->root_entity);
 		new_enemy->base.flags |= EF_ACTIVE;
+		scene_entity_bvh_insert(scene, &new_enemy->base);
 		enemy_init(new_enemy, type);
 	}
 	else
 	{
-		log_error("scene:enemy_create", "Max enemy limit reached!");
+		log_error("scene:enemy_create", "Failed to allocate new enemy");
 	}
 
 	return new_enemy;
@@ -947,27 +940,19 @@ struct Enemy* scene_enemy_create(struct Scene* scene, const char* name, struct E
 struct Door* scene_door_create(struct Scene* scene, const char* name, struct Entity* parent, int mask)
 {
 	assert(scene);
-	struct Door* new_door = NULL;
-	for(int i = 0; i < MAX_SCENE_DOORS; i++)
-	{
-		struct Door* door = &scene->doors[i];
-		if(!(door->base.flags & EF_ACTIVE))
-		{
-			new_door = door;
-			break;
-		}
-	}
-
+	int index = -1;
+	struct Door* new_door = pool_alloc(&scene->doors, &index);
 	if(new_door)
 	{
-		entity_reset(new_door, new_door->base.id);
+		entity_reset(new_door, index);
 		entity_init(&new_door->base, name, parent ? parent : &scene->root_entity);
 		new_door->base.flags |= EF_ACTIVE;
+		scene_entity_bvh_insert(scene, &new_door->base);
 		door_init(new_door, mask);
 	}
 	else
 	{
-		log_error("scene:door_create", "Max door limit reached!");
+		log_error("scene:door_create", "Failed to allocate new door");
 	}
 
 	return new_door;
@@ -976,27 +961,19 @@ struct Door* scene_door_create(struct Scene* scene, const char* name, struct Ent
 struct Pickup* scene_pickup_create(struct Scene* scene, const char* name, struct Entity* parent, int type)
 {
 	assert(scene);
-	struct Pickup* new_pickup = NULL;
-	for(int i = 0; i < MAX_SCENE_PICKUPS; i++)
-	{
-		struct Pickup* pickup = &scene->pickups[i];
-		if(!(pickup->base.flags & EF_ACTIVE))
-		{
-			new_pickup = pickup;
-			break;
-		}
-	}
-
+	int index = -1;
+	struct Pickup* new_pickup = pool_alloc(&scene->pickups, &index);
 	if(new_pickup)
 	{
-		entity_reset(new_pickup, new_pickup->base.id);
+		entity_reset(new_pickup, index);
 		entity_init(&new_pickup->base, name, parent ? parent : &scene->root_entity);
 		new_pickup->base.flags |= EF_ACTIVE;
+		scene_entity_bvh_insert(scene, &new_pickup->base);
 		pickup_init(new_pickup, type);
 	}
 	else
 	{
-		log_error("scene:pickup_create", "Max pickup limit reached!");
+		log_error("scene:pickup_create", "Failed to allocate new pickup");
 	}
 
 	return new_pickup;
@@ -1005,27 +982,19 @@ struct Pickup* scene_pickup_create(struct Scene* scene, const char* name, struct
 struct Trigger* scene_trigger_create(struct Scene* scene, const char* name, struct Entity* parent, int type, int mask)
 {
 	assert(scene);
-	struct Trigger* new_trigger = NULL;
-	for(int i = 0; i < MAX_SCENE_TRIGGERS; i++)
-	{
-		struct Trigger* trigger = &scene->triggers[i];
-		if(!(trigger->base.flags & EF_ACTIVE))
-		{
-			new_trigger = trigger;
-			break;
-		}
-	}
-
+	int index = -1;
+	struct Trigger* new_trigger = pool_alloc(&scene->triggers, &index);
 	if(new_trigger)
 	{
-		entity_reset(new_trigger, new_trigger->base.id);
+		entity_reset(new_trigger, index);
 		entity_init(&new_trigger->base, name, parent ? parent : &scene->root_entity);
 		new_trigger->base.flags |= EF_ACTIVE;
+		scene_entity_bvh_insert(scene, &new_trigger->base);
 		trigger_init(new_trigger, type, mask);
 	}
 	else
 	{
-		log_error("scene:trigger_create", "Max trigger limit reached!");
+		log_error("scene:trigger_create", "Failed to allocate new trigger");
 	}
 
 	return new_trigger;
@@ -1035,11 +1004,17 @@ void scene_entity_base_remove(struct Scene* scene, struct Entity* entity)
 {
 	assert(scene && entity && entity->id >= 0);
 
-	if(!(entity->flags & EF_ACTIVE)) return;
+	scene_entity_bvh_remove(scene, entity);
+
+	/* Deactivated entities still own their slot and transform so pooled entities are released
+	   whenever their slot is live, only entities living directly inside the scene rely on the flag */
+	struct Pool* pool = scene_entity_pool_get(scene, entity->type);
+	if(pool ? !pool_is_live(pool, entity->id) : !(entity->flags & EF_ACTIVE)) return;
 
 	transform_destroy(entity);
 	entity->flags = EF_NONE;
 	memset(entity->name, '\0', MAX_ENTITY_NAME_LEN);
+	if(pool) pool_free(pool, entity->id);
 }
 
 void scene_light_remove(struct Scene* scene, struct Light* light)
@@ -1106,11 +1081,12 @@ struct Entity* scene_entity_find(struct Scene* scene, const char* name)
 	assert(scene && name);
 	struct Entity* entity = NULL;
 
-	for(int i = 0; i < MAX_SCENE_ENTITIES; i++)
+	for(int i = 0; i < scene->entities.num_live; i++)
 	{
-		if(strncmp(name, scene->entities[i].name, MAX_ENTITY_NAME_LEN) == 0)
+		struct Entity* current = pool_live_at(&scene->entities, i);
+		if(strncmp(name, current->name, MAX_ENTITY_NAME_LEN) == 0)
 		{
-			entity = &scene->entities[i];
+			entity = current;
 			break;
 		}
 	}
@@ -1123,11 +1099,12 @@ struct Light* scene_light_find(struct Scene* scene, const char* name)
 	assert(scene && name);
 	struct Light* light = NULL;
 
-	for(int i = 0; i < MAX_SCENE_LIGHTS; i++)
+	for(int i = 0; i < scene->lights.num_live; i++)
 	{
-		if(strncmp(name, scene->lights[i].base.name, MAX_ENTITY_NAME_LEN) == 0)
+		struct Light* current = pool_live_at(&scene->lights, i);
+		if(strncmp(name, current->base.name, MAX_ENTITY_NAME_LEN) == 0)
 		{
-			light = &scene->lights[i];
+			light = current;
 			break;
 		}
 	}
@@ -1157,11 +1134,12 @@ struct Static_Mesh* scene_static_mesh_find(struct Scene* scene, const char* name
 	assert(scene && name);
 	struct Static_Mesh* static_mesh = NULL;
 
-	for(int i = 0; i < MAX_SCENE_STATIC_MESHES; i++)
+	for(int i = 0; i < scene->static_meshes.num_live; i++)
 	{
-		if(strncmp(name, scene->static_meshes[i].base.name, MAX_ENTITY_NAME_LEN) == 0)
+		struct Static_Mesh* current = pool_live_at(&scene->static_meshes, i);
+		if(strncmp(name, current->base.name, MAX_ENTITY_NAME_LEN) == 0)
 		{
-			static_mesh = &scene->static_meshes[i];
+			static_mesh = current;
 			break;
 		}
 	}
@@ -1174,11 +1152,12 @@ struct Sound_Source* scene_sound_source_find(struct Scene* scene, const char* na
 	assert(scene && name);
 	struct Sound_Source* sound_source = NULL;
 
-	for(int i = 0; i < MAX_SCENE_SOUND_SOURCES; i++)
+	for(int i = 0; i < scene->sound_sources.num_live; i++)
 	{
-		if(strncmp(name, scene->sound_sources[i].base.name, MAX_ENTITY_NAME_LEN) == 0)
+		struct Sound_Source* current = pool_live_at(&scene->sound_sources, i);
+		if(strncmp(name, current->base.name, MAX_ENTITY_NAME_LEN) == 0)
 		{
-			sound_source = &scene->sound_sources[i];
+			sound_source = current;
 			break;
 		}
 	}
@@ -1191,11 +1170,12 @@ struct Enemy* scene_enemy_find(struct Scene* scene, const char* name)
 	assert(scene && name);
 	struct Enemy* enemy = NULL;
 
-	for(int i = 0; i < MAX_SCENE_ENEMIES; i++)
+	for(int i = 0; i < scene->enemies.num_live; i++)
 	{
-		if(strncmp(name, scene->enemies[i].base.name, MAX_ENTITY_NAME_LEN) == 0)
+		struct Enemy* current = pool_live_at(&scene->enemies, i);
+		if(strncmp(name, current->base.name, MAX_ENTITY_NAME_LEN) == 0)
 		{
-			enemy = &scene->enemies[i];
+			enemy = current;
 			break;
 		}
 	}
@@ -1208,11 +1188,12 @@ struct Door* scene_door_find(struct Scene* scene, const char* name)
 	assert(scene && name);
 	struct Door* door = NULL;
 
-	for(int i = 0; i < MAX_SCENE_DOORS; i++)
+	for(int i = 0; i < scene->doors.num_live; i++)
 	{
-		if(strncmp(name, scene->doors[i].base.name, MAX_ENTITY_NAME_LEN) == 0)
+		struct Door* current = pool_live_at(&scene->doors, i);
+		if(strncmp(name, current->base.name, MAX_ENTITY_NAME_LEN) == 0)
 		{
-			door = &scene->doors[i];
+			door = current;
 			break;
 		}
 	}
@@ -1225,11 +1206,12 @@ struct Pickup* scene_pickup_find(struct Scene* scene, const char* name)
 	assert(scene && name);
 	struct Pickup* pickup = NULL;
 
-	for(int i = 0; i < MAX_SCENE_PICKUPS; i++)
+	for(int i = 0; i < scene->pickups.num_live; i++)
 	{
-		if(strncmp(name, scene->pickups[i].base.name, MAX_ENTITY_NAME_LEN) == 0)
+		struct Pickup* current = pool_live_at(&scene->pickups, i);
+		if(strncmp(name, current->base.name, MAX_ENTITY_NAME_LEN) == 0)
 		{
-			pickup = &scene->pickups[i];
+			pickup = current;
 			break;
 		}
 	}
@@ -1242,11 +1224,12 @@ struct Trigger* scene_trigger_find(struct Scene* scene, const char* name)
 	assert(scene && name);
 	struct Trigger* trigger = NULL;
 
-	for(int i = 0; i < MAX_SCENE_TRIGGERS; i++)
+	for(int i = 0; i < scene->triggers.num_live; i++)
 	{
-		if(strncmp(name, scene->triggers[i].base.name, MAX_ENTITY_NAME_LEN) == 0)
+		struct Trigger* current = pool_live_at(&scene->triggers, i);
+		if(strncmp(name, current->base.name, MAX_ENTITY_NAME_LEN) == 0)
 		{
-			trigger = &scene->triggers[i];
+			trigger = current;
 			break;
 		}
 	}
@@ -1294,6 +1277,21 @@ void scene_entity_parent_reset(struct Scene* scene, struct Entity* entity)
 	transform_parent_set(entity, &scene->root_entity, true);
 }
 
+void scene_geometry_changed(struct Scene* scene, int geometry_index, const struct Bounding_Box* old_bounding_box)
+{
+	assert(scene && old_bounding_box);
+	for(int i = 0; i < scene->static_meshes.num_live; i++)
+	{
+		struct Static_Mesh* mesh = pool_live_at(&scene->static_meshes, i);
+		if(mesh->model.geometry_index != geometry_index) continue;
+
+		// Bounds that were loaded from the entity file are left alone
+		struct Bounding_Box* box = &mesh->base.bounding_box;
+		if(memcmp(&box->min, &old_bounding_box->min, sizeof(vec3)) == 0 && memcmp(&box->max, &old_bounding_box->max, sizeof(vec3)) == 0)
+			entity_bounding_box_reset(&mesh->base, true);
+	}
+}
+
 void scene_entity_parent_set(struct Scene* scene, struct Entity* entity, struct Entity* parent)
 {
 	assert(scene && entity && parent && entity != parent);
@@ -1304,211 +1302,164 @@ void scene_ray_intersect(struct Scene* scene, struct Ray* ray, struct Raycast_Re
 {
 	assert(out_results);
 
-	memset(&out_results[0], '\0', sizeof(struct Entity*) * MAX_RAYCAST_ENTITIES_INTERSECT);
-	out_results->num_entities_intersected = 0;
-
-	for(int i = 0; i < ET_MAX; i++)
-	{
-		int max_length = 0;
-		size_t stride = 0;
-		struct Entity* entity = NULL;
+	memset(out_results, '\0', sizeof(*out_results));
+	transform_resolve_all();
+	struct Scene_Raycast_Query query = { .results = out_results, .ray_mask = ray_mask };
+	bvh_ray_query(&scene->bvh, ray, &scene_ray_intersect_visit, &query);
+}
 
-		switch(i)
-		{
-		case ET_DEFAULT:
-			if(!(ray_mask & ERM_DEFAULT)) continue;
-			max_length = MAX_SCENE_ENTITIES;
-			entity = &scene->entities[0];
-			stride = sizeof(struct Entity);
-			break;
-		case ET_LIGHT:
-			if(!(ray_mask & ERM_LIGHT)) continue;
-			max_length = MAX_SCENE_LIGHTS;
-			entity = &scene->lights[0].base;
-			stride = sizeof(struct Light);
-			break;
-		case ET_STATIC_MESH:
-			if(!(ray_mask & ERM_STATIC_MESH)) continue;
-			max_length = MAX_SCENE_STATIC_MESHES;
-			entity = &scene->static_meshes[0].base;
-			stride = sizeof(struct Static_Mesh);
-			break;
-		case ET_CAMERA:
-			if(!(ray_mask & ERM_CAMERA)) continue;
-			max_length = MAX_SCENE_CAMERAS;
-			entity = &scene->cameras[0].base;
-			stride = sizeof(struct Camera);
-			break;
-		case ET_SOUND_SOURCE:
-			if(!(ray_mask & ERM_SOUND_SOURCE)) continue;
-			max_length = MAX_SCENE_SOUND_SOURCES;
-			entity = &scene->sound_sources[0].base;
-			stride = sizeof(struct Sound_Source);
-			break;
-		case ET_PLAYER:
-			if(!(ray_mask & ERM_PLAYER)) continue;
-			max_length = 1;
-			entity = &scene->player;
-			stride = sizeof(struct Player);
-			break;
-		case ET_ENEMY:
-			if(!(ray_mask & ERM_ENEMY)) continue;
-			max_length = MAX_SCENE_ENEMIES;
-			entity = &scene->enemies[0].base;
-			stride = sizeof(struct Enemy);
-			break;
-		case ET_TRIGGER:
-			if(!(ray_mask & ERM_TRIGGER)) continue;
-			max_length = MAX_SCENE_TRIGGERS;
-			entity = &scene->triggers[0].base;
-			stride = sizeof(struct Trigger);
-			break;
-		case ET_DOOR:
-			if(!(ray_mask & ERM_DOOR)) continue;
-			max_length = MAX_SCENE_DOORS;
-			entity = &scene->doors[0].base;
-			stride = sizeof(struct Door);
-			break;
-		case ET_PICKUP:
-			if(!(ray_mask & ERM_PICKUP)) continue;
-			max_length = MAX_SCENE_PICKUPS;
-			entity = &scene->pickups[0].base;
-			stride = sizeof(struct Pickup);
-			break;
-		default: continue;
-		}
+struct Entity* scene_ray_intersect_closest(struct Scene* scene, struct Ray* ray, int ray_mask)
+{
+	struct Scene_Closest_Query query = { .closest = NULL, .distance = 0.f, .ray_mask = ray_mask };
+	transform_resolve_all();
+	bvh_ray_query(&scene->bvh, ray, &scene_ray_intersect_closest_visit, &query);
+	return query.closest;
+}
 
-		size_t count = 0;
-		while(count < max_length)
-		{
-			if(entity->flags & EF_ACTIVE && !(entity->flags & EF_IGNORE_RAYCAST))
-			{
-				int result = bv_intersect_bounding_box_ray(&entity->derived_bounding_box, ray);
-				if(result == IT_INTERSECT || result == IT_INSIDE)
-				{
-					out_results->entities_intersected[out_results->num_entities_intersected] = entity;
-					out_results->num_entities_intersected++;
-					if(out_results->num_entities_intersected >= MAX_RAYCAST_ENTITIES_INTERSECT)
-					{
-						//log_warning("Reached Max raycast limit");
-						return;
-					}
-				}
-			}
+float scene_ray_intersect_visit(struct Entity* entity, struct Ray* ray, void* user_data)
+{
+	struct Scene_Raycast_Query* query = (struct Scene_Raycast_Query*)user_data;
+	struct Raycast_Result* results = query->results;
+	if(!scene_entity_raycastable(entity, query->ray_mask))
+		return INFINITY;
+
+	int result = bv_intersect_bounding_box_ray(&entity->derived_bounding_box, ray);
+	if(result != IT_INTERSECT && result != IT_INSIDE)
+		return INFINITY;
+
+	// Insert sorted by distance, once the results are full only nearer hits can replace the farthest one
+	float distance = bv_distance_ray_bounding_box(ray, &entity->derived_bounding_box);
+	int count = results->num_entities_intersected;
+	if(count == MAX_RAYCAST_ENTITIES_INTERSECT && !(distance < results->entity_distances[count - 1]))
+		return results->entity_distances[count - 1];
+
+	int index = count < MAX_RAYCAST_ENTITIES_INTERSECT ? count : MAX_RAYCAST_ENTITIES_INTERSECT - 1;
+	while(index > 0 && results->entity_distances[index - 1] > distance)
+	{
+		results->entities_intersected[index] = results->entities_intersected[index - 1];
+		results->entity_distances[index]     = results->entity_distances[index - 1];
+		index--;
+	}
+	results->entities_intersected[index] = entity;
+	results->entity_distances[index]     = distance;
+	if(count < MAX_RAYCAST_ENTITIES_INTERSECT)
+		results->num_entities_intersected++;
+
+	return results->num_entities_intersected == MAX_RAYCAST_ENTITIES_INTERSECT ? results->entity_distances[MAX_RAYCAST_ENTITIES_INTERSECT - 1] : INFINITY;
+}
 
-			count++;
-			((char*)entity) += stride;
-		}
-	}
+float scene_ray_intersect_closest_visit(struct Entity* entity, struct Ray* ray, void* user_data)
+{
+	struct Scene_Closest_Query* query = (struct Scene_Closest_Query*)user_data;
+	float limit = query->closest ? query->distance : INFINITY;
+	if(!scene_entity_raycastable(entity, query->ray_mask))
+		return limit;
+
+	float distance = bv_distance_ray_bounding_box(ray, &entity->derived_bounding_box);
+	if(distance == INFINITY || distance < 0.f)
+		return limit;
+
+	bool assign = false;
+	if(query->closest == NULL)
+		assign = true;
+	else if(distance > query->distance &&
+			bv_intersect_bounding_box_ray(&entity->derived_bounding_box, ray) == IT_INSIDE &&
+			bv_intersect_bounding_boxes(&entity->derived_bounding_box, &query->closest->derived_bounding_box) != IT_INSIDE)
+		assign = true;
+	else if(distance < query->distance)
+		assign = true;
+
+	if(assign)
+	{
+		query->distance = distance;
+		query->closest  = entity;
+	}
+
+	/* Boxes that contain the ray origin, which are the only ones that can win while being
+	   farther away, sit under nodes that also contain the origin and are never skipped */
+	return query->distance;
 }
 
-struct Entity* scene_ray_intersect_closest(struct Scene* scene, struct Ray* ray, int ray_mask)
+bool scene_entity_raycastable(struct Entity* entity, int ray_mask)
 {
-	struct Entity* closest = NULL;
-	float current_closest = 0.f;
-	for(int i = 0; i < ET_MAX; i++)
+	if(!(entity->flags & EF_ACTIVE) || (entity->flags & EF_IGNORE_RAYCAST))
+		return false;
+
+	switch(entity->type)
 	{
-		int max_length = 0;
-		size_t stride = 0;
-		struct Entity* entity = NULL;
+	case ET_DEFAULT:      return ray_mask & ERM_DEFAULT;
+	case ET_LIGHT:        return ray_mask & ERM_LIGHT;
+	case ET_STATIC_MESH:  return ray_mask & ERM_STATIC_MESH;
+	case ET_CAMERA:       return ray_mask & ERM_CAMERA;
+	case ET_SOUND_SOURCE: return ray_mask & ERM_SOUND_SOURCE;
+	case ET_PLAYER:       return ray_mask & ERM_PLAYER;
+	case ET_ENEMY:        return ray_mask & ERM_ENEMY;
+	case ET_TRIGGER:      return ray_mask & ERM_TRIGGER;
+	case ET_DOOR:         return ray_mask & ERM_DOOR;
+	case ET_PICKUP:       return ray_mask & ERM_PICKUP;
+	default:              return false;
+	}
+}
 
-		switch(i)
-		{
-		case ET_DEFAULT:
-			if(!(ray_mask & ERM_DEFAULT)) continue;
-			max_length = MAX_SCENE_ENTITIES;
-			entity = &scene->entities[0];
-			stride = sizeof(struct Entity);
-			break;
-		case ET_LIGHT:
-			if(!(ray_mask & ERM_LIGHT)) continue;
-			max_length = MAX_SCENE_LIGHTS;
-			entity = &scene->lights[0].base;
-			stride = sizeof(struct Light);
-			break;
-		case ET_STATIC_MESH:
-			if(!(ray_mask & ERM_STATIC_MESH)) continue;
-			max_length = MAX_SCENE_STATIC_MESHES;
-			entity = &scene->static_meshes[0].base;
-			stride = sizeof(struct Static_Mesh);
-			break;
-		case ET_CAMERA:
-			if(!(ray_mask & ERM_CAMERA)) continue;
-			max_length = MAX_SCENE_CAMERAS;
-			entity = &scene->cameras[0].base;
-			stride = sizeof(struct Camera);
-			break;
-		case ET_SOUND_SOURCE:
-			if(!(ray_mask & ERM_SOUND_SOURCE)) continue;
-			max_length = MAX_SCENE_SOUND_SOURCES;
-			entity = &scene->sound_sources[0].base;
-			stride = sizeof(struct Sound_Source);
-			break;
-		case ET_PLAYER:
-			if(!(ray_mask & ERM_PLAYER)) continue;
-			max_length = 1;
-			entity = &scene->player;
-			stride = sizeof(struct Player);
-			break;
-		case ET_ENEMY:
-			if(!(ray_mask & ERM_ENEMY)) continue;
-			max_length = MAX_SCENE_ENEMIES;
-			entity = &scene->enemies[0].base;
-			stride = sizeof(struct Enemy);
-			break;
-		case ET_TRIGGER:
-			if(!(ray_mask & ERM_TRIGGER)) continue;
-			max_length = MAX_SCENE_TRIGGERS;
-			entity = &scene->triggers[0].base;
-			stride = sizeof(struct Trigger);
-			break;
-		case ET_DOOR:
-			if(!(ray_mask & ERM_DOOR)) continue;
-			max_length = MAX_SCENE_DOORS;
-			entity = &scene->doors[0].base;
-			stride = sizeof(struct Door);
-			break;
-		case ET_PICKUP:
-			if(!(ray_mask & ERM_PICKUP)) continue;
-			max_length = MAX_SCENE_PICKUPS;
-			entity = &scene->pickups[0].base;
-			stride = sizeof(struct Pickup);
-			break;
-		default: continue;
-		}
+void scene_entity_bvh_insert(struct Scene* scene, struct Entity* entity)
+{
+	if(entity->bvh_proxy != BVH_NULL_NODE) return;
+	entity->bvh_proxy = bvh_proxy_create(&scene->bvh, &entity->derived_bounding_box, entity);
+}
 
-		size_t count = 0;
-		while(count < max_length)
-		{
-			if(entity->flags & EF_ACTIVE && !(entity->flags & EF_IGNORE_RAYCAST))
-			{
-				float distance = bv_distance_ray_bounding_box(ray, &entity->derived_bounding_box);
-				if(distance != INFINITY && distance >= 0.f)
-				{
-					bool assign = false;
-					if(closest == NULL)
-						assign = true;
-					else if(distance > current_closest&&
-							bv_intersect_bounding_box_ray(&entity->derived_bounding_box, ray) == IT_INSIDE &&
-							bv_intersect_bounding_boxes(&entity->derived_bounding_box, &closest->derived_bounding_box) != IT_INSIDE)
-						assign = true;
-					else if(distance < current_closest)
-						assign = true;
-
-					if(assign)
-					{
-						current_closest = distance;
-						closest = entity;
-					}
-				}
-			}
+void scene_entity_bvh_remove(struct Scene* scene, struct Entity* entity)
+{
+	if(entity->bvh_proxy == BVH_NULL_NODE) return;
+	bvh_proxy_destroy(&scene->bvh, entity->bvh_proxy);
+	entity->bvh_proxy = BVH_NULL_NODE;
+}
 
-			count++;
-			((char*)entity) += stride;
-		}
+struct Pool* scene_entity_pool_get(struct Scene* scene, int entity_type)
+{
+	switch(entity_type)
+	{
+	case ET_DEFAULT:      return &scene->entities;
+	case ET_LIGHT:        return &scene->lights;
+	case ET_STATIC_MESH:  return &scene->static_meshes;
+	case ET_SOUND_SOURCE: return &scene->sound_sources;
+	case ET_ENEMY:        return &scene->enemies;
+	case ET_TRIGGER:      return &scene->triggers;
+	case ET_DOOR:         return &scene->doors;
+	case ET_PICKUP:       return &scene->pickups;
+	default:              return NULL; // Root, player and cameras live directly inside the scene
 	}
+}
 
-	return closest;
+struct Entity_Handle scene_entity_handle_get(struct Scene* scene, struct Entity* entity)
+{
+	assert(scene);
+	struct Entity_Handle handle = { .type = ET_NONE, .index = -1, .generation = 0 };
+	if(!entity || !(entity->flags & EF_ACTIVE)) return handle;
+
+	handle.type  = entity->type;
+	handle.index = entity->id;
+	struct Pool* pool = scene_entity_pool_get(scene, entity->type);
+	if(pool) handle.generation = pool_generation(pool, entity->id);
+	return handle;
+}
+
+struct Entity* scene_entity_handle_resolve(struct Scene* scene, struct Entity_Handle handle)
+{
+	assert(scene);
+	if(handle.index == -1) return NULL;
+
+	struct Entity* entity = NULL;
+	struct Pool* pool = scene_entity_pool_get(scene, handle.type);
+	if(pool)
+		entity = pool_get_live(pool, handle.index, handle.generation);
+	else if(handle.type == ET_CAMERA && handle.index < MAX_SCENE_CAMERAS)
+		entity = &scene->cameras[handle.index].base;
+	else if(handle.type == ET_PLAYER)
+		entity = &scene->player.base;
+	else if(handle.type == ET_ROOT)
+		entity = &scene->root_entity;
+
+	return entity && (entity->flags & EF_ACTIVE) ? entity : NULL;
 }
 
 float scene_entity_distance(struct Scene* scene, struct Entity* entity1, struct Entity* entity2)
@@ -1645,3 +1596,23 @@ struct Entity* scene_entity_duplicate(struct Scene* scene, struct Entity* entity
 	}
 	return new_entity;
 }
+
+static void scene_enemy_physics_job(void* data, int start, int end)
+{
+	struct Scene_Physics_Job* job = (struct Scene_Physics_Job*)data;
+	PROFILE_SCOPE("Enemy Physics Job")
+	{
+		for(int i = start; i < end; i++)
+			enemy_update_physics_compute(job->enemies[i], job->fixed_dt, job->ticks, &job->enemy_results[i]);
+	}
+}
+
+static void scene_trigger_physics_job(void* data, int start, int end)
+{
+	struct Scene_Physics_Job* job = (struct Scene_Physics_Job*)data;
+	PROFILE_SCOPE("Trigger Physics Job")
+	{
+		for(int i = start; i < end; i++)
+			job->triggering_entities[i] = trigger_update_physics_compute(job->triggers[i], job->scene);
+	}
+}
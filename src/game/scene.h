@@ -3,7 +3,9 @@
 
 #include "entity.h"
 #include "renderer.h"
+#include "bvh.h"
 #include "../common/limits.h"
+#include "../common/pool.h"
 
 struct Ray;
 struct Raycast_Result;
@@ -16,16 +18,18 @@ struct Scene
 	char                        next_level_filename[MAX_FILENAME_LEN];
     struct Entity               root_entity;
     struct Player               player;
-    struct Entity               entities[MAX_SCENE_ENTITIES];
-    struct Static_Mesh          static_meshes[MAX_SCENE_STATIC_MESHES];
+    struct Pool                 entities;      // struct Entity
+    struct Pool                 static_meshes; // struct Static_Mesh
     struct Camera               cameras[MAX_SCENE_CAMERAS];
-    struct Light                lights[MAX_SCENE_LIGHTS];
-    struct Sound_Source         sound_sources[MAX_SCENE_SOUND_SOURCES];
-	struct Enemy                enemies[MAX_SCENE_ENEMIES];
-	struct Trigger              triggers[MAX_SCENE_TRIGGERS];
-	struct Door                 doors[MAX_SCENE_DOORS];
-	struct Pickup               pickups[MAX_SCENE_PICKUPS];
+    struct Pool                 lights;        // struct Light
+    struct Pool                 sound_sources; // struct Sound_Source
+	struct Pool                 enemies;       // struct Enemy
+	struct Pool                 triggers;      // struct Trigger
+	struct Pool                 doors;         // struct Door
+	struct Pool                 pickups;       // struct Pickup
 	char                        entity_archetypes[MAX_SCENE_ENTITY_ARCHETYPES][MAX_FILENAME_LEN];
+	struct Bvh                  bvh; // Derived bounding boxes of all entities, used for ray queries
+	struct Bounding_Box_Soa     static_mesh_bounds; // Derived bounding boxes of static meshes indexed by pool slot, used for frustum culling
     int                         active_camera_index;
 	char                        init_func_name[MAX_HASH_KEY_LEN];
 	char                        cleanup_func_name[MAX_HASH_KEY_LEN];
@@ -83,8 +87,12 @@ struct Pickup*       scene_pickup_find(struct Scene* scene, const char* name);
 void scene_entity_parent_set(struct Scene* scene, struct Entity* entity, struct Entity* parent);
 void scene_entity_parent_reset(struct Scene* scene, struct Entity* entity); // Sets root entity as parent
 int  scene_entity_archetype_add(struct Scene* scene, const char* filename);
+void scene_geometry_changed(struct Scene* scene, int geometry_index, const struct Bounding_Box* old_bounding_box); // Refreshes the bounds of static meshes using the geometry unless they were overridden
 
-void           scene_ray_intersect(struct Scene* scene, struct Ray* ray, struct Raycast_Result* out_results, int ray_mask);
+struct Entity_Handle scene_entity_handle_get(struct Scene* scene, struct Entity* entity); // Returns a null handle for NULL or inactive entities
+struct Entity*       scene_entity_handle_resolve(struct Scene* scene, struct Entity_Handle handle); // Returns NULL if the entity has been removed since the handle was taken
+
+void           scene_ray_intersect(struct Scene* scene, struct Ray* ray, struct Raycast_Result* out_results, int ray_mask); // Results are sorted by distance along the ray, nearest first
 struct Entity* scene_ray_intersect_closest(struct Scene* scene, struct Ray* ray, int ray_mask);
 float          scene_entity_distance(struct Scene* scene, struct Entity* entity1, struct Entity* entity2);
 
@@ -0,0 +1,419 @@
+#include "scene_binary.h"
+#include "../common/parser.h"
+#include "../common/hashmap.h"
+#include "../common/variant.h"
+#include "../common/array.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "../system/file_io.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <limits.h>
+#include <assert.h>
+
+struct Scene_Binary_Header
+{
+	uint32 magic;
+	uint32 version;
+	uint32 num_sources;
+	uint32 num_objects;
+	uint32 num_values;
+	uint32 string_table_size;
+};
+
+/* Source 0 is always the scene itself, the rest are the entity archetypes it references */
+struct Scene_Binary_Source
+{
+	uint32 filename; // Offset into string table
+	uint32 first_object;
+	uint32 num_objects;
+	uint32 padding;
+	int64  modified_time;
+};
+
+struct Scene_Binary_Object
+{
+	int32  type;
+	uint32 first_value;
+	uint32 num_values;
+};
+
+// Values are stored as struct Parser_Value so loaded objects can point straight at them
+struct Scene_Binary_Writer
+{
+	struct Scene_Binary_Source* sources;
+	struct Scene_Binary_Object* objects;
+	struct Parser_Value*        values;
+	char*                       string_table;
+};
+
+static bool   scene_binary_source_add(struct Scene_Binary_Writer* writer, struct Parser* parser, const char* filename, const char* path, int directory_type);
+static uint32 scene_binary_string_add(struct Scene_Binary_Writer* writer, const char* string);
+static void   scene_binary_value_write(struct Scene_Binary_Writer* writer, const char* key, struct Variant* value);
+static int    scene_binary_value_type_infer(const char* value_str, struct Variant* out_value);
+static struct Parser* scene_binary_parser_create(const struct Scene_Binary_Source* source, const struct Scene_Binary_Object* objects, const struct Parser_Value* values, const char* string_table);
+
+bool scene_binary_compile(const char* filename, int directory_type)
+{
+	char prefixed_filename[MAX_FILENAME_LEN + 16];
+	snprintf(prefixed_filename, MAX_FILENAME_LEN + 16, "scenes/%s.symtres", filename);
+	FILE* scene_file = io_file_open(directory_type, prefixed_filename, "rb");
+	if(!scene_file)
+	{
+		log_error("scene_binary:compile", "Failed to open scene file %s for reading", prefixed_filename);
+		return false;
+	}
+
+	struct Parser* scene_parser = parser_load_objects(scene_file, prefixed_filename);
+	fclose(scene_file);
+	if(!scene_parser)
+	{
+		log_error("scene_binary:compile", "Failed to parse file '%s'", prefixed_filename);
+		return false;
+	}
+
+	struct Scene_Binary_Writer writer;
+	writer.sources      = array_new(struct Scene_Binary_Source);
+	writer.objects      = array_new(struct Scene_Binary_Object);
+	writer.values       = array_new(struct Parser_Value);
+	writer.string_table = array_new(char);
+
+	bool success = scene_binary_source_add(&writer, scene_parser, filename, prefixed_filename, directory_type);
+
+	// Each archetype is stored only once no matter how many times the scene places it
+	for(int i = 0; success && i < array_len(scene_parser->objects); i++)
+	{
+		struct Parser_Object* object = &scene_parser->objects[i];
+		if(object->type != PO_SCENE_ENTITY_ENTRY || !hashmap_value_exists(object->data, "filename")) continue;
+
+		const char* archetype_filename = hashmap_str_get(object->data, "filename");
+		bool already_added = false;
+		for(int j = 1; j < array_len(writer.sources); j++)
+		{
+			if(strncmp(&writer.string_table[writer.sources[j].filename], archetype_filename, MAX_FILENAME_LEN) == 0)
+			{
+				already_added = true;
+				break;
+			}
+		}
+		if(already_added) continue;
+
+		char archetype_path[MAX_FILENAME_LEN + 16];
+		snprintf(archetype_path, MAX_FILENAME_LEN + 16, "entities/%s.symtres", archetype_filename);
+		FILE* archetype_file = io_file_open(DIRT_INSTALL, archetype_path, "rb");
+		if(!archetype_file)
+		{
+			log_error("scene_binary:compile", "Failed to open entity file %s referenced by %s", archetype_path, prefixed_filename);
+			success = false;
+			break;
+		}
+
+		struct Parser* archetype_parser = parser_load_objects(archetype_file, archetype_path);
+		fclose(archetype_file);
+		if(!archetype_parser)
+		{
+			log_error("scene_binary:compile", "Failed to parse file '%s'", archetype_path);
+			success = false;
+			break;
+		}
+
+		success = scene_binary_source_add(&writer, archetype_parser, archetype_filename, archetype_path, DIRT_INSTALL);
+		parser_free(archetype_parser);
+	}
+	parser_free(scene_parser);
+
+	char binary_filename[MAX_FILENAME_LEN + 16];
+	snprintf(binary_filename, MAX_FILENAME_LEN + 16, "scenes/%s." SCENE_BINARY_EXTENSION, filename);
+	FILE* binary_file = success ? io_file_open(directory_type, binary_filename, "wb") : NULL;
+	if(binary_file)
+	{
+		struct Scene_Binary_Header header =
+		{
+			.magic             = SCENE_BINARY_MAGIC,
+			.version           = SCENE_BINARY_VERSION,
+			.num_sources       = (uint32)array_len(writer.sources),
+			.num_objects       = (uint32)array_len(writer.objects),
+			.num_values        = (uint32)array_len(writer.values),
+			.string_table_size = (uint32)array_len(writer.string_table)
+		};
+		fwrite(&header, sizeof(header), 1, binary_file);
+		fwrite(writer.sources, sizeof(*writer.sources), header.num_sources, binary_file);
+		fwrite(writer.objects, sizeof(*writer.objects), header.num_objects, binary_file);
+		fwrite(writer.values, sizeof(*writer.values), header.num_values, binary_file);
+		fwrite(writer.string_table, 1, header.string_table_size, binary_file);
+		fclose(binary_file);
+		log_message("Compiled %s to %s, %d sources, %d objects, %d values", prefixed_filename, binary_filename, header.num_sources, header.num_objects, header.num_values);
+	}
+	else
+	{
+		if(success) log_error("scene_binary:compile", "Failed to open %s for writing", binary_filename);
+		success = false;
+	}
+
+	array_free(writer.sources);
+	array_free(writer.objects);
+	array_free(writer.values);
+	array_free(writer.string_table);
+	return success;
+}
+
+static bool scene_binary_source_add(struct Scene_Binary_Writer* writer, struct Parser* parser, const char* filename, const char* path, int directory_type)
+{
+	int64 modified_time = 0;
+	if(!io_file_modified_time_get(directory_type, path, &modified_time))
+	{
+		log_error("scene_binary:source_add", "Failed to get modification time of %s", path);
+		return false;
+	}
+
+	uint32 filename_offset = scene_binary_string_add(writer, filename);
+	struct Scene_Binary_Source* source = array_grow(writer->sources, struct Scene_Binary_Source);
+	source->filename      = filename_offset;
+	source->first_object  = (uint32)array_len(writer->objects);
+	source->num_objects   = 0;
+	source->padding       = 0;
+	source->modified_time = modified_time;
+
+	for(int i = 0; i < array_len(parser->objects); i++)
+	{
+		struct Parser_Object* parser_object = &parser->objects[i];
+		if(parser_object->type == PO_UNKNOWN) continue;
+
+		struct Scene_Binary_Object* object = array_grow(writer->objects, struct Scene_Binary_Object);
+		object->type        = parser_object->type;
+		object->first_value = (uint32)array_len(writer->values);
+
+		char* key = NULL;
+		struct Variant* value = NULL;
+		HASHMAP_FOREACH(parser_object->data, key, value)
+		{
+			scene_binary_value_write(writer, key, value);
+		}
+		object->num_values = (uint32)array_len(writer->values) - object->first_value;
+		source->num_objects++;
+	}
+
+	return true;
+}
+
+static uint32 scene_binary_string_add(struct Scene_Binary_Writer* writer, const char* string)
+{
+	uint32 offset = (uint32)array_len(writer->string_table);
+	size_t length = strlen(string);
+	for(size_t i = 0; i <= length; i++)
+	{
+		char* c = array_grow(writer->string_table, char);
+		*c = string[i];
+	}
+	return offset;
+}
+
+static void scene_binary_value_write(struct Scene_Binary_Writer* writer, const char* key, struct Variant* value)
+{
+	struct Variant typed_value;
+	variant_init_empty(&typed_value);
+	int type = value->type == VT_STR ? scene_binary_value_type_infer(value->val_str, &typed_value) : VT_NONE;
+
+	uint32 key_offset  = scene_binary_string_add(writer, key);
+	uint32 text_offset = scene_binary_string_add(writer, value->type == VT_STR ? value->val_str : "");
+
+	struct Parser_Value* record = array_grow(writer->values, struct Parser_Value);
+	memset(record, 0, sizeof(*record));
+	record->key  = key_offset;
+	record->text = text_offset;
+	record->type = type;
+	switch(type)
+	{
+	case VT_BOOL:  record->val_int = typed_value.val_bool ? 1 : 0;                   break;
+	case VT_INT:   record->val_int = typed_value.val_int;                            break;
+	case VT_FLOAT: record->val_float[0] = typed_value.val_float;                     break;
+	case VT_VEC2:  memcpy(record->val_float, &typed_value.val_vec2, sizeof(vec2));   break;
+	case VT_VEC3:  memcpy(record->val_float, &typed_value.val_vec3, sizeof(vec3));   break;
+	case VT_VEC4:  memcpy(record->val_float, &typed_value.val_vec4, sizeof(vec4));   break;
+	case VT_STR:                                                                     break;
+	default:
+		log_warning("Unsupported value type for key '%s' while compiling scene", key);
+		record->type = VT_NONE;
+		break;
+	}
+	variant_free(&typed_value);
+}
+
+/* Values coming out of the text parser are all strings. The type is picked from the shape
+   of the text, true or false, a single whole number, a single decimal number or two to four
+   numbers, so "1.0" is stored as a float just like "1.0000". The stored value is exactly what
+   variant_from_str makes of the text and getters asking for any other type convert the text
+   instead, so every getter sees what it would have seen when reading the text file. Anything
+   that is not entirely made of plain decimal numbers is kept as a string */
+static int scene_binary_value_type_infer(const char* value_str, struct Variant* out_value)
+{
+	static const int vector_types[] = { VT_FLOAT, VT_VEC2, VT_VEC3, VT_VEC4 };
+	int type = VT_STR;
+	if(strcmp(value_str, "true") == 0 || strcmp(value_str, "false") == 0)
+	{
+		type = VT_BOOL;
+	}
+	else
+	{
+		int  num_numbers = 0;
+		bool is_integer  = true;
+		const char* token = value_str;
+		while(true)
+		{
+			while(isspace((unsigned char)*token)) token++;
+			if(*token == '\0') break;
+
+			const char* token_end = token;
+			while(*token_end != '\0' && !isspace((unsigned char)*token_end))
+			{
+				if(!isdigit((unsigned char)*token_end) && !strchr("+-.eE", *token_end)) return VT_STR;
+				if(!isdigit((unsigned char)*token_end) && *token_end != '+' && *token_end != '-') is_integer = false;
+				token_end++;
+			}
+
+			char* parsed_end = NULL;
+			double number = strtod(token, &parsed_end);
+			if(parsed_end != token_end || ++num_numbers > 4) return VT_STR;
+			if(number < (double)INT_MIN || number > (double)INT_MAX) is_integer = false;
+			token = token_end;
+		}
+
+		if(num_numbers == 1 && is_integer)
+			type = VT_INT;
+		else if(num_numbers > 0)
+			type = vector_types[num_numbers - 1];
+	}
+
+	if(type == VT_STR) return VT_STR;
+	variant_from_str(out_value, value_str, type);
+	if(out_value->type == type) return type;
+
+	variant_free(out_value);
+	return VT_STR;
+}
+
+struct Scene_Binary* scene_binary_load(const char* filename, int directory_type)
+{
+	char binary_filename[MAX_FILENAME_LEN + 16];
+	snprintf(binary_filename, MAX_FILENAME_LEN + 16, "scenes/%s." SCENE_BINARY_EXTENSION, filename);
+
+	// Not having a compiled scene is the common case so check quietly before mapping
+	int64 binary_modified_time = 0;
+	if(!io_file_modified_time_get(directory_type, binary_filename, &binary_modified_time))
+		return NULL;
+
+	long file_size = 0;
+	const char* data = io_file_map(directory_type, binary_filename, &file_size);
+	if(!data) return NULL;
+
+	const struct Scene_Binary_Header* header = (const struct Scene_Binary_Header*)data;
+	if((size_t)file_size < sizeof(*header) || header->magic != SCENE_BINARY_MAGIC || header->version != SCENE_BINARY_VERSION)
+	{
+		log_warning("%s is not a compiled scene or was compiled by a different version, falling back to text", binary_filename);
+		io_file_unmap((void*)data, file_size);
+		return NULL;
+	}
+
+	size_t expected_size = sizeof(*header) +
+		sizeof(struct Scene_Binary_Source) * header->num_sources +
+		sizeof(struct Scene_Binary_Object) * header->num_objects +
+		sizeof(struct Parser_Value) * header->num_values +
+		header->string_table_size;
+	if((size_t)file_size != expected_size || header->num_sources == 0 || header->string_table_size == 0)
+	{
+		log_warning("%s is corrupted, falling back to text", binary_filename);
+		io_file_unmap((void*)data, file_size);
+		return NULL;
+	}
+
+	const struct Scene_Binary_Source* sources = (const struct Scene_Binary_Source*)(data + sizeof(*header));
+	const struct Scene_Binary_Object* objects = (const struct Scene_Binary_Object*)(sources + header->num_sources);
+	const struct Parser_Value*        values  = (const struct Parser_Value*)(objects + header->num_objects);
+	const char*                       strings = (const char*)(values + header->num_values);
+
+	// Every offset has to stay inside the blob and the string table has to be terminated
+	bool valid = strings[header->string_table_size - 1] == '\0';
+	for(uint32 i = 0; valid && i < header->num_sources; i++)
+		valid = sources[i].filename < header->string_table_size && sources[i].first_object + sources[i].num_objects <= header->num_objects;
+	for(uint32 i = 0; valid && i < header->num_objects; i++)
+		valid = objects[i].first_value + objects[i].num_values <= header->num_values;
+	for(uint32 i = 0; valid && i < header->num_values; i++)
+		valid = values[i].key < header->string_table_size && values[i].text < header->string_table_size;
+	if(!valid)
+	{
+		log_warning("%s is corrupted, falling back to text", binary_filename);
+		io_file_unmap((void*)data, file_size);
+		return NULL;
+	}
+
+	// The blob is only usable as long as none of the files it was compiled from have changed
+	for(uint32 i = 0; i < header->num_sources; i++)
+	{
+		char source_path[MAX_FILENAME_LEN + 16];
+		int source_directory_type = i == 0 ? directory_type : DIRT_INSTALL;
+		snprintf(source_path, MAX_FILENAME_LEN + 16, i == 0 ? "scenes/%s.symtres" : "entities/%s.symtres", &strings[sources[i].filename]);
+
+		int64 modified_time = 0;
+		if(!io_file_modified_time_get(source_directory_type, source_path, &modified_time) || modified_time != sources[i].modified_time)
+		{
+			log_message("%s is out of date with %s, falling back to text", binary_filename, source_path);
+			io_file_unmap((void*)data, file_size);
+			return NULL;
+		}
+	}
+
+	struct Scene_Binary* scene_binary = memory_allocate(sizeof(*scene_binary));
+	scene_binary->data          = (void*)data;
+	scene_binary->data_size     = file_size;
+	scene_binary->scene_objects = scene_binary_parser_create(&sources[0], objects, values, strings);
+	scene_binary->archetypes    = array_new(struct Scene_Binary_Archetype);
+	for(uint32 i = 1; i < header->num_sources; i++)
+	{
+		struct Scene_Binary_Archetype* archetype = array_grow(scene_binary->archetypes, struct Scene_Binary_Archetype);
+		strncpy(archetype->filename, &strings[sources[i].filename], MAX_FILENAME_LEN - 1);
+		archetype->filename[MAX_FILENAME_LEN - 1] = '\0';
+		archetype->parser = scene_binary_parser_create(&sources[i], objects, values, strings);
+	}
+	return scene_binary;
+}
+
+// Objects only point at their records, nothing is converted or copied until a getter asks for it
+static struct Parser* scene_binary_parser_create(const struct Scene_Binary_Source* source, const struct Scene_Binary_Object* objects, const struct Parser_Value* values, const char* string_table)
+{
+	struct Parser* parser = parser_new();
+	if(!parser) return NULL;
+
+	for(uint32 i = source->first_object; i < source->first_object + source->num_objects; i++)
+	{
+		const struct Scene_Binary_Object* object = &objects[i];
+		parser_object_compiled_new(parser, object->type, &values[object->first_value], (int)object->num_values, string_table);
+	}
+
+	return parser;
+}
+
+void scene_binary_free(struct Scene_Binary* scene_binary)
+{
+	assert(scene_binary);
+	if(scene_binary->scene_objects) parser_free(scene_binary->scene_objects);
+	for(int i = 0; i < array_len(scene_binary->archetypes); i++)
+	{
+		if(scene_binary->archetypes[i].parser) parser_free(scene_binary->archetypes[i].parser);
+	}
+	array_free(scene_binary->archetypes);
+	io_file_unmap(scene_binary->data, scene_binary->data_size);
+	memory_free(scene_binary);
+}
+
+struct Parser* scene_binary_archetype_get(struct Scene_Binary* scene_binary, const char* filename)
+{
+	assert(scene_binary);
+	for(int i = 0; i < array_len(scene_binary->archetypes); i++)
+	{
+		if(strncmp(scene_binary->archetypes[i].filename, filename, MAX_FILENAME_LEN) == 0)
+			return scene_binary->archetypes[i].parser;
+	}
+	return NULL;
+}
@@ -0,0 +1,40 @@
+#ifndef SCENE_BINARY_H
+#define SCENE_BINARY_H
+
+#include "../common/limits.h"
+#include "../common/num_types.h"
+
+struct Parser;
+
+/* Compiled form of a scene and every entity archetype it references. The text
+   files are flattened into fixed size records that point into a shared string table
+   and written next to the scene as scenes/<name>.symbscn. The blob remembers the
+   modification times of all the files it was built from and is ignored as soon as
+   any of them changes so the text files always remain the source of truth. Loaded
+   objects read their values straight out of the mapped records so the blob stays
+   mapped until the Scene_Binary is freed */
+
+#define SCENE_BINARY_MAGIC     0x4E435353 // "SSCN"
+#define SCENE_BINARY_VERSION   2
+#define SCENE_BINARY_EXTENSION "symbscn"
+
+struct Scene_Binary_Archetype
+{
+	char           filename[MAX_FILENAME_LEN];
+	struct Parser* parser;
+};
+
+struct Scene_Binary
+{
+	struct Parser*                 scene_objects;
+	struct Scene_Binary_Archetype* archetypes;
+	void*                          data;
+	long                           data_size;
+};
+
+bool                 scene_binary_compile(const char* filename, int directory_type);
+struct Scene_Binary* scene_binary_load(const char* filename, int directory_type); // Returns NULL if there is no blob or it is out of date with the text files
+void                 scene_binary_free(struct Scene_Binary* scene_binary);
+struct Parser*       scene_binary_archetype_get(struct Scene_Binary* scene_binary, const char* filename);
+
+#endif
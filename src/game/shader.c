@@ -4,6 +4,7 @@
 #include "../common/string_utils.h"
 #include "../common/memory_utils.h"
 #include "../common/log.h"
+#include "../common/limits.h"
 #include "renderer.h"
 #include "texture.h"
 #include "gl_load.h"
@@ -15,8 +16,31 @@
 #include <assert.h>
 
 #define MAX_INCLUDE_LINE_LEN 256
+#define MAX_SHADER_INCLUDES  16
+#define MIN_UNIFORM_TABLE_CAPACITY 16
 
-static uint* shader_list;
+struct Shader_Uniform
+{
+	uint32 name_hash;
+	int    location;
+	char   name[MAX_UNIFORM_NAME_LEN]; // Empty name marks an unused slot
+};
+
+struct Shader
+{
+	uint                   program;
+	struct Shader_Uniform* uniforms; // Open addressed table whose capacity is always a power of two
+	int                    uniforms_capacity;
+	int                    uniforms_count;
+};
+
+static struct Shader* shader_list;
+static int            uniform_location_queries = 0; // Number of times glGetUniformLocation was called since last reset
+
+static void                   shader_uniform_table_create(struct Shader* shader);
+static void                   shader_uniform_table_insert(struct Shader* shader, uint32 name_hash, const char* name, int location);
+static struct Shader_Uniform* shader_uniform_table_find(struct Shader* shader, uint32 name_hash, const char* name);
+static int                    shader_uniform_location_query(uint program, const char* name);
 static int*  empty_indices;
 static const char* GLSL_VERSION_STR = "#version 330\n";
 
@@ -37,6 +61,12 @@ void debug_print_shader(const char* shaderText)
 
 char* run_preprocessor(char* shader_text, const char* custom_defines)
 {
+	/* The result is laid out as version line, custom defines, included files in reverse order
+	   and then the shader text itself. Pieces are gathered in the scratch arena first so the
+	   final text only needs a single allocation instead of one per include */
+	struct Memory_Arena_Scope scope = memory_arena_scope_begin(memory_scratch_arena_get());
+	char* includes[MAX_SHADER_INCLUDES];
+	int   num_includes = 0;
 	char* include_loc = strstr(shader_text, "//include");
 	if(include_loc)
 	{
@@ -50,58 +80,70 @@ char* run_preprocessor(char* shader_text, const char* custom_defines)
 		char* filename = strtok(inc_line, " ");
 		while(filename)
 		{
-			if(filename)
+			if(num_includes == MAX_SHADER_INCLUDES)
 			{
-				char* path = str_new("shaders/");
-				path = str_concat(path, filename);
-                char* file_contents = io_file_read(DIRT_INSTALL, path, "rb", NULL);
-				if(file_contents)
-				{
-					char* shader_text_new = str_new("%s\n%s", file_contents, shader_text);
-					memory_free(shader_text);
-					memory_free(file_contents);
-					memory_free(path);
-					shader_text = shader_text_new;
-				}
+				log_error("shader:run_preprocessor", "Too many includes, ignoring '%s' and the rest", filename);
+				break;
 			}
+			char* path = str_arena_new(memory_scratch_arena_get(), "shaders/%s", filename);
+			char* file_contents = path ? io_file_read(DIRT_INSTALL, path, "rb", NULL) : NULL;
+			if(file_contents) includes[num_includes++] = file_contents;
 			filename = strtok(NULL, " ");
 		}
 	}
-    
-    //If there are other #defines, add them too
-    if(custom_defines)
-    {
-        char* shader_text_with_custom_defines = str_new("%s\n%s", custom_defines, shader_text);
-        memory_free(shader_text);
-        shader_text = shader_text_with_custom_defines;
-    }
-    
-    // Insert #version line at the top
-    char* shader_text_with_version = str_new("%s\n%s", GLSL_VERSION_STR, shader_text);
-    memory_free(shader_text);
-    shader_text = shader_text_with_version;
-    
-	return shader_text;
+
+	size_t version_len = strlen(GLSL_VERSION_STR);
+	size_t defines_len = custom_defines ? strlen(custom_defines) : 0;
+	size_t text_len    = strlen(shader_text);
+	size_t total_len   = version_len + 1 + text_len + 1;
+	if(custom_defines) total_len += defines_len + 1;
+	for(int i = 0; i < num_includes; i++)
+		total_len += strlen(includes[i]) + 1;
+
+	char* processed_text = memory_allocate(total_len);
+	char* write_pos      = processed_text;
+	memcpy(write_pos, GLSL_VERSION_STR, version_len);
+	write_pos += version_len;
+	*write_pos++ = '\n';
+	if(custom_defines)
+	{
+		memcpy(write_pos, custom_defines, defines_len);
+		write_pos += defines_len;
+		*write_pos++ = '\n';
+	}
+	for(int i = num_includes - 1; i >= 0; i--)
+	{
+		size_t include_len = strlen(includes[i]);
+		memcpy(write_pos, includes[i], include_len);
+		write_pos += include_len;
+		*write_pos++ = '\n';
+		memory_free(includes[i]);
+	}
+	memcpy(write_pos, shader_text, text_len + 1);
+
+	memory_free(shader_text);
+	memory_arena_scope_end(&scope);
+	return processed_text;
 }
 
 void shader_init(void)
 {
-	shader_list = array_new(uint);
+	shader_list = array_new(struct Shader);
 	empty_indices = array_new(int);
 }
 	
 int shader_create(const char* vert_shader_name, const char* frag_shader_name, const char* custom_defines)
 {
-	char* vs_path = str_new("shaders/");
-	vs_path = str_concat(vs_path, vert_shader_name);
-	char* fs_path = str_new("shaders/");
-	fs_path = str_concat(fs_path, frag_shader_name);
+	struct Memory_Arena_Scope scope = memory_arena_scope_begin(memory_scratch_arena_get());
+	char* vs_path = str_arena_new(memory_scratch_arena_get(), "shaders/%s", vert_shader_name);
+	char* fs_path = str_arena_new(memory_scratch_arena_get(), "shaders/%s", frag_shader_name);
 		
 	GLuint vert_shader = glCreateShader(GL_VERTEX_SHADER);
 	GLuint frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
 
     char* vert_source = io_file_read(DIRT_INSTALL, vs_path, "rb", NULL);
     char* frag_source = io_file_read(DIRT_INSTALL, fs_path, "rb", NULL);
+	memory_arena_scope_end(&scope);
 
 	assert(vert_source != NULL);
 	assert(frag_source != NULL);
@@ -166,6 +208,8 @@ int shader_create(const char* vert_shader_name, const char* frag_shader_name, co
 	GL_CHECK(glBindAttribLocation(program, ATTRIB_LOC_NORMAL,   "vNormal"));
 	GL_CHECK(glBindAttribLocation(program, ATRRIB_LOC_UV,       "vUV"));
 	//GL_CHECK(glBindAttribLocation(program, ATTRIB_LOC_COLOR,    "vColor"));
+	GL_CHECK(glBindAttribLocation(program, ATTRIB_LOC_MODEL_MAT, "vModelMat"));
+	GL_CHECK(glBindAttribLocation(program, ATTRIB_LOC_NORMAL_MAT, "vNormalMat"));
 	GL_CHECK(glLinkProgram(program));
 
 	GLint is_linked = 0;
@@ -191,7 +235,7 @@ int shader_create(const char* vert_shader_name, const char* frag_shader_name, co
 	GL_CHECK(glDeleteShader(frag_shader));
 	
 	/* add new object or overwrite existing one */
-	uint* new_shader = 0;
+	struct Shader* new_shader = 0;
 	int index = -1;
 	int empty_len = array_len(empty_indices);
 	if(empty_len != 0)
@@ -202,22 +246,21 @@ int shader_create(const char* vert_shader_name, const char* frag_shader_name, co
 	}
 	else
 	{
-		new_shader = array_grow(shader_list, uint);
+		new_shader = array_grow(shader_list, struct Shader);
 		index = array_len(shader_list) - 1;
 	}
 	assert(new_shader);
-	*new_shader = program;
+	new_shader->program = program;
+	shader_uniform_table_create(new_shader);
 	
 	log_message("%s, %s compiled into shader program", vert_shader_name, frag_shader_name);
-	memory_free(vs_path);
-	memory_free(fs_path);
 	
 	return index;
 }
 
 void shader_bind(const int shader_index)
 {
-	GL_CHECK(glUseProgram(shader_list[shader_index]));
+	GL_CHECK(glUseProgram(shader_list[shader_index].program));
 }
 
 void shader_unbind(void)
@@ -225,14 +268,145 @@ void shader_unbind(void)
 	GL_CHECK(glUseProgram(0));
 }
 
+uint32 shader_uniform_name_hash(const char* name)
+{
+	/* FNV-1a */
+	uint32 hash = 2166136261u;
+	for(const char* c = name; *c != '\0'; c++)
+	{
+		hash ^= (uint32)(uchar)*c;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
 int shader_get_uniform_location(const int shader_index, const char* name)
 {
-	GLint handle = 0;
-	GL_CHECK(handle = glGetUniformLocation(shader_list[shader_index], name));
-	if(handle == -1)
+	return shader_get_uniform_location_hashed(shader_index, shader_uniform_name_hash(name), name);
+}
+
+int shader_get_uniform_location_hashed(const int shader_index, uint32 name_hash, const char* name)
+{
+	assert(shader_index > -1 && shader_index < array_len(shader_list));
+	struct Shader* shader = &shader_list[shader_index];
+	struct Shader_Uniform* uniform = shader_uniform_table_find(shader, name_hash, name);
+	if(uniform)
+		return uniform->location;
+
+	/* Not an active uniform reported by the driver when the program was linked, ask once and
+	   remember the result so that invalid names don't end up querying the driver every frame */
+	int location = shader_uniform_location_query(shader->program, name);
+	if(location == -1)
 		log_error("shader:get_uniform_location", "Invalid uniform %s", name);
+	shader_uniform_table_insert(shader, name_hash, name, location);
+	return location;
+}
+
+int shader_uniform_location_queries_reset(void)
+{
+	int queries = uniform_location_queries;
+	uniform_location_queries = 0;
+	return queries;
+}
+
+int shader_uniform_location_query(uint program, const char* name)
+{
+	GLint location = -1;
+	GL_CHECK(location = glGetUniformLocation(program, name));
+	uniform_location_queries++;
+	return location;
+}
+
+void shader_uniform_table_create(struct Shader* shader)
+{
+	GLint active_uniforms = 0;
+	GL_CHECK(glGetProgramiv(shader->program, GL_ACTIVE_UNIFORMS, &active_uniforms));
 
-	return handle;
+	int capacity = MIN_UNIFORM_TABLE_CAPACITY;
+	while(capacity < active_uniforms * 2)
+		capacity <<= 1;
+	shader->uniforms          = memory_allocate_and_clear(capacity, sizeof(*shader->uniforms));
+	shader->uniforms_capacity = capacity;
+	shader->uniforms_count    = 0;
+
+	char name[MAX_UNIFORM_NAME_LEN];
+	for(int i = 0; i < active_uniforms; i++)
+	{
+		GLsizei name_len = 0;
+		GLint   size     = 0;
+		GLenum  type     = 0;
+		memset(name, '\0', MAX_UNIFORM_NAME_LEN);
+		GL_CHECK(glGetActiveUniform(shader->program, (GLuint)i, MAX_UNIFORM_NAME_LEN, &name_len, &size, &type, name));
+
+		// Members of uniform blocks do not have a location
+		int location = shader_uniform_location_query(shader->program, name);
+		if(location == -1)
+			continue;
+
+		shader_uniform_table_insert(shader, shader_uniform_name_hash(name), name, location);
+
+		// Arrays are reported as "name[0]", make them available by their plain name as well
+		if(name_len > 3 && strcmp(&name[name_len - 3], "[0]") == 0)
+		{
+			name[name_len - 3] = '\0';
+			shader_uniform_table_insert(shader, shader_uniform_name_hash(name), name, location);
+		}
+	}
+}
+
+void shader_uniform_table_insert(struct Shader* shader, uint32 name_hash, const char* name, int location)
+{
+	// Keep load factor at or below one half
+	if((shader->uniforms_count + 1) * 2 > shader->uniforms_capacity)
+	{
+		struct Shader_Uniform* old_uniforms = shader->uniforms;
+		int old_capacity = shader->uniforms_capacity;
+		shader->uniforms_capacity = old_capacity << 1;
+		shader->uniforms          = memory_allocate_and_clear(shader->uniforms_capacity, sizeof(*shader->uniforms));
+		shader->uniforms_count    = 0;
+		for(int i = 0; i < old_capacity; i++)
+		{
+			if(old_uniforms[i].name[0] != '\0')
+				shader_uniform_table_insert(shader, old_uniforms[i].name_hash, old_uniforms[i].name, old_uniforms[i].location);
+		}
+		memory_free(old_uniforms);
+	}
+
+	uint32 mask = (uint32)shader->uniforms_capacity - 1;
+	uint32 index = name_hash & mask;
+	while(shader->uniforms[index].name[0] != '\0')
+	{
+		struct Shader_Uniform* uniform = &shader->uniforms[index];
+		if(uniform->name_hash == name_hash && strncmp(uniform->name, name, MAX_UNIFORM_NAME_LEN) == 0)
+		{
+			uniform->location = location;
+			return;
+		}
+		index = (index + 1) & mask;
+	}
+
+	struct Shader_Uniform* uniform = &shader->uniforms[index];
+	uniform->name_hash = name_hash;
+	uniform->location  = location;
+	strncpy(uniform->name, name, MAX_UNIFORM_NAME_LEN - 1);
+	shader->uniforms_count++;
+}
+
+struct Shader_Uniform* shader_uniform_table_find(struct Shader* shader, uint32 name_hash, const char* name)
+{
+	if(!shader->uniforms)
+		return NULL;
+
+	uint32 mask = (uint32)shader->uniforms_capacity - 1;
+	uint32 index = name_hash & mask;
+	while(shader->uniforms[index].name[0] != '\0')
+	{
+		struct Shader_Uniform* uniform = &shader->uniforms[index];
+		if(uniform->name_hash == name_hash && strncmp(uniform->name, name, MAX_UNIFORM_NAME_LEN) == 0)
+			return uniform;
+		index = (index + 1) & mask;
+	}
+	return NULL;
 }
 
 void shader_set_uniform_int(const int shader_index, const char* name, const int value)
@@ -279,14 +453,18 @@ void shader_set_uniform_mat4(const int shader_index,  const char* name, const ma
 
 void shader_remove(const int shader_index)
 {
-	uint shader = shader_list[shader_index];
+	uint shader = shader_list[shader_index].program;
 	if(shader == 0) return; 	/* shader is already deleted or invalid */
 	int curr_program = 0;
 	GL_CHECK(glGetIntegerv(GL_CURRENT_PROGRAM, &curr_program));
 	if((uint)curr_program == shader)
 		GL_CHECK(glUseProgram(0));
 	GL_CHECK(glDeleteProgram(shader));
-	shader_list[shader_index] = 0;
+	shader_list[shader_index].program = 0;
+	memory_free(shader_list[shader_index].uniforms);
+	shader_list[shader_index].uniforms          = NULL;
+	shader_list[shader_index].uniforms_capacity = 0;
+	shader_list[shader_index].uniforms_count    = 0;
 	array_push(empty_indices, shader_index, int);
 }
 	
@@ -355,6 +533,20 @@ int shader_get_attribute_location(const int shader_index, const char* attrib_nam
 {
 	assert(shader_index > -1 && shader_index < array_len(shader_list));
 	int location = 0;
-	GL_CHECK(location = glGetAttribLocation(shader_list[shader_index], attrib_name));
+	GL_CHECK(location = glGetAttribLocation(shader_list[shader_index].program, attrib_name));
 	return location;
 }
+
+bool shader_uniform_block_bind(const int shader_index, const char* block_name, const int binding)
+{
+	assert(shader_index > -1 && shader_index < array_len(shader_list));
+	GLuint block_index = GL_INVALID_INDEX;
+	GL_CHECK(block_index = glGetUniformBlockIndex(shader_list[shader_index].program, block_name));
+	if(block_index == GL_INVALID_INDEX)
+	{
+		log_error("shader:uniform_block_bind", "Invalid uniform block %s", block_name);
+		return false;
+	}
+	GL_CHECK(glUniformBlockBinding(shader_list[shader_index].program, block_index, binding));
+	return true;
+}
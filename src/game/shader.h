@@ -2,6 +2,7 @@
 #define SHADER_H
 
 #include "../common/linmath.h"
+#include "../common/num_types.h"
 
 // Constants for locations of attributes inside all shaders
 enum Attribute_Location
@@ -9,7 +10,9 @@ enum Attribute_Location
 	ATTRIB_LOC_POSITION = 0,
     ATTRIB_LOC_NORMAL   = 1,
     ATRRIB_LOC_UV       = 2,
-    ATTRIB_LOC_COLOR    = 3
+    ATTRIB_LOC_COLOR    = 3,
+    ATTRIB_LOC_MODEL_MAT = 4, // Per-instance mat4, occupies locations 4 to 7
+    ATTRIB_LOC_NORMAL_MAT = 8 // Per-instance mat3, occupies locations 8 to 10
 };
 
 enum Uniform_Type
@@ -23,6 +26,12 @@ enum Uniform_Type
 	UT_TEX
 };
 
+// Binding points for uniform blocks shared between shaders
+enum Uniform_Block_Binding
+{
+	UBB_LIGHTS = 0
+};
+
 int  shader_create(const char* vert_shader_name, const char* frag_shader_name, const char* custom_defines);
 void shader_init(void);
 void shader_bind(const int shader_index);
@@ -36,7 +45,11 @@ void shader_set_uniform_vec4(const int shader_index,  const char* name, const ve
 void shader_set_uniform_mat4(const int shader_index,  const char* name, const mat4* value);
 void shader_set_uniform(const int uniform_type, const int uniform_loc, void* value);
 void shader_cleanup(void);
-int  shader_get_uniform_location(const int shader_index, const char* name);
+int  shader_get_uniform_location(const int shader_index, const char* name); // Resolve once and reuse the result with shader_set_uniform
+int  shader_get_uniform_location_hashed(const int shader_index, uint32 name_hash, const char* name);
+uint32 shader_uniform_name_hash(const char* name);
+int  shader_uniform_location_queries_reset(void); // Returns the number of driver uniform queries made since the last reset
 int  shader_get_attribute_location(const int shader_index, const char* attrib_name);
+bool shader_uniform_block_bind(const int shader_index, const char* block_name, const int binding);
 
 #endif
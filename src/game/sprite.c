@@ -54,6 +54,7 @@ void sprite_batch_create(struct Sprite_Batch* batch, const char* texture_name, c
 		shader = shader_create("default.vert", "default.frag", NULL);
 	}
 	batch->shader = shader;
+	batch->uniform_mvp = shader_get_uniform_location(shader, "mvp");
 	batch->draw_mode = draw_mode;
 	batch->current_sprite_count = 0;
 }
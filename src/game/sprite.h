@@ -23,6 +23,7 @@ struct Sprite_Batch
 {
 	int           texture;
 	int           shader;
+	int           uniform_mvp;
 	struct Sprite sprites[SPRITE_BATCH_SIZE];
 	int           draw_mode;
 	uint          vao;
@@ -7,10 +7,26 @@
 #include "renderer.h"
 #include "gl_load.h"
 #include "../system/file_io.h"
+#include "asset_loader.h"
+#include "image.h"
 
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
+
+#define TEXTURE_PLACEHOLDER   "default.tga"
+#define MAX_TEXTURE_ERROR_LEN 256
+
+/* Not part of the core profile glad was generated for, both extensions are available on every desktop driver we target */
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+	#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+	#define GL_TEXTURE_MAX_ANISOTROPY_EXT     0x84FE
+	#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
 
 struct Texture
 {
@@ -21,40 +37,58 @@ struct Texture
 	GLenum format;
 	GLint  internal_format;
 	GLenum type;
+	int    num_levels;       // Mip levels loaded from file, 0 for textures made with texture_create whose sampling is left to the caller
+	int    load_id;          // Non-zero while the image is being loaded in the background
+	bool   uses_placeholder; // Handle belongs to the placeholder texture and must not be deleted
 };
 
-#pragma pack(push, 1)
-struct Tga_Header
+struct Texture_Load_Request
 {
-	char  idlength;
-	char  colourmaptype;
-	char  datatypecode;
-	short colourmaporigin;
-	short colourmaplength;
-	char  colourmapdepth;
-	short x_origin;
-	short y_origin;
-	short width;
-	short height;
-	char  bitsperpixel;
-	char  imagedescriptor;
+	int          index;
+	int          load_id;
+	char*        full_path;
+	bool         is_container;
+	char*        file_data;    // Container levels point into this until they are uploaded
+	struct Image image;
+	bool         success;
+	char         error[MAX_TEXTURE_ERROR_LEN];
 };
-#pragma pack(pop)
 
 static struct Texture* texture_list;
-static int* empty_indices;
-
-#define MAX_PIXEL_BYTES 5
-
-static int  load_img(FILE* file, GLubyte** image_data, int* width, int* height, int* fmt, int* internal_format);
+static int*  empty_indices;
+static int   placeholder_index = -1;
+static int   next_load_id      = 1;
+static bool  use_trilinear     = true;
+static float anisotropy        = 1.f;
+static float max_anisotropy    = 0.f;   // 0 when anisotropic filtering is not supported
+static bool  s3tc_supported    = false;
+
+static bool texture_image_load(const uint8* file_data, size_t file_size, bool is_container, struct Image* out_image, char* error);
+static int  texture_create_from_file_async(const char* filename, int texture_unit, char* full_path, bool is_container);
+static int  texture_create_from_image(const char* name, int texture_unit, const struct Image* image);
+static char* texture_container_path_get(const char* filename);
+static bool texture_container_usable(const char* source_path, const char* container_path);
+static void texture_sampling_apply(int index);
+static void texture_load_request_load(void* data);
+static void texture_load_request_finalize(void* data);
+static struct Texture* texture_slot_get(int* out_index);
 static void debug_write_tga(struct Tga_Header* header, GLubyte* image_data);
-static void copy_tga_pixel(GLubyte* source, GLubyte* dest, size_t bytes_per_pixel);
 static void create_gl_texture(uint* out_handle, int width, int height, int format, int internal_format, int type, const void* data);
+static void create_gl_texture_from_image(uint* out_handle, const struct Image* image, GLenum* out_format, GLint* out_internal_format);
 
-void texture_init(void)
+void texture_init(bool trilinear, float max_anisotropy_level)
 {
-	texture_list  = array_new(struct Texture);
-	empty_indices = array_new(int);
+	texture_list   = array_new(struct Texture);
+	empty_indices  = array_new(int);
+	use_trilinear  = trilinear;
+	anisotropy     = max_anisotropy_level;
+	s3tc_supported = gl_extension_supported("GL_EXT_texture_compression_s3tc");
+	max_anisotropy = 0.f;
+	if(gl_extension_supported("GL_EXT_texture_filter_anisotropic") || gl_extension_supported("GL_ARB_texture_filter_anisotropic"))
+		GL_CHECK(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_anisotropy));
+
+	if(!s3tc_supported)
+		log_warning("GL_EXT_texture_compression_s3tc not supported, block compressed texture containers will be ignored");
 }
 
 int texture_create_from_file(const char* filename, int texture_unit)
@@ -67,45 +101,239 @@ int texture_create_from_file(const char* filename, int texture_unit)
 		texture_list[index].ref_count++;
 		return index;
 	}
-	/* If texture not already loaded then try to load it */
-	char* full_path = str_new("textures/%s", filename);
-    FILE* file = io_file_open(DIRT_INSTALL, full_path, "rb");
-	int img_load_success = -1;
-	
-	if(file)
+	/* If texture not already loaded then try to load it. A container built by the texture
+	   importer is preferred over the source image since its levels are uploaded as they are */
+	char* full_path      = str_new("textures/%s", filename);
+	char* container_path = texture_container_path_get(filename);
+	bool  is_container   = texture_container_usable(full_path, container_path);
+	const char* load_path = is_container ? container_path : full_path;
+
+	/* Everything but the placeholder is streamed in when the asset loader is running */
+	if(asset_loader_is_running() && strcmp(filename, TEXTURE_PLACEHOLDER) != 0)
 	{
-		/* Load texture here */
-		int width, height, internal_format, fmt;
-		GLubyte* img_data = NULL;
-		width = height = internal_format = fmt = -1;
-		img_load_success = load_img(file, &img_data, &width, &height, &fmt, &internal_format);
+		int64 modified_time = 0;
+		if(!io_file_modified_time_get(DIRT_INSTALL, load_path, &modified_time))
+			log_error("texture:create_from_file", "Could not open file %s", filename);
+		else
+			index = texture_create_from_file_async(filename, texture_unit, io_file_full_path_get(DIRT_INSTALL, load_path), is_container);
+		memory_free(container_path);
+		memory_free(full_path);
+		return index;
+	}
 
-		if(img_load_success)
+	long  file_size = 0;
+	void* file_data = io_file_map(DIRT_INSTALL, load_path, &file_size);
+	if(file_data)
+	{
+		struct Image image;
+		char error[MAX_TEXTURE_ERROR_LEN] = {'\0'};
+		if(!texture_image_load(file_data, (size_t)file_size, is_container, &image, error))
 		{
-			index = texture_create(filename, texture_unit, width, height, fmt, internal_format, GL_UNSIGNED_BYTE, img_data);
-			if(index > -1)
-			{
-				texture_set_param(index, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-				texture_set_param(index, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				texture_set_param(index, GL_TEXTURE_WRAP_S,GL_REPEAT);
-				texture_set_param(index, GL_TEXTURE_WRAP_T,GL_REPEAT);
-			}
-			else
-			{
-				log_error("texture:create_from_file", "Error creating texture");
-			}
-			if(img_data) memory_free(img_data);
+			log_error("texture:create_from_file", "Failed to load %s, %s", load_path, error);
+		}
+		else
+		{
+			index = texture_create_from_image(filename, texture_unit, &image);
+			image_free(&image);
 		}
-		fclose(file);
+		io_file_unmap(file_data, file_size);
 	}
 	else
 	{
 		log_error("texture:create_from_file", "Could not open file %s", filename);
 	}
+	memory_free(container_path);
 	memory_free(full_path);
 	return index;
 }
 
+static char* texture_container_path_get(const char* filename)
+{
+	const char* extension   = strrchr(filename, '.');
+	int         stem_length = extension ? (int)(extension - filename) : (int)strlen(filename);
+	return str_new("textures/%.*s.%s", stem_length, filename, IMAGE_CONTAINER_EXTENSION);
+}
+
+static bool texture_container_usable(const char* source_path, const char* container_path)
+{
+	int64 container_time = 0;
+	if(!io_file_modified_time_get(DIRT_INSTALL, container_path, &container_time))
+		return false;
+
+	int64 source_time = 0;
+	if(io_file_modified_time_get(DIRT_INSTALL, source_path, &source_time) && source_time > container_time)
+	{
+		log_warning("Texture container %s is older than %s, using the source image until it is imported again", container_path, source_path);
+		return false;
+	}
+
+	/* Block compressed levels cannot be uploaded without s3tc but uncompressed containers still
+	   can, only the header is looked at here since the levels point into the mapped file */
+	if(!s3tc_supported)
+	{
+		long  file_size = 0;
+		void* file_data = io_file_map(DIRT_INSTALL, container_path, &file_size);
+		if(!file_data) return false;
+
+		struct Image image;
+		char error[MAX_TEXTURE_ERROR_LEN] = {'\0'};
+		bool usable = image_container_parse(file_data, (size_t)file_size, &image, error, sizeof(error)) && image.format != IMF_BC1 && image.format != IMF_BC3;
+		image_free(&image);
+		io_file_unmap(file_data, file_size);
+		return usable;
+	}
+	return true;
+}
+
+static int texture_create_from_image(const char* name, int texture_unit, const struct Image* image)
+{
+	int    index           = -1;
+	uint   handle          = 0;
+	GLenum format          = GL_RGB;
+	GLint  internal_format = GL_RGB;
+	create_gl_texture_from_image(&handle, image, &format, &internal_format);
+	struct Texture* new_tex   = texture_slot_get(&index);
+	new_tex->name             = str_new(name);
+	new_tex->handle           = handle;
+	new_tex->ref_count        = 1;
+	new_tex->texture_unit     = texture_unit;
+	new_tex->format           = format;
+	new_tex->internal_format  = internal_format;
+	new_tex->type             = GL_UNSIGNED_BYTE;
+	new_tex->num_levels       = image->num_levels;
+	new_tex->load_id          = 0;
+	new_tex->uses_placeholder = false;
+	texture_sampling_apply(index);
+	return index;
+}
+
+static void texture_sampling_apply(int index)
+{
+	struct Texture* texture = &texture_list[index];
+	GLint min_filter = GL_LINEAR;
+	if(texture->num_levels > 1)
+		min_filter = use_trilinear ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST;
+
+	GLint curr_texture = 0;
+	GL_CHECK(glGetIntegerv(GL_TEXTURE_BINDING_2D, &curr_texture));
+	GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture->handle));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+	if(max_anisotropy > 0.f)
+	{
+		float level = anisotropy < 1.f ? 1.f : (anisotropy > max_anisotropy ? max_anisotropy : anisotropy);
+		GL_CHECK(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, level));
+	}
+	glBindTexture(GL_TEXTURE_2D, curr_texture);
+}
+
+static int texture_create_from_file_async(const char* filename, int texture_unit, char* full_path, bool is_container)
+{
+	if(placeholder_index == -1)
+	{
+		placeholder_index = texture_create_from_file(TEXTURE_PLACEHOLDER, TU_DIFFUSE);
+		if(placeholder_index == -1)
+		{
+			log_error("texture:create_from_file_async", "Failed to load placeholder texture %s", TEXTURE_PLACEHOLDER);
+			memory_free(full_path);
+			return -1;
+		}
+	}
+
+	struct Texture_Load_Request* request = memory_allocate_tagged(sizeof(*request), MT_TEXTURE);
+	if(!request)
+	{
+		log_error("texture:create_from_file_async", "Out of memory");
+		memory_free(full_path);
+		return -1;
+	}
+
+	/* Until the image has been uploaded the new texture shows the placeholder */
+	int index = -1;
+	struct Texture* placeholder = &texture_list[placeholder_index];
+	uint   placeholder_handle   = placeholder->handle;
+	GLenum placeholder_format   = placeholder->format;
+	GLint  placeholder_internal = placeholder->internal_format;
+	struct Texture* new_tex     = texture_slot_get(&index);
+	new_tex->name               = str_new(filename);
+	new_tex->handle             = placeholder_handle;
+	new_tex->ref_count          = 1;
+	new_tex->texture_unit       = texture_unit;
+	new_tex->format             = placeholder_format;
+	new_tex->internal_format    = placeholder_internal;
+	new_tex->type               = GL_UNSIGNED_BYTE;
+	new_tex->num_levels         = 0;
+	new_tex->load_id            = next_load_id++;
+	new_tex->uses_placeholder   = true;
+
+	request->index        = index;
+	request->load_id      = new_tex->load_id;
+	request->full_path    = full_path;
+	request->is_container = is_container;
+	request->file_data    = NULL;
+	request->success      = false;
+	request->error[0]     = '\0';
+	memset(&request->image, 0, sizeof(request->image));
+	asset_loader_request(&texture_load_request_load, &texture_load_request_finalize, request);
+	return index;
+}
+
+static void texture_load_request_load(void* data)
+{
+	struct Texture_Load_Request* request = (struct Texture_Load_Request*)data;
+	long file_size = 0;
+	request->file_data = asset_loader_file_read(request->full_path, MT_TEXTURE, &file_size);
+	if(!request->file_data)
+	{
+		snprintf(request->error, MAX_TEXTURE_ERROR_LEN, "Could not read file %s", request->full_path);
+		return;
+	}
+	request->success = texture_image_load((const uint8*)request->file_data, (size_t)file_size, request->is_container, &request->image, request->error);
+
+	/* Decoded images own their pixels, only container levels still point into the file */
+	if(!request->is_container || !request->success)
+	{
+		memory_free(request->file_data);
+		request->file_data = NULL;
+	}
+}
+
+static void texture_load_request_finalize(void* data)
+{
+	struct Texture_Load_Request* request = (struct Texture_Load_Request*)data;
+
+	/* The texture might have been removed, and its slot reused, while it was loading */
+	struct Texture* texture = request->index < array_len(texture_list) ? &texture_list[request->index] : NULL;
+	if(texture && texture->load_id == request->load_id)
+	{
+		texture->load_id = 0;
+		if(request->success)
+		{
+			uint   handle          = 0;
+			GLenum format          = GL_RGB;
+			GLint  internal_format = GL_RGB;
+			create_gl_texture_from_image(&handle, &request->image, &format, &internal_format);
+			texture->handle           = handle;
+			texture->format           = format;
+			texture->internal_format  = internal_format;
+			texture->num_levels       = request->image.num_levels;
+			texture->uses_placeholder = false;
+			texture_sampling_apply(request->index);
+		}
+		else
+		{
+			log_error("texture:load_request_finalize", "Failed to load %s, %s. Keeping placeholder", texture->name, request->error);
+		}
+	}
+
+	image_free(&request->image);
+	if(request->file_data) memory_free(request->file_data);
+	memory_free(request->full_path);
+	memory_free(request);
+}
+
 void texture_remove(int index)
 {
 	if(index > -1 && index < array_len(texture_list))
@@ -116,7 +344,7 @@ void texture_remove(int index)
 			texture->ref_count--;
 			if(texture->ref_count < 0)
 			{	
-				glDeleteTextures(1, &texture->handle);
+				if(!texture->uses_placeholder) glDeleteTextures(1, &texture->handle);
 				if(texture->name) memory_free(texture->name);
 				texture->name            = NULL;
 				texture->ref_count       = -1;
@@ -124,6 +352,10 @@ void texture_remove(int index)
 				texture->format          = -1;
 				texture->internal_format = -1;
 				texture->type            = -1;
+				texture->num_levels      = 0;
+				texture->load_id         = 0;
+				texture->uses_placeholder = false;
+				if(index == placeholder_index) placeholder_index = -1;
 				array_push(empty_indices, index, int);			
 			}
 		}
@@ -153,8 +385,9 @@ void texture_cleanup(void)
 
 	array_free(texture_list);
 	array_free(empty_indices);
-	texture_list  = NULL;
-	empty_indices = NULL;
+	texture_list      = NULL;
+	empty_indices     = NULL;
+	placeholder_index = -1;
 }
 
 void texture_bind(int index)
@@ -179,137 +412,30 @@ void texture_unbind(int index)
 	GL_CHECK(glBindTexture(GL_TEXTURE_2D, 0));
 }
 
-int load_img(FILE* file, GLubyte** image_data, int* width, int* height, int* fmt, int* internal_format)
-{	
-	int success = 0;
-	struct Tga_Header header; 
-	size_t items_read = fread(&header, sizeof(struct Tga_Header), 1, file);
-
-	 if(items_read == 1)
-	 {
-		 if(header.datatypecode == 0)
-		 {
-			 log_error("texture:load_img", "No image data in file");
-		 }
-		 else
-		 {
-			 /* only compressed and uncompressed true color image data supported yet */
-			 if(header.datatypecode != 2 && header.datatypecode != 10)
-			 {
-				 log_error("texture:load_img", "Unsupported image data type");
-				 return success;
-			 }
-
-			 if(header.bitsperpixel != 24 && header.bitsperpixel != 32)
-			 {
-				 log_error("texture:load_img",
-						   "Unsupported bitsperpixel size(%d), only 24 and 32 supported", header.bitsperpixel);
-				 return success;
-			 }
-
-			 if(header.width <= 0 || header.height <= 0)
-			 {
-				 log_error("texture:load_img", "Invalid width and height (%d:%d)", header.width, header.height);
-				 return success;
-			 }
-
-			 size_t bytes_per_pixel = header.bitsperpixel / 8;
-			 size_t image_size = (bytes_per_pixel * header.width * header.height);
-			 *image_data = memory_allocate(image_size);
-			 if(!*image_data)
-			 {
-				 log_error("texture:load_img", "Out of memory");
-				 return success;
-			 }
-
-			 /* skip over unnecessary things like colormap data */
-			 int skipover = 0;
-			 skipover += header.idlength;
-			 skipover += header.colourmaptype * header.colourmaplength;
-			 fseek(file, skipover, SEEK_CUR);
-
-			 /* Start reading pixel by pixel */
-			 if(header.datatypecode == 2) /* uncompressed image data */
-			 {
-				 GLubyte pixel[MAX_PIXEL_BYTES];
-				 GLubyte* curr_pixel = *image_data;
-				 for(int i = 0; i < header.width * header.height; i++)
-				 {
-					 if(fread(&pixel, 1, bytes_per_pixel, file) != bytes_per_pixel)
-					 {
-						 log_error("texture:load_img", "Unexpected end of file at pixel %d", i);
-						 memory_free(*image_data);
-						 *image_data = NULL;
-						 return success;
-					 }
-
-					 /* Copy pixel and change BGR to RGB */
-					 copy_tga_pixel(&pixel[0], curr_pixel, bytes_per_pixel);
-					 curr_pixel += bytes_per_pixel;
-				 }
-			 }
-			 else if(header.datatypecode == 10) /* RLE encoded image data */
-			 {
-                 size_t chunk_size = bytes_per_pixel + 1;
-                 GLubyte chunk[MAX_PIXEL_BYTES];
-				 GLubyte* curr_chunk = *image_data;
-				 for(int i = 0; i < header.width * header.height;)
-				 {
-					 /* read chunk (header+pixel) */
-                     if(fread(chunk, 1, chunk_size, file) != chunk_size)
-					 {
-						 log_error("texture:img_load", "Unexpected end of file at chunk %d", i);
-						 memory_free(*image_data);
-						 *image_data = NULL;
-						 return success;
-					 }
-					 i++;
-					 copy_tga_pixel(&chunk[1], curr_chunk, bytes_per_pixel);
-					 curr_chunk += bytes_per_pixel;
-					 GLubyte chunk_identifier = chunk[0];
-					 int count = chunk[0] & 0x7f;
-					 if(chunk_identifier & 0x80) /* RLE chunk */
-					 {
-						 for(int j = 0; j < count; j++)
-						 {
-							 copy_tga_pixel(&chunk[1], curr_chunk, bytes_per_pixel);
-							 curr_chunk += bytes_per_pixel;
-							 i++;
-						 }
-					 }
-					 else		/* Normal chunk */
-					 {
-						 for(int j = 0; j < count; j++)
-						 {
-							 if(fread(&chunk[1], 1, bytes_per_pixel, file) != bytes_per_pixel)
-							 {
-								 log_error("texture:img_load", "Unexpected end of file at pixel %d", i);
-								 memory_free(*image_data);
-								 *image_data = NULL;
-								 return success;
-							 }
-							 copy_tga_pixel(&chunk[1], curr_chunk, bytes_per_pixel);
-							 curr_chunk += bytes_per_pixel;
-							 i++;
-						 }
-					 }
-				 }
-			 }
-			 //debug_write_tga(&header, *image_data);
-			 *height          = header.height;
-			 *width           = header.width;
-			 *fmt             = bytes_per_pixel == 3 ? GL_RGB : GL_RGBA;
-			 *internal_format = *fmt;
-			 success          = 1;
-		 }
-	 }
-	 else
-	 {
-		 log_error("texture:load_img", "Could not read header");
-		 success = 0;
-	 }
-
-	return success;
+static bool texture_image_load(const uint8* file_data, size_t file_size, bool is_container, struct Image* out_image, char* error)
+{
+	if(is_container)
+		return image_container_parse(file_data, file_size, out_image, error, MAX_TEXTURE_ERROR_LEN);
+
+	/* Source images are uploaded as a single level */
+	uint8* pixels   = NULL;
+	int    width    = 0;
+	int    height   = 0;
+	int    channels = 0;
+	memset(out_image, 0, sizeof(*out_image));
+	if(!image_tga_decode(file_data, file_size, &pixels, &width, &height, &channels, error, MAX_TEXTURE_ERROR_LEN))
+		return false;
+
+	out_image->format           = channels == 3 ? IMF_RGB8 : IMF_RGBA8;
+	out_image->width            = width;
+	out_image->height           = height;
+	out_image->num_levels       = 1;
+	out_image->storage          = pixels;
+	out_image->levels[0].data   = pixels;
+	out_image->levels[0].size   = (uint32)image_level_size_get(out_image->format, width, height);
+	out_image->levels[0].width  = width;
+	out_image->levels[0].height = height;
+	return true;
 }
 
 void texture_set_param(int index, int parameter, int value)
@@ -320,6 +446,12 @@ void texture_set_param(int index, int parameter, int value)
 	else
 		return;
 
+	if(texture->uses_placeholder)
+	{
+		log_warning("Cannot set parameter on texture %s as it is still using the placeholder", texture->name);
+		return;
+	}
+
 	GLint curr_texture = 0;
 	GL_CHECK(glGetIntegerv(GL_TEXTURE_BINDING_2D, &curr_texture));
 	GL_CHECK(glBindTexture(GL_TEXTURE_2D, texture->handle));
@@ -348,14 +480,6 @@ void debug_write_tga(struct Tga_Header* header, GLubyte* image_data)
 	fclose(fptr);
 }
 
-void copy_tga_pixel(GLubyte* source, GLubyte* dest, size_t bytes_per_pixel)
-{
-	dest[0] = source[2];
-	dest[1] = source[1];
-	dest[2] = source[0];
-	if(bytes_per_pixel == 4) dest[3] = source[3];
-}
-
 int texture_get_textureunit(int index)
 {
 	assert(index > -1 && index < array_len(texture_list));
@@ -393,26 +517,35 @@ int texture_create(const char* name,
 	int index   = -1;
 	uint handle = 0;
 	create_gl_texture(&handle, width, height, format, internal_format, type, data);
+	struct Texture* new_tex  = texture_slot_get(&index);
+	new_tex->name            = name ? str_new(name) : str_new("texture_%d", index);
+	new_tex->handle          = handle;
+	new_tex->ref_count       = 1;
+	new_tex->texture_unit    = texture_unit;
+	new_tex->format          = format;
+	new_tex->internal_format = internal_format;
+	new_tex->type            = type;
+	new_tex->num_levels      = 0;
+	new_tex->load_id         = 0;
+	new_tex->uses_placeholder = false;
+	return index;
+}
+
+static struct Texture* texture_slot_get(int* out_index)
+{
 	struct Texture* new_tex = NULL;
 	if(array_len(empty_indices) > 0)
 	{
-		index = *array_get_last(empty_indices, int);
+		*out_index = *array_get_last(empty_indices, int);
 		array_pop(empty_indices);
-		new_tex = &texture_list[index];
+		new_tex = &texture_list[*out_index];
 	}
 	else
 	{
 		new_tex = array_grow(texture_list, struct Texture);
-		index   = array_len(texture_list) - 1;
+		*out_index = array_len(texture_list) - 1;
 	}
-	new_tex->name            = name ? str_new(name) : str_new("texture_%d", index);
-	new_tex->handle          = handle;
-	new_tex->ref_count       = 1;
-	new_tex->texture_unit    = texture_unit;
-	new_tex->format          = format;
-	new_tex->internal_format = internal_format;
-	new_tex->type            = type;
-	return index;
+	return new_tex;
 }
 
 void create_gl_texture(uint*       out_handle,
@@ -429,6 +562,36 @@ void create_gl_texture(uint*       out_handle,
 	glBindTexture(GL_TEXTURE_2D, 0);	
 }
 
+void create_gl_texture_from_image(uint* out_handle, const struct Image* image, GLenum* out_format, GLint* out_internal_format)
+{
+	bool compressed = false;
+	switch(image->format)
+	{
+	case IMF_RGB8:  *out_format = GL_RGB;  *out_internal_format = GL_RGB;                                                     break;
+	case IMF_RGBA8: *out_format = GL_RGBA; *out_internal_format = GL_RGBA;                                                    break;
+	case IMF_BC1:   *out_format = GL_RGB;  *out_internal_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;  compressed = true; break;
+	case IMF_BC3:   *out_format = GL_RGBA; *out_internal_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; compressed = true; break;
+	}
+
+	/* Rows of small RGB levels are not 4 byte aligned */
+	GLint unpack_alignment = 4;
+	GL_CHECK(glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment));
+	GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	GL_CHECK(glGenTextures(1, out_handle));
+	glBindTexture(GL_TEXTURE_2D, *out_handle);
+	for(int i = 0; i < image->num_levels; i++)
+	{
+		const struct Image_Level* level = &image->levels[i];
+		if(compressed)
+			GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, i, (GLenum)*out_internal_format, level->width, level->height, 0, (GLsizei)level->size, level->data));
+		else
+			GL_CHECK(glTexImage2D(GL_TEXTURE_2D, i, *out_internal_format, level->width, level->height, 0, *out_format, GL_UNSIGNED_BYTE, level->data));
+	}
+	GL_CHECK(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image->num_levels - 1));
+	glBindTexture(GL_TEXTURE_2D, 0);
+	GL_CHECK(glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment));
+}
+
 void texture_resize(int index, int width, int height, const void* data)
 {
 	assert(index > -1 && index < array_len(texture_list));
@@ -1,16 +1,21 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include <stdbool.h>
+
 enum Texture_Unit
 {
 	TU_DIFFUSE = 0,
 	TU_SHADOWMAP1,
 	TU_SHADOWMAP2,
 	TU_SHADOWMAP3,
-	TU_SHADOWMAP4
+	TU_SHADOWMAP4,
+	TU_LIGHTS,         // Buffer textures used for clustered lighting
+	TU_LIGHT_CLUSTERS,
+	TU_LIGHT_INDICES
 };
 
-void texture_init(void);
+void texture_init(bool trilinear, float anisotropy); // Sampling used for textures loaded from file, anisotropy is clamped to what the driver supports and 1 disables it
 int  texture_create_from_file(const char* filename, int texture_unit);
 void texture_remove(int index);
 int  texture_find(const char* name);
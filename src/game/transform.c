@@ -11,6 +11,11 @@
 #include <string.h>
 #include <float.h>
 
+/* Entities whose world matrix is out of date, array length is only grown and
+   num_dirty_entities tracks how many slots are in use this frame */
+static struct Entity** dirty_entities     = NULL;
+static int             num_dirty_entities = 0;
+
 void transform_init(struct Entity* entity, struct Entity* parent)
 {
 	struct Transform* transform = &entity->transform;
@@ -20,9 +25,10 @@ void transform_init(struct Entity* entity, struct Entity* parent)
 	mat4_identity(&transform->trans_mat);
 	transform->children = array_new(struct Entity*);
 	transform->parent   = NULL;
+	transform->is_dirty = false;
 	if(parent)
 		transform_parent_set(entity, parent, false);
-	transform_update_transmat(entity);
+	transform_mark_dirty(entity);
 } 
 
 void transform_child_add(struct Entity* parent, struct Entity* child, bool update_transmat)
@@ -43,7 +49,7 @@ void transform_child_add(struct Entity* parent, struct Entity* child, bool updat
 	struct Entity** new_child_loc = array_grow(parent_transform->children, struct Entity*);
 	*new_child_loc = child;
 	child_transform->parent = parent;
-	if(update_transmat) transform_update_transmat(child);
+	if(update_transmat || parent_transform->is_dirty) transform_mark_dirty(child);
 }
 
 bool transform_child_remove(struct Entity* parent, struct Entity* child)
@@ -75,7 +81,7 @@ void transform_parent_set(struct Entity* child, struct Entity* parent, bool upda
 		transform_child_add(parent, child, false);
 	}
 
-	if(update_transmat) transform_update_transmat(child);
+	if(update_transmat) transform_mark_dirty(child);
 }
 
 void transform_copy(struct Entity* copy_to, struct Entity* copy_from, bool copy_parent)
@@ -97,7 +103,7 @@ void transform_copy(struct Entity* copy_to, struct Entity* copy_from, bool copy_
 	}
 	copy_to->transform.is_modified = true;
 	copy_to->transform.children = current_children;
-	transform_update_transmat(copy_to);
+	transform_mark_dirty(copy_to);
 }
 
 void transform_translate(struct Entity* entity, vec3* amount, enum Transform_Space space)
@@ -119,7 +125,7 @@ void transform_translate(struct Entity* entity, vec3* amount, enum Transform_Spa
 		}
 	}
 	vec3_add(&transform->position, &transform->position, &translation_amount);
-	transform_update_transmat(entity);
+	transform_mark_dirty(entity);
 }
 
 void transform_rotate(struct Entity*       entity,
@@ -137,14 +143,14 @@ void transform_rotate(struct Entity*       entity,
 	else
 		quat_mul(&transform->rotation, &new_rot, &transform->rotation);
 	quat_norm(&transform->rotation, &transform->rotation);
-	transform_update_transmat(entity);
+	transform_mark_dirty(entity);
 }
 
 void transform_scale(struct Entity* entity, vec3* scale)
 {
 	struct Transform* transform = &entity->transform;
 	vec3_assign(&transform->scale, scale);
-	transform_update_transmat(entity);
+	transform_mark_dirty(entity);
 }
 
 void transform_get_forward(struct Entity* entity, vec3* res)
@@ -208,38 +214,73 @@ void transform_get_right(struct Entity* entity, vec3* res)
 	quat_get_right(res, &transform->rotation);
 }
 
-void transform_update_transmat(struct Entity* entity)
+void transform_mark_dirty(struct Entity* entity)
 {
-	static mat4 scale, translation, rotation;
 	struct Transform* transform = &entity->transform;
-	mat4_identity(&scale);
-	mat4_identity(&translation);
-	mat4_identity(&rotation);
-	mat4_identity(&transform->trans_mat);
-	mat4_scale(&scale, transform->scale.x, transform->scale.y, transform->scale.z);
-	mat4_translate(&translation, transform->position.x, transform->position.y, transform->position.z);
-	mat4_from_quat(&rotation, &transform->rotation);
+	transform->is_modified = true;
 
-	mat4_mul(&transform->trans_mat, &transform->trans_mat, &translation);
-	mat4_mul(&transform->trans_mat, &transform->trans_mat, &rotation);
-	mat4_mul(&transform->trans_mat, &transform->trans_mat, &scale);
-	
-	if(transform->parent)
-	{
-		struct Transform* parent_tran = &transform->parent->transform;
-		mat4_mul(&transform->trans_mat, &parent_tran->trans_mat, &transform->trans_mat);
-	}
+	/* A dirty transform always has a dirty subtree so there is nothing left to mark */
+	if(transform->is_dirty)
+		return;
 
-	entity_update_derived_bounding_box(entity);
+	transform->is_dirty = true;
+	if(num_dirty_entities < array_len(dirty_entities))
+		dirty_entities[num_dirty_entities] = entity;
+	else
+		array_push(dirty_entities, entity, struct Entity*);
+	num_dirty_entities++;
 
-	/* Update all children */
-	int children = array_len(transform->children);
-	if(children > 0)
-	{
-		for(int i = 0; i < children; i++)
-			transform_update_transmat(entity->transform.children[i]);
-	}
+	int children = transform->children ? array_len(transform->children) : 0;
+	for(int i = 0; i < children; i++)
+		transform_mark_dirty(transform->children[i]);
+}
+
+void transform_resolve(struct Entity* entity)
+{
+	struct Transform* transform = &entity->transform;
+	if(!transform->is_dirty)
+		return;
+
+	struct Entity* parent = transform->parent;
+	if(parent)
+		transform_resolve(parent);
+
+	mat4_from_trs(&transform->trans_mat, &transform->position, &transform->rotation, &transform->scale);
+	if(parent)
+		mat4_mul(&transform->trans_mat, &parent->transform.trans_mat, &transform->trans_mat);
+
+	transform->is_dirty    = false;
 	transform->is_modified = true;
+	entity_update_derived_bounding_box(entity);
+}
+
+void transform_resolve_all(void)
+{
+	/* Entities are queued in the order they were marked, resolving parents first
+	   keeps this a single pass even when a child was queued before its parent */
+	for(int i = 0; i < num_dirty_entities; i++)
+		transform_resolve(dirty_entities[i]);
+	num_dirty_entities = 0;
+}
+
+void transform_resolve_discard(void)
+{
+	for(int i = 0; i < num_dirty_entities; i++)
+		dirty_entities[i]->transform.is_dirty = false;
+	num_dirty_entities = 0;
+}
+
+void transform_system_init(void)
+{
+	dirty_entities     = array_new(struct Entity*);
+	num_dirty_entities = 0;
+}
+
+void transform_system_cleanup(void)
+{
+	array_free(dirty_entities);
+	dirty_entities     = NULL;
+	num_dirty_entities = 0;
 }
 
 void transform_destroy(struct Entity* entity)
@@ -273,17 +314,19 @@ void transform_destroy(struct Entity* entity)
 	transform->parent = NULL;
 	transform->children = NULL;
 	transform->is_modified = false;
+	transform->is_dirty = false;
 }
 
 void transform_set_position(struct Entity* entity, vec3* new_position)
 {
 	struct Transform* transform = &entity->transform;
 	vec3_assign(&transform->position, new_position);
-	transform_update_transmat(entity);
+	transform_mark_dirty(entity);
 }
 
 void transform_get_absolute_position(struct Entity* entity, vec3* res)
 {
+	transform_resolve(entity);
 	res->x = entity->transform.trans_mat.mat[12];
 	res->y = entity->transform.trans_mat.mat[13];
 	res->z = entity->transform.trans_mat.mat[14];
@@ -332,5 +375,5 @@ void transform_reset(struct Entity* entity)
 	vec3_fill(&entity->transform.position, 0.f, 0.f, 0.f);
 	vec3_fill(&entity->transform.scale, 0.f, 0.f, 0.f);
 	quat_identity(&entity->transform.rotation);
-	transform_update_transmat(entity);
+	transform_mark_dirty(entity);
 }
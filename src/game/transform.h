@@ -22,7 +22,12 @@ void transform_get_forward(struct Entity* entity, vec3* res);
 void transform_get_lookat(struct Entity* entity, vec3* res);
 void transform_get_up(struct Entity* entity, vec3* res);
 void transform_get_right(struct Entity* entity, vec3* res);
-void transform_update_transmat(struct Entity* entity);
+void transform_mark_dirty(struct Entity* entity); // Flags the entity and its children, world matrices are rebuilt later by transform_resolve
+void transform_resolve(struct Entity* entity);    // Rebuilds the world matrix of a dirty entity, resolving its parents first
+void transform_resolve_all(void);                 // Resolves every entity marked dirty since the last call
+void transform_resolve_discard(void);             // Drops pending updates without resolving them, for when the queued entities are about to be freed
+void transform_system_init(void);
+void transform_system_cleanup(void);
 void transform_get_absolute_position(struct Entity* entity, vec3* res);
 void transform_get_absolute_rotation(struct Entity* entity, quat* res);
 void transform_get_absolute_scale(struct Entity* entity, vec3* res);
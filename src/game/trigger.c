@@ -23,40 +23,33 @@ void trigger_reset(struct Trigger* trigger)
 
 }
 
-void trigger_update_physics(struct Trigger* trigger, struct Scene* scene, float fixed_dt)
+struct Entity* trigger_update_physics_compute(struct Trigger* trigger, struct Scene* scene)
 {
-	// Check if we're triggered and fire the associated event
-	bool intersecting = false;
-	struct Entity* triggering_entity = NULL;
 	if(trigger->trigger_mask & TRIGM_PLAYER)
 	{
 		int intersection = bv_intersect_bounding_boxes(&trigger->base.derived_bounding_box, &scene->player.base.derived_bounding_box);
 		if(intersection == IT_INSIDE || intersection == IT_INTERSECT)
-		{
-			intersecting = true;
-			triggering_entity = &scene->player.base;
-		}
+			return &scene->player.base;
 	}
 
-	if(!intersecting && trigger->trigger_mask & TRIGM_ENEMY)
+	if(trigger->trigger_mask & TRIGM_ENEMY)
 	{
-		for(int i = 0; i < MAX_SCENE_ENEMIES; i++)
+		for(int i = 0; i < scene->enemies.num_live; i++)
 		{
-			struct Enemy* enemy = &scene->enemies[i];
-			if(!(enemy->base.flags & EF_ACTIVE))
-				continue;
-
+			struct Enemy* enemy = pool_live_at(&scene->enemies, i);
+			if(!(enemy->base.flags & EF_ACTIVE)) continue;
 			int intersection = bv_intersect_bounding_boxes(&trigger->base.derived_bounding_box, &enemy->mesh->base.derived_bounding_box);
 			if(intersection == IT_INTERSECT || intersection == IT_INSIDE)
-			{
-				intersecting = true;
-				triggering_entity = &enemy->base;
-				break;
-			}
+				return &enemy->base;
 		}
 	}
+	return NULL;
+}
 
-	if(intersecting)
+void trigger_update_physics_apply(struct Trigger* trigger, struct Scene* scene, struct Entity* triggering_entity)
+{
+	// Check if we're triggered and fire the associated event
+	if(triggering_entity)
 	{
 		bool fire_event = false;
 		switch(trigger->type)
@@ -96,12 +89,11 @@ void trigger_update_physics(struct Trigger* trigger, struct Scene* scene, float
 		if(fire_event)
 		{
 			struct Event_Manager* event_manager = game_state_get()->event_manager;
-			struct Event* trigger_event = event_manager_create_new_event(event_manager);
-			trigger_event->type = EVT_TRIGGER;
-			trigger_event->trigger.sender = trigger;
-			trigger_event->trigger.triggering_entity = triggering_entity;
-			trigger_event->sender = trigger;
-			event_manager_send_event(event_manager, trigger_event);
+			struct Event trigger_event = { .type = EVT_TRIGGER };
+			trigger_event.trigger.sender            = scene_entity_handle_get(scene, &trigger->base);
+			trigger_event.trigger.triggering_entity = scene_entity_handle_get(scene, triggering_entity);
+			trigger_event.sender = trigger;
+			event_manager_send_event(event_manager, &trigger_event, ED_END_OF_TICK);
 			if(trigger->type == TRIG_ONE_SHOT)
 				scene_trigger_remove(scene, trigger);
 		}
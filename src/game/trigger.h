@@ -2,9 +2,12 @@
 #define TRIGGER_H
 
 struct Trigger;
+struct Scene;
+struct Entity;
 
-void trigger_init(struct Trigger* trigger, int type, int trigger_mask);
-void trigger_reset(struct Trigger* trigger);
-void trigger_update_physics(struct Trigger* trigger, struct Scene* scene, float fixed_dt);
+void           trigger_init(struct Trigger* trigger, int type, int trigger_mask);
+void           trigger_reset(struct Trigger* trigger);
+struct Entity* trigger_update_physics_compute(struct Trigger* trigger, struct Scene* scene); // Safe on worker threads once transforms are resolved, returns the entity inside the trigger or NULL
+void           trigger_update_physics_apply(struct Trigger* trigger, struct Scene* scene, struct Entity* triggering_entity); // Fires the trigger event and may remove a one shot trigger
 
 #endif
\ No newline at end of file
@@ -26,6 +26,7 @@ void config_vars_init(struct Hashmap* cvars)
     hashmap_int_set(cvars,   "msaa_levels",                   4);
     hashmap_bool_set(cvars,  "debug_draw_enabled",            false);
     hashmap_bool_set(cvars,  "debug_draw_physics",            false);
+    hashmap_bool_set(cvars,  "render_multi_draw_indirect",    true);
     hashmap_int_set(cvars,   "video_driver_linux",            VD_WAYLAND);
     hashmap_int_set(cvars,   "debug_draw_mode",               0);
     hashmap_vec4_setf(cvars, "debug_draw_color",              0.8f, 0.4f, 0.1f, 1.f);
@@ -36,6 +37,21 @@ void config_vars_init(struct Hashmap* cvars)
     hashmap_float_set(cvars, "player_gravity",               -2.5f);
     hashmap_float_set(cvars, "player_min_forward_distance",   5.f);
     hashmap_float_set(cvars, "player_min_downward_distance",  2.f);
+    hashmap_int_set(cvars,   "asset_loader_threads",          0);
+    hashmap_float_set(cvars, "asset_upload_budget_ms",        2.f);
+    hashmap_int_set(cvars,   "job_workers",                   -1); // -1 picks a count based on the number of cpus, 0 runs jobs on the main thread
+    hashmap_bool_set(cvars,  "texture_trilinear",             true);
+    hashmap_float_set(cvars, "texture_anisotropy",            8.f); // Clamped to what the driver supports, 1 disables anisotropic filtering
+    hashmap_bool_set(cvars,  "profiler_enabled",              false);
+    hashmap_float_set(cvars, "memory_budget_general_mb",      512.f); // Soft budgets, going over only logs a warning. 0 disables the budget
+    hashmap_float_set(cvars, "memory_budget_geometry_mb",     512.f);
+    hashmap_float_set(cvars, "memory_budget_texture_mb",      1024.f);
+    hashmap_float_set(cvars, "memory_budget_parser_mb",       64.f);
+    hashmap_float_set(cvars, "memory_budget_hashmap_mb",      64.f);
+    hashmap_float_set(cvars, "memory_budget_array_mb",        256.f);
+    hashmap_float_set(cvars, "memory_budget_sound_mb",        128.f);
+    hashmap_float_set(cvars, "memory_budget_gui_mb",          64.f);
+    hashmap_float_set(cvars, "memory_budget_editor_mb",       64.f);
 }
 
 void config_vars_cleanup(struct Hashmap* cvars)
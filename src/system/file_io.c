@@ -2,6 +2,15 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "file_io.h"
 #include "../common/log.h"
@@ -12,7 +21,8 @@ static char* executable_directory = NULL;
 static char* install_directory = NULL;
 static char* user_directory    = NULL;
 
-static char* relative_path_get(const int directory_type);
+static const char* relative_path_get(const int directory_type);
+static char*       scratch_path_get(const int directory_type, const char* path);
 
 void io_file_init(const char* install_dir, const char* user_dir)
 {
@@ -52,6 +62,7 @@ char* io_file_read(const int directory_type, const char* path, const char* mode,
 			{
 				log_error("io:file_read", "fread failed");
 				memory_free(data);
+				data = NULL;
 			}
 		}
 		else
@@ -71,14 +82,15 @@ FILE* io_file_open(const int directory_type, const char* path, const char* mode)
 {
 	assert(directory_type >= 0 && directory_type < DIRT_COUNT);
 
-	char* relative_path = relative_path_get(directory_type);
+	struct Memory_Arena_Scope scope = memory_arena_scope_begin(memory_scratch_arena_get());
+	char* relative_path = scratch_path_get(directory_type, path);
 	if(!relative_path)
 	{
 		log_error("io:file_open", "Failed to get relative path for '%s'", path);
+		memory_arena_scope_end(&scope);
 		return NULL;
 	}
 	
-	relative_path = str_concat(relative_path, path);
 	FILE* file = fopen(relative_path, mode);
 	if(!file)
     {
@@ -87,7 +99,7 @@ FILE* io_file_open(const int directory_type, const char* path, const char* mode)
         perror(&err_str[0]);
 		log_error("io:file_open", "Failed to open file '%s' (%s)", relative_path, err_str);
     }
-	memory_free(relative_path);
+	memory_arena_scope_end(&scope);
 	return file;
 }
 
@@ -124,33 +136,112 @@ bool io_file_copy(const int directory_type, const char* source, const char* dest
 
 bool io_file_delete(const int directory_type, const char* filename)
 {
-	char* relative_path = relative_path_get(directory_type);
-	relative_path = str_concat(relative_path, filename);
+	struct Memory_Arena_Scope scope = memory_arena_scope_begin(memory_scratch_arena_get());
+	char* relative_path = scratch_path_get(directory_type, filename);
+	bool success = relative_path && remove(relative_path) == 0;
+	if(!success)
+		log_error("io:file_delete", "Failed to delete '%s'", filename);
+	else
+		log_message("'%s' deleted", filename);
+	
+	memory_arena_scope_end(&scope);
+	return success;
+}
+
+bool io_file_modified_time_get(const int directory_type, const char* path, int64* out_modified_time)
+{
+	struct Memory_Arena_Scope scope = memory_arena_scope_begin(memory_scratch_arena_get());
+	char* relative_path = scratch_path_get(directory_type, path);
+
+	struct stat file_stat;
+	bool success = relative_path && stat(relative_path, &file_stat) == 0;
+	if(success) *out_modified_time = (int64)file_stat.st_mtime;
+	memory_arena_scope_end(&scope);
+	return success;
+}
 
-	if(remove(relative_path) != 0)
+void* io_file_map(const int directory_type, const char* path, long* out_file_size)
+{
+	struct Memory_Arena_Scope scope = memory_arena_scope_begin(memory_scratch_arena_get());
+	char* relative_path = scratch_path_get(directory_type, path);
+	if(!relative_path)
 	{
-		log_error("io:file_delete", "Failed to delete '%s'", filename);
-		return false;
+		memory_arena_scope_end(&scope);
+		return NULL;
 	}
-	else
+
+	void* data = NULL;
+	long file_size = 0;
+#ifdef _WIN32
+	HANDLE file = CreateFileA(relative_path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file != INVALID_HANDLE_VALUE)
 	{
-		log_message("'%s' deleted", filename);
+		file_size = (long)GetFileSize(file, NULL);
+		HANDLE mapping = file_size > 0 ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+		if(mapping)
+		{
+			data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping); // The view keeps the mapping alive
+		}
+		CloseHandle(file);
 	}
-	
-	memory_free(relative_path);
-	return true;
+#else
+	int file = open(relative_path, O_RDONLY);
+	if(file != -1)
+	{
+		struct stat file_stat;
+		if(fstat(file, &file_stat) == 0 && file_stat.st_size > 0)
+		{
+			file_size = (long)file_stat.st_size;
+			data = mmap(NULL, (size_t)file_size, PROT_READ, MAP_PRIVATE, file, 0);
+			if(data == MAP_FAILED) data = NULL;
+		}
+		close(file);
+	}
+#endif
+
+	if(!data)
+		log_error("io:file_map", "Failed to map file '%s'", relative_path);
+	else if(out_file_size)
+		*out_file_size = file_size;
+
+	memory_arena_scope_end(&scope);
+	return data;
 }
 
-static char* relative_path_get(const int directory_type)
+void io_file_unmap(void* data, long file_size)
 {
-	char* relative_path = NULL;
+	if(!data) return;
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap(data, (size_t)file_size);
+#endif
+}
+
+char* io_file_full_path_get(const int directory_type, const char* path)
+{
+	const char* relative_path = relative_path_get(directory_type);
+	return relative_path ? str_new("%s%s", relative_path, path) : NULL;
+}
+
+static const char* relative_path_get(const int directory_type)
+{
+	const char* relative_path = NULL;
 	switch(directory_type)
 	{
-	case DIRT_USER:       relative_path = str_new(user_directory);         break;
-	case DIRT_INSTALL:    relative_path = str_new(install_directory);      break;
-	case DIRT_EXECUTABLE: relative_path = str_new(executable_directory);   break;
+	case DIRT_USER:       relative_path = user_directory;                  break;
+	case DIRT_INSTALL:    relative_path = install_directory;               break;
+	case DIRT_EXECUTABLE: relative_path = executable_directory;            break;
 	default: log_error("io:relative_path_get", "Invalid directory type!"); break;
 	};
 	return relative_path;
 }
 
+static char* scratch_path_get(const int directory_type, const char* path)
+{
+	// Callers are expected to have opened a scope on the scratch arena
+	const char* relative_path = relative_path_get(directory_type);
+	return relative_path ? str_arena_new(memory_scratch_arena_get(), "%s%s", relative_path, path) : NULL;
+}
+
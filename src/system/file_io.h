@@ -5,6 +5,7 @@
 #include <stdio.h>
 
 #include "../common/limits.h"
+#include "../common/num_types.h"
 
 enum Directory_Type
 {
@@ -20,5 +21,9 @@ char* io_file_read(const int directory_type, const char* path, const char* mode,
 FILE* io_file_open(const int directory_type, const char* path, const char* mode);
 bool  io_file_copy(const int directory_type, const char* source, const char* destination);
 bool  io_file_delete(const int directory_type, const char* filename);
+bool  io_file_modified_time_get(const int directory_type, const char* path, int64* out_modified_time);
+void* io_file_map(const int directory_type, const char* path, long* out_file_size); // Read-only mapping of the whole file, release with io_file_unmap
+void  io_file_unmap(void* data, long file_size);
+char* io_file_full_path_get(const int directory_type, const char* path); // Caller frees, returns NULL for invalid directory types
 
 #endif
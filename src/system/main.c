@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "../common/log.h"
 #include "sound.h"
@@ -9,17 +10,37 @@
 #include "../common/hashmap.h"
 #include "../game/game.h"
 #include "../common/memory_utils.h"
+#include "../game/bench.h"
+#include "../common/limits.h"
 
 struct Wndow;
 
-static struct Window*  window = NULL;
-static struct Hashmap* cvars  = NULL;
+static struct Window*      window     = NULL;
+static struct Hashmap*     cvars      = NULL;
+static bool                bench_mode = false;
+static struct Bench_Params bench_params;
 
 bool init(void);
 void cleanup(void);
+bool arguments_parse(int argc, char** args);
 
 int main(int argc, char** args)
 {
+    if(!arguments_parse(argc, args))
+    {
+		log_to_stdout("Usage: Symmetry [--bench <scene> [--frames N] [--fixed-dt] [--out <file.csv|file.json>]]");
+		exit(EXIT_FAILURE);
+    }
+
+    if(bench_mode)
+    {
+		/* Run once and report through the exit code so scripts can use this as a gate */
+		bool success = init() && game_init(window, cvars) && game_bench_run(&bench_params);
+		if(!success) log_to_stdout("ERR:(Main) Benchmark failed");
+		cleanup(); // Shut down and report leaks before the status is handed back instead of leaving it to atexit
+		exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
     if(!init())
     {
 		log_to_stdout("ERR:(Main) Could not initialize");
@@ -52,6 +73,7 @@ bool init(void)
         return false;
 	}
 
+	memory_arenas_init(FRAME_ARENA_CAPACITY, SCRATCH_ARENA_CAPACITY);
 	cvars = hashmap_create();
     config_vars_init(cvars);
     if(!platform_init()) return false;
@@ -68,6 +90,13 @@ bool init(void)
         config_vars_save(cvars, "config.symtres", DIRT_USER);
     }
 
+    for(int i = 0; i < MT_MAX; i++)
+    {
+        char budget_name[MAX_HASH_KEY_LEN];
+        snprintf(budget_name, MAX_HASH_KEY_LEN, "memory_budget_%s_mb", memory_tag_name_get(i));
+        memory_budget_set(i, (size_t)(hashmap_float_get(cvars, budget_name) * 1024.f * 1024.f));
+    }
+
     if(!platform_init_video()) return false;
 
     if(!platform_load_gl(NULL))
@@ -88,11 +117,57 @@ bool init(void)
         return false;
     }
 
+    // Benchmarks render offscreen so there is nothing to show
+    if(bench_mode) window_hide(window);
+
     return true;
 }
 
+bool arguments_parse(int argc, char** args)
+{
+	memset(&bench_params, 0, sizeof(bench_params));
+	bench_params.num_frames = BENCH_DEFAULT_FRAMES;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(args[i], "--bench") == 0 && i + 1 < argc)
+		{
+			bench_mode = true;
+			strncpy(bench_params.scene_filename, args[++i], MAX_FILENAME_LEN - 1);
+		}
+		else if(strcmp(args[i], "--frames") == 0 && i + 1 < argc)
+		{
+			bench_params.num_frames = atoi(args[++i]);
+			if(bench_params.num_frames <= 0) return false;
+		}
+		else if(strcmp(args[i], "--fixed-dt") == 0)
+		{
+			bench_params.fixed_dt = true;
+		}
+		else if(strcmp(args[i], "--out") == 0 && i + 1 < argc)
+		{
+			strncpy(bench_params.output_filename, args[++i], MAX_FILENAME_LEN - 1);
+		}
+		else if(strncmp(args[i], "--", 2) == 0)
+		{
+			log_to_stdout("ERR:(Main) Unknown or incomplete argument '%s'", args[i]);
+			return false;
+		}
+	}
+
+	if(bench_mode && bench_params.output_filename[0] == '\0')
+		snprintf(bench_params.output_filename, MAX_FILENAME_LEN, "bench_%.*s.json", MAX_FILENAME_LEN - 16, bench_params.scene_filename);
+
+	return true;
+}
+
 void cleanup(void)
 {
+	// Bench mode calls this directly before exiting, atexit would run it a second time
+	static bool cleaned_up = false;
+	if(cleaned_up) return;
+	cleaned_up = true;
+
 	game_cleanup();
     if(window) window_destroy(window);
     log_reset_all_callbacks(); // Now that the game library has been unloaded, reset all callbacks to stubs so we don't crash on exit
@@ -100,6 +175,8 @@ void cleanup(void)
     platform_cleanup();
 	config_vars_cleanup(cvars);
     io_file_cleanup();
+	memory_arenas_cleanup();
+	memory_leak_report();
 	log_message("Program exiting!");
 	log_cleanup();
 }
@@ -409,3 +409,82 @@ bool platform_timer_remove(int timer_id)
 {
     return (bool)SDL_RemoveTimer(timer_id);
 }
+
+uint64 platform_counter_get(void)
+{
+    return SDL_GetPerformanceCounter();
+}
+
+uint64 platform_counter_frequency_get(void)
+{
+    return SDL_GetPerformanceFrequency();
+}
+
+int platform_cpu_count_get(void)
+{
+    return SDL_GetCPUCount();
+}
+
+struct Thread* platform_thread_create(Thread_Func func, const char* name, void* param)
+{
+    SDL_Thread* thread = SDL_CreateThread(func, name, param);
+    if(!thread)
+        log_error("platform:thread_create", "Failed to create thread '%s', SDL : (%s)", name, SDL_GetError());
+    return (struct Thread*)thread;
+}
+
+void platform_thread_wait(struct Thread* thread)
+{
+    if(thread) SDL_WaitThread((SDL_Thread*)thread, NULL);
+}
+
+struct Mutex* platform_mutex_create(void)
+{
+    SDL_mutex* mutex = SDL_CreateMutex();
+    if(!mutex)
+        log_error("platform:mutex_create", "Failed to create mutex, SDL : (%s)", SDL_GetError());
+    return (struct Mutex*)mutex;
+}
+
+void platform_mutex_destroy(struct Mutex* mutex)
+{
+    if(mutex) SDL_DestroyMutex((SDL_mutex*)mutex);
+}
+
+void platform_mutex_lock(struct Mutex* mutex)
+{
+    SDL_LockMutex((SDL_mutex*)mutex);
+}
+
+void platform_mutex_unlock(struct Mutex* mutex)
+{
+    SDL_UnlockMutex((SDL_mutex*)mutex);
+}
+
+struct Condition* platform_condition_create(void)
+{
+    SDL_cond* condition = SDL_CreateCond();
+    if(!condition)
+        log_error("platform:condition_create", "Failed to create condition variable, SDL : (%s)", SDL_GetError());
+    return (struct Condition*)condition;
+}
+
+void platform_condition_destroy(struct Condition* condition)
+{
+    if(condition) SDL_DestroyCond((SDL_cond*)condition);
+}
+
+void platform_condition_wait(struct Condition* condition, struct Mutex* mutex)
+{
+    SDL_CondWait((SDL_cond*)condition, (SDL_mutex*)mutex);
+}
+
+void platform_condition_signal(struct Condition* condition)
+{
+    SDL_CondSignal((SDL_cond*)condition);
+}
+
+void platform_condition_broadcast(struct Condition* condition)
+{
+    SDL_CondBroadcast((SDL_cond*)condition);
+}
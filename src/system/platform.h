@@ -5,6 +5,7 @@
 #include "../common/num_types.h"
 
 typedef void (*Timer_Callback_Func) (uint32 interval, void* param);
+typedef int  (*Thread_Func) (void* param);
 
 enum Video_Drivers_Linux
 {
@@ -56,5 +57,25 @@ void        platform_unload_gl(void);
 void*       platform_load_function_gl(const char* func_name);
 int         platform_timer_add(uint32 interval_ms, Timer_Callback_Func callback, void* param);
 bool        platform_timer_remove(int timer_id);
+uint64      platform_counter_get(void); // High resolution counter, divide differences by platform_counter_frequency_get to get seconds
+uint64      platform_counter_frequency_get(void);
+int         platform_cpu_count_get(void);
+
+// Threading functions
+struct Thread;
+struct Mutex;
+struct Condition;
+
+struct Thread*    platform_thread_create(Thread_Func func, const char* name, void* param);
+void              platform_thread_wait(struct Thread* thread); // Blocks until the thread exits and releases it
+struct Mutex*     platform_mutex_create(void);
+void              platform_mutex_destroy(struct Mutex* mutex);
+void              platform_mutex_lock(struct Mutex* mutex);
+void              platform_mutex_unlock(struct Mutex* mutex);
+struct Condition* platform_condition_create(void);
+void              platform_condition_destroy(struct Condition* condition);
+void              platform_condition_wait(struct Condition* condition, struct Mutex* mutex);
+void              platform_condition_signal(struct Condition* condition);
+void              platform_condition_broadcast(struct Condition* condition);
 
 #endif
@@ -0,0 +1,141 @@
+#include "../game/event.h"
+#include "../game/game.h"
+#include "../common/array.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Subscribes 10k listeners spread over several event types, half of them only listening to one
+   sender, then sends 100k events both immediately and through the end of tick queue and finally
+   removes every subscription by handle. Prints the time for each step and fails if any listener
+   was called a different number of times than its subscription asks for */
+
+#define BENCH_NUM_SUBSCRIBERS 10000
+#define BENCH_NUM_EVENTS      100000
+#define BENCH_NUM_TYPES       10 // Event types starting at EVT_KEY_PRESSED, each gets an equal share of listeners
+#define BENCH_NUM_SENDERS     16
+
+struct Bench_Listener
+{
+	int    event_type;
+	int    sender;   // Index into the sender array or -1 when listening to every sender
+	uint32 num_calls;
+};
+
+static struct Game_State bench_game_state;
+
+static void bench_handler_subscriber(const struct Event* event, void* subscriber);
+static void bench_handler_subscriber_sender(const struct Event* event, void* subscriber, void* sender);
+static int  bench_events_send(struct Event_Manager* event_manager, int delivery, char* senders);
+static bool bench_calls_check(struct Bench_Listener* listeners, int num_rounds);
+
+// event.c reads the quit flag while polling os input, which this target never does
+struct Game_State* game_state_get(void)
+{
+	return &bench_game_state;
+}
+
+int main(void)
+{
+	log_init("Event_Bench.log", ".");
+	struct Event_Manager*      event_manager = memory_allocate(sizeof(*event_manager));
+	struct Bench_Listener*     listeners     = memory_allocate_and_clear(BENCH_NUM_SUBSCRIBERS, sizeof(*listeners));
+	Event_Subscription_Handle* handles       = memory_allocate(sizeof(*handles) * BENCH_NUM_SUBSCRIBERS);
+	char                       senders[BENCH_NUM_SENDERS];
+	event_manager_init(event_manager);
+
+	uint64 start = test_time_ns();
+	for(int i = 0; i < BENCH_NUM_SUBSCRIBERS; i++)
+	{
+		struct Bench_Listener* listener = &listeners[i];
+		listener->event_type = EVT_KEY_PRESSED + i % BENCH_NUM_TYPES;
+		listener->sender     = (i / BENCH_NUM_TYPES) % 2 == 0 ? -1 : (i / (BENCH_NUM_TYPES * 2)) % BENCH_NUM_SENDERS;
+		if(listener->sender == -1)
+			handles[i] = event_manager_subscribe_with_subscriber(event_manager, listener->event_type, &bench_handler_subscriber, listener);
+		else
+			handles[i] = event_manager_subscribe_with_subscriber_sender(event_manager, listener->event_type, &bench_handler_subscriber_sender, listener, &senders[listener->sender]);
+	}
+	uint64 subscribe_time = test_time_ns() - start;
+
+	start = test_time_ns();
+	int num_sent = bench_events_send(event_manager, ED_IMMEDIATE, senders);
+	uint64 immediate_time = test_time_ns() - start;
+
+	start = test_time_ns();
+	num_sent += bench_events_send(event_manager, ED_END_OF_TICK, senders);
+	uint64 queued_time = test_time_ns() - start;
+
+	bool success = num_sent == BENCH_NUM_EVENTS * 2 && bench_calls_check(listeners, 2);
+
+	start = test_time_ns();
+	for(int i = 0; i < BENCH_NUM_SUBSCRIBERS; i++)
+		event_manager_unsubscribe_handle(event_manager, handles[i]);
+	uint64 unsubscribe_time = test_time_ns() - start;
+
+	int num_left = 0;
+	for(int i = 0; i < EVT_MAX; i++)
+		num_left += array_len(event_manager->subscriptions[i]);
+	if(num_left != 0) success = false;
+
+	log_to_stdout("Subscribe %d listeners          : %8.2f ms, %7.1f ns each", BENCH_NUM_SUBSCRIBERS, (double)subscribe_time / 1e6, (double)subscribe_time / BENCH_NUM_SUBSCRIBERS);
+	log_to_stdout("Send %d events immediately    : %8.2f ms, %7.1f ns each", BENCH_NUM_EVENTS, (double)immediate_time / 1e6, (double)immediate_time / BENCH_NUM_EVENTS);
+	log_to_stdout("Send %d events at end of tick : %8.2f ms, %7.1f ns each", BENCH_NUM_EVENTS, (double)queued_time / 1e6, (double)queued_time / BENCH_NUM_EVENTS);
+	log_to_stdout("Unsubscribe %d handles         : %8.2f ms, %7.1f ns each, %d left", BENCH_NUM_SUBSCRIBERS, (double)unsubscribe_time / 1e6, (double)unsubscribe_time / BENCH_NUM_SUBSCRIBERS, num_left);
+	log_to_stdout(success ? "Event bench passed" : "Event bench FAILED");
+
+	event_manager_cleanup(event_manager);
+	memory_free(handles);
+	memory_free(listeners);
+	memory_free(event_manager);
+	log_cleanup();
+	exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static void bench_handler_subscriber(const struct Event* event, void* subscriber)
+{
+	((struct Bench_Listener*)subscriber)->num_calls++;
+}
+
+static void bench_handler_subscriber_sender(const struct Event* event, void* subscriber, void* sender)
+{
+	((struct Bench_Listener*)subscriber)->num_calls++;
+}
+
+static int bench_events_send(struct Event_Manager* event_manager, int delivery, char* senders)
+{
+	// Queued events are drained whenever the queue fills up, the way the game would at the end of each tick
+	int num_sent = 0;
+	for(int i = 0; i < BENCH_NUM_EVENTS; i++)
+	{
+		struct Event event;
+		memset(&event, 0, sizeof(event));
+		event.type   = EVT_KEY_PRESSED + i % BENCH_NUM_TYPES;
+		event.sender = &senders[(i / BENCH_NUM_TYPES) % BENCH_NUM_SENDERS];
+		if(event_manager_send_event(event_manager, &event, delivery)) num_sent++;
+		if(delivery == ED_END_OF_TICK && (i + 1) % MAX_QUEUED_EVENTS == 0) event_manager_tick_end(event_manager);
+	}
+	if(delivery == ED_END_OF_TICK) event_manager_tick_end(event_manager);
+	return num_sent;
+}
+
+static bool bench_calls_check(struct Bench_Listener* listeners, int num_rounds)
+{
+	// Every type receives the same number of events and each sender gets an equal share of them
+	int events_per_type   = BENCH_NUM_EVENTS / BENCH_NUM_TYPES;
+	int events_per_sender = events_per_type / BENCH_NUM_SENDERS;
+	int num_wrong = 0;
+	for(int i = 0; i < BENCH_NUM_SUBSCRIBERS; i++)
+	{
+		uint32 expected = (uint32)((listeners[i].sender == -1 ? events_per_type : events_per_sender) * num_rounds);
+		if(listeners[i].num_calls != expected)
+		{
+			if(num_wrong < 8) log_to_stdout("Listener %d was called %u times, expected %u", i, listeners[i].num_calls, expected);
+			num_wrong++;
+		}
+	}
+	return num_wrong == 0;
+}
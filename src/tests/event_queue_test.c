@@ -0,0 +1,144 @@
+#include "../game/event.h"
+#include "../game/game.h"
+#include "../common/atomics.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "../system/platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Several threads post events to the event manager at once while the main thread keeps
+   draining both queues, the way asset loader workers and the game loop share it. Producers
+   cycle through all three delivery modes and retry whenever a queue is full. Every event has
+   to be handled exactly once, on the main thread, and each producer's events have to arrive
+   in the order it sent them. Immediate events from other threads go through the end of tick
+   queue so they are ordered together with the end of tick ones */
+
+#define TEST_NUM_PRODUCERS       4
+#define TEST_EVENTS_PER_PRODUCER 20000
+#define TEST_MAX_IDLE_PASSES     100000000
+
+struct Test_Producer
+{
+	struct Event_Manager* event_manager;
+	int                   index;
+	uint32                num_retries; // Times a send found its queue full
+};
+
+struct Test_State
+{
+	uint8* received;                              // One entry per event, counts how often it was handled
+	int    last_received[TEST_NUM_PRODUCERS][2]; // Last sequence number handled per producer, for the end of tick and next frame queues
+	int    num_received;
+	int    num_out_of_order;
+};
+
+static struct Game_State test_game_state;
+static struct Test_State test_state;
+static volatile uint32   test_start = 0;
+
+static int  test_producer_run(void* param);
+static void test_event_handler(const struct Event* event);
+
+// event.c reads the quit flag while polling os input
+struct Game_State* game_state_get(void)
+{
+	return &test_game_state;
+}
+
+int main(void)
+{
+	log_init("Event_Queue_Test.log", ".");
+	struct Event_Manager* event_manager = memory_allocate(sizeof(*event_manager));
+	event_manager_init(event_manager);
+	event_manager_subscribe(event_manager, EVT_KEY_PRESSED, &test_event_handler);
+
+	int total_events = TEST_NUM_PRODUCERS * TEST_EVENTS_PER_PRODUCER;
+	test_state.received = memory_allocate_and_clear(total_events, sizeof(*test_state.received));
+	for(int i = 0; i < TEST_NUM_PRODUCERS; i++)
+		test_state.last_received[i][0] = test_state.last_received[i][1] = -1;
+
+	struct Test_Producer producers[TEST_NUM_PRODUCERS];
+	struct Thread*       threads[TEST_NUM_PRODUCERS];
+	for(int i = 0; i < TEST_NUM_PRODUCERS; i++)
+	{
+		producers[i].event_manager = event_manager;
+		producers[i].index         = i;
+		producers[i].num_retries   = 0;
+		threads[i] = platform_thread_create(&test_producer_run, "Event_Producer", &producers[i]);
+	}
+
+	// Drain until everything arrived, giving up after a long stretch without progress so a lost event cannot hang the test
+	atomic_uint32_store(&test_start, 1);
+	int num_passes = 0, num_idle_passes = 0;
+	while(test_state.num_received < total_events && num_idle_passes < TEST_MAX_IDLE_PASSES)
+	{
+		int num_received = test_state.num_received;
+		event_manager_tick_end(event_manager);
+		event_manager_poll_events(event_manager);
+		num_idle_passes = test_state.num_received == num_received ? num_idle_passes + 1 : 0;
+		num_passes++;
+	}
+
+	uint32 num_retries = 0;
+	for(int i = 0; i < TEST_NUM_PRODUCERS; i++)
+	{
+		platform_thread_wait(threads[i]);
+		num_retries += producers[i].num_retries;
+	}
+
+	// Anything sent twice would still be sitting in a queue
+	event_manager_tick_end(event_manager);
+	event_manager_poll_events(event_manager);
+
+	int num_missing = 0, num_duplicates = 0;
+	for(int i = 0; i < total_events; i++)
+	{
+		if(test_state.received[i] == 0) num_missing++;
+		if(test_state.received[i] > 1)  num_duplicates++;
+	}
+
+	bool success = num_missing == 0 && num_duplicates == 0 && test_state.num_out_of_order == 0;
+	log_to_stdout("%d producers, %d events : %d missing, %d handled more than once, %d out of order, %u sends retried on a full queue, %d drain passes",
+				  TEST_NUM_PRODUCERS, total_events, num_missing, num_duplicates, test_state.num_out_of_order, num_retries, num_passes);
+	log_to_stdout(success ? "Event queue test passed" : "Event queue test FAILED");
+
+	memory_free(test_state.received);
+	event_manager_cleanup(event_manager);
+	memory_free(event_manager);
+	log_cleanup();
+	exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static int test_producer_run(void* param)
+{
+	struct Test_Producer* producer = (struct Test_Producer*)param;
+	while(atomic_uint32_load(&test_start) == 0);
+
+	for(int i = 0; i < TEST_EVENTS_PER_PRODUCER; i++)
+	{
+		struct Event event;
+		memset(&event, 0, sizeof(event));
+		event.type         = EVT_KEY_PRESSED;
+		event.key.scancode = producer->index;
+		event.key.key      = i;
+		int delivery = i % 3 == 0 ? ED_IMMEDIATE : (i % 3 == 1 ? ED_END_OF_TICK : ED_NEXT_FRAME);
+		event.key.state    = delivery == ED_NEXT_FRAME ? 1 : 0;
+		while(!event_manager_send_event(producer->event_manager, &event, delivery))
+			producer->num_retries++;
+	}
+	return 0;
+}
+
+static void test_event_handler(const struct Event* event)
+{
+	int producer = event->key.scancode;
+	int sequence = event->key.key;
+	int queue    = event->key.state;
+	test_state.received[producer * TEST_EVENTS_PER_PRODUCER + sequence]++;
+	if(sequence <= test_state.last_received[producer][queue]) test_state.num_out_of_order++;
+	test_state.last_received[producer][queue] = sequence;
+	test_state.num_received++;
+}
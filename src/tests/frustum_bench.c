@@ -0,0 +1,123 @@
+#include "../game/bounding_volumes.h"
+#include "../common/linmath.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Culls 10k boxes scattered around a camera with bv_intersect_frustum_boxes and with one
+   bv_intersect_frustum_box call per box, prints the time per box for both and fails if the
+   visibility mask disagrees with the per box test for any box */
+
+#define BENCH_NUM_BOXES   10000
+#define BENCH_NUM_REPEATS 500
+#define BENCH_WORLD_SIZE  400.f
+
+#if defined(__AVX__)
+	#define BENCH_BUILD_NAME "avx"
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define BENCH_BUILD_NAME "sse"
+#else
+	#define BENCH_BUILD_NAME "scalar"
+#endif
+
+static void frustum_build(vec4* frustum);
+static void boxes_generate(struct Bounding_Box* boxes, struct Bounding_Box_Soa* boxes_soa);
+
+int main(void)
+{
+	log_init("Frustum_Bench.log", ".");
+
+	vec4 frustum[FP_NUM_PLANES];
+	frustum_build(frustum);
+
+	struct Bounding_Box*    boxes = memory_allocate(sizeof(*boxes) * BENCH_NUM_BOXES);
+	struct Bounding_Box_Soa boxes_soa;
+	bv_box_soa_init(&boxes_soa);
+	bv_box_soa_reserve(&boxes_soa, BENCH_NUM_BOXES);
+	boxes_generate(boxes, &boxes_soa);
+
+	int     num_words  = (BENCH_NUM_BOXES + 31) / 32;
+	uint32* visibility = memory_allocate(sizeof(*visibility) * num_words);
+	int*    results    = memory_allocate(sizeof(*results) * BENCH_NUM_BOXES);
+
+	uint64 start = test_time_ns();
+	for(int repeat = 0; repeat < BENCH_NUM_REPEATS; repeat++)
+		bv_intersect_frustum_boxes(frustum, &boxes_soa, BENCH_NUM_BOXES, visibility);
+	uint64 batched_time = test_time_ns() - start;
+
+	start = test_time_ns();
+	for(int repeat = 0; repeat < BENCH_NUM_REPEATS; repeat++)
+		for(int i = 0; i < BENCH_NUM_BOXES; i++)
+			results[i] = bv_intersect_frustum_box(frustum, &boxes[i]);
+	uint64 single_time = test_time_ns() - start;
+
+	int num_visible = 0, num_mismatches = 0;
+	for(int i = 0; i < BENCH_NUM_BOXES; i++)
+	{
+		bool batched_visible = (visibility[i >> 5] & (1u << (i & 31))) != 0;
+		bool single_visible  = results[i] != IT_OUTSIDE;
+		if(single_visible) num_visible++;
+		if(batched_visible != single_visible)
+		{
+			if(num_mismatches < 8) log_to_stdout("Box %d : batched %s, bv_intersect_frustum_box %d", i, batched_visible ? "visible" : "outside", results[i]);
+			num_mismatches++;
+		}
+	}
+
+	double num_tests = (double)BENCH_NUM_BOXES * BENCH_NUM_REPEATS;
+	log_to_stdout("%d boxes, %d visible", BENCH_NUM_BOXES, num_visible);
+	log_to_stdout("%-6s bv_intersect_frustum_boxes : %6.2f ns/box", BENCH_BUILD_NAME, (double)batched_time / num_tests);
+	log_to_stdout("%-6s bv_intersect_frustum_box   : %6.2f ns/box", BENCH_BUILD_NAME, (double)single_time / num_tests);
+	log_to_stdout(num_mismatches == 0 ? "Frustum bench passed" : "Frustum bench FAILED, %d boxes differ", num_mismatches);
+
+	memory_free(results);
+	memory_free(visibility);
+	memory_free(boxes);
+	bv_box_soa_destroy(&boxes_soa);
+	log_cleanup();
+	exit(num_mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static void frustum_build(vec4* frustum)
+{
+	// Same plane extraction as the camera's update_frustum, which needs a whole camera entity
+	mat4 view, proj, view_proj;
+	vec3 eye    = {   0.f, 10.f, 0.f };
+	vec3 center = { 100.f,  0.f, 60.f };
+	vec3 up     = {   0.f,  1.f, 0.f };
+	mat4_lookat(&view, &eye, &center, &up);
+	mat4_perspective(&proj, 60.f, 16.f / 9.f, 0.1f, 150.f);
+	mat4_identity(&view_proj);
+	mat4_mul(&view_proj, &proj, &view);
+
+	float* mvp = &view_proj.mat[0];
+	vec4_fill(&frustum[FP_LEFT],   mvp[3] + mvp[0], mvp[7] + mvp[4], mvp[11] + mvp[8],  mvp[15] + mvp[12]);
+	vec4_fill(&frustum[FP_RIGHT],  mvp[3] - mvp[0], mvp[7] - mvp[4], mvp[11] - mvp[8],  mvp[15] - mvp[12]);
+	vec4_fill(&frustum[FP_BOTTOM], mvp[3] + mvp[1], mvp[7] + mvp[5], mvp[11] + mvp[9],  mvp[15] + mvp[13]);
+	vec4_fill(&frustum[FP_TOP],    mvp[3] - mvp[1], mvp[7] - mvp[5], mvp[11] - mvp[9],  mvp[15] - mvp[13]);
+	vec4_fill(&frustum[FP_NEAR],   mvp[3] + mvp[2], mvp[7] + mvp[6], mvp[11] + mvp[10], mvp[15] + mvp[14]);
+	vec4_fill(&frustum[FP_FAR],    mvp[3] - mvp[2], mvp[7] - mvp[6], mvp[11] - mvp[10], mvp[15] - mvp[14]);
+	for(int i = 0; i < FP_NUM_PLANES; i++)
+		vec4_norm(&frustum[i], &frustum[i]);
+}
+
+static void boxes_generate(struct Bounding_Box* boxes, struct Bounding_Box_Soa* boxes_soa)
+{
+	// Boxes all around the camera so some are inside, some straddle a plane and most are culled
+	uint32 seed = 0x12345678u;
+	for(int i = 0; i < BENCH_NUM_BOXES; i++)
+	{
+		struct Bounding_Box* box = &boxes[i];
+		vec3 center = { test_random_range(&seed, -BENCH_WORLD_SIZE, BENCH_WORLD_SIZE) * 0.5f,
+		                test_random_range(&seed, -20.f, 20.f),
+		                test_random_range(&seed, -BENCH_WORLD_SIZE, BENCH_WORLD_SIZE) * 0.5f };
+		vec3 extent = { test_random_range(&seed, 0.25f, 8.f), test_random_range(&seed, 0.25f, 8.f), test_random_range(&seed, 0.25f, 8.f) };
+		vec3_sub(&box->min, &center, &extent);
+		vec3_add(&box->max, &center, &extent);
+		bv_box_soa_set(boxes_soa, i, box);
+	}
+}
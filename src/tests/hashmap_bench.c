@@ -0,0 +1,199 @@
+#define _POSIX_C_SOURCE 200809L // strnlen, which the old map used
+
+#include "../common/hashmap.h"
+#include "../common/variant.h"
+#include "../common/array.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Compares the hashmap against the bucketed map it replaced at 10, 100 and 10k keys. The old
+   map is kept below exactly as far as inserting and looking up goes, ten buckets of growable
+   arrays with the key rehashed using strlen on every loop iteration. Both maps get the same
+   keys and lookups, and every value read from either map has to match what was inserted */
+
+#define BENCH_NUM_LOOKUPS 200000
+#define BENCH_OLD_BUCKETS 10
+
+struct Old_Hashmap_Entry
+{
+	char           key[MAX_HASH_KEY_LEN];
+	struct Variant value;
+};
+
+struct Old_Hashmap
+{
+	struct Old_Hashmap_Entry* buckets[BENCH_OLD_BUCKETS];
+};
+
+struct Bench_Times
+{
+	uint64 insert;
+	uint64 lookup;
+	uint64 lookup_missing;
+};
+
+static struct Old_Hashmap* old_hashmap_create(void);
+static void                old_hashmap_free(struct Old_Hashmap* hashmap);
+static void                old_hashmap_int_set(struct Old_Hashmap* hashmap, const char* key, int value);
+static struct Variant*     old_hashmap_value_get(const struct Old_Hashmap* hashmap, const char* key);
+static unsigned int        old_hashmap_generate_hash(const char* key);
+static bool                bench_run(int num_keys);
+
+int main(void)
+{
+	const int key_counts[] = { 10, 100, 10000 };
+	bool success = true;
+	log_init("Hashmap_Bench.log", ".");
+	for(int i = 0; i < (int)(sizeof(key_counts) / sizeof(key_counts[0])); i++)
+		if(!bench_run(key_counts[i])) success = false;
+	log_to_stdout(success ? "Hashmap bench passed" : "Hashmap bench FAILED");
+	log_cleanup();
+	exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static bool bench_run(int num_keys)
+{
+	// Key names shaped like cvars and parsed object keys so string lengths are realistic
+	char (*keys)[MAX_HASH_KEY_LEN]         = memory_allocate(sizeof(*keys) * num_keys);
+	char (*missing_keys)[MAX_HASH_KEY_LEN] = memory_allocate(sizeof(*missing_keys) * num_keys);
+	uint32* hashes  = memory_allocate(sizeof(*hashes) * num_keys);
+	int*    lookups = memory_allocate(sizeof(*lookups) * BENCH_NUM_LOOKUPS);
+	uint32  seed    = 0xA5A5F00Du;
+	for(int i = 0; i < num_keys; i++)
+	{
+		snprintf(keys[i], MAX_HASH_KEY_LEN, "render_setting_%d_value", i);
+		snprintf(missing_keys[i], MAX_HASH_KEY_LEN, "render_setting_%d_missing", i);
+		hashes[i] = hashmap_key_hash(keys[i]);
+	}
+	for(int i = 0; i < BENCH_NUM_LOOKUPS; i++)
+		lookups[i] = (int)(test_random_float(&seed) * num_keys);
+
+	struct Bench_Times new_times, old_times;
+	uint64 lookup_hashed_time = 0; // The old map had no way to pass in a hash
+	int    num_wrong          = 0;
+
+	uint64 start = test_time_ns();
+	struct Hashmap* hashmap = hashmap_create();
+	for(int i = 0; i < num_keys; i++)
+		hashmap_int_set(hashmap, keys[i], i);
+	new_times.insert = test_time_ns() - start;
+
+	start = test_time_ns();
+	for(int i = 0; i < BENCH_NUM_LOOKUPS; i++)
+		if(hashmap_int_get(hashmap, keys[lookups[i]]) != lookups[i]) num_wrong++;
+	new_times.lookup = test_time_ns() - start;
+
+	start = test_time_ns();
+	for(int i = 0; i < BENCH_NUM_LOOKUPS; i++)
+	{
+		const struct Variant* value = hashmap_value_get_hashed(hashmap, hashes[lookups[i]], keys[lookups[i]]);
+		if(!value || value->val_int != lookups[i]) num_wrong++;
+	}
+	lookup_hashed_time = test_time_ns() - start;
+
+	start = test_time_ns();
+	for(int i = 0; i < BENCH_NUM_LOOKUPS; i++)
+		if(hashmap_value_get(hashmap, missing_keys[lookups[i]])) num_wrong++;
+	new_times.lookup_missing = test_time_ns() - start;
+	hashmap_free(hashmap);
+
+	start = test_time_ns();
+	struct Old_Hashmap* old_hashmap = old_hashmap_create();
+	for(int i = 0; i < num_keys; i++)
+		old_hashmap_int_set(old_hashmap, keys[i], i);
+	old_times.insert = test_time_ns() - start;
+
+	start = test_time_ns();
+	for(int i = 0; i < BENCH_NUM_LOOKUPS; i++)
+	{
+		const struct Variant* value = old_hashmap_value_get(old_hashmap, keys[lookups[i]]);
+		if(!value || value->val_int != lookups[i]) num_wrong++;
+	}
+	old_times.lookup = test_time_ns() - start;
+
+	start = test_time_ns();
+	for(int i = 0; i < BENCH_NUM_LOOKUPS; i++)
+		if(old_hashmap_value_get(old_hashmap, missing_keys[lookups[i]])) num_wrong++;
+	old_times.lookup_missing = test_time_ns() - start;
+	old_hashmap_free(old_hashmap);
+
+	log_to_stdout("%5d keys, old -> new : insert %8.1f -> %5.1f ns, get %8.1f -> %5.1f ns, get missing %8.1f -> %5.1f ns, get hashed %5.1f ns, %d wrong",
+				  num_keys,
+				  (double)old_times.insert / num_keys,                  (double)new_times.insert / num_keys,
+				  (double)old_times.lookup / BENCH_NUM_LOOKUPS,         (double)new_times.lookup / BENCH_NUM_LOOKUPS,
+				  (double)old_times.lookup_missing / BENCH_NUM_LOOKUPS, (double)new_times.lookup_missing / BENCH_NUM_LOOKUPS,
+				  (double)lookup_hashed_time / BENCH_NUM_LOOKUPS,
+				  num_wrong);
+
+	memory_free(lookups);
+	memory_free(hashes);
+	memory_free(missing_keys);
+	memory_free(keys);
+	return num_wrong == 0;
+}
+
+static struct Old_Hashmap* old_hashmap_create(void)
+{
+	struct Old_Hashmap* hashmap = memory_allocate(sizeof(*hashmap));
+	for(int i = 0; i < BENCH_OLD_BUCKETS; i++)
+		hashmap->buckets[i] = array_new(struct Old_Hashmap_Entry);
+	return hashmap;
+}
+
+static void old_hashmap_free(struct Old_Hashmap* hashmap)
+{
+	for(int i = 0; i < BENCH_OLD_BUCKETS; i++)
+	{
+		for(int j = 0; j < array_len(hashmap->buckets[i]); j++)
+			variant_free(&hashmap->buckets[i][j].value);
+		array_free(hashmap->buckets[i]);
+	}
+	memory_free(hashmap);
+}
+
+static void old_hashmap_int_set(struct Old_Hashmap* hashmap, const char* key, int value)
+{
+	unsigned int index = old_hashmap_generate_hash(key);
+	struct Old_Hashmap_Entry* new_entry = NULL;
+	for(int i = 0; i < array_len(hashmap->buckets[index]); i++)
+	{
+		if(strncmp(key, hashmap->buckets[index][i].key, MAX_HASH_KEY_LEN) == 0)
+		{
+			new_entry = &hashmap->buckets[index][i];
+			memset(new_entry->key, '\0', MAX_HASH_KEY_LEN);
+			break;
+		}
+	}
+	if(!new_entry) new_entry = array_grow(hashmap->buckets[index], struct Old_Hashmap_Entry);
+	strncpy(new_entry->key, key, MAX_HASH_KEY_LEN - 1);
+	new_entry->key[MAX_HASH_KEY_LEN - 1] = '\0';
+	new_entry->value.type = VT_NONE;
+	variant_assign_int(&new_entry->value, value);
+}
+
+static struct Variant* old_hashmap_value_get(const struct Old_Hashmap* hashmap, const char* key)
+{
+	unsigned int index       = old_hashmap_generate_hash(key);
+	int          key_len     = (int)strlen(key);
+	int          compare_len = key_len < MAX_HASH_KEY_LEN ? key_len : MAX_HASH_KEY_LEN;
+	for(int i = 0; i < array_len(hashmap->buckets[index]); i++)
+	{
+		if(strnlen(hashmap->buckets[index][i].key, MAX_HASH_KEY_LEN) == (size_t)compare_len && strncmp(key, hashmap->buckets[index][i].key, compare_len) == 0)
+			return &hashmap->buckets[index][i].value;
+	}
+	return NULL;
+}
+
+static unsigned int old_hashmap_generate_hash(const char* key)
+{
+	unsigned int index      = 0;
+	const int    multiplier = 51;
+	for(int i = 0; i < (int)strlen(key); i++)
+		index = index * multiplier + key[i];
+	return index % BENCH_OLD_BUCKETS;
+}
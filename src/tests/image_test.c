@@ -0,0 +1,267 @@
+#include "../game/image.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Built twice. Image_Test encodes generated images as 24 and 32 bit tga files, raw and run
+   length encoded, with the bottom and the top left origin, and checks image_tga_decode hands
+   back exactly the pixels that went in. Every truncated prefix of each file has to be rejected.
+   Image_Bench defines IMAGE_BENCH and instead times decoding 4096x4096 images in MB/s of
+   decoded pixels */
+
+#define TEST_BENCH_SIZE    4096
+#define TEST_BENCH_REPEATS 5
+#define TEST_ID_LENGTH     5 // Image id bytes written before the pixel data, the decoder has to skip them
+
+struct Test_Size
+{
+	int width;
+	int height;
+};
+
+static uint8* pixels_generate(int width, int height, int channels, uint32 seed);
+static uint8* tga_build(const uint8* pixels, int width, int height, int channels, bool rle, bool top_origin, size_t* out_size);
+static size_t tga_rle_encode(const uint8* source, uint8* dest, size_t num_pixels, int channels);
+#if defined(IMAGE_BENCH)
+static bool   bench_run(void);
+#else
+static bool   test_run(void);
+static bool   tga_check(const uint8* file_data, size_t file_size, const uint8* expected, int width, int height, int channels);
+static int    tga_truncated_check(const uint8* file_data, size_t file_size);
+#endif
+
+int main(void)
+{
+	log_init("Image_Test.log", ".");
+#if defined(IMAGE_BENCH)
+	bool success = bench_run();
+#else
+	bool success = test_run();
+#endif
+	log_cleanup();
+	exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+#if !defined(IMAGE_BENCH)
+static bool test_run(void)
+{
+	// Widths leave pixels over for the scalar tail of the swizzle and rows wider than the flip buffer
+	const struct Test_Size sizes[] = { { 1, 1 }, { 37, 5 }, { 300, 3 }, { 16, 16 } };
+	bool success = true;
+	for(int size = 0; size < (int)(sizeof(sizes) / sizeof(sizes[0])); size++)
+	{
+		int width  = sizes[size].width;
+		int height = sizes[size].height;
+		for(int channels = 3; channels <= 4; channels++)
+		{
+			uint8* pixels = pixels_generate(width, height, channels, 0x2545F491u + (uint32)size);
+			for(int rle = 0; rle <= 1; rle++)
+			{
+				for(int top_origin = 0; top_origin <= 1; top_origin++)
+				{
+					size_t file_size = 0;
+					uint8* file_data = tga_build(pixels, width, height, channels, rle, top_origin, &file_size);
+					bool   decoded   = tga_check(file_data, file_size, pixels, width, height, channels);
+					int    accepted  = tga_truncated_check(file_data, file_size);
+					log_to_stdout("%3dx%-3d %d bit %-3s %-6s origin : decode %s, %d of %zu truncated files accepted",
+								  width, height, channels * 8, rle ? "rle" : "raw", top_origin ? "top" : "bottom", decoded ? "ok" : "FAILED", accepted, file_size);
+					if(!decoded || accepted > 0) success = false;
+					memory_free(file_data);
+				}
+			}
+			memory_free(pixels);
+		}
+	}
+
+	log_to_stdout(success ? "Image test passed" : "Image test FAILED");
+	return success;
+}
+
+static bool tga_check(const uint8* file_data, size_t file_size, const uint8* expected, int width, int height, int channels)
+{
+	uint8* pixels = NULL;
+	int    decoded_width = 0, decoded_height = 0, decoded_channels = 0;
+	char   error[128];
+	if(!image_tga_decode(file_data, file_size, &pixels, &decoded_width, &decoded_height, &decoded_channels, error, sizeof(error)))
+	{
+		log_to_stdout("Decode failed : %s", error);
+		return false;
+	}
+
+	bool success = decoded_width == width && decoded_height == height && decoded_channels == channels &&
+		           memcmp(pixels, expected, (size_t)width * height * channels) == 0;
+	memory_free(pixels);
+	return success;
+}
+
+static int tga_truncated_check(const uint8* file_data, size_t file_size)
+{
+	// Every byte of a well formed file is needed so every shorter prefix must fail without pixels
+	int num_accepted = 0;
+	for(size_t size = 0; size < file_size; size++)
+	{
+		uint8* pixels = NULL;
+		int    width = 0, height = 0, channels = 0;
+		char   error[128];
+		if(image_tga_decode(file_data, size, &pixels, &width, &height, &channels, error, sizeof(error)) || pixels)
+		{
+			num_accepted++;
+			memory_free(pixels);
+		}
+	}
+	return num_accepted;
+}
+#else
+static bool bench_run(void)
+{
+	bool success = true;
+	for(int channels = 3; channels <= 4; channels++)
+	{
+		uint8* pixels = pixels_generate(TEST_BENCH_SIZE, TEST_BENCH_SIZE, channels, 0x9E3779B9u);
+		for(int rle = 0; rle <= 1; rle++)
+		{
+			for(int top_origin = 0; top_origin <= 1; top_origin++)
+			{
+				size_t file_size = 0;
+				uint8* file_data = tga_build(pixels, TEST_BENCH_SIZE, TEST_BENCH_SIZE, channels, rle, top_origin, &file_size);
+
+				// Best of a few runs, the first one also pays for faulting in the output pages
+				uint64 best_time = 0;
+				for(int repeat = 0; repeat < TEST_BENCH_REPEATS; repeat++)
+				{
+					uint8* decoded = NULL;
+					int    width = 0, height = 0, decoded_channels = 0;
+					char   error[128];
+					uint64 start   = test_time_ns();
+					bool   result  = image_tga_decode(file_data, file_size, &decoded, &width, &height, &decoded_channels, error, sizeof(error));
+					uint64 elapsed = test_time_ns() - start;
+					if(!result)
+					{
+						log_to_stdout("Decode failed : %s", error);
+						success = false;
+						break;
+					}
+					if(repeat == 0 && memcmp(decoded, pixels, (size_t)TEST_BENCH_SIZE * TEST_BENCH_SIZE * channels) != 0)
+					{
+						log_to_stdout("Decoded pixels differ from the source image");
+						success = false;
+					}
+					memory_free(decoded);
+					if(repeat == 0 || elapsed < best_time) best_time = elapsed;
+				}
+
+				double decoded_mb = (double)TEST_BENCH_SIZE * TEST_BENCH_SIZE * channels / (1024.0 * 1024.0);
+				log_to_stdout("%dx%d %d bit %-3s %-6s origin : %8.2f ms, %8.1f MB/s (file %.1f MB)",
+							  TEST_BENCH_SIZE, TEST_BENCH_SIZE, channels * 8, rle ? "rle" : "raw", top_origin ? "top" : "bottom",
+							  (double)best_time / 1e6, decoded_mb / ((double)best_time / 1e9), (double)file_size / (1024.0 * 1024.0));
+				memory_free(file_data);
+			}
+		}
+		memory_free(pixels);
+	}
+	return success;
+}
+#endif
+
+static uint8* pixels_generate(int width, int height, int channels, uint32 seed)
+{
+	// Runs of repeated pixels between noisy stretches so rle files get both kinds of packet
+	size_t num_pixels = (size_t)width * height;
+	uint8* pixels     = memory_allocate(num_pixels * channels);
+	uint8  pixel[4]   = { 0, 0, 0, 0 };
+	int    remaining  = 0;
+	for(size_t i = 0; i < num_pixels; i++)
+	{
+		if(remaining == 0)
+		{
+			for(int c = 0; c < channels; c++)
+				pixel[c] = (uint8)(test_random_float(&seed) * 256.f);
+			remaining = test_random_float(&seed) < 0.5f ? 1 : 2 + (int)(test_random_float(&seed) * 32.f);
+		}
+		memcpy(pixels + i * channels, pixel, channels);
+		remaining--;
+	}
+	return pixels;
+}
+
+static uint8* tga_build(const uint8* pixels, int width, int height, int channels, bool rle, bool top_origin, size_t* out_size)
+{
+	struct Tga_Header header;
+	memset(&header, 0, sizeof(header));
+	header.idlength        = TEST_ID_LENGTH;
+	header.datatypecode    = rle ? 10 : 2;
+	header.width           = (short)width;
+	header.height          = (short)height;
+	header.bitsperpixel    = (char)(channels * 8);
+	header.imagedescriptor = (char)((channels == 4 ? 8 : 0) | (top_origin ? 0x20 : 0));
+
+	// Stored rows are in file order and bgr(a), the expected pixels are bottom row first and rgb(a)
+	size_t num_pixels = (size_t)width * height;
+	size_t row_size   = (size_t)width * channels;
+	uint8* stored     = memory_allocate(num_pixels * channels);
+	for(int row = 0; row < height; row++)
+	{
+		int source_row = top_origin ? height - 1 - row : row;
+		memcpy(stored + row * row_size, pixels + source_row * row_size, row_size);
+	}
+	image_swizzle_red_blue(stored, stored, num_pixels, channels);
+
+	// Worst case rle output is one packet header per pixel
+	uint8* file_data = memory_allocate(sizeof(header) + TEST_ID_LENGTH + num_pixels * (channels + 1));
+	memcpy(file_data, &header, sizeof(header));
+	memset(file_data + sizeof(header), 0xAB, TEST_ID_LENGTH);
+	uint8* data = file_data + sizeof(header) + TEST_ID_LENGTH;
+	size_t data_size = 0;
+	if(rle)
+	{
+		data_size = tga_rle_encode(stored, data, num_pixels, channels);
+	}
+	else
+	{
+		data_size = num_pixels * channels;
+		memcpy(data, stored, data_size);
+	}
+	memory_free(stored);
+
+	*out_size = sizeof(header) + TEST_ID_LENGTH + data_size;
+	return file_data;
+}
+
+static size_t tga_rle_encode(const uint8* source, uint8* dest, size_t num_pixels, int channels)
+{
+	uint8* out = dest;
+	size_t i   = 0;
+	while(i < num_pixels)
+	{
+		size_t run = 1;
+		while(i + run < num_pixels && run < 128 && memcmp(source + (i + run) * channels, source + i * channels, channels) == 0)
+			run++;
+
+		if(run > 1)
+		{
+			*out++ = (uint8)(0x80 | (run - 1));
+			memcpy(out, source + i * channels, channels);
+			out += channels;
+			i   += run;
+			continue;
+		}
+
+		// Raw packets end where the next run of two or more starts
+		size_t count = 1;
+		while(i + count < num_pixels && count < 128)
+		{
+			if(i + count + 1 < num_pixels && memcmp(source + (i + count) * channels, source + (i + count + 1) * channels, channels) == 0)
+				break;
+			count++;
+		}
+		*out++ = (uint8)(count - 1);
+		memcpy(out, source + i * channels, count * channels);
+		out += count * channels;
+		i   += count;
+	}
+	return (size_t)(out - dest);
+}
@@ -0,0 +1,290 @@
+#include "../common/job_system.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "../common/linmath.h"
+#include "../game/bounding_volumes.h"
+
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Runs the same enemy and trigger physics fixture with the job system on the main thread only
+   and with several worker counts. The compute functions follow the rules the scene's physics
+   jobs follow, they only read shared state and write one result per index, results are applied
+   serially afterwards. Every run has to produce byte for byte identical results. The job system
+   is given threads straight from SDL so the platform layer does not have to be linked in */
+
+#define TEST_NUM_ENEMIES  5000
+#define TEST_NUM_TRIGGERS 700
+#define TEST_NUM_STEPS    60
+#define TEST_FIXED_DT     (1.f / 60.f)
+
+struct Test_Enemy
+{
+	vec3                position;
+	float               yaw;
+	float               max_yaw;
+	float               turn_speed;
+	bool                turn_positive;
+	struct Bounding_Box box;
+};
+
+// Mirrors struct Enemy_Physics_Result
+struct Test_Enemy_Result
+{
+	float yaw;
+	bool  move_mesh;
+	vec3  mesh_position;
+};
+
+struct Test_Trigger
+{
+	struct Bounding_Box box;
+};
+
+struct Test_Fixture
+{
+	struct Test_Enemy*        enemies;
+	struct Test_Enemy_Result* enemy_results;
+	struct Test_Trigger*      triggers;
+	int*                      triggering_enemies; // Index of the first enemy inside each trigger or -1
+	float                     ticks;
+};
+
+static void fixture_create(struct Test_Fixture* fixture);
+static void fixture_destroy(struct Test_Fixture* fixture);
+static void fixture_run(struct Test_Fixture* fixture, int num_workers);
+static void enemy_physics_job(void* data, int start, int end);
+static void trigger_physics_job(void* data, int start, int end);
+
+static int               test_cpu_count_get(void);
+static struct Thread*    test_thread_create(int (*func)(void* param), const char* name, void* param);
+static void              test_thread_wait(struct Thread* thread);
+static struct Mutex*     test_mutex_create(void);
+static void              test_mutex_destroy(struct Mutex* mutex);
+static void              test_mutex_lock(struct Mutex* mutex);
+static void              test_mutex_unlock(struct Mutex* mutex);
+static struct Condition* test_condition_create(void);
+static void              test_condition_destroy(struct Condition* condition);
+static void              test_condition_wait(struct Condition* condition, struct Mutex* mutex);
+static void              test_condition_signal(struct Condition* condition);
+static void              test_condition_broadcast(struct Condition* condition);
+
+static const struct Job_System_Threading test_threading =
+{
+	.cpu_count_get       = &test_cpu_count_get,
+	.thread_create       = &test_thread_create,
+	.thread_wait         = &test_thread_wait,
+	.mutex_create        = &test_mutex_create,
+	.mutex_destroy       = &test_mutex_destroy,
+	.mutex_lock          = &test_mutex_lock,
+	.mutex_unlock        = &test_mutex_unlock,
+	.condition_create    = &test_condition_create,
+	.condition_destroy   = &test_condition_destroy,
+	.condition_wait      = &test_condition_wait,
+	.condition_signal    = &test_condition_signal,
+	.condition_broadcast = &test_condition_broadcast
+};
+
+int main(void)
+{
+	// Worker counts other than 0 only mean anything if they actually get threads
+	const int worker_counts[] = { 1, 2, 3, 7, -1 };
+	bool success = true;
+	log_init("Job_System_Test.log", ".");
+
+	struct Test_Fixture reference;
+	fixture_create(&reference);
+	fixture_run(&reference, 0);
+
+	for(int i = 0; i < (int)(sizeof(worker_counts) / sizeof(worker_counts[0])); i++)
+	{
+		struct Test_Fixture fixture;
+		fixture_create(&fixture);
+		fixture_run(&fixture, worker_counts[i]);
+
+		bool enemies_match  = memcmp(fixture.enemies, reference.enemies, sizeof(*fixture.enemies) * TEST_NUM_ENEMIES) == 0;
+		bool results_match  = memcmp(fixture.enemy_results, reference.enemy_results, sizeof(*fixture.enemy_results) * TEST_NUM_ENEMIES) == 0;
+		bool triggers_match = memcmp(fixture.triggering_enemies, reference.triggering_enemies, sizeof(*fixture.triggering_enemies) * TEST_NUM_TRIGGERS) == 0;
+		log_to_stdout("Workers %2d : enemies %s, enemy results %s, trigger results %s", worker_counts[i], enemies_match ? "match" : "DIFFER", results_match ? "match" : "DIFFER", triggers_match ? "match" : "DIFFER");
+		if(!enemies_match || !results_match || !triggers_match) success = false;
+		fixture_destroy(&fixture);
+	}
+
+	fixture_destroy(&reference);
+	log_to_stdout(success ? "Job system test passed" : "Job system test FAILED");
+	log_cleanup();
+	exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static void fixture_create(struct Test_Fixture* fixture)
+{
+	// Padding is part of the comparison so everything starts out cleared
+	fixture->enemies            = memory_allocate_and_clear(TEST_NUM_ENEMIES, sizeof(*fixture->enemies));
+	fixture->enemy_results      = memory_allocate_and_clear(TEST_NUM_ENEMIES, sizeof(*fixture->enemy_results));
+	fixture->triggers           = memory_allocate_and_clear(TEST_NUM_TRIGGERS, sizeof(*fixture->triggers));
+	fixture->triggering_enemies = memory_allocate_and_clear(TEST_NUM_TRIGGERS, sizeof(*fixture->triggering_enemies));
+	fixture->ticks              = 0.f;
+
+	srand(1234);
+	for(int i = 0; i < TEST_NUM_ENEMIES; i++)
+	{
+		struct Test_Enemy* enemy = &fixture->enemies[i];
+		vec3_fill(&enemy->position, (float)(rand() % 400) - 200.f, 0.f, (float)(rand() % 400) - 200.f);
+		enemy->yaw           = (float)(rand() % 90) - 45.f;
+		enemy->max_yaw       = 30.f + (float)(rand() % 30);
+		enemy->turn_speed    = 20.f + (float)(rand() % 40);
+		enemy->turn_positive = (rand() & 1) != 0;
+		vec3_fill(&enemy->box.min, enemy->position.x - 1.f, -1.f, enemy->position.z - 1.f);
+		vec3_fill(&enemy->box.max, enemy->position.x + 1.f,  1.f, enemy->position.z + 1.f);
+	}
+
+	for(int i = 0; i < TEST_NUM_TRIGGERS; i++)
+	{
+		struct Test_Trigger* trigger = &fixture->triggers[i];
+		vec3 center = { (float)(rand() % 400) - 200.f, 0.f, (float)(rand() % 400) - 200.f };
+		float extent = 1.f + (float)(rand() % 8);
+		vec3_fill(&trigger->box.min, center.x - extent, -2.f, center.z - extent);
+		vec3_fill(&trigger->box.max, center.x + extent,  2.f, center.z + extent);
+	}
+}
+
+static void fixture_destroy(struct Test_Fixture* fixture)
+{
+	memory_free(fixture->enemies);
+	memory_free(fixture->enemy_results);
+	memory_free(fixture->triggers);
+	memory_free(fixture->triggering_enemies);
+}
+
+static void fixture_run(struct Test_Fixture* fixture, int num_workers)
+{
+	job_system_init(num_workers, &test_threading, NULL);
+	for(int step = 0; step < TEST_NUM_STEPS; step++)
+	{
+		fixture->ticks += TEST_FIXED_DT * 1000.f;
+
+		// Small batches so ranges get split and stolen as often as possible
+		job_system_parallel_for(&enemy_physics_job, fixture, TEST_NUM_ENEMIES, 16);
+		for(int i = 0; i < TEST_NUM_ENEMIES; i++)
+		{
+			struct Test_Enemy* enemy = &fixture->enemies[i];
+			const struct Test_Enemy_Result* result = &fixture->enemy_results[i];
+			enemy->yaw += result->yaw;
+			if(result->move_mesh)
+			{
+				float offset = result->mesh_position.x - enemy->position.x;
+				vec3_assign(&enemy->position, &result->mesh_position);
+				enemy->box.min.x += offset;
+				enemy->box.max.x += offset;
+			}
+		}
+
+		job_system_parallel_for(&trigger_physics_job, fixture, TEST_NUM_TRIGGERS, 4);
+	}
+	job_system_cleanup();
+}
+
+static void enemy_physics_job(void* data, int start, int end)
+{
+	struct Test_Fixture* fixture = (struct Test_Fixture*)data;
+	for(int i = start; i < end; i++)
+	{
+		struct Test_Enemy* enemy = &fixture->enemies[i];
+		struct Test_Enemy_Result* result = &fixture->enemy_results[i];
+		memset(result, 0, sizeof(*result));
+
+		// Turrets sweep back and forth between their yaw limits, flipping direction is state owned by the enemy
+		float yaw = enemy->turn_speed * TEST_FIXED_DT * (enemy->turn_positive ? 1.f : -1.f);
+		if(fabsf(enemy->yaw + yaw) > enemy->max_yaw)
+		{
+			enemy->turn_positive = !enemy->turn_positive;
+			yaw = -yaw;
+		}
+		result->yaw = yaw;
+
+		result->move_mesh = true;
+		vec3_assign(&result->mesh_position, &enemy->position);
+		result->mesh_position.x += sinf(fixture->ticks * 0.001f + (float)i) * 0.5f;
+	}
+}
+
+static void trigger_physics_job(void* data, int start, int end)
+{
+	struct Test_Fixture* fixture = (struct Test_Fixture*)data;
+	for(int i = start; i < end; i++)
+	{
+		fixture->triggering_enemies[i] = -1;
+		for(int j = 0; j < TEST_NUM_ENEMIES; j++)
+		{
+			int intersection = bv_intersect_bounding_boxes(&fixture->triggers[i].box, &fixture->enemies[j].box);
+			if(intersection == IT_INTERSECT || intersection == IT_INSIDE)
+			{
+				fixture->triggering_enemies[i] = j;
+				break;
+			}
+		}
+	}
+}
+
+static int test_cpu_count_get(void)
+{
+	return SDL_GetCPUCount();
+}
+
+static struct Thread* test_thread_create(int (*func)(void* param), const char* name, void* param)
+{
+	return (struct Thread*)SDL_CreateThread(func, name, param);
+}
+
+static void test_thread_wait(struct Thread* thread)
+{
+	if(thread) SDL_WaitThread((SDL_Thread*)thread, NULL);
+}
+
+static struct Mutex* test_mutex_create(void)
+{
+	return (struct Mutex*)SDL_CreateMutex();
+}
+
+static void test_mutex_destroy(struct Mutex* mutex)
+{
+	if(mutex) SDL_DestroyMutex((SDL_mutex*)mutex);
+}
+
+static void test_mutex_lock(struct Mutex* mutex)
+{
+	SDL_LockMutex((SDL_mutex*)mutex);
+}
+
+static void test_mutex_unlock(struct Mutex* mutex)
+{
+	SDL_UnlockMutex((SDL_mutex*)mutex);
+}
+
+static struct Condition* test_condition_create(void)
+{
+	return (struct Condition*)SDL_CreateCond();
+}
+
+static void test_condition_destroy(struct Condition* condition)
+{
+	if(condition) SDL_DestroyCond((SDL_cond*)condition);
+}
+
+static void test_condition_wait(struct Condition* condition, struct Mutex* mutex)
+{
+	SDL_CondWait((SDL_cond*)condition, (SDL_mutex*)mutex);
+}
+
+static void test_condition_signal(struct Condition* condition)
+{
+	SDL_CondSignal((SDL_cond*)condition);
+}
+
+static void test_condition_broadcast(struct Condition* condition)
+{
+	SDL_CondBroadcast((SDL_cond*)condition);
+}
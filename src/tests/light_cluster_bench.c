@@ -0,0 +1,101 @@
+#include "../game/light_cluster.h"
+#include "../common/linmath.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Times light_cluster_grid_build for 30, 256 and 1024 point lights scattered around a camera
+   with the engine's default projection. Only the per frame part is timed, the cluster bounds
+   are built by a first untimed call. Every run also checks that each cluster's list is sorted
+   and only holds indices of lights that were passed in */
+
+#define BENCH_TARGET_LIGHTS 500000 // Builds per light count are chosen so every count tests about this many lights
+#define BENCH_WORLD_SIZE    120.f
+#define BENCH_NEARZ         0.1f
+#define BENCH_FARZ          1000.f
+
+static void lights_generate(struct Bounding_Sphere* spheres, int num_lights);
+static bool grid_check(const struct Light_Cluster_Grid* grid, int num_lights, int first_light_index, int* out_max_cluster_lights);
+
+int main(void)
+{
+	const int light_counts[] = { 30, 256, 1024 };
+	const int first_light_index = 1; // As if one directional light came first
+	bool success = true;
+	log_init("Light_Cluster_Bench.log", ".");
+
+	mat4 view_mat, proj_mat;
+	vec3 eye    = { 0.f, 5.f,  0.f };
+	vec3 center = { 0.f, 3.f, -20.f };
+	vec3 up     = { 0.f, 1.f,  0.f };
+	mat4_lookat(&view_mat, &eye, &center, &up);
+	mat4_perspective(&proj_mat, 60.f, 16.f / 9.f, BENCH_NEARZ, BENCH_FARZ);
+
+	struct Light_Cluster_Grid* grid = memory_allocate(sizeof(*grid));
+	light_cluster_grid_init(grid);
+	for(int i = 0; i < (int)(sizeof(light_counts) / sizeof(light_counts[0])); i++)
+	{
+		int num_lights = light_counts[i];
+		int num_builds = BENCH_TARGET_LIGHTS / num_lights;
+		struct Bounding_Sphere* spheres = memory_allocate(sizeof(*spheres) * num_lights);
+		lights_generate(spheres, num_lights);
+
+		light_cluster_grid_build(grid, &view_mat, &proj_mat, BENCH_NEARZ, BENCH_FARZ, spheres, num_lights, first_light_index);
+		uint64 start = test_time_ns();
+		for(int build = 0; build < num_builds; build++)
+			light_cluster_grid_build(grid, &view_mat, &proj_mat, BENCH_NEARZ, BENCH_FARZ, spheres, num_lights, first_light_index);
+		uint64 elapsed = test_time_ns() - start;
+
+		int  max_cluster_lights = 0;
+		bool valid = grid_check(grid, num_lights, first_light_index, &max_cluster_lights);
+		if(!valid) success = false;
+		log_to_stdout("%4d lights : %8.2f us/build, %6d light indices, at most %3d lights in a cluster, lists %s",
+					  num_lights, (double)elapsed / num_builds / 1000.0, grid->num_light_indices, max_cluster_lights, valid ? "valid" : "INVALID");
+		memory_free(spheres);
+	}
+
+	light_cluster_grid_destroy(grid);
+	memory_free(grid);
+	log_to_stdout(success ? "Light cluster bench passed" : "Light cluster bench FAILED");
+	log_cleanup();
+	exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static void lights_generate(struct Bounding_Sphere* spheres, int num_lights)
+{
+	// Spread over the area around the camera so some lights are behind it or cross the near plane
+	uint32 seed = 0xC0FFEE11u;
+	for(int i = 0; i < num_lights; i++)
+	{
+		vec3_fill(&spheres[i].center,
+				  test_random_range(&seed, -BENCH_WORLD_SIZE, BENCH_WORLD_SIZE) * 0.5f,
+				  test_random_range(&seed, 0.f, 10.f),
+				  test_random_range(&seed, -BENCH_WORLD_SIZE, BENCH_WORLD_SIZE * 0.25f));
+		spheres[i].radius = test_random_range(&seed, 2.f, 15.f);
+	}
+}
+
+static bool grid_check(const struct Light_Cluster_Grid* grid, int num_lights, int first_light_index, int* out_max_cluster_lights)
+{
+	uint32 total = 0;
+	*out_max_cluster_lights = 0;
+	for(int i = 0; i < LIGHT_CLUSTER_COUNT; i++)
+	{
+		uint32 offset = grid->clusters[i][0];
+		uint32 count  = grid->clusters[i][1];
+		if(offset != total || offset + count > (uint32)grid->num_light_indices) return false;
+		for(uint32 j = 0; j < count; j++)
+		{
+			int index = grid->light_indices[offset + j];
+			if(index < first_light_index || index >= first_light_index + num_lights) return false;
+			if(j > 0 && index <= grid->light_indices[offset + j - 1]) return false;
+		}
+		if((int)count > *out_max_cluster_lights) *out_max_cluster_lights = (int)count;
+		total += count;
+	}
+	return total == (uint32)grid->num_light_indices;
+}
@@ -0,0 +1,204 @@
+#include "../common/linmath.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Built twice, Linmath_Test_Scalar defines LINMATH_NO_SSE and Linmath_Test does not. Both
+   run mat4_mul, mat4_inverse, mat4_from_quat, mat4_from_trs and quat_mul_vec3 over the same
+   generated inputs and print the time per call. The scalar build writes its results as the
+   reference with --write and the SSE build checks its own results against that file with
+   --compare:
+
+       Linmath_Test_Scalar --write linmath_reference.bin
+       Linmath_Test --compare linmath_reference.bin */
+
+#define TEST_NUM_INPUTS  4096
+#define TEST_NUM_REPEATS 256
+#define TEST_EPSILON     1e-4f
+
+#if defined(LINMATH_NO_SSE)
+	#define TEST_BUILD_NAME "scalar"
+#else
+	#define TEST_BUILD_NAME "sse"
+#endif
+
+struct Test_Results
+{
+	mat4 products[TEST_NUM_INPUTS];
+	mat4 inverses[TEST_NUM_INPUTS];
+	mat4 rotations[TEST_NUM_INPUTS];
+	mat4 transforms[TEST_NUM_INPUTS];
+	vec3 rotated[TEST_NUM_INPUTS];
+};
+
+struct Test_Inputs
+{
+	mat4 matrices[TEST_NUM_INPUTS];
+	quat rotations[TEST_NUM_INPUTS];
+	vec3 vectors[TEST_NUM_INPUTS];
+};
+
+static void inputs_generate(struct Test_Inputs* inputs);
+static void results_compute(struct Test_Inputs* inputs, struct Test_Results* results);
+static bool results_write(const struct Test_Results* results, const char* filename);
+static bool results_compare(const struct Test_Results* results, const char* filename);
+static int  floats_compare(const char* name, const float* floats, const float* reference, int count);
+
+int main(int argc, char** args)
+{
+	bool write   = argc == 3 && strcmp(args[1], "--write") == 0;
+	bool compare = argc == 3 && strcmp(args[1], "--compare") == 0;
+	if(argc != 1 && !write && !compare)
+	{
+		log_to_stdout("Usage: %s [--write reference_file | --compare reference_file]", args[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	struct Test_Inputs*  inputs  = memory_allocate(sizeof(*inputs));
+	struct Test_Results* results = memory_allocate(sizeof(*results));
+	inputs_generate(inputs);
+	results_compute(inputs, results);
+
+	bool success = true;
+	if(write)   success = results_write(results, args[2]);
+	if(compare) success = results_compare(results, args[2]);
+
+	memory_free(inputs);
+	memory_free(results);
+	exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static void inputs_generate(struct Test_Inputs* inputs)
+{
+	// Plain arithmetic only, anything from linmath could already differ between the two builds
+	uint32 seed = 0x9E3779B9u;
+	for(int i = 0; i < TEST_NUM_INPUTS; i++)
+	{
+		// A strong diagonal keeps the matrices well away from singular so inverses are comparable
+		mat4* matrix = &inputs->matrices[i];
+		for(int j = 0; j < 16; j++)
+			matrix->mat[j] = test_random_range(&seed, -1.f, 1.f);
+		for(int j = 0; j < 4; j++)
+			matrix->mat[j * 5] += test_random_float(&seed) < 0.5f ? -4.f : 4.f;
+
+		quat* rotation = &inputs->rotations[i];
+		rotation->x = test_random_range(&seed, -1.f, 1.f);
+		rotation->y = test_random_range(&seed, -1.f, 1.f);
+		rotation->z = test_random_range(&seed, -1.f, 1.f);
+		rotation->w = test_random_range(&seed, -1.f, 1.f);
+		float length = sqrtf(rotation->x * rotation->x + rotation->y * rotation->y + rotation->z * rotation->z + rotation->w * rotation->w);
+		rotation->x /= length;
+		rotation->y /= length;
+		rotation->z /= length;
+		rotation->w /= length;
+
+		vec3* vector = &inputs->vectors[i];
+		vector->x = test_random_range(&seed, -100.f, 100.f);
+		vector->y = test_random_range(&seed, -100.f, 100.f);
+		vector->z = test_random_range(&seed, -100.f, 100.f);
+	}
+}
+
+static void results_compute(struct Test_Inputs* inputs, struct Test_Results* results)
+{
+	// Results are rewritten on every repeat, the last pass is the one that gets compared
+	uint64 start = test_time_ns();
+	for(int repeat = 0; repeat < TEST_NUM_REPEATS; repeat++)
+		for(int i = 0; i < TEST_NUM_INPUTS; i++)
+			mat4_mul(&results->products[i], &inputs->matrices[i], &inputs->matrices[(i + 1) % TEST_NUM_INPUTS]);
+	uint64 mul_time = test_time_ns() - start;
+
+	start = test_time_ns();
+	for(int repeat = 0; repeat < TEST_NUM_REPEATS; repeat++)
+		for(int i = 0; i < TEST_NUM_INPUTS; i++)
+			mat4_inverse(&results->inverses[i], &inputs->matrices[i]);
+	uint64 inverse_time = test_time_ns() - start;
+
+	start = test_time_ns();
+	for(int repeat = 0; repeat < TEST_NUM_REPEATS; repeat++)
+		for(int i = 0; i < TEST_NUM_INPUTS; i++)
+			mat4_from_quat(&results->rotations[i], &inputs->rotations[i]);
+	uint64 from_quat_time = test_time_ns() - start;
+
+	// The next input's vector doubles as a scale so every axis gets a different one
+	start = test_time_ns();
+	for(int repeat = 0; repeat < TEST_NUM_REPEATS; repeat++)
+		for(int i = 0; i < TEST_NUM_INPUTS; i++)
+			mat4_from_trs(&results->transforms[i], &inputs->vectors[i], &inputs->rotations[i], &inputs->vectors[(i + 1) % TEST_NUM_INPUTS]);
+	uint64 from_trs_time = test_time_ns() - start;
+
+	start = test_time_ns();
+	for(int repeat = 0; repeat < TEST_NUM_REPEATS; repeat++)
+		for(int i = 0; i < TEST_NUM_INPUTS; i++)
+			quat_mul_vec3(&results->rotated[i], &inputs->rotations[i], &inputs->vectors[i]);
+	uint64 rotate_time = test_time_ns() - start;
+
+	double num_calls = (double)TEST_NUM_INPUTS * TEST_NUM_REPEATS;
+	log_to_stdout("%-6s mat4_mul       : %6.2f ns/op", TEST_BUILD_NAME, (double)mul_time / num_calls);
+	log_to_stdout("%-6s mat4_inverse   : %6.2f ns/op", TEST_BUILD_NAME, (double)inverse_time / num_calls);
+	log_to_stdout("%-6s mat4_from_quat : %6.2f ns/op", TEST_BUILD_NAME, (double)from_quat_time / num_calls);
+	log_to_stdout("%-6s mat4_from_trs  : %6.2f ns/op", TEST_BUILD_NAME, (double)from_trs_time / num_calls);
+	log_to_stdout("%-6s quat_mul_vec3  : %6.2f ns/op", TEST_BUILD_NAME, (double)rotate_time / num_calls);
+}
+
+static bool results_write(const struct Test_Results* results, const char* filename)
+{
+	FILE* file = fopen(filename, "wb");
+	if(!file || fwrite(results, sizeof(*results), 1, file) != 1)
+	{
+		log_to_stdout("Failed to write reference results to %s", filename);
+		if(file) fclose(file);
+		return false;
+	}
+	fclose(file);
+	log_to_stdout("Wrote %s reference results to %s", TEST_BUILD_NAME, filename);
+	return true;
+}
+
+static bool results_compare(const struct Test_Results* results, const char* filename)
+{
+	struct Test_Results* reference = memory_allocate(sizeof(*reference));
+	FILE* file = fopen(filename, "rb");
+	if(!file || fread(reference, sizeof(*reference), 1, file) != 1)
+	{
+		log_to_stdout("Failed to read reference results from %s, write them with Linmath_Test_Scalar --write first", filename);
+		if(file) fclose(file);
+		memory_free(reference);
+		return false;
+	}
+	fclose(file);
+
+	int num_mismatches = 0;
+	num_mismatches += floats_compare("mat4_mul",       &results->products[0].mat[0],   &reference->products[0].mat[0],   TEST_NUM_INPUTS * 16);
+	num_mismatches += floats_compare("mat4_inverse",   &results->inverses[0].mat[0],   &reference->inverses[0].mat[0],   TEST_NUM_INPUTS * 16);
+	num_mismatches += floats_compare("mat4_from_quat", &results->rotations[0].mat[0],  &reference->rotations[0].mat[0],  TEST_NUM_INPUTS * 16);
+	num_mismatches += floats_compare("mat4_from_trs",  &results->transforms[0].mat[0], &reference->transforms[0].mat[0], TEST_NUM_INPUTS * 16);
+	num_mismatches += floats_compare("quat_mul_vec3",  &results->rotated[0].x,         &reference->rotated[0].x,         TEST_NUM_INPUTS * 3);
+	memory_free(reference);
+
+	log_to_stdout(num_mismatches == 0 ? "Linmath test passed" : "Linmath test FAILED");
+	return num_mismatches == 0;
+}
+
+static int floats_compare(const char* name, const float* floats, const float* reference, int count)
+{
+	int num_mismatches = 0;
+	float max_difference = 0.f;
+	for(int i = 0; i < count; i++)
+	{
+		float difference = fabsf(floats[i] - reference[i]);
+		if(difference > max_difference) max_difference = difference;
+		if(!test_float_equal(floats[i], reference[i], TEST_EPSILON))
+		{
+			if(num_mismatches < 8) log_to_stdout("%s mismatch at %d : %f, reference %f", name, i, floats[i], reference[i]);
+			num_mismatches++;
+		}
+	}
+	log_to_stdout("%-14s : %d mismatches in %d values, largest difference %g", name, num_mismatches, count, max_difference);
+	return num_mismatches;
+}
@@ -0,0 +1,144 @@
+#include "../common/parser.h"
+#include "../common/hashmap.h"
+#include "../common/variant.h"
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Cached entity archetypes hand the same parsed objects to every instance, so reading a
+   value must never change what the next reader sees. Reads each key of a parsed object,
+   a compiled object and a map holding typed values as one type, then as another, then
+   as the first type again and checks that the last read still returns the original */
+
+#define TEST_EPSILON 1e-5f
+
+static const char* test_text =
+	"Entity\n"
+	"{\n"
+	"\tscale : 2.500\n"
+	"\tflags : 7\n"
+	"\tactive : true\n"
+	"\tposition : 1.000 2.000 3.000\n"
+	"\tname : Door\n"
+	"}\n";
+
+static int  test_parsed_object(void);
+static int  test_compiled_object(void);
+static int  test_typed_hashmap(void);
+static int  test_check(const char* name, bool passed);
+
+int main(void)
+{
+	log_init("Parser_Test.log", ".");
+	int num_failed = test_parsed_object() + test_compiled_object() + test_typed_hashmap();
+	log_to_stdout(num_failed == 0 ? "Parser test passed" : "Parser test FAILED, %d checks failed", num_failed);
+	log_cleanup();
+	exit(num_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static int test_parsed_object(void)
+{
+	FILE* file = tmpfile();
+	if(!file) return test_check("parsed: create temporary file", false);
+	fputs(test_text, file);
+	rewind(file);
+	struct Parser* parser = parser_load_objects(file, "parser_test");
+	fclose(file);
+	if(!parser) return test_check("parsed: load objects", false);
+
+	const struct Parser_Object* object = &parser->objects[0];
+	int num_failed = 0;
+	num_failed += test_check("parsed: scale as int",            parser_object_int_get(object, "scale") == 2);
+	num_failed += test_check("parsed: scale as float after int", test_float_equal(parser_object_float_get(object, "scale"), 2.5f, TEST_EPSILON));
+	num_failed += test_check("parsed: scale text unchanged",     strcmp(parser_object_str_get(object, "scale"), "2.500") == 0);
+	num_failed += test_check("parsed: flags as float",           test_float_equal(parser_object_float_get(object, "flags"), 7.f, TEST_EPSILON));
+	num_failed += test_check("parsed: flags as int after float", parser_object_int_get(object, "flags") == 7);
+	num_failed += test_check("parsed: active as str",            strcmp(parser_object_str_get(object, "active"), "true") == 0);
+	num_failed += test_check("parsed: active as bool after str", parser_object_bool_get(object, "active"));
+	num_failed += test_check("parsed: position as float",        test_float_equal(parser_object_float_get(object, "position"), 1.f, TEST_EPSILON));
+
+	vec3 position = parser_object_vec3_get(object, "position");
+	num_failed += test_check("parsed: position as vec3 after float", test_float_equal(position.y, 2.f, TEST_EPSILON) && test_float_equal(position.z, 3.f, TEST_EPSILON));
+	num_failed += test_check("parsed: position text unchanged",      strcmp(parser_object_str_get(object, "position"), "1.000 2.000 3.000") == 0);
+	num_failed += test_check("parsed: name unchanged",               strcmp(parser_object_str_get(object, "name"), "Door") == 0);
+
+	parser_free(parser);
+	return num_failed;
+}
+
+static int test_compiled_object(void)
+{
+	// Laid out the way scene_binary writes records, typed values keep their original text
+	static const char string_table[] = "scale\0" "2.500\0" "flags\0" "7\0" "rotation\0" "0.000 0.707 0.000 0.707";
+	struct Parser_Value values[3];
+	memset(values, 0, sizeof(values));
+	values[0].key          = 0;
+	values[0].text         = 6;
+	values[0].type         = VT_FLOAT;
+	values[0].val_float[0] = 2.5f;
+	values[1].key          = 12;
+	values[1].text         = 18;
+	values[1].type         = VT_INT;
+	values[1].val_int      = 7;
+	values[2].key          = 20;
+	values[2].text         = 29;
+	values[2].type         = VT_VEC4;
+	values[2].val_float[1] = 0.5f; // Differs from the text so reading it back shows the record was used
+	values[2].val_float[3] = 0.5f;
+
+	struct Parser* parser = parser_new();
+	const struct Parser_Object* object = parser_object_compiled_new(parser, PO_ENTITY, values, 3, string_table);
+	if(!object)
+	{
+		parser_free(parser);
+		return test_check("compiled: create object", false);
+	}
+
+	int num_failed = 0;
+	num_failed += test_check("compiled: scale as int",            parser_object_int_get(object, "scale") == 2);
+	num_failed += test_check("compiled: scale as float after int", test_float_equal(parser_object_float_get(object, "scale"), 2.5f, TEST_EPSILON));
+	num_failed += test_check("compiled: scale text unchanged",     strcmp(parser_object_str_get(object, "scale"), "2.500") == 0);
+	num_failed += test_check("compiled: flags as float",           test_float_equal(parser_object_float_get(object, "flags"), 7.f, TEST_EPSILON));
+	num_failed += test_check("compiled: flags as int after float", parser_object_int_get(object, "flags") == 7);
+	num_failed += test_check("compiled: records unchanged",        values[0].type == VT_FLOAT && values[1].type == VT_INT && values[1].val_int == 7);
+
+	// Rotations are compiled as vec4 and quats are read from that record instead of the text
+	quat rotation = parser_object_quat_get(object, "rotation");
+	num_failed += test_check("compiled: rotation as quat from vec4 record", test_float_equal(rotation.y, 0.5f, TEST_EPSILON) && test_float_equal(rotation.w, 0.5f, TEST_EPSILON));
+	vec4 rotation_vec4 = parser_object_vec4_get(object, "rotation");
+	num_failed += test_check("compiled: rotation as vec4 after quat",      test_float_equal(rotation_vec4.y, 0.5f, TEST_EPSILON) && values[2].type == VT_VEC4);
+
+	parser_free(parser);
+	return num_failed;
+}
+
+static int test_typed_hashmap(void)
+{
+	// Values set with a type are returned as stored, reading them as another type must not convert them
+	struct Hashmap* hashmap = hashmap_create();
+	hashmap_float_set(hashmap, "scale", 2.5f);
+	hashmap_int_set(hashmap, "flags", 7);
+
+	int num_failed = 0;
+	hashmap_int_get(hashmap, "scale");
+	hashmap_str_get(hashmap, "scale");
+	num_failed += test_check("typed: scale as float after int and str", test_float_equal(hashmap_float_get(hashmap, "scale"), 2.5f, TEST_EPSILON));
+	num_failed += test_check("typed: scale type unchanged",             hashmap_value_get(hashmap, "scale")->type == VT_FLOAT);
+	hashmap_float_get(hashmap, "flags");
+	hashmap_bool_get(hashmap, "flags");
+	num_failed += test_check("typed: flags as int after float and bool", hashmap_int_get(hashmap, "flags") == 7);
+	num_failed += test_check("typed: flags type unchanged",              hashmap_value_get(hashmap, "flags")->type == VT_INT);
+
+	hashmap_free(hashmap);
+	return num_failed;
+}
+
+static int test_check(const char* name, bool passed)
+{
+	if(!passed) log_to_stdout("FAILED: %s", name);
+	return passed ? 0 : 1;
+}
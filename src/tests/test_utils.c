@@ -0,0 +1,48 @@
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#define _POSIX_C_SOURCE 199309L
+	#include <time.h>
+#endif
+
+#include "test_utils.h"
+
+#include <math.h>
+
+uint64 test_time_ns(void)
+{
+#if defined(_WIN32)
+	static LARGE_INTEGER frequency;
+	if(frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (uint64)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64)time.tv_sec * 1000000000ull + (uint64)time.tv_nsec;
+#endif
+}
+
+float test_random_float(uint32* state)
+{
+	// xorshift32, rand() differs between c runtimes and the inputs have to match across builds
+	uint32 x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return (float)(x >> 8) / 16777216.f;
+}
+
+float test_random_range(uint32* state, float min, float max)
+{
+	return min + (max - min) * test_random_float(state);
+}
+
+bool test_float_equal(float a, float b, float epsilon)
+{
+	float magnitude = fmaxf(1.f, fmaxf(fabsf(a), fabsf(b)));
+	return fabsf(a - b) <= epsilon * magnitude;
+}
@@ -0,0 +1,14 @@
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include "../common/num_types.h"
+
+/* Helpers shared by the test and benchmark targets in this directory. They do not
+   depend on SDL so targets that only exercise common code stay self contained */
+
+uint64 test_time_ns(void);                      // Monotonic clock, only differences are meaningful
+float  test_random_float(uint32* state);        // Deterministic across platforms, returns a value in [0, 1)
+float  test_random_range(uint32* state, float min, float max);
+bool   test_float_equal(float a, float b, float epsilon); // Relative to the larger magnitude once it exceeds 1
+
+#endif
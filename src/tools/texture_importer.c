@@ -0,0 +1,169 @@
+#include "../common/log.h"
+#include "../common/memory_utils.h"
+#include "../common/num_types.h"
+#include "../game/image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Offline step that turns source images into texture containers the engine uploads without any
+   conversion. Mip chains are built here and optionally block compressed so none of that work
+   happens while the game is loading. Containers are written next to the source image and the
+   engine prefers them over the source as long as they are newer */
+
+struct Importer_Options
+{
+	const char* input_path;
+	const char* output_path; // Input path with the container extension when not given
+	bool        compress;
+	bool        mipmaps;
+};
+
+static bool  arguments_parse(int argc, char** args, struct Importer_Options* options);
+static uint8* file_read(const char* path, size_t* out_size);
+static char* output_path_get(const char* input_path);
+static bool  texture_import(const struct Importer_Options* options);
+
+int main(int argc, char** args)
+{
+	struct Importer_Options options;
+	if(!arguments_parse(argc, args, &options))
+	{
+		log_to_stdout("Usage: Texture_Importer [--compress] [--no-mipmaps] <input.tga> [output." IMAGE_CONTAINER_EXTENSION "]");
+		exit(EXIT_FAILURE);
+	}
+
+	bool success = texture_import(&options);
+	exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+static bool arguments_parse(int argc, char** args, struct Importer_Options* options)
+{
+	options->input_path  = NULL;
+	options->output_path = NULL;
+	options->compress    = false;
+	options->mipmaps     = true;
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(args[i], "--compress") == 0)
+			options->compress = true;
+		else if(strcmp(args[i], "--no-mipmaps") == 0)
+			options->mipmaps = false;
+		else if(args[i][0] == '-')
+			return false;
+		else if(!options->input_path)
+			options->input_path = args[i];
+		else if(!options->output_path)
+			options->output_path = args[i];
+		else
+			return false;
+	}
+	return options->input_path != NULL;
+}
+
+static bool texture_import(const struct Importer_Options* options)
+{
+	size_t file_size = 0;
+	uint8* file_data = file_read(options->input_path, &file_size);
+	if(!file_data)
+	{
+		log_to_stdout("ERR:(texture_importer:import) Could not read %s", options->input_path);
+		return false;
+	}
+
+	uint8* pixels = NULL;
+	int    width = 0, height = 0, channels = 0;
+	char   error[256] = {'\0'};
+	bool   decoded = image_tga_decode(file_data, file_size, &pixels, &width, &height, &channels, error, sizeof(error));
+	memory_free(file_data);
+	if(!decoded)
+	{
+		log_to_stdout("ERR:(texture_importer:import) Failed to decode %s, %s", options->input_path, error);
+		return false;
+	}
+
+	struct Image image;
+	bool success = image_mips_build(pixels, width, height, channels, options->mipmaps ? 0 : 1, &image);
+	memory_free(pixels);
+	if(!success)
+	{
+		log_to_stdout("ERR:(texture_importer:import) Failed to build mip chain for %s (%dx%d)", options->input_path, width, height);
+		return false;
+	}
+
+	if(options->compress)
+	{
+		struct Image compressed;
+		success = image_compress(&image, &compressed);
+		image_free(&image);
+		if(!success)
+		{
+			log_to_stdout("ERR:(texture_importer:import) Failed to compress %s", options->input_path);
+			return false;
+		}
+		image = compressed;
+	}
+
+	char* output_path = options->output_path ? NULL : output_path_get(options->input_path);
+	const char* path  = options->output_path ? options->output_path : output_path;
+	success = path && image_container_write(&image, path);
+	if(success)
+	{
+		size_t total_size = 0;
+		for(int i = 0; i < image.num_levels; i++)
+			total_size += image.levels[i].size;
+		size_t source_size = (size_t)width * (size_t)height * (size_t)channels;
+		log_to_stdout("%s -> %s, %dx%d, %d levels, %zu bytes (base level uncompressed is %zu bytes)",
+					  options->input_path, path, width, height, image.num_levels, total_size, source_size);
+	}
+	else
+	{
+		log_to_stdout("ERR:(texture_importer:import) Failed to write %s", path ? path : options->input_path);
+	}
+
+	if(output_path) memory_free(output_path);
+	image_free(&image);
+	return success;
+}
+
+static uint8* file_read(const char* path, size_t* out_size)
+{
+	FILE* file = fopen(path, "rb");
+	if(!file) return NULL;
+
+	uint8* data = NULL;
+	long   size = -1;
+	if(fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0)
+	{
+		rewind(file);
+		data = memory_allocate((size_t)size);
+		if(data && fread(data, (size_t)size, 1, file) == 1)
+		{
+			*out_size = (size_t)size;
+		}
+		else if(data)
+		{
+			memory_free(data);
+			data = NULL;
+		}
+	}
+	fclose(file);
+	return data;
+}
+
+static char* output_path_get(const char* input_path)
+{
+	const char* extension = strrchr(input_path, '.');
+	const char* separator = strrchr(input_path, '/');
+	const char* backslash = strrchr(input_path, '\\');
+	if(backslash > separator) separator = backslash;
+	size_t stem_length = extension && extension > separator ? (size_t)(extension - input_path) : strlen(input_path);
+
+	size_t length = stem_length + 1 + strlen(IMAGE_CONTAINER_EXTENSION) + 1;
+	char*  path   = memory_allocate(length);
+	if(!path) return NULL;
+	memcpy(path, input_path, stem_length);
+	snprintf(path + stem_length, length - stem_length, "." IMAGE_CONTAINER_EXTENSION);
+	return path;
+}